@@ -0,0 +1,280 @@
+// cache_server_bench：通过LLZXCacheClient（memcached文本协议、一致性hash）压测一组缓存节点，输出吞吐、命中率和延迟分位数
+//
+// 用法：cache_server_bench [--servers=127.0.0.1:11211,...] [--reactors=N] [--memory=MB] [--threads=1,2,4] [--ops=N]
+//                          [--workload=uniform|zipf] [--keys=N] [--theta=0.99] [--value-size=100] [--get-ratio=0.9]
+//                          [--pipeline=1]
+// 不指定servers时在进程内启动一个cache_server（reactors个I/O线程）作为被测节点；
+// 指定为memcached的地址时得到同一工作负载下memcached的数据，两者可以直接对比
+// 每个线程一个客户端；一次请求包含pipeline个key，get-ratio的概率为一次multi-get、否则为pipeline个set，延迟按请求计
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXCacheClient.h"
+#include "LLZXCacheServer.h"
+#include "LLZXCacheStats.h"
+#include "LLZXWorkload.h"
+
+using namespace LLZXNet;
+using LLZXCache::LLZXLatencySnapshot;
+using namespace LLZXCache::bench;
+
+namespace
+{
+
+struct Options
+{
+	std::vector<LLZXNodeAddress> servers;
+	size_t                       reactors = 0;
+	size_t                       memoryMB = 256;
+	std::vector<size_t>          threads{1, 2, 4};
+	size_t                       ops = 100000; // 每个线程的请求数
+	WorkloadSpec                 workload;
+	size_t                       valueSize = 100;
+	double                       getRatio = 0.9;
+	size_t                       pipeline = 1;
+};
+
+std::vector<std::string> splitList(const std::string& value)
+{
+	std::vector<std::string> items;
+	size_t begin = 0;
+	while (begin <= value.size())
+	{
+		size_t end = value.find(',', begin);
+		if (end == std::string::npos)
+			end = value.size();
+		if (end > begin)
+			items.push_back(value.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return items;
+}
+
+void usage()
+{
+	std::fprintf(stderr,
+		"usage: cache_server_bench [--servers=HOST:PORT,...] [--reactors=N] [--memory=MB] [--threads=1,2,4] [--ops=N]\n"
+		"                          [--workload=uniform|zipf] [--keys=N] [--theta=0.99] [--value-size=100]\n"
+		"                          [--get-ratio=0.9] [--pipeline=1]\n");
+}
+
+Options parseOptions(int argc, char** argv)
+{
+	Options options;
+	options.workload.keySpace = 100000;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		size_t eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+			throw std::invalid_argument("bad argument: " + arg);
+		std::string name = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+		if (name == "servers")
+		{
+			for (const auto& item : splitList(value))
+				options.servers.push_back(parseNodeAddress(item));
+		}
+		else if (name == "reactors") options.reactors = std::stoull(value);
+		else if (name == "memory") options.memoryMB = std::stoull(value);
+		else if (name == "threads")
+		{
+			options.threads.clear();
+			for (const auto& item : splitList(value))
+				options.threads.push_back(std::max<size_t>(1, std::stoull(item)));
+		}
+		else if (name == "ops") options.ops = std::stoull(value);
+		else if (name == "workload")
+		{
+			if (value == "uniform") options.workload.kind = WorkloadKind::Uniform;
+			else if (value == "zipf") options.workload.kind = WorkloadKind::Zipf;
+			else throw std::invalid_argument("unknown workload: " + value);
+		}
+		else if (name == "keys") options.workload.keySpace = std::stoull(value);
+		else if (name == "theta") options.workload.theta = std::stod(value);
+		else if (name == "value-size") options.valueSize = std::stoull(value);
+		else if (name == "get-ratio") options.getRatio = std::stod(value);
+		else if (name == "pipeline") options.pipeline = std::max<size_t>(1, std::stoull(value));
+		else throw std::invalid_argument("unknown option: --" + name);
+	}
+	if (options.workload.kind == WorkloadKind::Zipf && !(options.workload.theta > 0.0 && options.workload.theta < 1.0))
+		throw std::invalid_argument("theta must be in (0, 1)");
+	if (options.workload.keySpace == 0)
+		throw std::invalid_argument("keys must be positive");
+	return options;
+}
+
+std::string keyOf(uint64_t key)
+{
+	return "key:" + std::to_string(key);
+}
+
+struct ThreadResult
+{
+	uint64_t            hits = 0;
+	uint64_t            lookups = 0;
+	LLZXLatencySnapshot latency;
+};
+
+void runOps(LLZXCacheClient& client, KeyGenerator& keys, const Options& options, const std::string& value,
+	ThreadResult& result)
+{
+	std::vector<std::string> batch(options.pipeline);
+	std::vector<std::string> values(options.pipeline, value);
+	for (size_t i = 0; i < options.ops; ++i)
+	{
+		for (auto& key : batch)
+			key = keyOf(keys.next());
+		bool read = keys.uniform() < options.getRatio;
+		auto start = std::chrono::steady_clock::now();
+
+		if (read)
+		{
+			for (const auto& hit : client.getMany(batch))
+				result.hits += hit.has_value();
+			result.lookups += batch.size();
+		}
+		else
+			client.setMany(batch, values);
+
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		++result.latency.buckets[LLZXLatencySnapshot::bucketOf(nanos)];
+		++result.latency.count;
+		result.latency.totalNanos += nanos;
+	}
+}
+
+// 按批写入工作负载中的所有key，之后的读取从满命中开始（受节点容量限制）
+void prefill(const Options& options, const std::string& value)
+{
+	LLZXCacheClient client(options.servers);
+	constexpr size_t kBatch = 100;
+	std::vector<std::string> keys, values;
+	for (uint64_t rank = 0; rank < options.workload.keySpace; ++rank)
+	{
+		keys.push_back(keyOf(scrambleKey(rank)));
+		values.push_back(value);
+		if (keys.size() == kBatch || rank + 1 == options.workload.keySpace)
+		{
+			client.setMany(keys, values);
+			keys.clear();
+			values.clear();
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_server_bench: %s\n", error.what());
+		usage();
+		return 2;
+	}
+
+	try
+	{
+		std::unique_ptr<LLZXCacheServer> server;
+		if (options.servers.empty())
+		{
+			LLZXServerOptions serverOptions;
+			serverOptions.host = "127.0.0.1";
+			serverOptions.port = 0;
+			serverOptions.reactorNum = options.reactors;
+			serverOptions.maxBytes = options.memoryMB * 1024 * 1024;
+			server = std::make_unique<LLZXCacheServer>(serverOptions);
+			server->start();
+			options.servers.push_back(LLZXNodeAddress{"127.0.0.1", server->port()});
+		}
+
+		std::string value(options.valueSize, 'v');
+		prefill(options, value);
+		Workload workload(options.workload);
+
+		std::printf("servers=%zu%s workload=%s keys=%llu value-size=%zu get-ratio=%.2f pipeline=%zu ops/thread=%zu\n",
+			options.servers.size(), server ? " (in-process cache_server)" : "",
+			options.workload.kind == WorkloadKind::Zipf ? "zipf" : "uniform",
+			static_cast<unsigned long long>(options.workload.keySpace), options.valueSize, options.getRatio,
+			options.pipeline, options.ops);
+		std::printf("%7s %14s %14s %8s %10s %10s %10s\n",
+			"threads", "requests/s", "keys/s", "hit%", "p50(us)", "p99(us)", "p999(us)");
+
+		for (size_t threadNum : options.threads)
+		{
+			std::vector<ThreadResult> results(threadNum);
+			std::vector<std::thread> workers;
+			std::atomic<size_t> ready{0};
+			std::atomic<bool> go{false};
+			std::atomic<bool> failed{false};
+			for (size_t t = 0; t < threadNum; ++t)
+			{
+				workers.emplace_back([&, t] {
+					try
+					{
+						LLZXCacheClient client(options.servers);
+						KeyGenerator keys(workload, t, threadNum);
+						ready.fetch_add(1);
+						while (!go.load(std::memory_order_acquire))
+							std::this_thread::yield();
+						runOps(client, keys, options, value, results[t]);
+					}
+					catch (const std::exception& error)
+					{
+						std::fprintf(stderr, "cache_server_bench: %s\n", error.what());
+						failed.store(true);
+						ready.fetch_add(1);
+					}
+				});
+			}
+			while (ready.load() < threadNum)
+				std::this_thread::yield();
+
+			auto start = std::chrono::steady_clock::now();
+			go.store(true, std::memory_order_release);
+			for (auto& worker : workers)
+				worker.join();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (failed.load())
+				return 1;
+
+			uint64_t hits = 0, lookups = 0;
+			LLZXLatencySnapshot latency;
+			for (const auto& result : results)
+			{
+				hits += result.hits;
+				lookups += result.lookups;
+				latency += result.latency;
+			}
+			double requests = static_cast<double>(options.ops * threadNum) / seconds;
+			std::printf("%7zu %14.0f %14.0f %7.2f%% %10.1f %10.1f %10.1f\n",
+				threadNum, requests, requests * static_cast<double>(options.pipeline),
+				lookups ? 100.0 * static_cast<double>(hits) / static_cast<double>(lookups) : 0.0,
+				static_cast<double>(latency.percentile(0.5)) / 1000.0,
+				static_cast<double>(latency.percentile(0.99)) / 1000.0,
+				static_cast<double>(latency.percentile(0.999)) / 1000.0);
+			std::fflush(stdout);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_server_bench: %s\n", error.what());
+		return 1;
+	}
+	return 0;
+}
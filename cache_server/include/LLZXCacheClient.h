@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LLZXHashRing.h"
+
+namespace LLZXNet
+{
+
+struct LLZXNodeAddress
+{
+	std::string host; // IPv4地址
+	uint16_t    port = 11211;
+};
+
+// 解析"host:port"，省略端口时为11211
+LLZXNodeAddress parseNodeAddress(std::string_view text);
+
+struct LLZXClientOptions
+{
+	size_t                    virtualNodes = 160;
+	// 建立连接、以及每次send/recv等待的上限，超时抛出错误码为ETIMEDOUT的std::system_error；0为不限
+	std::chrono::milliseconds connectTimeout{1000};
+	std::chrono::milliseconds ioTimeout{1000};
+};
+
+// 多个缓存节点的客户端，使用memcached文本协议，可以连接cache_server，也可以连接memcached
+//   key经过一致性hash环选择节点，每个节点一条阻塞的TCP连接，第一次使用时建立，出错后关闭、下次使用时重连
+//   getMany/setMany按节点分组，每个节点先把整组请求一次写出，再依次读取响应（pipelining），
+//   往返次数等于涉及的节点数而不是key数；一个节点上的key较多时multi-get拆成多条不超过8KB的get命令，一起写出
+// 不是线程安全的，每个线程使用自己的客户端；网络错误抛出std::system_error，服务端返回错误时抛出std::runtime_error
+// key为空、超过250字节或含有空白/控制字符时在发送任何数据之前抛出std::invalid_argument
+class LLZXCacheClient
+{
+public:
+	explicit LLZXCacheClient(const std::vector<LLZXNodeAddress>& nodes, const LLZXClientOptions& options = {});
+	~LLZXCacheClient();
+
+	LLZXCacheClient(const LLZXCacheClient&) = delete;
+	LLZXCacheClient& operator=(const LLZXCacheClient&) = delete;
+
+	std::optional<std::string> get(std::string_view key);
+
+	// exptime的含义同memcached，返回服务端是否保存了该值（value超过服务端上限时为false）
+	bool set(std::string_view key, std::string_view value, uint32_t flags = 0, int64_t exptime = 0);
+
+	// 返回key是否存在
+	bool remove(std::string_view key);
+
+	// 结果与keys一一对应，未命中为std::nullopt
+	std::vector<std::optional<std::string>> getMany(const std::vector<std::string>& keys);
+
+	// 返回成功保存的个数
+	size_t setMany(const std::vector<std::string>& keys, const std::vector<std::string>& values,
+		uint32_t flags = 0, int64_t exptime = 0);
+
+	// key所在节点的编号（与构造时的顺序一致）
+	size_t nodeOf(std::string_view key) const { return ring_.nodeOf(key); }
+	size_t nodeNum() const { return nodes_.size(); }
+
+private:
+	class Node;
+
+	Node& nodeFor(std::string_view key);
+	// 把keys按节点分组，返回每个节点上的下标
+	std::vector<std::vector<size_t>> groupByNode(const std::vector<std::string>& keys) const;
+	void disconnect(const std::vector<std::vector<size_t>>& groups);
+
+private:
+	LLZXHashRing                       ring_;
+	std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+} // namespace LLZXNet
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXItemStore.h"
+
+namespace LLZXNet
+{
+
+struct LLZXServerOptions
+{
+	std::string host = "0.0.0.0";              // IPv4地址
+	uint16_t    port = 11211;                  // 为0时由系统分配，启动后通过port()取得
+	size_t      reactorNum = 0;                // I/O线程数，为0时取CPU核数
+	size_t      maxBytes = 64 * 1024 * 1024;   // 缓存的字节数上限，含每个元素的固定开销
+	size_t      sliceNum = 16;
+	LLZXCache::LLZXReadMode readMode = LLZXCache::LLZXReadMode::Buffered;
+	size_t      maxItemSize = 1024 * 1024;     // 单个value的上限
+	size_t      maxOutputPending = 4 * 1024 * 1024; // 每个连接积压的响应超过这个字节数时暂停读取请求
+	int         backlog = 1024;
+};
+
+// 兼容memcached文本协议和二进制协议的缓存节点，存储层是LLZXItemStore（分片的LLZXHashLruCache）
+//   多reactor：每个I/O线程有自己的epoll，共享同一个非阻塞的监听套接字（EPOLLEXCLUSIVE，一个连接只唤醒一个线程去accept），
+//   连接接受之后一直由这个线程处理，线程之间不交换连接，也不共享连接状态
+//   连接使用边缘触发，一次就绪读到EAGAIN为止，缓冲区中流水线式的多个请求依次执行，响应合并后用一次sendmsg发出
+//   命中的value以引用的形式排进发送队列，直接从缓存中的元素发送
+class LLZXCacheServer
+{
+public:
+	explicit LLZXCacheServer(const LLZXServerOptions& options);
+	~LLZXCacheServer();
+
+	LLZXCacheServer(const LLZXCacheServer&) = delete;
+	LLZXCacheServer& operator=(const LLZXCacheServer&) = delete;
+
+	// 绑定端口并启动I/O线程，失败时抛出std::system_error
+	void start();
+
+	// 停止所有I/O线程并关闭连接，可以重复调用
+	void stop();
+
+	// 实际监听的端口
+	uint16_t port() const { return port_; }
+
+	// 服务端进程内也可以直接访问存储
+	LLZXItemStore& store() { return store_; }
+
+private:
+	class Reactor;
+
+	LLZXServerOptions                     options_;
+	LLZXItemStore                         store_;
+	int                                   listenFd_ = -1;
+	int                                   stopFd_ = -1; // eventfd，写入后唤醒所有I/O线程退出
+	uint16_t                              port_ = 0;
+	std::vector<std::unique_ptr<Reactor>> reactors_;
+	std::vector<std::thread>              threads_;
+};
+
+} // namespace LLZXNet
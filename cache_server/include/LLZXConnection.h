@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LLZXItemStore.h"
+
+namespace LLZXNet
+{
+
+// 待发送的响应：小段内容拷贝进连续的缓冲区，较大的value只保存元素的引用，发送时直接指向元素中的数据（零拷贝）
+// 元素在引用释放之前不会回收，期间被覆盖或驱逐都不影响正在发送的响应
+class LLZXOutputQueue
+{
+public:
+	// 不小于这个长度的value以引用方式发送
+	static constexpr size_t kZeroCopyThreshold = 512;
+
+	void append(const char* data, size_t size);
+	void append(std::string_view data) { append(data.data(), data.size()); }
+	void appendValue(const LLZXItemPtr& item);
+
+	// 尚未发送的总字节数
+	size_t pending() const { return pending_; }
+	bool empty() const { return pending_ == 0; }
+
+	// 用sendmsg一次发送尽量多的块，返回发送的字节数；
+	// 返回-1表示出错（errno为EAGAIN/EWOULDBLOCK时只是发送缓冲区已满）
+	long flush(int fd);
+
+private:
+	struct Chunk
+	{
+		std::string bytes; // item为空时的内容
+		LLZXItemPtr item;  // 引用发送的元素，内容为item->data
+		size_t      size() const { return item ? item->data.size() : bytes.size(); }
+		const char* data() const { return item ? item->data.data() : bytes.data(); }
+	};
+
+	// 拷贝的内容攒到这个长度后另起一块，避免单个缓冲区无限增长
+	static constexpr size_t kChunkBytes = 16 * 1024;
+	static constexpr size_t kMaxIov = 64;
+
+	std::deque<Chunk> chunks_;
+	size_t            offset_ = 0; // 第一块中已经发送的字节数
+	size_t            pending_ = 0;
+};
+
+// 一个客户端连接的协议状态，与套接字无关：reactor把读到的字节交给input，consume解析其中所有完整的请求并执行，
+// 响应追加到output，由reactor负责发送
+//   同时支持memcached文本协议和二进制协议，按连接上第一个字节区分（二进制请求以0x80开头）
+//   一次读到的多个请求（pipelining）依次执行，响应按请求顺序排列；
+//   待发送的响应超过maxOutputPending时暂停解析，发送出去之后再继续，慢客户端不会让服务端无限缓冲
+class LLZXConnection
+{
+public:
+	LLZXConnection(LLZXItemStore& store, size_t maxValueSize, size_t maxOutputPending);
+
+	// 可写入的输入缓冲区，至少有minSpace字节空间；写入n字节后调用commit(n)
+	char* inputSpace(size_t minSpace);
+	void commit(size_t n) { inputEnd_ += n; }
+
+	// 解析并执行缓冲区中完整的请求，返回是否消费了输入
+	bool consume();
+
+	LLZXOutputQueue& output() { return output_; }
+	// 响应积压超过上限，暂停读取和解析
+	bool blocked() const { return output_.pending() >= maxOutputPending_; }
+	// 客户端发送了quit或协议错误之后，发送完剩余响应即关闭连接
+	bool closing() const { return closing_; }
+
+private:
+	enum class Protocol
+	{
+		Unknown,
+		Text,
+		Binary,
+	};
+
+	// 以下返回处理掉的字节数，为0表示请求还不完整
+	size_t consumeText(const char* begin, const char* end);
+	size_t consumeBinary(const char* begin, const char* end);
+
+	// 文本协议的各个命令，tokens[0]为命令名；存储类命令的数据块紧跟在命令行之后
+	void textGet(const std::vector<std::string_view>& tokens, bool withCas);
+	size_t textStore(const std::vector<std::string_view>& tokens, const char* data, const char* end);
+	void textDelete(const std::vector<std::string_view>& tokens);
+	void textDelta(const std::vector<std::string_view>& tokens, bool incr);
+	void textTouch(const std::vector<std::string_view>& tokens);
+	void textFlush(const std::vector<std::string_view>& tokens);
+	void textStats();
+	void reply(std::string_view line, bool noreply);
+	void appendNumber(char separator, uint64_t value);
+
+	// 二进制协议的响应，extras/key/value依次排在24字节的头部之后，value可以引用元素零拷贝发送
+	void binaryReply(uint8_t opcode, uint16_t status, uint32_t opaque, uint64_t cas,
+		std::string_view extras, std::string_view key, std::string_view value, const LLZXItemPtr& item = nullptr);
+	void binaryError(uint8_t opcode, uint16_t status, uint32_t opaque);
+
+private:
+	LLZXItemStore&                store_;
+	size_t                        maxValueSize_;
+	size_t                        maxOutputPending_;
+	Protocol                      protocol_ = Protocol::Unknown;
+	std::vector<char>             input_;
+	size_t                        inputBegin_ = 0;
+	size_t                        inputEnd_ = 0;
+	size_t                        swallow_ = 0; // 过大的存储请求剩余要丢弃的数据字节
+	bool                          closing_ = false;
+	LLZXOutputQueue               output_;
+	std::vector<std::string_view> tokens_;      // 当前文本命令行的各个字段，复用以免每行分配
+};
+
+} // namespace LLZXNet
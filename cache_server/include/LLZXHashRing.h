@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace LLZXNet
+{
+
+// 一致性hash环：每个节点在环上放virtualNodes个虚拟节点，key顺时针落到第一个虚拟节点所属的节点
+// 增删一个节点只影响约1/N的key；虚拟节点越多，各节点分到的key越均匀
+// hash只依赖节点名和key的字节，不依赖标准库实现，不同进程、不同平台上的客户端得到相同的分布
+// （与ketama使用的md5不同，不能与libmemcached等客户端混用同一组节点）
+class LLZXHashRing
+{
+public:
+	explicit LLZXHashRing(size_t virtualNodes = 160)
+		: virtualNodes_(virtualNodes > 0 ? virtualNodes : 1)
+	{}
+
+	// 返回节点编号，按添加顺序从0开始
+	size_t addNode(const std::string& name)
+	{
+		size_t node = names_.size();
+		names_.push_back(name);
+		for (size_t i = 0; i < virtualNodes_; ++i)
+			points_.emplace_back(hashOf(name + "#" + std::to_string(i)), node);
+		std::sort(points_.begin(), points_.end());
+		return node;
+	}
+
+	void removeNode(const std::string& name)
+	{
+		auto it = std::find(names_.begin(), names_.end(), name);
+		if (it == names_.end())
+			return;
+		size_t node = static_cast<size_t>(it - names_.begin());
+		points_.erase(std::remove_if(points_.begin(), points_.end(),
+			[node](const Point& point) { return point.second == node; }), points_.end());
+		// 编号保持不变，名字置空占位
+		it->clear();
+	}
+
+	// 环为空时返回SIZE_MAX
+	size_t nodeOf(std::string_view key) const
+	{
+		if (points_.empty())
+			return SIZE_MAX;
+		uint64_t hash = hashOf(key);
+		auto it = std::lower_bound(points_.begin(), points_.end(), Point(hash, 0));
+		return it == points_.end() ? points_.front().second : it->second;
+	}
+
+	const std::string& nameOf(size_t node) const { return names_[node]; }
+	size_t nodeNum() const { return names_.size(); }
+
+	// FNV-1a再经过一次64位混合，单纯的FNV-1a对只差末尾几个字节的虚拟节点名分布不够均匀
+	static uint64_t hashOf(std::string_view data)
+	{
+		uint64_t hash = 0xcbf29ce484222325ULL;
+		for (char c : data)
+		{
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 0x100000001b3ULL;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+private:
+	using Point = std::pair<uint64_t, size_t>; // 虚拟节点的hash和所属节点
+
+	size_t                   virtualNodes_;
+	std::vector<std::string> names_;
+	std::vector<Point>       points_;
+};
+
+} // namespace LLZXNet
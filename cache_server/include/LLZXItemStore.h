@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "LLZXLruCache.h"
+
+namespace LLZXNet
+{
+
+// 缓存中的一个元素，写入后不再修改：读者拿到的是shared_ptr，响应直接引用data发送，不需要拷贝，
+// 同一个key之后的写入换成新的元素，旧元素在最后一个引用（包括尚未发送完的响应）释放时回收
+struct LLZXItem
+{
+	uint32_t    flags = 0;
+	uint64_t    cas = 0;       // 每次写入分配的唯一版本号
+	int64_t     storedAt = 0;  // 写入时刻（steady_clock纳秒），flush_all据此判断元素是否失效
+	int64_t     deadline = 0;  // 过期时刻（steady_clock纳秒），0为不过期；append/incr等沿用原来的过期时间
+	std::string data;
+};
+
+using LLZXItemPtr = std::shared_ptr<const LLZXItem>;
+
+enum class LLZXStoreMode
+{
+	Set,
+	Add,     // key不存在时才写入
+	Replace, // key存在时才写入
+	Append,
+	Prepend,
+	Cas,     // 版本号与当前元素一致时才写入
+};
+
+enum class LLZXStoreResult
+{
+	Stored,
+	NotStored,
+	Exists,   // cas版本号不一致
+	NotFound, // cas的key不存在
+};
+
+enum class LLZXDeltaResult
+{
+	Ok,
+	NotFound,
+	NonNumeric,
+};
+
+struct LLZXStoreStats
+{
+	uint64_t getHits = 0;
+	uint64_t getMisses = 0;
+	uint64_t sets = 0;
+	uint64_t deletes = 0;
+	uint64_t currItems = 0;
+	uint64_t limitBytes = 0;
+};
+
+// cache_server的存储层：按字节数限制容量的LLZXHashLruCache<std::string, LLZXItemPtr>
+//   读只经过缓存本身（string_view异构查找，不构造临时key）；
+//   add/cas/append/incr等读-改-写的操作按key的hash持有256把锁之一，同一个key上的写入串行，不同key互不影响
+//   过期时间交给缓存的ttl，flush_all记录一个时刻，此前写入的元素在读取时视为不存在，确认仍是同一个元素后在key的锁内删除
+// exptime采用memcached的约定：0为不过期，负数为立即过期，不超过30天为相对秒数，否则为unix时间戳
+class LLZXItemStore
+{
+public:
+	using Cache = LLZXCache::LLZXHashLruCache<std::string, LLZXItemPtr,
+		LLZXCache::LLZXFlatNodeIndex<std::string, LLZXCache::LLZXStringHash, std::equal_to<>>>;
+
+	// 每个元素在key和value之外计入的固定开销（元素结构、控制块、节点和索引项）
+	static constexpr size_t kItemOverhead = 96;
+
+	LLZXItemStore(size_t maxBytes, size_t sliceNum, LLZXCache::LLZXReadMode readMode = LLZXCache::LLZXReadMode::Buffered);
+
+	LLZXItemStore(const LLZXItemStore&) = delete;
+	LLZXItemStore& operator=(const LLZXItemStore&) = delete;
+
+	// 未命中返回空指针
+	LLZXItemPtr get(std::string_view key);
+
+	// cas只在Cas模式下使用；写入成功时newCas（不为空时）返回新元素的版本号
+	LLZXStoreResult store(LLZXStoreMode mode, std::string_view key, uint32_t flags, int64_t exptime,
+		std::string data, uint64_t cas = 0, uint64_t* newCas = nullptr);
+
+	bool remove(std::string_view key);
+
+	// incr/decr：当前值按十进制无符号64位整数解析，incr溢出时回绕，decr不低于0
+	// key不存在且create为true时写入initial（二进制协议的语义），此时exptime用于新元素
+	LLZXDeltaResult delta(std::string_view key, bool incr, uint64_t amount, uint64_t& value,
+		bool create = false, uint64_t initial = 0, int64_t exptime = 0, uint64_t* newCas = nullptr);
+
+	// 更新过期时间，key不存在时返回false；元素不可修改，touch写入一份只改了过期时间的副本
+	bool touch(std::string_view key, int64_t exptime);
+
+	// delay秒之后（0为立即）让此前写入的所有元素失效
+	void flushAll(int64_t delay);
+
+	LLZXStoreStats stats() const;
+
+	// 能够缓存的最大value字节数：单个元素的权重不能超过一个分片的容量
+	size_t maxValueSize(size_t keySize) const;
+
+	Cache& cache() { return cache_; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static int64_t nowNanos();
+	// exptime换算成过期时刻，已经过期时返回false
+	static bool deadlineOf(int64_t exptime, int64_t& deadline);
+
+	std::mutex& lockOf(std::string_view key);
+	bool flushed(const LLZXItem& item) const;
+	// 读-改-写操作的查找，调用方持有lockOf(key)
+	LLZXItemPtr find(std::string_view key);
+	LLZXItemPtr makeItem(uint32_t flags, int64_t deadline, std::string data);
+	// 写入新元素，过期时刻已到时改为删除
+	void put(std::string_view key, LLZXItemPtr item);
+
+private:
+	static constexpr size_t kLockNum = 256;
+
+	Cache                              cache_;
+	size_t                             maxBytes_;
+	std::array<std::mutex, kLockNum>   locks_;
+	std::atomic<uint64_t>              nextCas_{0};
+	std::atomic<int64_t>               flushAt_{0}; // 为0表示没有flush_all
+	std::atomic<uint64_t>              getHits_{0};
+	std::atomic<uint64_t>              getMisses_{0};
+	std::atomic<uint64_t>              sets_{0};
+	std::atomic<uint64_t>              deletes_{0};
+};
+
+} // namespace LLZXNet
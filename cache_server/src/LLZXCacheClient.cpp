@@ -0,0 +1,460 @@
+#include "LLZXCacheClient.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace LLZXNet
+{
+
+namespace
+{
+
+constexpr size_t kReadSize = 16 * 1024;
+// memcached文本协议的key上限
+constexpr size_t kMaxKeyLength = 250;
+// 一条multi-get命令行的长度上限，远低于cache_server的64KB行长限制；更多的key拆成多条命令一起发出
+constexpr size_t kMaxGetLine = 8 * 1024;
+
+[[noreturn]] void throwErrno(const char* what)
+{
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::string nameOf(const LLZXNodeAddress& address)
+{
+	return address.host + ":" + std::to_string(address.port);
+}
+
+void setTimeout(int fd, int option, std::chrono::milliseconds timeout)
+{
+	timeval value{};
+	value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+	value.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000 * 1000);
+	if (::setsockopt(fd, SOL_SOCKET, option, &value, sizeof(value)) < 0)
+		throwErrno("setsockopt");
+}
+
+// 文本协议以空格分隔字段、以\r\n结束命令，key中出现空白或控制字符会被解析成别的命令，发送前拒绝
+void checkKey(std::string_view key)
+{
+	if (key.empty() || key.size() > kMaxKeyLength)
+		throw std::invalid_argument("bad key length: " + std::to_string(key.size()));
+	for (char c : key)
+	{
+		auto byte = static_cast<unsigned char>(c);
+		if (byte <= ' ' || byte == 0x7f)
+			throw std::invalid_argument("key contains space or control character");
+	}
+}
+
+void appendNumber(std::string& out, uint64_t value)
+{
+	char number[24];
+	char* end = std::to_chars(number, number + sizeof(number), value).ptr;
+	out.append(number, end);
+}
+
+void appendSet(std::string& request, std::string_view key, std::string_view value, uint32_t flags, int64_t exptime)
+{
+	request += "set ";
+	request += key;
+	request += ' ';
+	appendNumber(request, flags);
+	request += ' ';
+	request += std::to_string(exptime);
+	request += ' ';
+	appendNumber(request, value.size());
+	request += "\r\n";
+	request += value;
+	request += "\r\n";
+}
+
+// set的响应：STORED/NOT_STORED为正常结果，SERVER_ERROR（如value过大）视为未保存，其他为协议错误
+bool parseStored(const std::string& line)
+{
+	if (line == "STORED")
+		return true;
+	if (line == "NOT_STORED" || line.compare(0, 12, "SERVER_ERROR") == 0)
+		return false;
+	throw std::runtime_error("unexpected reply to set: " + line);
+}
+
+} // namespace
+
+LLZXNodeAddress parseNodeAddress(std::string_view text)
+{
+	LLZXNodeAddress address;
+	size_t colon = text.rfind(':');
+	address.host = std::string(text.substr(0, colon));
+	if (colon != std::string_view::npos)
+	{
+		unsigned port = 0;
+		std::string_view digits = text.substr(colon + 1);
+		auto result = std::from_chars(digits.data(), digits.data() + digits.size(), port);
+		if (result.ec != std::errc() || result.ptr != digits.data() + digits.size() || port == 0 || port > 65535)
+			throw std::invalid_argument("bad node address: " + std::string(text));
+		address.port = static_cast<uint16_t>(port);
+	}
+	return address;
+}
+
+// 到一个节点的阻塞连接和它的接收缓冲区；连接用非阻塞connect加poll限时，读写由SO_RCVTIMEO/SO_SNDTIMEO限时
+class LLZXCacheClient::Node
+{
+public:
+	Node(LLZXNodeAddress address, std::chrono::milliseconds connectTimeout, std::chrono::milliseconds ioTimeout)
+		: address_(std::move(address))
+		, connectTimeout_(connectTimeout)
+		, ioTimeout_(ioTimeout)
+	{}
+
+	~Node() { disconnect(); }
+
+	void send(const std::string& request)
+	{
+		if (fd_ < 0)
+			connect();
+		size_t sent = 0;
+		while (sent < request.size())
+		{
+			ssize_t n = ::send(fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				if (errno == EAGAIN || errno == EWOULDBLOCK)
+					throw std::system_error(ETIMEDOUT, std::generic_category(), "send to " + nameOf(address_) + " timed out");
+				throwErrno("send");
+			}
+			sent += static_cast<size_t>(n);
+		}
+	}
+
+	// 一行响应，不含结尾的\r\n
+	std::string readLine()
+	{
+		for (;;)
+		{
+			size_t pos = buffer_.find("\r\n", begin_);
+			if (pos != std::string::npos)
+			{
+				std::string line = buffer_.substr(begin_, pos - begin_);
+				begin_ = pos + 2;
+				return line;
+			}
+			fill();
+		}
+	}
+
+	// 长度为size的数据块及其后的\r\n
+	std::string readBlock(size_t size)
+	{
+		while (buffer_.size() - begin_ < size + 2)
+			fill();
+		if (buffer_.compare(begin_ + size, 2, "\r\n") != 0)
+			throw std::runtime_error("bad data block from " + nameOf(address_));
+		std::string block = buffer_.substr(begin_, size);
+		begin_ += size + 2;
+		return block;
+	}
+
+	void disconnect()
+	{
+		if (fd_ >= 0)
+			::close(fd_);
+		fd_ = -1;
+		buffer_.clear();
+		begin_ = 0;
+	}
+
+private:
+	void connect()
+	{
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(address_.port);
+		if (::inet_pton(AF_INET, address_.host.c_str(), &address.sin_addr) != 1)
+			throw std::system_error(EINVAL, std::generic_category(), "bad node address " + nameOf(address_));
+		int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+		if (fd < 0)
+			throwErrno("socket");
+		try
+		{
+			if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+			{
+				if (errno != EINPROGRESS)
+					throw std::system_error(errno, std::generic_category(), "connect " + nameOf(address_));
+				waitConnected(fd);
+			}
+			// 连接建立后恢复阻塞模式，之后的读写由套接字超时限制
+			if (::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK) < 0)
+				throwErrno("fcntl");
+			if (ioTimeout_.count() > 0)
+			{
+				setTimeout(fd, SO_RCVTIMEO, ioTimeout_);
+				setTimeout(fd, SO_SNDTIMEO, ioTimeout_);
+			}
+		}
+		catch (...)
+		{
+			::close(fd);
+			throw;
+		}
+		int one = 1;
+		::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		fd_ = fd;
+	}
+
+	void waitConnected(int fd)
+	{
+		pollfd event{fd, POLLOUT, 0};
+		int timeout = connectTimeout_.count() > 0 ? static_cast<int>(connectTimeout_.count()) : -1;
+		int n;
+		do
+			n = ::poll(&event, 1, timeout);
+		while (n < 0 && errno == EINTR);
+		if (n < 0)
+			throwErrno("poll");
+		if (n == 0)
+			throw std::system_error(ETIMEDOUT, std::generic_category(), "connect " + nameOf(address_) + " timed out");
+		int error = 0;
+		socklen_t length = sizeof(error);
+		if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0)
+			throwErrno("getsockopt");
+		if (error != 0)
+			throw std::system_error(error, std::generic_category(), "connect " + nameOf(address_));
+	}
+
+	void fill()
+	{
+		if (begin_ > 0)
+		{
+			buffer_.erase(0, begin_);
+			begin_ = 0;
+		}
+		size_t size = buffer_.size();
+		buffer_.resize(size + kReadSize);
+		ssize_t n;
+		do
+			n = ::recv(fd_, &buffer_[size], kReadSize, 0);
+		while (n < 0 && errno == EINTR);
+		buffer_.resize(size + static_cast<size_t>(n > 0 ? n : 0));
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			throw std::system_error(ETIMEDOUT, std::generic_category(), "recv from " + nameOf(address_) + " timed out");
+		if (n < 0)
+			throwErrno("recv");
+		if (n == 0)
+			throw std::system_error(ECONNRESET, std::generic_category(), "connection closed by " + nameOf(address_));
+	}
+
+private:
+	LLZXNodeAddress           address_;
+	std::chrono::milliseconds connectTimeout_;
+	std::chrono::milliseconds ioTimeout_;
+	int                       fd_ = -1;
+	std::string               buffer_;
+	size_t                    begin_ = 0; // buffer_中尚未读取的位置
+};
+
+LLZXCacheClient::LLZXCacheClient(const std::vector<LLZXNodeAddress>& nodes, const LLZXClientOptions& options)
+	: ring_(options.virtualNodes)
+{
+	if (nodes.empty())
+		throw std::invalid_argument("LLZXCacheClient needs at least one node");
+	for (const auto& address : nodes)
+	{
+		ring_.addNode(nameOf(address));
+		nodes_.push_back(std::make_unique<Node>(address, options.connectTimeout, options.ioTimeout));
+	}
+}
+
+LLZXCacheClient::~LLZXCacheClient() = default;
+
+LLZXCacheClient::Node& LLZXCacheClient::nodeFor(std::string_view key)
+{
+	return *nodes_[ring_.nodeOf(key)];
+}
+
+std::vector<std::vector<size_t>> LLZXCacheClient::groupByNode(const std::vector<std::string>& keys) const
+{
+	std::vector<std::vector<size_t>> groups(nodes_.size());
+	for (size_t i = 0; i < keys.size(); ++i)
+		groups[ring_.nodeOf(keys[i])].push_back(i);
+	return groups;
+}
+
+std::optional<std::string> LLZXCacheClient::get(std::string_view key)
+{
+	auto results = getMany({std::string(key)});
+	return std::move(results.front());
+}
+
+bool LLZXCacheClient::set(std::string_view key, std::string_view value, uint32_t flags, int64_t exptime)
+{
+	checkKey(key);
+	Node& node = nodeFor(key);
+	try
+	{
+		std::string request;
+		appendSet(request, key, value, flags, exptime);
+		node.send(request);
+		return parseStored(node.readLine());
+	}
+	catch (...)
+	{
+		node.disconnect();
+		throw;
+	}
+}
+
+bool LLZXCacheClient::remove(std::string_view key)
+{
+	checkKey(key);
+	Node& node = nodeFor(key);
+	try
+	{
+		std::string request = "delete ";
+		request += key;
+		request += "\r\n";
+		node.send(request);
+		std::string line = node.readLine();
+		if (line == "DELETED")
+			return true;
+		if (line == "NOT_FOUND")
+			return false;
+		throw std::runtime_error("unexpected reply to delete: " + line);
+	}
+	catch (...)
+	{
+		node.disconnect();
+		throw;
+	}
+}
+
+std::vector<std::optional<std::string>> LLZXCacheClient::getMany(const std::vector<std::string>& keys)
+{
+	for (const auto& key : keys)
+		checkKey(key);
+	std::vector<std::optional<std::string>> results(keys.size());
+	auto groups = groupByNode(keys);
+	std::vector<size_t> commands(nodes_.size(), 1); // 每个节点上拆成的get命令数
+	try
+	{
+		// 先向所有涉及的节点发出各自的multi-get，再逐个读取，各节点的处理时间相互重叠
+		for (size_t i = 0; i < nodes_.size(); ++i)
+		{
+			if (groups[i].empty())
+				continue;
+			std::string request = "get";
+			size_t lineBegin = 0;
+			for (size_t index : groups[i])
+			{
+				if (request.size() - lineBegin + 1 + keys[index].size() + 2 > kMaxGetLine)
+				{
+					request += "\r\nget";
+					lineBegin = request.size() - 3;
+					++commands[i];
+				}
+				request += ' ';
+				request += keys[index];
+			}
+			request += "\r\n";
+			nodes_[i]->send(request);
+		}
+
+		for (size_t i = 0; i < nodes_.size(); ++i)
+		{
+			if (groups[i].empty())
+				continue;
+			// 命中的VALUE按请求中key的顺序返回，未命中的key没有响应，按顺序向后匹配；每条get命令以END结束
+			size_t next = 0;
+			for (size_t ends = 0; ends < commands[i];)
+			{
+				std::string line = nodes_[i]->readLine();
+				if (line == "END")
+				{
+					++ends;
+					continue;
+				}
+				// VALUE <key> <flags> <bytes> [<cas>]
+				size_t keyEnd = line.compare(0, 6, "VALUE ") == 0 ? line.find(' ', 6) : std::string::npos;
+				size_t flagsEnd = keyEnd == std::string::npos ? keyEnd : line.find(' ', keyEnd + 1);
+				size_t bytes = 0;
+				if (flagsEnd == std::string::npos
+					|| std::from_chars(line.data() + flagsEnd + 1, line.data() + line.size(), bytes).ec != std::errc())
+					throw std::runtime_error("unexpected reply to get: " + line);
+				std::string_view key(line.data() + 6, keyEnd - 6);
+				std::string value = nodes_[i]->readBlock(bytes);
+
+				while (next < groups[i].size() && keys[groups[i][next]] != key)
+					++next;
+				if (next == groups[i].size())
+					throw std::runtime_error("unexpected key in get reply: " + std::string(key));
+				results[groups[i][next++]] = std::move(value);
+			}
+		}
+	}
+	catch (...)
+	{
+		disconnect(groups);
+		throw;
+	}
+	return results;
+}
+
+size_t LLZXCacheClient::setMany(const std::vector<std::string>& keys, const std::vector<std::string>& values,
+	uint32_t flags, int64_t exptime)
+{
+	if (keys.size() != values.size())
+		throw std::invalid_argument("setMany: keys and values differ in length");
+	for (const auto& key : keys)
+		checkKey(key);
+	auto groups = groupByNode(keys);
+	size_t stored = 0;
+	try
+	{
+		for (size_t i = 0; i < nodes_.size(); ++i)
+		{
+			if (groups[i].empty())
+				continue;
+			std::string request;
+			for (size_t index : groups[i])
+				appendSet(request, keys[index], values[index], flags, exptime);
+			nodes_[i]->send(request);
+		}
+		for (size_t i = 0; i < nodes_.size(); ++i)
+		{
+			for (size_t j = 0; j < groups[i].size(); ++j)
+				stored += parseStored(nodes_[i]->readLine());
+		}
+	}
+	catch (...)
+	{
+		disconnect(groups);
+		throw;
+	}
+	return stored;
+}
+
+// 批量请求中途出错时，其他节点上可能还有未读的响应，全部断开，下次使用时重连
+void LLZXCacheClient::disconnect(const std::vector<std::vector<size_t>>& groups)
+{
+	for (size_t i = 0; i < nodes_.size(); ++i)
+	{
+		if (!groups[i].empty())
+			nodes_[i]->disconnect();
+	}
+}
+
+} // namespace LLZXNet
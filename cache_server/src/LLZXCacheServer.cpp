@@ -0,0 +1,312 @@
+#include "LLZXCacheServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "LLZXConnection.h"
+
+namespace LLZXNet
+{
+
+namespace
+{
+
+constexpr size_t kReadSize = 16 * 1024;
+constexpr int kMaxEvents = 256;
+
+[[noreturn]] void throwErrno(const char* what)
+{
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+bool wouldBlock(int error)
+{
+	return error == EAGAIN || error == EWOULDBLOCK;
+}
+
+} // namespace
+
+// 一个I/O线程：自己的epoll实例和自己接受的连接，所有成员只在这个线程上访问（构造和析构除外）
+class LLZXCacheServer::Reactor
+{
+public:
+	Reactor(LLZXItemStore& store, const LLZXServerOptions& options, int listenFd, int stopFd)
+		: store_(store)
+		, options_(options)
+		, listenFd_(listenFd)
+	{
+		epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+		if (epollFd_ < 0)
+			throwErrno("epoll_create1");
+
+		epoll_event event{};
+		event.events = EPOLLIN | EPOLLEXCLUSIVE;
+		event.data.ptr = &listenTag_;
+		if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd, &event) < 0)
+		{
+			::close(epollFd_);
+			throwErrno("epoll_ctl(listen)");
+		}
+		// 停止信号不读走，保持可读，所有线程都能看到
+		event.events = EPOLLIN;
+		event.data.ptr = &stopTag_;
+		if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, stopFd, &event) < 0)
+		{
+			::close(epollFd_);
+			throwErrno("epoll_ctl(stop)");
+		}
+	}
+
+	~Reactor()
+	{
+		for (auto& entry : connections_)
+			::close(entry.second->fd);
+		::close(epollFd_);
+	}
+
+	Reactor(const Reactor&) = delete;
+	Reactor& operator=(const Reactor&) = delete;
+
+	void run()
+	{
+		epoll_event events[kMaxEvents];
+		for (;;)
+		{
+			int n = ::epoll_wait(epollFd_, events, kMaxEvents, -1);
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return;
+			}
+			for (int i = 0; i < n; ++i)
+			{
+				void* tag = events[i].data.ptr;
+				if (tag == &stopTag_)
+					return;
+				if (tag == &listenTag_)
+				{
+					acceptAll();
+					continue;
+				}
+				auto* conn = static_cast<Conn*>(tag);
+				// 错误和挂断也当作可读，由recv取得具体的结果
+				if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+					conn->readable = true;
+				if (events[i].events & EPOLLOUT)
+					conn->writable = true;
+				service(*conn);
+			}
+		}
+	}
+
+private:
+	struct Conn
+	{
+		Conn(int fd, LLZXItemStore& store, const LLZXServerOptions& options)
+			: fd(fd)
+			, protocol(store, options.maxItemSize, options.maxOutputPending)
+		{}
+
+		int            fd;
+		LLZXConnection protocol;
+		bool           readable = false;   // 边缘触发：收到EPOLLIN后一直读到EAGAIN才清除
+		bool           writable = true;
+		bool           peerClosed = false;
+	};
+
+	void acceptAll()
+	{
+		for (;;)
+		{
+			int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0)
+			{
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				return; // EAGAIN，或者文件描述符耗尽，等下一次就绪再试
+			}
+			int one = 1;
+			::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+			auto conn = std::make_unique<Conn>(fd, store_, options_);
+			epoll_event event{};
+			event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+			event.data.ptr = conn.get();
+			if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0)
+			{
+				::close(fd);
+				continue;
+			}
+			connections_.emplace(conn.get(), std::move(conn));
+		}
+	}
+
+	// 交替发送、解析和读取，直到三者都无法推进：
+	//   发送缓冲区满时等EPOLLOUT，响应积压超过上限时不再读取，输入读完时等下一次EPOLLIN
+	void service(Conn& conn)
+	{
+		for (;;)
+		{
+			bool progress = false;
+			LLZXOutputQueue& output = conn.protocol.output();
+			if (!output.empty() && conn.writable)
+			{
+				long sent = output.flush(conn.fd);
+				if (sent < 0)
+				{
+					if (!wouldBlock(errno) && errno != EINTR)
+					{
+						close(conn);
+						return;
+					}
+					conn.writable = errno == EINTR;
+				}
+				progress |= sent > 0;
+			}
+
+			progress |= conn.protocol.consume();
+
+			if (conn.protocol.closing() || conn.peerClosed)
+			{
+				if (output.empty())
+				{
+					close(conn);
+					return;
+				}
+				if (!conn.writable)
+					return;
+				continue;
+			}
+
+			if (conn.readable && !conn.protocol.blocked())
+			{
+				char* space = conn.protocol.inputSpace(kReadSize);
+				ssize_t n = ::recv(conn.fd, space, kReadSize, 0);
+				if (n > 0)
+				{
+					conn.protocol.commit(static_cast<size_t>(n));
+					progress = true;
+				}
+				else if (n == 0)
+				{
+					conn.peerClosed = true;
+					conn.readable = false;
+					progress = true;
+				}
+				else if (wouldBlock(errno))
+					conn.readable = false;
+				else if (errno != EINTR)
+				{
+					close(conn);
+					return;
+				}
+			}
+
+			if (!progress)
+				return;
+		}
+	}
+
+	void close(Conn& conn)
+	{
+		// 关闭描述符会自动从epoll中移除；未发送完的响应随连接一起释放，对元素的引用也随之释放
+		::close(conn.fd);
+		connections_.erase(&conn);
+	}
+
+private:
+	LLZXItemStore&           store_;
+	const LLZXServerOptions& options_;
+	int                      listenFd_;
+	int                      epollFd_ = -1;
+	char                     listenTag_ = 0; // 监听套接字和停止信号在epoll中的标记，只取地址
+	char                     stopTag_ = 0;
+	std::unordered_map<Conn*, std::unique_ptr<Conn>> connections_;
+};
+
+LLZXCacheServer::LLZXCacheServer(const LLZXServerOptions& options)
+	: options_(options)
+	, store_(options.maxBytes, options.sliceNum, options.readMode)
+{
+	if (options_.reactorNum == 0)
+		options_.reactorNum = std::max(1u, std::thread::hardware_concurrency());
+}
+
+LLZXCacheServer::~LLZXCacheServer()
+{
+	stop();
+}
+
+void LLZXCacheServer::start()
+{
+	if (listenFd_ >= 0)
+		return;
+	try
+	{
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(options_.port);
+		if (::inet_pton(AF_INET, options_.host.c_str(), &address.sin_addr) != 1)
+			throw std::system_error(EINVAL, std::generic_category(), "bad listen address " + options_.host);
+
+		listenFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (listenFd_ < 0)
+			throwErrno("socket");
+		int one = 1;
+		::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+		if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+			throwErrno("bind");
+		if (::listen(listenFd_, options_.backlog) < 0)
+			throwErrno("listen");
+		socklen_t length = sizeof(address);
+		if (::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&address), &length) < 0)
+			throwErrno("getsockname");
+		port_ = ntohs(address.sin_port);
+
+		stopFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (stopFd_ < 0)
+			throwErrno("eventfd");
+
+		for (size_t i = 0; i < options_.reactorNum; ++i)
+			reactors_.push_back(std::make_unique<Reactor>(store_, options_, listenFd_, stopFd_));
+		for (auto& reactor : reactors_)
+			threads_.emplace_back([&reactor] { reactor->run(); });
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+}
+
+void LLZXCacheServer::stop()
+{
+	if (!threads_.empty())
+	{
+		uint64_t one = 1;
+		ssize_t written = ::write(stopFd_, &one, sizeof(one));
+		(void)written;
+		for (auto& thread : threads_)
+			thread.join();
+		threads_.clear();
+	}
+	reactors_.clear();
+	if (stopFd_ >= 0)
+		::close(stopFd_);
+	if (listenFd_ >= 0)
+		::close(listenFd_);
+	stopFd_ = listenFd_ = -1;
+}
+
+} // namespace LLZXNet
@@ -0,0 +1,753 @@
+#include "LLZXConnection.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace LLZXNet
+{
+
+namespace
+{
+
+constexpr std::string_view kServerVersion = "1.0.0";
+constexpr size_t kMaxKeyLength = 250;
+// 文本协议一行的上限（get可以带很多个key），超过时认为客户端出错并关闭连接
+constexpr size_t kMaxLineLength = 64 * 1024;
+constexpr size_t kInitialInput = 16 * 1024;
+// 空闲连接的输入缓冲区超过这个大小时收缩，收过大value的连接不会一直占着内存
+constexpr size_t kMaxIdleInput = 256 * 1024;
+
+// 二进制协议的头部和操作码（memcached binary protocol）
+constexpr size_t kBinaryHeader = 24;
+constexpr uint8_t kRequestMagic = 0x80;
+constexpr uint8_t kResponseMagic = 0x81;
+
+enum BinaryOpcode : uint8_t
+{
+	kGet = 0x00,
+	kSet = 0x01,
+	kAdd = 0x02,
+	kReplace = 0x03,
+	kDelete = 0x04,
+	kIncrement = 0x05,
+	kDecrement = 0x06,
+	kQuit = 0x07,
+	kFlush = 0x08,
+	kGetQ = 0x09,
+	kNoop = 0x0a,
+	kVersion = 0x0b,
+	kGetK = 0x0c,
+	kGetKQ = 0x0d,
+	kAppend = 0x0e,
+	kPrepend = 0x0f,
+	kSetQ = 0x11,
+	kAddQ = 0x12,
+	kReplaceQ = 0x13,
+	kDeleteQ = 0x14,
+	kIncrementQ = 0x15,
+	kDecrementQ = 0x16,
+	kQuitQ = 0x17,
+	kFlushQ = 0x18,
+	kAppendQ = 0x19,
+	kPrependQ = 0x1a,
+	kTouch = 0x1c,
+};
+
+enum BinaryStatus : uint16_t
+{
+	kOk = 0x00,
+	kKeyNotFound = 0x01,
+	kKeyExists = 0x02,
+	kValueTooLarge = 0x03,
+	kInvalidArguments = 0x04,
+	kItemNotStored = 0x05,
+	kNonNumeric = 0x06,
+	kUnknownCommand = 0x81,
+};
+
+uint16_t load16(const char* p)
+{
+	auto u = reinterpret_cast<const unsigned char*>(p);
+	return static_cast<uint16_t>(u[0] << 8 | u[1]);
+}
+
+uint32_t load32(const char* p)
+{
+	auto u = reinterpret_cast<const unsigned char*>(p);
+	return uint32_t(u[0]) << 24 | uint32_t(u[1]) << 16 | uint32_t(u[2]) << 8 | uint32_t(u[3]);
+}
+
+uint64_t load64(const char* p)
+{
+	return uint64_t(load32(p)) << 32 | load32(p + 4);
+}
+
+void store16(char* p, uint16_t v)
+{
+	p[0] = static_cast<char>(v >> 8);
+	p[1] = static_cast<char>(v);
+}
+
+void store32(char* p, uint32_t v)
+{
+	store16(p, static_cast<uint16_t>(v >> 16));
+	store16(p + 2, static_cast<uint16_t>(v));
+}
+
+void store64(char* p, uint64_t v)
+{
+	store32(p, static_cast<uint32_t>(v >> 32));
+	store32(p + 4, static_cast<uint32_t>(v));
+}
+
+template<typename T>
+bool parseNumber(std::string_view text, T& value)
+{
+	auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+	return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+void splitTokens(std::string_view line, std::vector<std::string_view>& tokens)
+{
+	tokens.clear();
+	size_t pos = 0;
+	while (pos < line.size())
+	{
+		while (pos < line.size() && line[pos] == ' ')
+			++pos;
+		size_t start = pos;
+		while (pos < line.size() && line[pos] != ' ')
+			++pos;
+		if (pos > start)
+			tokens.push_back(line.substr(start, pos - start));
+	}
+}
+
+// 文本协议的存储类命令
+bool storeModeOf(std::string_view command, LLZXStoreMode& mode)
+{
+	if (command == "set") mode = LLZXStoreMode::Set;
+	else if (command == "add") mode = LLZXStoreMode::Add;
+	else if (command == "replace") mode = LLZXStoreMode::Replace;
+	else if (command == "append") mode = LLZXStoreMode::Append;
+	else if (command == "prepend") mode = LLZXStoreMode::Prepend;
+	else if (command == "cas") mode = LLZXStoreMode::Cas;
+	else return false;
+	return true;
+}
+
+// 二进制协议的存储类命令，quiet为true时成功不回复
+bool binaryStoreModeOf(uint8_t opcode, LLZXStoreMode& mode, bool& quiet)
+{
+	quiet = false;
+	switch (opcode)
+	{
+	case kSetQ: quiet = true; [[fallthrough]];
+	case kSet: mode = LLZXStoreMode::Set; return true;
+	case kAddQ: quiet = true; [[fallthrough]];
+	case kAdd: mode = LLZXStoreMode::Add; return true;
+	case kReplaceQ: quiet = true; [[fallthrough]];
+	case kReplace: mode = LLZXStoreMode::Replace; return true;
+	case kAppendQ: quiet = true; [[fallthrough]];
+	case kAppend: mode = LLZXStoreMode::Append; return true;
+	case kPrependQ: quiet = true; [[fallthrough]];
+	case kPrepend: mode = LLZXStoreMode::Prepend; return true;
+	default: return false;
+	}
+}
+
+} // namespace
+
+void LLZXOutputQueue::append(const char* data, size_t size)
+{
+	if (size == 0)
+		return;
+	if (chunks_.empty() || chunks_.back().item || chunks_.back().bytes.size() + size > kChunkBytes)
+	{
+		chunks_.emplace_back();
+		chunks_.back().bytes.reserve(std::max(size, kChunkBytes / 4));
+	}
+	chunks_.back().bytes.append(data, size);
+	pending_ += size;
+}
+
+void LLZXOutputQueue::appendValue(const LLZXItemPtr& item)
+{
+	const std::string& data = item->data;
+	if (data.size() < kZeroCopyThreshold)
+	{
+		append(data.data(), data.size());
+		return;
+	}
+	chunks_.emplace_back();
+	chunks_.back().item = item;
+	pending_ += data.size();
+}
+
+long LLZXOutputQueue::flush(int fd)
+{
+	iovec iov[kMaxIov];
+	size_t count = 0;
+	for (auto it = chunks_.begin(); it != chunks_.end() && count < kMaxIov; ++it, ++count)
+	{
+		size_t skip = count == 0 ? offset_ : 0;
+		iov[count].iov_base = const_cast<char*>(it->data() + skip);
+		iov[count].iov_len = it->size() - skip;
+	}
+	if (count == 0)
+		return 0;
+
+	msghdr message{};
+	message.msg_iov = iov;
+	message.msg_iovlen = count;
+	ssize_t sent = ::sendmsg(fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (sent < 0)
+		return -1;
+
+	size_t remaining = static_cast<size_t>(sent);
+	pending_ -= remaining;
+	while (remaining > 0)
+	{
+		size_t left = chunks_.front().size() - offset_;
+		if (remaining < left)
+		{
+			offset_ += remaining;
+			break;
+		}
+		remaining -= left;
+		chunks_.pop_front();
+		offset_ = 0;
+	}
+	return static_cast<long>(sent);
+}
+
+LLZXConnection::LLZXConnection(LLZXItemStore& store, size_t maxValueSize, size_t maxOutputPending)
+	: store_(store)
+	, maxValueSize_(maxValueSize)
+	, maxOutputPending_(maxOutputPending)
+{}
+
+char* LLZXConnection::inputSpace(size_t minSpace)
+{
+	if (input_.size() - inputEnd_ < minSpace)
+	{
+		// 先把未处理的数据挪到开头，仍然不够再扩容
+		if (inputBegin_ > 0)
+		{
+			std::memmove(input_.data(), input_.data() + inputBegin_, inputEnd_ - inputBegin_);
+			inputEnd_ -= inputBegin_;
+			inputBegin_ = 0;
+		}
+		if (input_.size() - inputEnd_ < minSpace)
+			input_.resize(std::max({input_.size() * 2, inputEnd_ + minSpace, kInitialInput}));
+	}
+	return input_.data() + inputEnd_;
+}
+
+bool LLZXConnection::consume()
+{
+	bool consumed = false;
+	while (!closing_ && !blocked() && inputBegin_ < inputEnd_)
+	{
+		const char* begin = input_.data() + inputBegin_;
+		const char* end = input_.data() + inputEnd_;
+		size_t n = 0;
+		if (swallow_ > 0)
+		{
+			n = std::min(swallow_, static_cast<size_t>(end - begin));
+			swallow_ -= n;
+		}
+		else
+		{
+			if (protocol_ == Protocol::Unknown)
+				protocol_ = static_cast<uint8_t>(*begin) == kRequestMagic ? Protocol::Binary : Protocol::Text;
+			n = protocol_ == Protocol::Binary ? consumeBinary(begin, end) : consumeText(begin, end);
+		}
+		if (n == 0)
+			break;
+		inputBegin_ += n;
+		consumed = true;
+	}
+
+	if (inputBegin_ == inputEnd_)
+	{
+		inputBegin_ = inputEnd_ = 0;
+		if (input_.size() > kMaxIdleInput)
+		{
+			input_.resize(kInitialInput);
+			input_.shrink_to_fit();
+		}
+	}
+	return consumed;
+}
+
+size_t LLZXConnection::consumeText(const char* begin, const char* end)
+{
+	const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+	if (!newline)
+	{
+		if (static_cast<size_t>(end - begin) > kMaxLineLength)
+		{
+			output_.append("CLIENT_ERROR line too long\r\n");
+			closing_ = true;
+		}
+		return 0;
+	}
+
+	size_t lineBytes = static_cast<size_t>(newline - begin) + 1;
+	std::string_view line(begin, lineBytes - 1);
+	if (!line.empty() && line.back() == '\r')
+		line.remove_suffix(1);
+	splitTokens(line, tokens_);
+	if (tokens_.empty())
+	{
+		output_.append("ERROR\r\n");
+		return lineBytes;
+	}
+
+	std::string_view command = tokens_[0];
+	LLZXStoreMode mode = LLZXStoreMode::Set;
+	if (command == "get" || command == "gets")
+		textGet(tokens_, command == "gets");
+	else if (storeModeOf(command, mode))
+	{
+		size_t data = textStore(tokens_, newline + 1, end);
+		if (data == SIZE_MAX)
+			return 0;
+		return lineBytes + data;
+	}
+	else if (command == "delete")
+		textDelete(tokens_);
+	else if (command == "incr" || command == "decr")
+		textDelta(tokens_, command == "incr");
+	else if (command == "touch")
+		textTouch(tokens_);
+	else if (command == "flush_all")
+		textFlush(tokens_);
+	else if (command == "stats")
+		textStats();
+	else if (command == "version")
+	{
+		output_.append("VERSION ");
+		output_.append(kServerVersion);
+		output_.append("\r\n");
+	}
+	else if (command == "verbosity")
+		reply("OK", tokens_.back() == "noreply");
+	else if (command == "quit")
+		closing_ = true;
+	else
+		output_.append("ERROR\r\n");
+	return lineBytes;
+}
+
+void LLZXConnection::reply(std::string_view line, bool noreply)
+{
+	if (noreply)
+		return;
+	output_.append(line);
+	output_.append("\r\n");
+}
+
+void LLZXConnection::appendNumber(char separator, uint64_t value)
+{
+	char number[24];
+	number[0] = separator;
+	char* end = std::to_chars(number + 1, number + sizeof(number), value).ptr;
+	output_.append(number, static_cast<size_t>(end - number));
+}
+
+void LLZXConnection::textGet(const std::vector<std::string_view>& tokens, bool withCas)
+{
+	if (tokens.size() < 2)
+	{
+		output_.append("ERROR\r\n");
+		return;
+	}
+	for (size_t i = 1; i < tokens.size(); ++i)
+	{
+		std::string_view key = tokens[i];
+		if (key.size() > kMaxKeyLength)
+		{
+			output_.append("CLIENT_ERROR bad command line format\r\n");
+			return;
+		}
+		LLZXItemPtr item = store_.get(key);
+		if (!item)
+			continue;
+
+		// VALUE <key> <flags> <bytes> [<cas>]\r\n<data>\r\n，各段直接追加到发送缓冲区的同一块中
+		output_.append("VALUE ");
+		output_.append(key);
+		appendNumber(' ', item->flags);
+		appendNumber(' ', item->data.size());
+		if (withCas)
+			appendNumber(' ', item->cas);
+		output_.append("\r\n");
+		output_.appendValue(item);
+		output_.append("\r\n");
+	}
+	output_.append("END\r\n");
+}
+
+// 返回命令行之后消费的数据字节数，数据还没有收全时返回SIZE_MAX
+size_t LLZXConnection::textStore(const std::vector<std::string_view>& tokens, const char* data, const char* end)
+{
+	LLZXStoreMode mode = LLZXStoreMode::Set;
+	storeModeOf(tokens[0], mode);
+	size_t fields = mode == LLZXStoreMode::Cas ? 6 : 5;
+	bool noreply = tokens.size() == fields + 1 && tokens.back() == "noreply";
+
+	uint32_t flags = 0;
+	int64_t exptime = 0;
+	size_t bytes = 0;
+	uint64_t cas = 0;
+	if ((tokens.size() != fields && !noreply) || tokens[1].size() > kMaxKeyLength
+		|| !parseNumber(tokens[2], flags) || !parseNumber(tokens[3], exptime) || !parseNumber(tokens[4], bytes)
+		|| (mode == LLZXStoreMode::Cas && !parseNumber(tokens[5], cas)))
+	{
+		// 数据块的长度未知，无法跳过，按memcached的做法把之后的内容当作新的命令
+		output_.append("CLIENT_ERROR bad command line format\r\n");
+		return 0;
+	}
+
+	if (bytes > maxValueSize_ || bytes > store_.maxValueSize(tokens[1].size()))
+	{
+		output_.append("SERVER_ERROR object too large for cache\r\n");
+		swallow_ = bytes + 2;
+		return 0;
+	}
+	if (static_cast<size_t>(end - data) < bytes + 2)
+		return SIZE_MAX;
+	if (data[bytes] != '\r' || data[bytes + 1] != '\n')
+	{
+		output_.append("CLIENT_ERROR bad data chunk\r\n");
+		return bytes + 2;
+	}
+
+	LLZXStoreResult result = store_.store(mode, tokens[1], flags, exptime, std::string(data, bytes), cas);
+	switch (result)
+	{
+	case LLZXStoreResult::Stored: reply("STORED", noreply); break;
+	case LLZXStoreResult::NotStored: reply("NOT_STORED", noreply); break;
+	case LLZXStoreResult::Exists: reply("EXISTS", noreply); break;
+	case LLZXStoreResult::NotFound: reply("NOT_FOUND", noreply); break;
+	}
+	return bytes + 2;
+}
+
+void LLZXConnection::textDelete(const std::vector<std::string_view>& tokens)
+{
+	bool noreply = tokens.back() == "noreply";
+	if (tokens.size() < 2 || tokens.size() > (noreply ? 4u : 3u) || tokens[1].size() > kMaxKeyLength)
+	{
+		output_.append("CLIENT_ERROR bad command line format\r\n");
+		return;
+	}
+	reply(store_.remove(tokens[1]) ? "DELETED" : "NOT_FOUND", noreply);
+}
+
+void LLZXConnection::textDelta(const std::vector<std::string_view>& tokens, bool incr)
+{
+	bool noreply = tokens.size() == 4 && tokens.back() == "noreply";
+	uint64_t amount = 0;
+	if ((tokens.size() != 3 && !noreply) || tokens[1].size() > kMaxKeyLength)
+	{
+		output_.append("ERROR\r\n");
+		return;
+	}
+	if (!parseNumber(tokens[2], amount))
+	{
+		output_.append("CLIENT_ERROR invalid numeric delta argument\r\n");
+		return;
+	}
+
+	uint64_t value = 0;
+	switch (store_.delta(tokens[1], incr, amount, value))
+	{
+	case LLZXDeltaResult::Ok:
+		if (!noreply)
+		{
+			char number[24];
+			char* end = std::to_chars(number, number + sizeof(number), value).ptr;
+			output_.append(number, static_cast<size_t>(end - number));
+			output_.append("\r\n");
+		}
+		break;
+	case LLZXDeltaResult::NotFound:
+		reply("NOT_FOUND", noreply);
+		break;
+	case LLZXDeltaResult::NonNumeric:
+		output_.append("CLIENT_ERROR cannot increment or decrement non-numeric value\r\n");
+		break;
+	}
+}
+
+void LLZXConnection::textTouch(const std::vector<std::string_view>& tokens)
+{
+	bool noreply = tokens.size() == 4 && tokens.back() == "noreply";
+	int64_t exptime = 0;
+	if ((tokens.size() != 3 && !noreply) || tokens[1].size() > kMaxKeyLength || !parseNumber(tokens[2], exptime))
+	{
+		output_.append("CLIENT_ERROR bad command line format\r\n");
+		return;
+	}
+	reply(store_.touch(tokens[1], exptime) ? "TOUCHED" : "NOT_FOUND", noreply);
+}
+
+void LLZXConnection::textFlush(const std::vector<std::string_view>& tokens)
+{
+	bool noreply = tokens.back() == "noreply";
+	int64_t delay = 0;
+	size_t args = tokens.size() - 1 - noreply;
+	if (args > 1 || (args == 1 && !parseNumber(tokens[1], delay)))
+	{
+		output_.append("CLIENT_ERROR bad command line format\r\n");
+		return;
+	}
+	store_.flushAll(delay);
+	reply("OK", noreply);
+}
+
+void LLZXConnection::textStats()
+{
+	LLZXStoreStats stats = store_.stats();
+	std::string text;
+	auto stat = [&text](const char* name, uint64_t value) {
+		text += "STAT ";
+		text += name;
+		text += ' ';
+		text += std::to_string(value);
+		text += "\r\n";
+	};
+	stat("pid", static_cast<uint64_t>(::getpid()));
+	stat("curr_items", stats.currItems);
+	stat("cmd_get", stats.getHits + stats.getMisses);
+	stat("cmd_set", stats.sets);
+	stat("get_hits", stats.getHits);
+	stat("get_misses", stats.getMisses);
+	stat("delete_hits", stats.deletes);
+	stat("limit_maxbytes", stats.limitBytes);
+	text += "STAT version ";
+	text += kServerVersion;
+	text += "\r\nEND\r\n";
+	output_.append(text);
+}
+
+void LLZXConnection::binaryReply(uint8_t opcode, uint16_t status, uint32_t opaque, uint64_t cas,
+	std::string_view extras, std::string_view key, std::string_view value, const LLZXItemPtr& item)
+{
+	size_t valueSize = item ? item->data.size() : value.size();
+	char header[kBinaryHeader];
+	header[0] = static_cast<char>(kResponseMagic);
+	header[1] = static_cast<char>(opcode);
+	store16(header + 2, static_cast<uint16_t>(key.size()));
+	header[4] = static_cast<char>(extras.size());
+	header[5] = 0;
+	store16(header + 6, status);
+	store32(header + 8, static_cast<uint32_t>(extras.size() + key.size() + valueSize));
+	std::memcpy(header + 12, &opaque, 4); // opaque原样返回，不做字节序转换
+	store64(header + 16, cas);
+	output_.append(header, kBinaryHeader);
+	output_.append(extras);
+	output_.append(key);
+	if (item)
+		output_.appendValue(item);
+	else
+		output_.append(value);
+}
+
+void LLZXConnection::binaryError(uint8_t opcode, uint16_t status, uint32_t opaque)
+{
+	std::string_view message;
+	switch (status)
+	{
+	case kKeyNotFound: message = "Not found"; break;
+	case kKeyExists: message = "Data exists for key"; break;
+	case kValueTooLarge: message = "Too large"; break;
+	case kInvalidArguments: message = "Invalid arguments"; break;
+	case kItemNotStored: message = "Not stored"; break;
+	case kNonNumeric: message = "Non-numeric server-side value for incr or decr"; break;
+	default: message = "Unknown command"; break;
+	}
+	binaryReply(opcode, status, opaque, 0, {}, {}, message);
+}
+
+size_t LLZXConnection::consumeBinary(const char* begin, const char* end)
+{
+	if (static_cast<size_t>(end - begin) < kBinaryHeader)
+		return 0;
+	if (static_cast<uint8_t>(begin[0]) != kRequestMagic)
+	{
+		// 二进制连接上出现了错误的魔数，无法再定位请求边界
+		closing_ = true;
+		return 0;
+	}
+
+	uint8_t opcode = static_cast<uint8_t>(begin[1]);
+	size_t keyLength = load16(begin + 2);
+	size_t extrasLength = static_cast<uint8_t>(begin[4]);
+	size_t bodyLength = load32(begin + 8);
+	uint32_t opaque;
+	std::memcpy(&opaque, begin + 12, 4);
+	uint64_t cas = load64(begin + 16);
+
+	if (keyLength + extrasLength > bodyLength || keyLength > kMaxKeyLength)
+	{
+		binaryError(opcode, kInvalidArguments, opaque);
+		swallow_ = bodyLength;
+		return kBinaryHeader;
+	}
+	size_t valueLength = bodyLength - keyLength - extrasLength;
+	if (valueLength > maxValueSize_ || valueLength > store_.maxValueSize(keyLength))
+	{
+		binaryError(opcode, kValueTooLarge, opaque);
+		swallow_ = bodyLength;
+		return kBinaryHeader;
+	}
+	if (static_cast<size_t>(end - begin) < kBinaryHeader + bodyLength)
+		return 0;
+
+	const char* extras = begin + kBinaryHeader;
+	std::string_view key(extras + extrasLength, keyLength);
+	std::string_view value(key.data() + keyLength, valueLength);
+	size_t consumed = kBinaryHeader + bodyLength;
+
+	LLZXStoreMode mode = LLZXStoreMode::Set;
+	bool quiet = false;
+	switch (opcode)
+	{
+	case kGet:
+	case kGetQ:
+	case kGetK:
+	case kGetKQ:
+	{
+		bool withKey = opcode == kGetK || opcode == kGetKQ;
+		quiet = opcode == kGetQ || opcode == kGetKQ;
+		LLZXItemPtr item = store_.get(key);
+		if (!item)
+		{
+			// quiet的get未命中时不回复；GETK的未命中响应带上key
+			if (!quiet)
+				binaryReply(opcode, kKeyNotFound, opaque, 0, {}, withKey ? key : std::string_view(), "Not found");
+			break;
+		}
+		char flags[4];
+		store32(flags, item->flags);
+		binaryReply(opcode, kOk, opaque, item->cas, std::string_view(flags, 4), withKey ? key : std::string_view(), {}, item);
+		break;
+	}
+	case kDelete:
+	case kDeleteQ:
+		if (store_.remove(key))
+		{
+			if (opcode == kDelete)
+				binaryReply(opcode, kOk, opaque, 0, {}, {}, {});
+		}
+		else
+			binaryError(opcode, kKeyNotFound, opaque);
+		break;
+	case kIncrement:
+	case kIncrementQ:
+	case kDecrement:
+	case kDecrementQ:
+	{
+		if (extrasLength != 20)
+		{
+			binaryError(opcode, kInvalidArguments, opaque);
+			break;
+		}
+		uint64_t amount = load64(extras), initial = load64(extras + 8);
+		uint32_t exptime = load32(extras + 16);
+		uint64_t result = 0, newCas = 0;
+		bool incr = opcode == kIncrement || opcode == kIncrementQ;
+		// exptime为0xffffffff时key不存在不创建
+		LLZXDeltaResult status = store_.delta(key, incr, amount, result, exptime != 0xffffffffu, initial,
+			static_cast<int64_t>(exptime), &newCas);
+		if (status == LLZXDeltaResult::NotFound)
+			binaryError(opcode, kKeyNotFound, opaque);
+		else if (status == LLZXDeltaResult::NonNumeric)
+			binaryError(opcode, kNonNumeric, opaque);
+		else if (opcode == kIncrement || opcode == kDecrement)
+		{
+			char number[8];
+			store64(number, result);
+			binaryReply(opcode, kOk, opaque, newCas, {}, {}, std::string_view(number, 8));
+		}
+		break;
+	}
+	case kQuit:
+	case kQuitQ:
+		if (opcode == kQuit)
+			binaryReply(opcode, kOk, opaque, 0, {}, {}, {});
+		closing_ = true;
+		break;
+	case kFlush:
+	case kFlushQ:
+		store_.flushAll(extrasLength == 4 ? static_cast<int64_t>(load32(extras)) : 0);
+		if (opcode == kFlush)
+			binaryReply(opcode, kOk, opaque, 0, {}, {}, {});
+		break;
+	case kNoop:
+		binaryReply(opcode, kOk, opaque, 0, {}, {}, {});
+		break;
+	case kVersion:
+		binaryReply(opcode, kOk, opaque, 0, {}, {}, kServerVersion);
+		break;
+	case kTouch:
+		if (extrasLength != 4)
+			binaryError(opcode, kInvalidArguments, opaque);
+		else if (store_.touch(key, static_cast<int64_t>(load32(extras))))
+			binaryReply(opcode, kOk, opaque, 0, {}, {}, {});
+		else
+			binaryError(opcode, kKeyNotFound, opaque);
+		break;
+	default:
+	{
+		if (!binaryStoreModeOf(opcode, mode, quiet))
+		{
+			binaryError(opcode, kUnknownCommand, opaque);
+			break;
+		}
+		// set/add/replace带8字节extras（flags、exptime），append/prepend没有extras
+		bool concat = mode == LLZXStoreMode::Append || mode == LLZXStoreMode::Prepend;
+		if (extrasLength != (concat ? 0u : 8u) || keyLength == 0)
+		{
+			binaryError(opcode, kInvalidArguments, opaque);
+			break;
+		}
+		uint32_t flags = concat ? 0 : load32(extras);
+		int64_t exptime = concat ? 0 : static_cast<int64_t>(load32(extras + 4));
+		// 请求带cas时set和replace按cas的语义执行
+		if (cas != 0 && (mode == LLZXStoreMode::Set || mode == LLZXStoreMode::Replace))
+			mode = LLZXStoreMode::Cas;
+
+		uint64_t newCas = 0;
+		LLZXStoreResult result = store_.store(mode, key, flags, exptime, std::string(value), cas, &newCas);
+		if (result == LLZXStoreResult::Stored)
+		{
+			if (!quiet)
+				binaryReply(opcode, kOk, opaque, newCas, {}, {}, {});
+		}
+		else if (result == LLZXStoreResult::Exists)
+			binaryError(opcode, kKeyExists, opaque);
+		else if (result == LLZXStoreResult::NotFound)
+			binaryError(opcode, kKeyNotFound, opaque);
+		else if (mode == LLZXStoreMode::Add)
+			binaryError(opcode, kKeyExists, opaque);
+		else if (mode == LLZXStoreMode::Replace)
+			binaryError(opcode, kKeyNotFound, opaque);
+		else
+			binaryError(opcode, kItemNotStored, opaque);
+		break;
+	}
+	}
+	return consumed;
+}
+
+} // namespace LLZXNet
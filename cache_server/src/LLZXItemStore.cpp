@@ -0,0 +1,287 @@
+#include "LLZXItemStore.h"
+
+#include <algorithm>
+#include <ctime>
+#include <limits>
+#include <optional>
+
+namespace LLZXNet
+{
+
+namespace
+{
+
+// memcached的约定：超过30天的exptime是unix时间戳
+constexpr int64_t kRelativeLimit = 60 * 60 * 24 * 30;
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+// now之后seconds秒的时刻，超出int64_t范围时返回std::nullopt
+std::optional<int64_t> nanosAfter(int64_t now, int64_t seconds)
+{
+	if (seconds > (std::numeric_limits<int64_t>::max() - now) / kNanosPerSecond)
+		return std::nullopt;
+	return now + seconds * kNanosPerSecond;
+}
+
+// 十进制无符号64位整数，不允许空串、符号和溢出
+bool parseCounter(const std::string& data, uint64_t& value)
+{
+	if (data.empty() || data.size() > 20)
+		return false;
+	uint64_t result = 0;
+	for (char c : data)
+	{
+		if (c < '0' || c > '9')
+			return false;
+		uint64_t digit = static_cast<uint64_t>(c - '0');
+		if (result > (UINT64_MAX - digit) / 10)
+			return false;
+		result = result * 10 + digit;
+	}
+	value = result;
+	return true;
+}
+
+} // namespace
+
+LLZXItemStore::LLZXItemStore(size_t maxBytes, size_t sliceNum, LLZXCache::LLZXReadMode readMode)
+	: cache_(maxBytes,
+		[](const std::string& key, const LLZXItemPtr& item) { return key.size() + item->data.size() + kItemOverhead; },
+		sliceNum, readMode)
+	, maxBytes_(maxBytes)
+{}
+
+int64_t LLZXItemStore::nowNanos()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+bool LLZXItemStore::deadlineOf(int64_t exptime, int64_t& deadline)
+{
+	if (exptime == 0)
+	{
+		deadline = 0;
+		return true;
+	}
+	if (exptime < 0)
+		return false;
+	// 绝对时间换算成相对秒数，再统一落到steady_clock上，不受系统时间调整的影响
+	int64_t seconds = exptime;
+	if (exptime > kRelativeLimit)
+	{
+		seconds = exptime - static_cast<int64_t>(std::time(nullptr));
+		if (seconds <= 0)
+			return false;
+	}
+	// 远到无法表示的过期时刻按永不过期处理
+	deadline = nanosAfter(nowNanos(), seconds).value_or(0);
+	return true;
+}
+
+std::mutex& LLZXItemStore::lockOf(std::string_view key)
+{
+	return locks_[LLZXCache::detail::fmix64(LLZXCache::LLZXStringHash{}(key)) % kLockNum];
+}
+
+bool LLZXItemStore::flushed(const LLZXItem& item) const
+{
+	int64_t at = flushAt_.load(std::memory_order_acquire);
+	return at != 0 && item.storedAt <= at && nowNanos() >= at;
+}
+
+// 调用方持有lockOf(key)，删除失效元素时不会与同一个key上的写入交错
+LLZXItemPtr LLZXItemStore::find(std::string_view key)
+{
+	LLZXItemPtr item;
+	if (!cache_.get(key, item))
+		return nullptr;
+	if (flushed(*item))
+	{
+		cache_.remove(key);
+		return nullptr;
+	}
+	return item;
+}
+
+LLZXItemPtr LLZXItemStore::makeItem(uint32_t flags, int64_t deadline, std::string data)
+{
+	auto item = std::make_shared<LLZXItem>();
+	item->flags = flags;
+	item->cas = nextCas_.fetch_add(1, std::memory_order_relaxed) + 1;
+	item->storedAt = nowNanos();
+	item->deadline = deadline;
+	item->data = std::move(data);
+	return item;
+}
+
+void LLZXItemStore::put(std::string_view key, LLZXItemPtr item)
+{
+	auto ttl = LLZXCache::LLZXExpiry::kNever;
+	if (item->deadline != 0)
+	{
+		int64_t remaining = item->deadline - nowNanos();
+		if (remaining <= 0)
+		{
+			cache_.remove(key);
+			return;
+		}
+		ttl = std::chrono::duration_cast<LLZXCache::LLZXExpiry::Duration>(std::chrono::nanoseconds(remaining));
+	}
+	sets_.fetch_add(1, std::memory_order_relaxed);
+	cache_.put(std::string(key), item, ttl);
+}
+
+LLZXItemPtr LLZXItemStore::get(std::string_view key)
+{
+	LLZXItemPtr item;
+	if (cache_.get(key, item) && flushed(*item))
+	{
+		// 读路径不持有key的锁：加锁后确认缓存中仍是这个元素才删除，不会误删并发写入的新元素
+		std::lock_guard lock(lockOf(key));
+		LLZXItemPtr current;
+		if (cache_.get(key, current) && current == item)
+			cache_.remove(key);
+		item.reset();
+	}
+	(item ? getHits_ : getMisses_).fetch_add(1, std::memory_order_relaxed);
+	return item;
+}
+
+LLZXStoreResult LLZXItemStore::store(LLZXStoreMode mode, std::string_view key, uint32_t flags, int64_t exptime,
+	std::string data, uint64_t cas, uint64_t* newCas)
+{
+	std::lock_guard lock(lockOf(key));
+	LLZXItemPtr current;
+	if (mode != LLZXStoreMode::Set)
+		current = find(key);
+
+	int64_t deadline = 0;
+	switch (mode)
+	{
+	case LLZXStoreMode::Set:
+		break;
+	case LLZXStoreMode::Add:
+		if (current)
+			return LLZXStoreResult::NotStored;
+		break;
+	case LLZXStoreMode::Replace:
+		if (!current)
+			return LLZXStoreResult::NotStored;
+		break;
+	case LLZXStoreMode::Cas:
+		if (!current)
+			return LLZXStoreResult::NotFound;
+		if (current->cas != cas)
+			return LLZXStoreResult::Exists;
+		break;
+	case LLZXStoreMode::Append:
+	case LLZXStoreMode::Prepend:
+		// 拼接沿用原元素的flags和过期时间，忽略请求中的值
+		if (!current)
+			return LLZXStoreResult::NotStored;
+		data = mode == LLZXStoreMode::Append ? current->data + data : data + current->data;
+		flags = current->flags;
+		deadline = current->deadline;
+		break;
+	}
+
+	if (mode != LLZXStoreMode::Append && mode != LLZXStoreMode::Prepend && !deadlineOf(exptime, deadline))
+	{
+		// 已经过期的写入等同于删除原来的值
+		cache_.remove(key);
+		return LLZXStoreResult::Stored;
+	}
+
+	LLZXItemPtr item = makeItem(flags, deadline, std::move(data));
+	if (newCas)
+		*newCas = item->cas;
+	put(key, std::move(item));
+	return LLZXStoreResult::Stored;
+}
+
+bool LLZXItemStore::remove(std::string_view key)
+{
+	std::lock_guard lock(lockOf(key));
+	if (!find(key))
+		return false;
+	cache_.remove(key);
+	deletes_.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+LLZXDeltaResult LLZXItemStore::delta(std::string_view key, bool incr, uint64_t amount, uint64_t& value,
+	bool create, uint64_t initial, int64_t exptime, uint64_t* newCas)
+{
+	std::lock_guard lock(lockOf(key));
+	LLZXItemPtr current = find(key);
+	uint32_t flags = 0;
+	int64_t deadline = 0;
+	if (!current)
+	{
+		if (!create || !deadlineOf(exptime, deadline))
+			return LLZXDeltaResult::NotFound;
+		value = initial;
+	}
+	else
+	{
+		uint64_t number = 0;
+		if (!parseCounter(current->data, number))
+			return LLZXDeltaResult::NonNumeric;
+		value = incr ? number + amount : (number > amount ? number - amount : 0);
+		flags = current->flags;
+		deadline = current->deadline;
+	}
+
+	LLZXItemPtr item = makeItem(flags, deadline, std::to_string(value));
+	if (newCas)
+		*newCas = item->cas;
+	put(key, std::move(item));
+	return LLZXDeltaResult::Ok;
+}
+
+bool LLZXItemStore::touch(std::string_view key, int64_t exptime)
+{
+	std::lock_guard lock(lockOf(key));
+	LLZXItemPtr current = find(key);
+	if (!current)
+		return false;
+	int64_t deadline = 0;
+	if (!deadlineOf(exptime, deadline))
+	{
+		cache_.remove(key);
+		return true;
+	}
+	// 副本保留原来的版本号和写入时刻
+	auto item = std::make_shared<LLZXItem>(*current);
+	item->deadline = deadline;
+	put(key, std::move(item));
+	return true;
+}
+
+void LLZXItemStore::flushAll(int64_t delay)
+{
+	int64_t now = nowNanos();
+	flushAt_.store(nanosAfter(now, std::max<int64_t>(delay, 0)).value_or(std::numeric_limits<int64_t>::max()),
+		std::memory_order_release);
+}
+
+LLZXStoreStats LLZXItemStore::stats() const
+{
+	LLZXStoreStats stats;
+	stats.getHits = getHits_.load(std::memory_order_relaxed);
+	stats.getMisses = getMisses_.load(std::memory_order_relaxed);
+	stats.sets = sets_.load(std::memory_order_relaxed);
+	stats.deletes = deletes_.load(std::memory_order_relaxed);
+	for (size_t count : cache_.sliceOccupancy())
+		stats.currItems += count;
+	stats.limitBytes = maxBytes_;
+	return stats;
+}
+
+size_t LLZXItemStore::maxValueSize(size_t keySize) const
+{
+	size_t sliceBytes = maxBytes_ / cache_.sliceNum();
+	return sliceBytes > keySize + kItemOverhead ? sliceBytes - keySize - kItemOverhead : 0;
+}
+
+} // namespace LLZXNet
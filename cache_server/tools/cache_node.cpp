@@ -0,0 +1,97 @@
+// cache_node：兼容memcached协议的缓存节点，收到SIGINT/SIGTERM后退出
+//
+// 用法：cache_node [--host=0.0.0.0] [--port=11211] [--reactors=N] [--memory=64(MB)] [--slices=16]
+//                  [--max-item-size=1048576] [--read-mode=exclusive|buffered|lockfree]
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <pthread.h>
+
+#include "LLZXCacheServer.h"
+
+using namespace LLZXNet;
+
+namespace
+{
+
+void usage()
+{
+	std::fprintf(stderr,
+		"usage: cache_node [--host=0.0.0.0] [--port=11211] [--reactors=N] [--memory=MB] [--slices=16]\n"
+		"                  [--max-item-size=BYTES] [--read-mode=exclusive|buffered|lockfree]\n");
+}
+
+LLZXServerOptions parseOptions(int argc, char** argv)
+{
+	LLZXServerOptions options;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		size_t eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+			throw std::invalid_argument("bad argument: " + arg);
+		std::string name = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+		if (name == "host") options.host = value;
+		else if (name == "port") options.port = static_cast<uint16_t>(std::stoul(value));
+		else if (name == "reactors") options.reactorNum = std::stoull(value);
+		else if (name == "memory") options.maxBytes = std::stoull(value) * 1024 * 1024;
+		else if (name == "slices") options.sliceNum = std::max<size_t>(1, std::stoull(value));
+		else if (name == "max-item-size") options.maxItemSize = std::stoull(value);
+		else if (name == "read-mode")
+		{
+			if (value == "exclusive") options.readMode = LLZXCache::LLZXReadMode::Exclusive;
+			else if (value == "buffered") options.readMode = LLZXCache::LLZXReadMode::Buffered;
+			else if (value == "lockfree") options.readMode = LLZXCache::LLZXReadMode::LockFree;
+			else throw std::invalid_argument("unknown read mode: " + value);
+		}
+		else throw std::invalid_argument("unknown option: --" + name);
+	}
+	return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	LLZXServerOptions options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_node: %s\n", error.what());
+		usage();
+		return 2;
+	}
+
+	// 先屏蔽信号再启动I/O线程，信号只由主线程的sigwait接收
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	try
+	{
+		LLZXCacheServer server(options);
+		server.start();
+		std::printf("cache_node listening on %s:%u\n", options.host.c_str(), static_cast<unsigned>(server.port()));
+		std::fflush(stdout);
+
+		int signal = 0;
+		sigwait(&signals, &signal);
+		server.stop();
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_node: %s\n", error.what());
+		return 1;
+	}
+	return 0;
+}
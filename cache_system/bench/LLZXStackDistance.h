@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace LLZXCache
+{
+namespace bench
+{
+
+// LRU栈距离（Mattson）：一次访问的栈距离是自该key上次访问以来访问过的不同key个数，
+// 容量为c的LRU命中当且仅当栈距离小于c，所以一遍扫描就能得到所有容量下的命中率
+// 实现：每个key只在其最近一次访问的时间戳上留一个标记，栈距离 = 上次访问之后的标记个数，用树状数组O(log n)求和；
+// 时间戳用完时把现存的标记按顺序重新编号，树状数组大小只与不同key个数成正比，与trace长度无关
+class LruStackDistance
+{
+public:
+	static constexpr uint64_t kInfinite = UINT64_MAX; // 第一次访问
+
+	// 栈距离不小于maxDistance的访问只计为未命中，直方图大小不超过maxDistance
+	explicit LruStackDistance(uint64_t maxDistance)
+		: maxDistance_(maxDistance)
+		, histogram_(static_cast<size_t>(maxDistance) + 1, 0)
+	{
+		tree_.assign(1024, 0);
+	}
+
+	// 访问一次key，counted为false时只更新栈（例如put）不计入直方图，返回栈距离
+	uint64_t access(uint64_t key, bool counted = true)
+	{
+		if (now_ == tree_.size())
+			compact();
+
+		uint64_t distance = kInfinite;
+		auto it = last_.find(key);
+		if (it != last_.end())
+		{
+			distance = marks_ - prefix(it->second + 1);
+			add(it->second, -1);
+			--marks_;
+			it->second = now_;
+		}
+		else
+			last_.emplace(key, now_);
+		add(now_, 1);
+		++marks_;
+		++now_;
+
+		if (counted)
+		{
+			++accesses_;
+			if (distance < maxDistance_)
+				++histogram_[static_cast<size_t>(distance)];
+		}
+		return distance;
+	}
+
+	// 容量为capacity时的命中率
+	double hitRatio(uint64_t capacity) const
+	{
+		if (accesses_ == 0)
+			return 0.0;
+		uint64_t limit = std::min(capacity, maxDistance_);
+		uint64_t hits = 0;
+		for (uint64_t d = 0; d < limit; ++d)
+			hits += histogram_[static_cast<size_t>(d)];
+		return static_cast<double>(hits) / static_cast<double>(accesses_);
+	}
+
+	// 一次计算多个容量的命中率，capacities需升序
+	// 按key空间采样时少数热点key是否被采到会造成整体偏差，expectedAccesses给出采样前访问数×采样率时，
+	// 把实际采样数与期望值之差计入距离最小的一档（SHARDS-adj），以期望值作为分母
+	std::vector<double> hitRatios(const std::vector<uint64_t>& capacities, double expectedAccesses = 0) const
+	{
+		double total = expectedAccesses > 0 ? expectedAccesses : static_cast<double>(accesses_);
+		double adjust = expectedAccesses > 0 ? expectedAccesses - static_cast<double>(accesses_) : 0.0;
+		std::vector<double> ratios;
+		uint64_t hits = 0, d = 0;
+		for (uint64_t capacity : capacities)
+		{
+			uint64_t limit = std::min(capacity, maxDistance_);
+			for (; d < limit; ++d)
+				hits += histogram_[static_cast<size_t>(d)];
+			double adjusted = static_cast<double>(hits) + (limit > 0 ? adjust : 0.0);
+			ratios.push_back(total > 0 ? std::min(1.0, std::max(0.0, adjusted / total)) : 0.0);
+		}
+		return ratios;
+	}
+
+	uint64_t accesses() const { return accesses_; }
+	uint64_t distinctKeys() const { return last_.size(); }
+
+private:
+	// 树状数组，下标从0开始
+	void add(uint64_t index, int64_t delta)
+	{
+		for (size_t i = static_cast<size_t>(index) + 1; i <= tree_.size(); i += i & (~i + 1))
+			tree_[i - 1] += delta;
+	}
+
+	// [0, end)的和
+	uint64_t prefix(uint64_t end) const
+	{
+		int64_t sum = 0;
+		for (size_t i = static_cast<size_t>(end); i > 0; i -= i & (~i + 1))
+			sum += tree_[i - 1];
+		return static_cast<uint64_t>(sum);
+	}
+
+	// 按最近访问时间顺序重新编号，空间不足一半时扩大一倍
+	void compact()
+	{
+		std::vector<std::pair<uint64_t, uint64_t>> order; // (时间戳, key)
+		order.reserve(last_.size());
+		for (const auto& entry : last_)
+			order.emplace_back(entry.second, entry.first);
+		std::sort(order.begin(), order.end());
+
+		size_t size = tree_.size();
+		while (order.size() * 2 > size)
+			size *= 2;
+
+		// 所有标记都在前order.size()个位置上，每个节点向父节点累加一次，O(n)建树
+		for (size_t i = 0; i < order.size(); ++i)
+			last_[order[i].second] = i;
+		tree_.assign(size, 0);
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (i < order.size())
+				tree_[i] += 1;
+			size_t parent = (i + 1) + ((i + 1) & (~(i + 1) + 1));
+			if (parent <= size)
+				tree_[parent - 1] += tree_[i];
+		}
+		now_ = order.size();
+		marks_ = order.size();
+	}
+
+private:
+	uint64_t                               maxDistance_;
+	std::vector<uint64_t>                  histogram_;
+	std::vector<int64_t>                   tree_;
+	std::unordered_map<uint64_t, uint64_t> last_;     // key -> 最近一次访问的时间戳
+	uint64_t                               now_ = 0;
+	uint64_t                               marks_ = 0;
+	uint64_t                               accesses_ = 0;
+};
+
+} // namespace bench
+} // namespace LLZXCache
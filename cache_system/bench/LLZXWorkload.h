@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LLZXCache
+{
+namespace bench
+{
+
+// 工作负载类型
+//   Uniform: keySpace个key均匀访问
+//   Zipf:    按Zipf分布访问，theta越大越集中（YCSB的生成方法，theta需小于1）
+//   Scan:    在Zipf访问中混入scanFraction比例的顺序扫描，扫描的key只出现一次，用来观察缓存抗扫描污染的能力
+//   Trace:   回放trace文件中的key序列
+enum class WorkloadKind
+{
+	Uniform,
+	Zipf,
+	Scan,
+	Trace,
+};
+
+struct WorkloadSpec
+{
+	WorkloadKind kind = WorkloadKind::Zipf;
+	uint64_t     keySpace = 1000000;
+	double       theta = 0.99;
+	double       scanFraction = 0.3;
+	std::string  tracePath;
+};
+
+// 可逆的64位混合函数，把排名打散成key，热点key不会集中在连续区间
+inline uint64_t scrambleKey(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+// trace文件每行一条访问，取行中最后一个字段作为key（前面可以有操作类型等字段），#开头的行忽略
+// key是十进制整数时直接使用，否则取字符串的hash
+inline std::vector<uint64_t> loadTrace(const std::string& path)
+{
+	std::ifstream in(path);
+	if (!in)
+		throw std::runtime_error("cannot open trace file: " + path);
+
+	std::vector<uint64_t> keys;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+		size_t end = line.find_last_not_of(" \t\r");
+		if (end == std::string::npos)
+			continue;
+		size_t begin = line.find_last_of(" \t", end);
+		begin = begin == std::string::npos ? 0 : begin + 1;
+		std::string token = line.substr(begin, end - begin + 1);
+
+		char* parsed = nullptr;
+		uint64_t key = std::strtoull(token.c_str(), &parsed, 10);
+		if (parsed != token.c_str() + token.size())
+			key = std::hash<std::string>()(token);
+		keys.push_back(key);
+	}
+	if (keys.empty())
+		throw std::runtime_error("trace file has no keys: " + path);
+	return keys;
+}
+
+// 预先计算好的Zipf参数，多个线程共享
+class ZipfTable
+{
+public:
+	ZipfTable(uint64_t n, double theta)
+		: n_(n > 0 ? n : 1)
+		, theta_(theta)
+	{
+		double zetan = 0;
+		for (uint64_t i = 1; i <= n_; ++i)
+			zetan += 1.0 / std::pow(static_cast<double>(i), theta_);
+		double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta_);
+		zetan_ = zetan;
+		alpha_ = 1.0 / (1.0 - theta_);
+		eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n_), 1.0 - theta_)) / (1.0 - zeta2 / zetan_);
+	}
+
+	// u为[0,1)上的均匀随机数，返回排名（0最热）
+	uint64_t rank(double u) const
+	{
+		double uz = u * zetan_;
+		if (uz < 1.0)
+			return 0;
+		if (uz < 1.0 + std::pow(0.5, theta_))
+			return 1;
+		uint64_t r = static_cast<uint64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+		return r < n_ ? r : n_ - 1;
+	}
+
+private:
+	uint64_t n_;
+	double   theta_;
+	double   zetan_;
+	double   alpha_;
+	double   eta_;
+};
+
+// 一组线程共享的工作负载数据（Zipf参数表、trace），每个线程再创建自己的KeyGenerator
+class Workload
+{
+public:
+	explicit Workload(const WorkloadSpec& spec)
+		: spec_(spec)
+	{
+		if (spec_.kind == WorkloadKind::Trace)
+			trace_ = loadTrace(spec_.tracePath);
+		else if (spec_.kind != WorkloadKind::Uniform)
+			zipf_ = std::make_shared<ZipfTable>(spec_.keySpace, spec_.theta);
+	}
+
+	const WorkloadSpec& spec() const { return spec_; }
+	const std::vector<uint64_t>& trace() const { return trace_; }
+	const ZipfTable* zipf() const { return zipf_.get(); }
+
+private:
+	WorkloadSpec               spec_;
+	std::vector<uint64_t>      trace_;
+	std::shared_ptr<ZipfTable> zipf_;
+};
+
+// 单个线程的key序列，不是线程安全的
+class KeyGenerator
+{
+public:
+	// 第thread个线程（共threadNum个）；回放trace时各线程从trace的不同位置开始，循环回放
+	KeyGenerator(const Workload& workload, size_t thread, size_t threadNum, uint64_t seed = 42)
+		: workload_(workload)
+		, rng_(seed + thread * 0x9e3779b97f4a7c15ULL)
+		, scanNext_((uint64_t(thread) + 1) << 48)
+	{
+		const auto& trace = workload_.trace();
+		if (!trace.empty())
+			tracePos_ = trace.size() / (threadNum > 0 ? threadNum : 1) * thread;
+	}
+
+	uint64_t next()
+	{
+		const WorkloadSpec& spec = workload_.spec();
+		switch (spec.kind)
+		{
+		case WorkloadKind::Uniform:
+			return scrambleKey(rng_() % spec.keySpace);
+		case WorkloadKind::Zipf:
+			return scrambleKey(workload_.zipf()->rank(uniform_(rng_)));
+		case WorkloadKind::Scan:
+			// 扫描的key取自各线程独立的区间，不会与热点key重复
+			if (uniform_(rng_) < spec.scanFraction)
+				return scrambleKey(spec.keySpace + scanNext_++);
+			return scrambleKey(workload_.zipf()->rank(uniform_(rng_)));
+		case WorkloadKind::Trace:
+		{
+			const auto& trace = workload_.trace();
+			uint64_t key = trace[tracePos_];
+			tracePos_ = tracePos_ + 1 == trace.size() ? 0 : tracePos_ + 1;
+			return key;
+		}
+		}
+		return 0;
+	}
+
+	// [0,1)上的均匀随机数，供调用方决定读写比例
+	double uniform() { return uniform_(rng_); }
+
+private:
+	const Workload&                        workload_;
+	std::mt19937_64                        rng_;
+	std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+	uint64_t                               scanNext_;
+	size_t                                 tracePos_ = 0;
+};
+
+} // namespace bench
+} // namespace LLZXCache
@@ -0,0 +1,373 @@
+// cache_bench：用可配置的工作负载驱动各个缓存策略，输出吞吐、命中率、延迟分位数和每个元素的内存占用
+//
+// 用法：cache_bench [--policy=lru,arc|all] [--workload=uniform|zipf|scan|trace] [--keys=N] [--theta=0.99]
+//                   [--scan=0.3] [--trace=FILE] [--capacity=N] [--threads=1,2,4] [--ops=N] [--warmup=N]
+//                   [--write-ratio=0] [--value-size=16] [--slices=N] [--sample=N]
+// 读操作按cache-aside方式执行：get未命中时put同一个key；write-ratio比例的操作直接put
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "LLZXArcCache.h"
+#include "LLZXCacheStats.h"
+#include "LLZXClockCache.h"
+#include "LLZXLfuCache.h"
+#include "LLZXLruCache.h"
+#include "LLZXSharedNothingCache.h"
+#include "LLZXTinyLfuCache.h"
+#include "LLZXWorkload.h"
+
+#if defined(LLZX_HAVE_MEMORY_POOL)
+#include "LLZXMemoryPool.h"
+#include "LLZXPooledCache.h"
+#endif
+
+using namespace LLZXCache;
+using namespace LLZXCache::bench;
+
+namespace
+{
+
+using Key = uint64_t;
+using Value = std::string;
+using Cache = LLZXCachePolicy<Key, Value>;
+
+struct Options
+{
+	std::vector<std::string> policies;
+	WorkloadSpec             workload;
+	size_t                   capacity = 100000;
+	std::vector<size_t>      threads{1};
+	size_t                   ops = 1000000;    // 每个线程的操作数
+	size_t                   warmup = 0;       // 计时前单线程预热的操作数，默认为容量的2倍
+	double                   writeRatio = 0.0;
+	size_t                   valueSize = 16;
+	size_t                   slices = 0;       // 分片缓存的分片数，0表示与线程数相同
+	size_t                   sample = 1;       // 每sample个操作记录一次延迟
+};
+
+const std::vector<std::string> kAllPolicies = {
+	"lru", "lru-buffered", "lru-k", "lfu", "arc", "clock", "tinylfu",
+	// 整数key默认使用内联key的分组探测索引，hash-lru-std显式使用unordered_map索引作对照
+	"hash-lru", "hash-lru-std", "hash-lru-buffered", "hash-lru-lockfree", "hash-lru-k", "hash-lfu", "hash-arc", "hash-clock", "hash-tinylfu",
+	// 每个分片由一个工作线程独占，slices为工作线程数；线程数超过核数时工作线程与压测线程抢占CPU
+	"shared-nothing",
+#if defined(LLZX_HAVE_MEMORY_POOL)
+	// 节点和索引从memory_pool分配；池直接向系统申请页，bytes/entry加上池映射的页（按1MB批量申请，含空闲部分）
+	"hash-lru-pool",
+#endif
+};
+
+std::unique_ptr<Cache> makeCache(const std::string& policy, size_t capacity, size_t slices)
+{
+	int cap = static_cast<int>(capacity);
+	// LRU-K的访问历史与主缓存同样大小，k=2
+	if (policy == "lru") return std::make_unique<LLZXLruCache<Key, Value>>(cap);
+	if (policy == "lru-buffered") return std::make_unique<LLZXLruCache<Key, Value>>(cap, LLZXReadMode::Buffered);
+	if (policy == "lru-k") return std::make_unique<LLZXLruKCache<Key, Value>>(cap, cap, 2);
+	if (policy == "lfu") return std::make_unique<LLZXLfuCache<Key, Value>>(cap);
+	if (policy == "arc") return std::make_unique<LLZXArcCache<Key, Value>>(cap);
+	if (policy == "clock") return std::make_unique<LLZXClockCache<Key, Value>>(cap);
+	if (policy == "tinylfu") return std::make_unique<LLZXTinyLfuCache<Key, Value>>(cap);
+	if (policy == "hash-lru") return std::make_unique<LLZXHashLruCache<Key, Value>>(capacity, slices);
+	if (policy == "hash-lru-std")
+		return std::make_unique<LLZXHashLruCache<Key, Value, LLZXStdNodeIndex<Key>>>(capacity, slices);
+	if (policy == "hash-lru-buffered")
+		return std::make_unique<LLZXHashLruCache<Key, Value>>(capacity, slices, LLZXReadMode::Buffered);
+	if (policy == "hash-lru-lockfree")
+		return std::make_unique<LLZXHashLruCache<Key, Value>>(capacity, slices, LLZXReadMode::LockFree);
+	if (policy == "hash-lru-k") return std::make_unique<LLZXHashLruKCache<Key, Value>>(capacity, capacity, 2, slices);
+	if (policy == "hash-lfu") return std::make_unique<LLZXHashLfuCache<Key, Value>>(capacity, slices);
+	if (policy == "hash-arc") return std::make_unique<LLZXHashArcCache<Key, Value>>(capacity, slices);
+	if (policy == "hash-clock") return std::make_unique<LLZXHashClockCache<Key, Value>>(capacity, slices);
+	if (policy == "hash-tinylfu") return std::make_unique<LLZXHashTinyLfuCache<Key, Value>>(capacity, slices);
+	if (policy == "shared-nothing") return std::make_unique<LLZXSharedNothingCache<Key, Value>>(capacity, slices);
+#if defined(LLZX_HAVE_MEMORY_POOL)
+	if (policy == "hash-lru-pool") return std::make_unique<LLZXPooledHashLruCache<Key, Value>>(capacity, slices);
+#endif
+	throw std::invalid_argument("unknown policy: " + policy);
+}
+
+// 当前堆上已分配的字节数，加上memory_pool直接向系统映射的页；拿不到时退回到常驻内存大小
+size_t heapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+	size_t bytes = info.uordblks + info.hblkhd;
+#if defined(LLZX_HAVE_MEMORY_POOL)
+	bytes += LLZXMemoryPool::systemBytes();
+#endif
+	return bytes;
+#else
+	size_t pages = 0, resident = 0;
+	if (FILE* statm = std::fopen("/proc/self/statm", "r"))
+	{
+		if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2)
+			resident = 0;
+		std::fclose(statm);
+	}
+	return resident * 4096;
+#endif
+}
+
+std::vector<std::string> splitList(const std::string& text)
+{
+	std::vector<std::string> items;
+	size_t begin = 0;
+	while (begin <= text.size())
+	{
+		size_t end = text.find(',', begin);
+		if (end == std::string::npos)
+			end = text.size();
+		if (end > begin)
+			items.push_back(text.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return items;
+}
+
+void usage()
+{
+	std::fprintf(stderr,
+		"usage: cache_bench [--policy=lru,arc|all] [--workload=uniform|zipf|scan|trace] [--keys=N]\n"
+		"                   [--theta=0.99] [--scan=0.3] [--trace=FILE] [--capacity=N] [--threads=1,2,4]\n"
+		"                   [--ops=N] [--warmup=N] [--write-ratio=0] [--value-size=16] [--slices=N] [--sample=N]\n"
+		"policies:");
+	for (const auto& policy : kAllPolicies)
+		std::fprintf(stderr, " %s", policy.c_str());
+	std::fprintf(stderr, "\n");
+}
+
+Options parseOptions(int argc, char** argv)
+{
+	Options options;
+	std::string policies = "all";
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		size_t eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+			throw std::invalid_argument("bad argument: " + arg);
+		std::string name = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+		if (name == "policy") policies = value;
+		else if (name == "workload")
+		{
+			if (value == "uniform") options.workload.kind = WorkloadKind::Uniform;
+			else if (value == "zipf") options.workload.kind = WorkloadKind::Zipf;
+			else if (value == "scan") options.workload.kind = WorkloadKind::Scan;
+			else if (value == "trace") options.workload.kind = WorkloadKind::Trace;
+			else throw std::invalid_argument("unknown workload: " + value);
+		}
+		else if (name == "keys") options.workload.keySpace = std::stoull(value);
+		else if (name == "theta") options.workload.theta = std::stod(value);
+		else if (name == "scan") options.workload.scanFraction = std::stod(value);
+		else if (name == "trace")
+		{
+			options.workload.tracePath = value;
+			options.workload.kind = WorkloadKind::Trace;
+		}
+		else if (name == "capacity") options.capacity = std::stoull(value);
+		else if (name == "threads")
+		{
+			options.threads.clear();
+			for (const auto& item : splitList(value))
+				options.threads.push_back(std::max<size_t>(1, std::stoull(item)));
+		}
+		else if (name == "ops") options.ops = std::stoull(value);
+		else if (name == "warmup") options.warmup = std::stoull(value);
+		else if (name == "write-ratio") options.writeRatio = std::stod(value);
+		else if (name == "value-size") options.valueSize = std::stoull(value);
+		else if (name == "slices") options.slices = std::stoull(value);
+		else if (name == "sample") options.sample = std::max<size_t>(1, std::stoull(value));
+		else throw std::invalid_argument("unknown option: --" + name);
+	}
+
+	options.policies = policies == "all" ? kAllPolicies : splitList(policies);
+	if (options.workload.kind != WorkloadKind::Trace && options.workload.kind != WorkloadKind::Uniform
+		&& !(options.workload.theta > 0.0 && options.workload.theta < 1.0))
+		throw std::invalid_argument("theta must be in (0, 1)");
+	if (options.workload.keySpace == 0 || options.capacity == 0)
+		throw std::invalid_argument("keys and capacity must be positive");
+	if (options.warmup == 0)
+		options.warmup = options.capacity * 2;
+	return options;
+}
+
+struct ThreadResult
+{
+	uint64_t            hits = 0;
+	uint64_t            lookups = 0;
+	LLZXLatencySnapshot latency;
+};
+
+struct RunResult
+{
+	double              opsPerSecond = 0;
+	double              hitRatio = 0;
+	double              bytesPerEntry = 0;
+	LLZXLatencySnapshot latency;
+};
+
+// 单线程执行ops个操作，sample为0时不记录延迟
+void runOps(Cache& cache, KeyGenerator& keys, size_t ops, double writeRatio, const Value& value,
+	size_t sample, ThreadResult& result)
+{
+	Value out;
+	for (size_t i = 0; i < ops; ++i)
+	{
+		Key key = keys.next();
+		bool write = writeRatio > 0 && keys.uniform() < writeRatio;
+		bool timed = sample != 0 && i % sample == 0;
+		auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+		if (write)
+			cache.put(key, value);
+		else
+		{
+			++result.lookups;
+			if (cache.get(key, out))
+				++result.hits;
+			else
+				cache.put(key, value);
+		}
+
+		if (timed)
+		{
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			++result.latency.buckets[LLZXLatencySnapshot::bucketOf(nanos)];
+			++result.latency.count;
+			result.latency.totalNanos += nanos;
+		}
+	}
+}
+
+RunResult runOne(const Options& options, const Workload& workload, const std::string& policy, size_t threadNum)
+{
+	Value value(options.valueSize, 'v');
+	size_t slices = options.slices ? options.slices : threadNum;
+
+	// 内存：构造缓存并用不会在工作负载中出现的key填满，按堆上增长的字节数计算每个元素的开销
+	size_t heapBefore = heapBytes();
+	std::unique_ptr<Cache> cache = makeCache(policy, options.capacity, slices);
+	for (size_t i = 0; i < options.capacity; ++i)
+		cache->put(scrambleKey((uint64_t(1) << 63) | i), value);
+	RunResult run;
+	run.bytesPerEntry = static_cast<double>(heapBytes() - heapBefore) / static_cast<double>(options.capacity);
+
+	// 预热：单线程执行，不计入结果
+	{
+		KeyGenerator keys(workload, threadNum, threadNum + 1, 7);
+		ThreadResult ignored;
+		runOps(*cache, keys, options.warmup, options.writeRatio, value, 0, ignored);
+	}
+
+	std::vector<ThreadResult> results(threadNum);
+	std::vector<std::thread> workers;
+	std::atomic<size_t> ready{0};
+	std::atomic<bool> go{false};
+	for (size_t t = 0; t < threadNum; ++t)
+	{
+		workers.emplace_back([&, t] {
+			KeyGenerator keys(workload, t, threadNum);
+			ready.fetch_add(1);
+			while (!go.load(std::memory_order_acquire))
+				std::this_thread::yield();
+			runOps(*cache, keys, options.ops, options.writeRatio, value, options.sample, results[t]);
+		});
+	}
+	while (ready.load() != threadNum)
+		std::this_thread::yield();
+
+	auto start = std::chrono::steady_clock::now();
+	go.store(true, std::memory_order_release);
+	for (auto& worker : workers)
+		worker.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t hits = 0, lookups = 0;
+	for (const auto& result : results)
+	{
+		hits += result.hits;
+		lookups += result.lookups;
+		run.latency += result.latency;
+	}
+	run.opsPerSecond = static_cast<double>(options.ops * threadNum) / seconds;
+	run.hitRatio = lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+	return run;
+}
+
+const char* workloadName(WorkloadKind kind)
+{
+	switch (kind)
+	{
+	case WorkloadKind::Uniform: return "uniform";
+	case WorkloadKind::Zipf: return "zipf";
+	case WorkloadKind::Scan: return "scan";
+	case WorkloadKind::Trace: return "trace";
+	}
+	return "?";
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		options = parseOptions(argc, argv);
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_bench: %s\n", error.what());
+		usage();
+		return 2;
+	}
+
+	try
+	{
+		Workload workload(options.workload);
+		std::printf("workload=%s keys=%llu theta=%.2f capacity=%zu ops/thread=%zu write-ratio=%.2f value-size=%zu\n",
+			workloadName(options.workload.kind), static_cast<unsigned long long>(options.workload.keySpace),
+			options.workload.theta, options.capacity, options.ops, options.writeRatio, options.valueSize);
+		std::printf("%-18s %7s %14s %8s %9s %9s %9s %11s\n",
+			"policy", "threads", "ops/s", "hit%", "p50(ns)", "p99(ns)", "p999(ns)", "bytes/entry");
+
+		for (const auto& policy : options.policies)
+		{
+			for (size_t threadNum : options.threads)
+			{
+				RunResult run = runOne(options, workload, policy, threadNum);
+				std::printf("%-18s %7zu %14.0f %7.2f%% %9llu %9llu %9llu %11.1f\n",
+					policy.c_str(), threadNum, run.opsPerSecond, run.hitRatio * 100.0,
+					static_cast<unsigned long long>(run.latency.percentile(0.5)),
+					static_cast<unsigned long long>(run.latency.percentile(0.99)),
+					static_cast<unsigned long long>(run.latency.percentile(0.999)),
+					run.bytesPerEntry);
+				std::fflush(stdout);
+			}
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_bench: %s\n", error.what());
+		return 1;
+	}
+	return 0;
+}
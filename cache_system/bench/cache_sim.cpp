@@ -0,0 +1,371 @@
+// cache_sim：离线回放访问trace，一遍扫描输出各策略在各容量下的命中率曲线，用于选择capacity、k、historyCapacity、sliceNum
+//
+// 用法：cache_sim (--trace=FILE | --workload=uniform|zipf|scan --keys=N --theta=0.99 --accesses=N)
+//                 [--policy=lru,lru-k,arc,lfu,clock,tinylfu,hash-lru] [--capacities=1000,2000 | --min-capacity=N --max-capacity=N --points=N]
+//                 [--k=2,3] [--history=1,2] [--slices=1,16] [--sample=1.0] [--threads=N]
+//   trace可以是LLZXTraceRecorder写出的二进制文件，也可以是每行一个key的文本文件
+//   lru通过栈距离直接得到所有容量下的精确命中率，其他策略在每个容量上各自模拟一个缓存，所有缓存在同一遍扫描中更新
+//   lru-k对每组(k, history)各模拟一次，history为访问历史容量与主缓存容量之比；hash-lru对每个分片数各模拟一次
+//   --sample小于1时再按key做空间采样，模拟的容量同样乘以采样率（与trace记录时的采样率相乘）
+// 输出CSV：policy,params,capacity,hit_ratio；get未命中时按cache-aside写入，put记录只写入不计入命中率
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXArcCache.h"
+#include "LLZXClockCache.h"
+#include "LLZXLfuCache.h"
+#include "LLZXLruCache.h"
+#include "LLZXStackDistance.h"
+#include "LLZXTinyLfuCache.h"
+#include "LLZXTraceRecorder.h"
+#include "LLZXWorkload.h"
+
+using namespace LLZXCache;
+using namespace LLZXCache::bench;
+
+namespace
+{
+
+using Cache = LLZXCachePolicy<uint64_t, uint8_t>;
+
+struct Options
+{
+	std::string              tracePath;
+	WorkloadSpec             workload;
+	bool                     synthetic = false;
+	uint64_t                 accesses = 10000000;
+	std::vector<std::string> policies{"lru", "lru-k", "arc", "lfu", "clock", "tinylfu"};
+	std::vector<uint64_t>    capacities;
+	uint64_t                 minCapacity = 1000;
+	uint64_t                 maxCapacity = 1000000;
+	size_t                   points = 16;
+	std::vector<uint64_t>    ks{2};
+	std::vector<double>      histories{1.0};
+	std::vector<uint64_t>    slices{16};
+	double                   sampleRate = 1.0;
+	size_t                   threads = 1;
+};
+
+std::vector<std::string> splitList(const std::string& text)
+{
+	std::vector<std::string> items;
+	size_t begin = 0;
+	while (begin <= text.size())
+	{
+		size_t end = text.find(',', begin);
+		if (end == std::string::npos)
+			end = text.size();
+		if (end > begin)
+			items.push_back(text.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return items;
+}
+
+template<typename T, typename Parse>
+std::vector<T> parseList(const std::string& text, Parse parse)
+{
+	std::vector<T> values;
+	for (const auto& item : splitList(text))
+		values.push_back(static_cast<T>(parse(item)));
+	return values;
+}
+
+uint64_t toU64(const std::string& text) { return std::stoull(text); }
+double toDouble(const std::string& text) { return std::stod(text); }
+
+Options parseOptions(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		size_t eq = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+			throw std::invalid_argument("bad argument: " + arg);
+		std::string name = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+
+		if (name == "trace") options.tracePath = value;
+		else if (name == "workload")
+		{
+			options.synthetic = true;
+			if (value == "uniform") options.workload.kind = WorkloadKind::Uniform;
+			else if (value == "zipf") options.workload.kind = WorkloadKind::Zipf;
+			else if (value == "scan") options.workload.kind = WorkloadKind::Scan;
+			else throw std::invalid_argument("unknown workload: " + value);
+		}
+		else if (name == "keys") options.workload.keySpace = toU64(value);
+		else if (name == "theta") options.workload.theta = toDouble(value);
+		else if (name == "scan") options.workload.scanFraction = toDouble(value);
+		else if (name == "accesses") options.accesses = toU64(value);
+		else if (name == "policy") options.policies = splitList(value);
+		else if (name == "capacities") options.capacities = parseList<uint64_t>(value, toU64);
+		else if (name == "min-capacity") options.minCapacity = toU64(value);
+		else if (name == "max-capacity") options.maxCapacity = toU64(value);
+		else if (name == "points") options.points = toU64(value);
+		else if (name == "k") options.ks = parseList<uint64_t>(value, toU64);
+		else if (name == "history") options.histories = parseList<double>(value, toDouble);
+		else if (name == "slices") options.slices = parseList<uint64_t>(value, toU64);
+		else if (name == "sample") options.sampleRate = toDouble(value);
+		else if (name == "threads") options.threads = std::max<size_t>(1, toU64(value));
+		else throw std::invalid_argument("unknown option: --" + name);
+	}
+
+	if (options.tracePath.empty() && !options.synthetic)
+		throw std::invalid_argument("either --trace or --workload is required");
+	if (options.synthetic && !(options.workload.kind == WorkloadKind::Uniform
+		|| (options.workload.theta > 0.0 && options.workload.theta < 1.0)))
+		throw std::invalid_argument("theta must be in (0, 1)");
+	if (!(options.sampleRate > 0.0 && options.sampleRate <= 1.0))
+		throw std::invalid_argument("sample must be in (0, 1]");
+
+	// 没有指定容量时在[min, max]上等比取points个点
+	if (options.capacities.empty())
+	{
+		uint64_t low = std::max<uint64_t>(1, options.minCapacity), high = std::max(low, options.maxCapacity);
+		size_t points = std::max<size_t>(1, options.points);
+		for (size_t i = 0; i < points; ++i)
+		{
+			double t = points == 1 ? 1.0 : static_cast<double>(i) / static_cast<double>(points - 1);
+			options.capacities.push_back(static_cast<uint64_t>(std::llround(
+				static_cast<double>(low) * std::pow(static_cast<double>(high) / static_cast<double>(low), t))));
+		}
+	}
+	std::sort(options.capacities.begin(), options.capacities.end());
+	options.capacities.erase(std::unique(options.capacities.begin(), options.capacities.end()), options.capacities.end());
+	return options;
+}
+
+// 按块读取访问记录（与LLZXTraceRecorder的记录格式相同）
+class RecordSource
+{
+public:
+	explicit RecordSource(const Options& options)
+		: options_(options)
+	{
+		if (options.synthetic)
+		{
+			workload_ = std::make_unique<Workload>(options.workload);
+			generator_ = std::make_unique<KeyGenerator>(*workload_, 0, 1);
+		}
+		else if (LLZXTraceReader::isBinaryTrace(options.tracePath))
+		{
+			reader_ = std::make_unique<LLZXTraceReader>(options.tracePath);
+			sampleRate_ = reader_->sampleRate();
+		}
+		else
+			text_ = loadTrace(options.tracePath);
+	}
+
+	// 记录时已经采样过的比例
+	double sampleRate() const { return sampleRate_; }
+
+	size_t read(uint64_t* records, size_t maxCount)
+	{
+		if (reader_)
+			return reader_->read(records, maxCount);
+
+		size_t count = 0;
+		if (generator_)
+		{
+			for (; count < maxCount && produced_ < options_.accesses; ++count, ++produced_)
+				records[count] = traceKeyOf(generator_->next());
+			return count;
+		}
+		for (; count < maxCount && textPos_ < text_.size(); ++count, ++textPos_)
+			records[count] = traceKeyOf(text_[textPos_]);
+		return count;
+	}
+
+private:
+	const Options&                options_;
+	std::unique_ptr<LLZXTraceReader> reader_;
+	std::unique_ptr<Workload>     workload_;
+	std::unique_ptr<KeyGenerator> generator_;
+	std::vector<uint64_t>         text_;
+	uint64_t                      produced_ = 0;
+	size_t                        textPos_ = 0;
+	double                        sampleRate_ = 1.0;
+};
+
+// 一个被模拟的(策略, 参数, 容量)组合
+struct Simulation
+{
+	std::string            policy;
+	std::string            params;
+	uint64_t               capacity;
+	std::unique_ptr<Cache> cache;
+	uint64_t               hits = 0;
+	uint64_t               lookups = 0;
+
+	void replay(const uint64_t* records, size_t count)
+	{
+		uint8_t value = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t key = traceKeyOf(records[i]);
+			if (traceOpOf(records[i]) == LLZXTraceOp::Put)
+			{
+				cache->put(key, 1);
+				continue;
+			}
+			++lookups;
+			if (cache->get(key, value))
+				++hits;
+			else
+				cache->put(key, 1);
+		}
+	}
+};
+
+std::unique_ptr<Cache> makeCache(const std::string& policy, uint64_t capacity, uint64_t k, double history, uint64_t slices)
+{
+	int cap = static_cast<int>(capacity);
+	if (policy == "lru-k")
+	{
+		int historyCapacity = std::max(1, static_cast<int>(std::llround(history * static_cast<double>(capacity))));
+		return std::make_unique<LLZXLruKCache<uint64_t, uint8_t>>(cap, historyCapacity, static_cast<int>(k));
+	}
+	if (policy == "hash-lru") return std::make_unique<LLZXHashLruCache<uint64_t, uint8_t>>(capacity, slices);
+	if (policy == "arc") return std::make_unique<LLZXArcCache<uint64_t, uint8_t>>(cap);
+	if (policy == "lfu") return std::make_unique<LLZXLfuCache<uint64_t, uint8_t>>(cap);
+	if (policy == "clock") return std::make_unique<LLZXClockCache<uint64_t, uint8_t>>(cap);
+	if (policy == "tinylfu") return std::make_unique<LLZXTinyLfuCache<uint64_t, uint8_t>>(cap);
+	throw std::invalid_argument("unknown policy: " + policy);
+}
+
+std::string formatDouble(double value)
+{
+	char text[32];
+	std::snprintf(text, sizeof(text), "%g", value);
+	return text;
+}
+
+int run(const Options& options)
+{
+	RecordSource source(options);
+	double sampleRate = source.sampleRate() * options.sampleRate;
+	uint64_t extraThreshold = detail::traceThreshold(options.sampleRate);
+
+	// 采样后模拟的容量
+	auto scaled = [sampleRate](uint64_t capacity) {
+		return std::max<uint64_t>(1, static_cast<uint64_t>(std::llround(static_cast<double>(capacity) * sampleRate)));
+	};
+
+	bool exactLru = std::find(options.policies.begin(), options.policies.end(), "lru") != options.policies.end();
+	std::unique_ptr<LruStackDistance> stack;
+	if (exactLru)
+		stack = std::make_unique<LruStackDistance>(scaled(options.capacities.back()));
+
+	std::vector<Simulation> simulations;
+	for (const auto& policy : options.policies)
+	{
+		if (policy == "lru")
+			continue;
+		for (uint64_t capacity : options.capacities)
+		{
+			if (policy == "lru-k")
+			{
+				for (uint64_t k : options.ks)
+					for (double history : options.histories)
+						simulations.push_back(Simulation{policy, "k=" + std::to_string(k) + " history=" + formatDouble(history),
+							capacity, makeCache(policy, scaled(capacity), k, history, 1)});
+			}
+			else if (policy == "hash-lru")
+			{
+				for (uint64_t slices : options.slices)
+					simulations.push_back(Simulation{policy, "slices=" + std::to_string(slices),
+						capacity, makeCache(policy, scaled(capacity), 0, 0, slices)});
+			}
+			else
+				simulations.push_back(Simulation{policy, "", capacity, makeCache(policy, scaled(capacity), 0, 0, 0)});
+		}
+	}
+
+	// 按块读入，每块由各个线程分别回放到自己负责的模拟上；栈距离作为第0个任务
+	std::vector<uint64_t> chunk(size_t(1) << 20), sampled;
+	sampled.reserve(chunk.size());
+	size_t jobs = simulations.size() + (stack ? 1 : 0);
+	size_t threadNum = std::min(options.threads, std::max<size_t>(1, jobs));
+	uint64_t total = 0, gets = 0;
+	for (size_t count; (count = source.read(chunk.data(), chunk.size())) > 0;)
+	{
+		total += count;
+		for (size_t i = 0; i < count; ++i)
+			gets += traceOpOf(chunk[i]) == LLZXTraceOp::Get;
+		const uint64_t* records = chunk.data();
+		if (extraThreshold != UINT64_MAX)
+		{
+			sampled.clear();
+			for (size_t i = 0; i < count; ++i)
+				if (detail::sliceMix64(traceKeyOf(chunk[i])) < extraThreshold)
+					sampled.push_back(chunk[i]);
+			records = sampled.data();
+			count = sampled.size();
+		}
+
+		auto work = [&](size_t worker) {
+			for (size_t job = worker; job < jobs; job += threadNum)
+			{
+				if (stack && job == 0)
+				{
+					for (size_t i = 0; i < count; ++i)
+						stack->access(traceKeyOf(records[i]), traceOpOf(records[i]) == LLZXTraceOp::Get);
+					continue;
+				}
+				simulations[job - (stack ? 1 : 0)].replay(records, count);
+			}
+		};
+		std::vector<std::thread> workers;
+		for (size_t worker = 1; worker < threadNum; ++worker)
+			workers.emplace_back(work, worker);
+		work(0);
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	std::fprintf(stderr, "cache_sim: %llu records, sample rate %g\n", static_cast<unsigned long long>(total), sampleRate);
+	std::printf("policy,params,capacity,hit_ratio\n");
+	if (stack)
+	{
+		std::vector<uint64_t> limits;
+		for (uint64_t capacity : options.capacities)
+			limits.push_back(scaled(capacity));
+		// 记录时的采样无法校正（不知道采样前的访问数），只校正这里的采样
+		double expected = extraThreshold != UINT64_MAX ? static_cast<double>(gets) * options.sampleRate : 0.0;
+		std::vector<double> ratios = stack->hitRatios(limits, expected);
+		for (size_t i = 0; i < options.capacities.size(); ++i)
+			std::printf("lru,,%llu,%.6f\n", static_cast<unsigned long long>(options.capacities[i]), ratios[i]);
+	}
+	for (const auto& simulation : simulations)
+	{
+		double ratio = simulation.lookups ? static_cast<double>(simulation.hits) / static_cast<double>(simulation.lookups) : 0.0;
+		std::printf("%s,%s,%llu,%.6f\n", simulation.policy.c_str(), simulation.params.c_str(),
+			static_cast<unsigned long long>(simulation.capacity), ratio);
+	}
+	return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		return run(parseOptions(argc, argv));
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "cache_sim: %s\n", error.what());
+		return 1;
+	}
+}
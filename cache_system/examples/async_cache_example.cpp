@@ -0,0 +1,198 @@
+// async_cache_example：LLZXAsyncCache的用法示例，同时检查三种awaiter的同步完成和挂起两条路径
+//
+// 用法：async_cache_example（需要打开CACHE_SYSTEM_ENABLE_COROUTINES，全部检查通过时返回0）
+//   主线程跑一个简单的事件循环（LLZXExecutor的实现），所有协程都在主线程上启动和恢复；
+//   另一个线程通过visit持有分片锁，让getAsync/putAsync走挂起、交给后台线程、再回到事件循环的路径
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "LLZXAsyncCache.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+// 跑在主线程上的事件循环：post可以在任意线程调用，协程只在run所在的线程上恢复
+class EventLoop : public LLZXExecutor
+{
+public:
+	void post(std::coroutine_handle<> handle) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			ready_.push_back(handle);
+			++posted_;
+		}
+		cv_.notify_one();
+	}
+
+	// 经过post恢复的次数，即挂起过的awaiter个数
+	size_t posted()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return posted_;
+	}
+
+	// 依次恢复就绪的协程，直到pending个协程全部结束
+	void run(const std::atomic<int>& pending)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (pending.load() > 0)
+		{
+			cv_.wait(lock, [this, &pending] { return !ready_.empty() || pending.load() == 0; });
+			while (!ready_.empty())
+			{
+				std::coroutine_handle<> handle = ready_.front();
+				ready_.pop_front();
+				lock.unlock();
+				checkThread();
+				handle.resume();
+				lock.lock();
+			}
+		}
+	}
+
+	// 恢复发生在事件循环的线程上，而不是缓存的后台线程
+	void checkThread() const
+	{
+		if (std::this_thread::get_id() != owner_)
+			throw std::runtime_error("coroutine resumed off the event loop thread");
+	}
+
+	void notify() { cv_.notify_one(); }
+
+private:
+	std::thread::id                     owner_ = std::this_thread::get_id();
+	std::mutex                          mutex_;
+	std::condition_variable             cv_;
+	std::deque<std::coroutine_handle<>> ready_;
+	size_t                              posted_ = 0;
+};
+
+// 立即开始执行、结束时自行销毁的协程
+struct Task
+{
+	struct promise_type
+	{
+		Task get_return_object() { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { std::terminate(); }
+	};
+};
+
+using Cache = LLZXAsyncCache<std::string, std::string>;
+
+int failures = 0;
+
+void expect(bool condition, const char* what)
+{
+	if (!condition)
+	{
+		std::fprintf(stderr, "async_cache_example: check failed: %s\n", what);
+		++failures;
+	}
+}
+
+Task readAndWrite(Cache& cache, EventLoop& loop, std::atomic<int>& pending)
+{
+	co_await cache.putAsync("user:1", "alice", loop);
+	std::optional<std::string> hit = co_await cache.getAsync("user:1", loop);
+	expect(hit && *hit == "alice", "getAsync returns the value written by putAsync");
+	loop.checkThread();
+	pending.fetch_sub(1);
+	loop.notify();
+}
+
+Task load(Cache& cache, EventLoop& loop, std::atomic<int>& loads, std::atomic<int>& pending)
+{
+	std::string value = co_await cache.getOrLoadAsync("user:2", [&loads](const std::string& key) {
+		loads.fetch_add(1);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		return "loaded " + key;
+	}, loop);
+	expect(value == "loaded user:2", "getOrLoadAsync returns the loaded value");
+	loop.checkThread();
+	pending.fetch_sub(1);
+	loop.notify();
+}
+
+// 分片锁被其他线程占用时，getAsync和putAsync挂起，锁释放后在事件循环上恢复
+Task contended(Cache& cache, EventLoop& loop, std::atomic<bool>& suspended, std::atomic<int>& pending)
+{
+	suspended.store(true);
+	co_await cache.putAsync("user:3", "carol", loop);
+	std::optional<std::string> hit = co_await cache.getAsync("user:3", loop);
+	expect(hit && *hit == "carol", "contended getAsync sees the contended putAsync");
+	loop.checkThread();
+	pending.fetch_sub(1);
+	loop.notify();
+}
+
+} // namespace
+
+int main()
+{
+	try
+	{
+		// 单分片：visit任意key都会占住所有key所在的分片
+		Cache cache(1000, 1, 2);
+		EventLoop loop;
+
+		// 没有竞争时同步完成，不挂起
+		std::atomic<int> pending{1};
+		readAndWrite(cache, loop, pending);
+		loop.run(pending);
+		expect(loop.posted() == 0, "uncontended awaiters complete without suspending");
+
+		// 同一个key并发的两次getOrLoadAsync只执行一次loader
+		std::atomic<int> loads{0};
+		pending.store(2);
+		load(cache, loop, loads, pending);
+		load(cache, loop, loads, pending);
+		loop.run(pending);
+		expect(loads.load() == 1, "concurrent getOrLoadAsync runs the loader once");
+
+		// 另一个线程在visit回调里持有分片锁，直到协程已经挂起在putAsync上
+		cache.cache().put("user:x", "x");
+		std::atomic<bool> locked{false}, suspended{false};
+		std::thread holder([&] {
+			cache.cache().visit("user:x", [&](const std::string&) {
+				locked.store(true);
+				while (!suspended.load())
+					std::this_thread::yield();
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			});
+		});
+		while (!locked.load())
+			std::this_thread::yield();
+		size_t posted = loop.posted();
+		pending.store(1);
+		contended(cache, loop, suspended, pending);
+		loop.run(pending);
+		holder.join();
+		expect(loop.posted() > posted, "contended awaiters suspend and resume through the executor");
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "async_cache_example: %s\n", error.what());
+		return 1;
+	}
+
+	if (failures == 0)
+		std::printf("async_cache_example: all checks passed\n");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,482 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+#include "LLZXShardedCache.h"
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+template<typename Key, typename Value, typename Index> class LLZXArcCache;
+
+template<typename Key, typename Value>
+class ArcNode
+{
+public:
+	ArcNode(Key key, Value value)
+		: key_(std::move(key))
+		, value_(std::move(value))
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+		, frequent_(false)
+	{}
+
+	const Key& getKey() const { return key_; }
+	const Value& getValue() const { return value_; }
+
+	template<typename K, typename V>
+	void reset(K&& key, V&& value)
+	{
+		key_ = std::forward<K>(key);
+		value_ = std::forward<V>(value);
+		frequent_ = false;
+	}
+
+private:
+	Key       key_;
+	Value     value_;
+	SlotIndex prev_;
+	SlotIndex next_;
+	bool      frequent_; // false在T1中（只访问过一次），true在T2中（至少访问过两次）
+
+	template<typename, typename, typename> friend class LLZXArcCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
+};
+
+// 幽灵节点：只保存被驱逐key的hash，不保存key和value
+class ArcGhost
+{
+public:
+	ArcGhost(uint64_t hash, bool frequent)
+		: hash_(hash)
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+		, frequent_(frequent)
+	{}
+
+	void reset(uint64_t hash, bool frequent)
+	{
+		hash_ = hash;
+		frequent_ = frequent;
+	}
+
+	const uint64_t& getHash() const { return hash_; }
+
+private:
+	uint64_t  hash_;
+	SlotIndex prev_;
+	SlotIndex next_;
+	bool      frequent_; // false在B1中，true在B2中
+
+	template<typename, typename, typename> friend class LLZXArcCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
+};
+
+// ARC自适应替换缓存（Megiddo & Modha）
+//   T1：只访问过一次的元素，T2：至少访问过两次的元素，B1/B2：分别从T1/T2驱逐的key的幽灵记录
+//   p_是T1的目标大小：插入的key命中B1说明T1太小，p_增大；命中B2说明T2太小，p_减小
+//   驱逐时T1超过p_就从T1驱逐，否则从T2驱逐，在偏重访问时间和偏重访问频率之间在线调整
+// 幽灵记录只保存key的hash（8字节），hash冲突只会让自适应略有偏差，不影响正确性
+// T1+B1不超过容量，四个链表之和不超过两倍容量
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXArcCache : public LLZXCachePolicy<Key, Value>
+{
+public:
+	using ArcNodeType = ArcNode<Key, Value>;
+	using NodeSlab = LLZXNodeSlab<ArcNodeType>;
+	using NodeList = LLZXNodeList<NodeSlab>;
+	using GhostSlab = LLZXNodeSlab<ArcGhost>;
+	using GhostList = LLZXNodeList<GhostSlab>;
+	using GhostMap = LLZXFlatNodeIndex<uint64_t>;
+	using NodeMap = Index;
+	using Duration = LLZXExpiry::Duration;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+private:
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+public:
+	explicit LLZXArcCache(int capacity)
+		: capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+		, slab_(capacity_)
+		, ghosts_(capacity_)
+	{
+		nodeMap_.reserve(capacity_);
+		ghostMap_.reserve(capacity_);
+	}
+
+	void put(const Key& key, const Value& value) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		Value value(std::forward<Args>(args)...);
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, std::move(value));
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return visit<Key, const Visitor&>(key, visitor);
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		SlotIndex slot = findLocked(key);
+		if (slot == kNullSlot)
+			return false;
+		promote(slot);
+		fn(slab_[slot].getValue());
+		return true;
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 批量读取，order含义同LLZXLruCache::getManyIndexed，整批只加一次锁
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (j + kPrefetchDistance < count)
+				nodeMap_.prefetch(keys[order ? order[j + kPrefetchDistance] : j + kPrefetchDistance]);
+			size_t i = order ? order[j] : j;
+			SlotIndex slot = findLocked(keys[i]);
+			hits[i] = slot != kNullSlot;
+			if (hits[i])
+			{
+				promote(slot);
+				values[i] = slab_[slot].getValue();
+				++hitCount;
+			}
+		}
+		return hitCount;
+	}
+
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t i = order ? order[j] : j;
+			putLocked(keys[i], values[i]);
+		}
+	}
+
+	// 删除元素，不留幽灵记录
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+			removeSlot(slot);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+	// 包括已过期但尚未回收的元素
+	size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return nodeMap_.size();
+	}
+
+	// 回收所有已过期的元素，返回回收个数；过期的元素不留幽灵记录
+	size_t purgeExpired()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return purgeExpiredLocked();
+	}
+
+	// 当前T1的目标大小，用于观察自适应的方向
+	size_t recencyTarget() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return p_;
+	}
+
+private:
+	static constexpr size_t kPrefetchDistance = 4;
+
+	struct KeyOfSlot
+	{
+		const NodeSlab* slab;
+		const Key& operator()(SlotIndex slot) const { return (*slab)[slot].getKey(); }
+	};
+
+	struct HashOfGhost
+	{
+		const GhostSlab* slab;
+		const uint64_t& operator()(SlotIndex slot) const { return (*slab)[slot].getHash(); }
+	};
+
+	KeyOfSlot keyOf() const { return KeyOfSlot{&slab_}; }
+	HashOfGhost hashOfGhost() const { return HashOfGhost{&ghosts_}; }
+
+	template<typename K>
+	static uint64_t hashOf(const K& key)
+	{
+		return typename Index::hasher()(key);
+	}
+
+	NodeList& listOf(bool frequent) { return frequent ? t2_ : t1_; }
+	GhostList& ghostListOf(bool frequent) { return frequent ? b2_ : b1_; }
+
+	// 查找未过期的元素，过期的顺手回收
+	template<typename K>
+	SlotIndex findLocked(const K& key)
+	{
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot && expiry_.expired(slot))
+		{
+			removeSlot(slot);
+			return kNullSlot;
+		}
+		return slot;
+	}
+
+	void removeSlot(SlotIndex slot)
+	{
+		nodeMap_.erase(slab_[slot].getKey(), keyOf());
+		listOf(slab_[slot].frequent_).unlink(slab_, slot);
+		expiry_.cancel(slot);
+		slab_[slot].key_ = Key{};
+		slab_[slot].value_ = Value{};
+		slab_.release(slot);
+	}
+
+	size_t purgeExpiredLocked()
+	{
+		return expiry_.purge([this](SlotIndex slot) { removeSlot(slot); });
+	}
+
+	// 命中：移到T2的最近访问端
+	void promote(SlotIndex slot)
+	{
+		ArcNodeType& node = slab_[slot];
+		if (node.frequent_)
+		{
+			t2_.moveToBack(slab_, slot);
+			return;
+		}
+		t1_.unlink(slab_, slot);
+		node.frequent_ = true;
+		t2_.pushBack(slab_, slot);
+	}
+
+	template<typename K, typename V>
+	void putLocked(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return;
+
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+		{
+			slab_[slot].value_ = std::forward<V>(value);
+			promote(slot);
+			expiry_.expireAfter(slot, ttl);
+			return;
+		}
+
+		// 先回收已过期的元素，腾出的位置不需要再驱逐有效元素
+		if (residentSize() >= capacity_)
+			purgeExpiredLocked();
+
+		uint64_t hash = hashOf(key);
+		SlotIndex reuse = kNullSlot;
+		bool frequent = false;
+		SlotIndex ghost = ghostMap_.find(hash, hashOfGhost());
+		if (ghost != kNullSlot)
+		{
+			// 命中幽灵记录：说明对应的链表给得太小，调整p_后直接放入T2
+			bool inB2 = ghosts_[ghost].frequent_;
+			if (!inB2)
+				p_ = std::min(capacity_, p_ + std::max<size_t>(b2_.size() / b1_.size(), 1));
+			else
+				p_ -= std::min(p_, std::max<size_t>(b1_.size() / b2_.size(), 1));
+			removeGhost(ghost);
+			if (residentSize() >= capacity_)
+				reuse = replace(inB2);
+			frequent = true;
+		}
+		else if (t1_.size() + b1_.size() >= capacity_)
+		{
+			if (t1_.size() < capacity_)
+			{
+				removeGhost(b1_.front());
+				if (residentSize() >= capacity_)
+					reuse = replace(false);
+			}
+			else
+			{
+				// B1为空且T1占满整个缓存，直接丢弃T1最久未访问的元素，不留幽灵记录
+				reuse = t1_.popFront(slab_);
+				nodeMap_.erase(slab_[reuse].getKey(), keyOf());
+				expiry_.cancel(reuse);
+			}
+		}
+		else if (residentSize() + b1_.size() + b2_.size() >= capacity_)
+		{
+			if (residentSize() + b1_.size() + b2_.size() >= 2 * capacity_)
+				removeGhost(b2_.front());
+			if (residentSize() >= capacity_)
+				reuse = replace(false);
+		}
+
+		if (reuse != kNullSlot)
+		{
+			slab_[reuse].reset(std::forward<K>(key), std::forward<V>(value));
+			slot = reuse;
+		}
+		else
+		{
+			slot = slab_.allocate(std::forward<K>(key), std::forward<V>(value));
+		}
+		slab_[slot].frequent_ = frequent;
+		listOf(frequent).pushBack(slab_, slot);
+		nodeMap_.insert(slab_[slot].getKey(), slot, keyOf());
+		expiry_.expireAfter(slot, ttl);
+	}
+
+	size_t residentSize() const { return t1_.size() + t2_.size(); }
+
+	// 驱逐一个元素并把它的hash记入对应的幽灵链表，返回腾出的槽位
+	SlotIndex replace(bool requestInB2)
+	{
+		bool fromT1 = !t1_.empty() && (t1_.size() > p_ || (requestInB2 && t1_.size() == p_) || t2_.empty());
+		NodeList& list = listOf(!fromT1);
+		SlotIndex victim = list.popFront(slab_);
+		addGhost(hashOf(slab_[victim].getKey()), !fromT1);
+		nodeMap_.erase(slab_[victim].getKey(), keyOf());
+		expiry_.cancel(victim);
+		return victim;
+	}
+
+	void addGhost(uint64_t hash, bool frequent)
+	{
+		SlotIndex ghost = ghostMap_.find(hash, hashOfGhost());
+		if (ghost != kNullSlot)
+		{
+			// hash冲突时复用已有的幽灵记录
+			ghostListOf(ghosts_[ghost].frequent_).unlink(ghosts_, ghost);
+			ghosts_[ghost].frequent_ = frequent;
+			ghostListOf(frequent).pushBack(ghosts_, ghost);
+			return;
+		}
+		ghost = ghosts_.allocate(hash, frequent);
+		ghostListOf(frequent).pushBack(ghosts_, ghost);
+		ghostMap_.insert(hash, ghost, hashOfGhost());
+	}
+
+	void removeGhost(SlotIndex ghost)
+	{
+		ghostMap_.erase(ghosts_[ghost].getHash(), hashOfGhost());
+		ghostListOf(ghosts_[ghost].frequent_).unlink(ghosts_, ghost);
+		ghosts_.release(ghost);
+	}
+
+private:
+	size_t    capacity_;
+	size_t    p_ = 0;    // T1的目标大小
+	NodeMap   nodeMap_;
+	GhostMap  ghostMap_; // key的hash -> 幽灵槽位
+	alignas(kCacheLineSize) mutable std::mutex mutex_;
+	NodeSlab  slab_;
+	GhostSlab ghosts_;
+	NodeList  t1_;
+	NodeList  t2_;
+	GhostList b1_;
+	GhostList b2_;
+	LLZXExpiry expiry_;
+};
+
+//分片ARC
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXHashArcCache : public LLZXShardedCache<Key, Value, LLZXArcCache<Key, Value, Index>>
+{
+	using SliceCache = LLZXArcCache<Key, Value, Index>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
+
+public:
+	LLZXHashArcCache(size_t capacity, size_t sliceNum, LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
+	{
+		this->initSlices(sliceNum, [](size_t sliceSize) {
+			return SliceCache(static_cast<int>(sliceSize));
+		});
+	}
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,347 @@
+#pragma once
+
+// C++20协程接口，编译器不支持协程时整个头文件为空（见CMake选项CACHE_SYSTEM_ENABLE_COROUTINES）
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "LLZXLruCache.h"
+
+namespace LLZXCache
+{
+
+// 协程恢复的位置：挂起的操作完成后通过post把协程交还给调用方的事件循环/线程池
+// post可能在任意线程上调用，实现需要线程安全
+class LLZXExecutor
+{
+public:
+	virtual ~LLZXExecutor() = default;
+	virtual void post(std::coroutine_handle<> handle) = 0;
+};
+
+// 直接在完成操作的线程上恢复协程：挂起过的协程之后在LLZXAsyncCache的后台线程上继续执行，
+// 占用后台线程直到下一次挂起，并且离开了调用方的线程；只适合不关心恢复线程、后续工作很短的场景，需要显式传入
+class LLZXInlineExecutor : public LLZXExecutor
+{
+public:
+	void post(std::coroutine_handle<> handle) override
+	{
+		handle.resume();
+	}
+
+	static LLZXInlineExecutor& instance()
+	{
+		static LLZXInlineExecutor executor;
+		return executor;
+	}
+};
+
+namespace detail
+{
+
+// 执行阻塞操作的后台线程：队列不设上限，不拒绝任务（挂起的协程只能由任务恢复）
+// 析构时先执行完队列中剩余的任务再退出
+class LLZXOffloadPool
+{
+public:
+	explicit LLZXOffloadPool(size_t threadNum)
+	{
+		threadNum = threadNum > 0 ? threadNum : 1;
+		workers_.reserve(threadNum);
+		for (size_t i = 0; i < threadNum; ++i)
+			workers_.emplace_back([this] { run(); });
+	}
+
+	~LLZXOffloadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_all();
+		for (auto& worker : workers_)
+			worker.join();
+	}
+
+	LLZXOffloadPool(const LLZXOffloadPool&) = delete;
+	LLZXOffloadPool& operator=(const LLZXOffloadPool&) = delete;
+
+	void submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			tasks_.push_back(std::move(task));
+		}
+		cv_.notify_one();
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;)
+		{
+			cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+			if (tasks_.empty())
+				return;
+			std::function<void()> task = std::move(tasks_.front());
+			tasks_.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+
+private:
+	std::mutex                        mutex_;
+	std::condition_variable           cv_;
+	std::deque<std::function<void()>> tasks_;
+	bool                              stop_ = false;
+	std::vector<std::thread>          workers_;
+};
+
+} // namespace detail
+
+// 分片LRU的协程接口：co_await cache.getAsync(key) / putAsync / getOrLoadAsync
+//   先在调用线程上tryGet/tryPut试一次，拿到分片锁就同步完成，不挂起；
+//   分片锁被占用或需要加载时挂起协程，把阻塞的操作交给后台线程，完成后通过调用方传入的executor恢复
+//   同一个key并发的getOrLoadAsync只执行一次loader，其余协程挂起等待，不占用后台线程；
+//   加载经过分片的getOrLoad，与同步调用方的getOrLoad同样合并
+// 挂起的协程恢复之前，cache和executor都必须保持有效；析构时会等待所有已经交给后台线程的操作完成
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXAsyncCache
+{
+	using Cache = LLZXHashLruCache<Key, Value, Index>;
+	using Duration = std::chrono::steady_clock::duration;
+
+	// 挂起在同一次加载上的协程，节点就是各自的awaitable，位于协程帧内
+	struct Waiter
+	{
+		std::coroutine_handle<> handle;
+		LLZXExecutor*           executor;
+		std::optional<Value>    value;
+		std::exception_ptr      error;
+	};
+
+public:
+	LLZXAsyncCache(size_t capacity, size_t sliceNum, size_t workerNum = 1,
+		LLZXReadMode readMode = LLZXReadMode::Exclusive)
+		: cache_(capacity, sliceNum, readMode)
+		, pool_(workerNum)
+	{}
+
+	LLZXAsyncCache(const LLZXAsyncCache&) = delete;
+	LLZXAsyncCache& operator=(const LLZXAsyncCache&) = delete;
+
+	// 同步接口直接使用底层的分片缓存
+	Cache& cache() { return cache_; }
+
+	class GetAwaiter
+	{
+	public:
+		bool await_ready()
+		{
+			Value value{};
+			LLZXTryResult result = owner_.cache_.tryGet(key_, value);
+			if (result == LLZXTryResult::Hit)
+				value_ = std::move(value);
+			return result != LLZXTryResult::Contended;
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			owner_.pool_.submit([this, handle] {
+				Value value{};
+				if (owner_.cache_.get(key_, value))
+					value_ = std::move(value);
+				executor_.post(handle);
+			});
+		}
+
+		std::optional<Value> await_resume() { return std::move(value_); }
+
+	private:
+		friend class LLZXAsyncCache;
+
+		GetAwaiter(LLZXAsyncCache& owner, const Key& key, LLZXExecutor& executor)
+			: owner_(owner), key_(key), executor_(executor)
+		{}
+
+		LLZXAsyncCache&      owner_;
+		Key                  key_;
+		LLZXExecutor&        executor_;
+		std::optional<Value> value_;
+	};
+
+	class PutAwaiter
+	{
+	public:
+		bool await_ready()
+		{
+			return owner_.cache_.tryPut(key_, value_, ttl_);
+		}
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			owner_.pool_.submit([this, handle] {
+				owner_.cache_.put(key_, value_, ttl_);
+				executor_.post(handle);
+			});
+		}
+
+		void await_resume() {}
+
+	private:
+		friend class LLZXAsyncCache;
+
+		PutAwaiter(LLZXAsyncCache& owner, const Key& key, const Value& value, Duration ttl, LLZXExecutor& executor)
+			: owner_(owner), key_(key), value_(value), ttl_(ttl), executor_(executor)
+		{}
+
+		LLZXAsyncCache& owner_;
+		Key             key_;
+		Value           value_;
+		Duration        ttl_;
+		LLZXExecutor&   executor_;
+	};
+
+	template<typename Loader>
+	class LoadAwaiter
+	{
+	public:
+		bool await_ready()
+		{
+			Value value{};
+			if (owner_.cache_.tryGet(key_, value) != LLZXTryResult::Hit)
+				return false;
+			waiter_.value = std::move(value);
+			return true;
+		}
+
+		// 已经有协程在加载这个key时只登记自己；否则成为领头者，把加载交给后台线程
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			waiter_.handle = handle;
+			{
+				std::lock_guard<std::mutex> lock(owner_.flightsMutex_);
+				auto [it, leader] = owner_.flights_.try_emplace(key_);
+				it->second.push_back(&waiter_);
+				if (!leader)
+					return;
+			}
+			try
+			{
+				owner_.pool_.submit([owner = &owner_, key = key_, loader = std::move(loader_), ttl = ttl_]() mutable {
+					owner->finishLoad(key, owner->loadNow(key, loader, ttl));
+				});
+			}
+			catch (...)
+			{
+				// 登记之后才失败，可能已有其他协程挂在这次加载上，统一按失败唤醒
+				owner_.finishLoad(key_, LoadResult{std::nullopt, std::current_exception()});
+			}
+		}
+
+		// loader抛出的异常在这里重新抛给每个等待的协程
+		Value await_resume()
+		{
+			if (waiter_.error)
+				std::rethrow_exception(waiter_.error);
+			return std::move(*waiter_.value);
+		}
+
+	private:
+		friend class LLZXAsyncCache;
+
+		LoadAwaiter(LLZXAsyncCache& owner, const Key& key, Loader loader, Duration ttl, LLZXExecutor& executor)
+			: owner_(owner), key_(key), loader_(std::move(loader)), ttl_(ttl)
+		{
+			waiter_.executor = &executor;
+		}
+
+		LLZXAsyncCache& owner_;
+		Key             key_;
+		Loader          loader_;
+		Duration        ttl_;
+		Waiter          waiter_;
+	};
+
+	// 以下接口的executor必须由调用方指定：挂起过的协程在executor上恢复，通常是调用方自己的事件循环
+
+	// 读取，返回std::nullopt表示未命中；分片锁被占用时挂起，由后台线程完成读取后在executor上恢复
+	GetAwaiter getAsync(const Key& key, LLZXExecutor& executor)
+	{
+		return GetAwaiter(*this, key, executor);
+	}
+
+	PutAwaiter putAsync(const Key& key, const Value& value, LLZXExecutor& executor, Duration ttl = LLZXExpiry::kNever)
+	{
+		return PutAwaiter(*this, key, value, ttl, executor);
+	}
+
+	// 未命中时由后台线程调用loader(key)并写入缓存（ttl为kNever时不过期），结果通过co_await返回
+	template<typename Loader>
+	LoadAwaiter<std::decay_t<Loader>> getOrLoadAsync(const Key& key, Loader&& loader, LLZXExecutor& executor,
+		Duration ttl = LLZXExpiry::kNever)
+	{
+		return LoadAwaiter<std::decay_t<Loader>>(*this, key, std::forward<Loader>(loader), ttl, executor);
+	}
+
+private:
+	struct LoadResult
+	{
+		std::optional<Value> value;
+		std::exception_ptr   error;
+	};
+
+	template<typename Loader>
+	LoadResult loadNow(const Key& key, Loader& loader, Duration ttl)
+	{
+		try
+		{
+			return LoadResult{cache_.getOrLoad(key, loader, ttl), nullptr};
+		}
+		catch (...)
+		{
+			return LoadResult{std::nullopt, std::current_exception()};
+		}
+	}
+
+	// 先摘下整组等待者再逐个恢复，恢复的协程可能立即发起同一个key的下一次加载
+	void finishLoad(const Key& key, const LoadResult& result)
+	{
+		std::vector<Waiter*> waiters;
+		{
+			std::lock_guard<std::mutex> lock(flightsMutex_);
+			auto it = flights_.find(key);
+			waiters = std::move(it->second);
+			flights_.erase(it);
+		}
+		for (Waiter* waiter : waiters)
+		{
+			waiter->value = result.value;
+			waiter->error = result.error;
+			waiter->executor->post(waiter->handle);
+		}
+	}
+
+private:
+	Cache      cache_;
+	std::mutex flightsMutex_;
+	std::unordered_map<Key, std::vector<Waiter*>, typename Index::hasher, typename Index::key_equal> flights_;
+	detail::LLZXOffloadPool pool_; // 最后初始化、最先析构：后台线程退出时其他成员仍然有效
+};
+
+} // namespace LLZXCache
+
+#endif
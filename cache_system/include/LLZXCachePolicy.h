@@ -1,22 +1,85 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+
 namespace LLZXCache
 {
 
+// 非阻塞操作的结果：Contended表示缓存的锁正被占用，操作没有执行
+enum class LLZXTryResult
+{
+    Hit,
+    Miss,
+    Contended,
+};
+
 template <typename Key, typename Value>
 class LLZXCachePolicy
 {
 public:
+    // 不拷贝读取时使用的回调，命中时在缓存锁内以const引用调用，回调中不要再访问同一个缓存
+    using Visitor = std::function<void(const Value&)>;
+
     virtual ~LLZXCachePolicy() {};
 
-    // 添加缓存接口
-    virtual void put(Key key, Value value) = 0;
+    // 添加缓存接口，右值版本会把key和value直接移动进节点
+    virtual void put(const Key& key, const Value& value) = 0;
+    virtual void put(Key&& key, Value&& value) = 0;
+    // 带过期时间的添加，ttl之后该元素视为不存在，再次不带ttl地put同一个key会清除过期时间
+    virtual void put(const Key& key, const Value& value, std::chrono::steady_clock::duration ttl) = 0;
 
     // key是传入参数  访问到的值以传出参数的形式返回 | 访问成功返回true
-    virtual bool get(Key key, Value& value) = 0;
+    virtual bool get(const Key& key, Value& value) = 0;
     // 如果缓存中能找到key，则直接返回value
-    virtual Value get(Key key) = 0;
+    virtual Value get(const Key& key) = 0;
+
+    // 命中时把值的引用交给visitor，不把值拷贝出来 | 访问成功返回true
+    virtual bool visit(const Key& key, const Visitor& visitor) = 0;
+
+    // 命中时把值拷贝进调用方的arena（如memory_pool中请求结束时整体回收的LLZXArena），value指向arena中的副本，
+    // 读路径不经过全局堆；Arena需要提供void* allocate(size_t bytes, size_t align)，Value需要是连续的字符序列（如std::string）
+    // 派生类重写了另外两个get，需要用using引入这个重载
+    template<typename Arena>
+    bool get(const Key& key, Arena& arena, std::string_view& value)
+    {
+        // 只捕获一个指针，std::function不需要在堆上保存lambda
+        struct Target { Arena* arena; std::string_view* value; } target{&arena, &value};
+        return visit(key, [&target](const Value& found) {
+            using Char = std::remove_cv_t<std::remove_pointer_t<decltype(found.data())>>;
+            static_assert(std::is_same<Char, char>::value, "arena get requires a contiguous char sequence value");
+            size_t size = found.size();
+            char* copy = static_cast<char*>(target.arena->allocate(size, alignof(char)));
+            if (size > 0)
+                std::memcpy(copy, found.data(), size);
+            *target.value = std::string_view(copy, size);
+        });
+    }
+
+    // 批量读取：values/hits由调用方提供，与keys一一对应，返回命中个数
+    // 默认实现逐个调用get，具体缓存可以重写为只加一次锁的版本
+    virtual size_t getMany(const Key* keys, size_t count, Value* values, bool* hits)
+    {
+        size_t hitCount = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            hits[i] = get(keys[i], values[i]);
+            hitCount += hits[i];
+        }
+        return hitCount;
+    }
+
+    // 批量写入，keys与values一一对应
+    virtual void putMany(const Key* keys, const Value* values, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            put(keys[i], values[i]);
+    }
 
 };
 
-} // namespace LLZXCache
\ No newline at end of file
+} // namespace LLZXCache
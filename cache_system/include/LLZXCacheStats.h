@@ -0,0 +1,322 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+#include "LLZXPlatform.h"
+
+// 编译期开关：定义LLZX_CACHE_ENABLE_STATS=1（CMake选项CACHE_SYSTEM_ENABLE_STATS）时缓存统计命中、驱逐、锁等待和延迟，
+// 关闭时LLZXCacheStats的所有接口都是空的内联函数，加锁直接调用互斥量，热路径上没有任何额外开销
+#ifndef LLZX_CACHE_ENABLE_STATS
+#define LLZX_CACHE_ENABLE_STATS 0
+#endif
+
+namespace LLZXCache
+{
+
+// 计数器种类
+enum class LLZXStat : uint8_t
+{
+	Hit,
+	Miss,
+	Insert,        // 新插入的元素
+	Update,        // 覆盖已有元素
+	Eviction,      // 因容量不足被驱逐
+	Expiration,    // 过期被回收
+	Admission,     // LRU-K：达到k次访问进入主缓存
+	Rejection,     // LRU-K：未达到k次访问，没有进入主缓存的写入
+	LockAcquire,   // 加锁次数
+	LockContended, // 第一次尝试没有拿到锁的次数
+	LockWaitNanos, // 拿不到锁时等待的总时间
+	Count,
+};
+
+// 延迟直方图的快照，桶按2的幂分段，每段再等分为kSubBuckets份，相对误差不超过1/kSubBuckets
+struct LLZXLatencySnapshot
+{
+	static constexpr size_t kSubBits = 2;
+	static constexpr size_t kSubBuckets = size_t(1) << kSubBits;
+	static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+	std::array<uint64_t, kBuckets> buckets{};
+	uint64_t count = 0;
+	uint64_t totalNanos = 0;
+
+	static size_t bucketOf(uint64_t nanos)
+	{
+		if (nanos < kSubBuckets)
+			return static_cast<size_t>(nanos);
+		size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(nanos));
+		size_t sub = static_cast<size_t>(nanos >> (exponent - kSubBits)) & (kSubBuckets - 1);
+		return (exponent - kSubBits + 1) * kSubBuckets + sub;
+	}
+
+	// 桶覆盖范围的上界（纳秒）
+	static uint64_t upperBoundOf(size_t bucket)
+	{
+		if (bucket < kSubBuckets)
+			return bucket;
+		size_t exponent = bucket / kSubBuckets + kSubBits - 1;
+		uint64_t sub = bucket % kSubBuckets;
+		uint64_t step = uint64_t(1) << (exponent - kSubBits);
+		uint64_t lower = (uint64_t(1) << exponent) + sub * step;
+		return lower + step - 1;
+	}
+
+	// q取0到1，返回该分位所在桶的上界（纳秒）；没有样本时返回0
+	uint64_t percentile(double q) const
+	{
+		// 并发记录时count和各个桶不是同一时刻读到的，以桶之和为准
+		uint64_t total = 0;
+		for (uint64_t n : buckets)
+			total += n;
+		if (total == 0)
+			return 0;
+		uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total));
+		rank = rank < total ? rank + 1 : total;
+		uint64_t seen = 0;
+		size_t i = 0;
+		for (; i + 1 < kBuckets; ++i)
+		{
+			seen += buckets[i];
+			if (seen >= rank)
+				break;
+		}
+		return upperBoundOf(i);
+	}
+
+	double meanNanos() const
+	{
+		return count ? static_cast<double>(totalNanos) / static_cast<double>(count) : 0.0;
+	}
+
+	LLZXLatencySnapshot& operator+=(const LLZXLatencySnapshot& other)
+	{
+		for (size_t i = 0; i < kBuckets; ++i)
+			buckets[i] += other.buckets[i];
+		count += other.count;
+		totalNanos += other.totalNanos;
+		return *this;
+	}
+};
+
+// 统计快照，分片缓存的快照是各分片之和
+struct LLZXCacheStatsSnapshot
+{
+	std::array<uint64_t, static_cast<size_t>(LLZXStat::Count)> counters{};
+	LLZXLatencySnapshot getLatency;
+	LLZXLatencySnapshot putLatency;
+
+	uint64_t operator[](LLZXStat stat) const { return counters[static_cast<size_t>(stat)]; }
+
+	double hitRatio() const
+	{
+		uint64_t lookups = (*this)[LLZXStat::Hit] + (*this)[LLZXStat::Miss];
+		return lookups ? static_cast<double>((*this)[LLZXStat::Hit]) / static_cast<double>(lookups) : 0.0;
+	}
+
+	LLZXCacheStatsSnapshot& operator+=(const LLZXCacheStatsSnapshot& other)
+	{
+		for (size_t i = 0; i < counters.size(); ++i)
+			counters[i] += other.counters[i];
+		getLatency += other.getLatency;
+		putLatency += other.putLatency;
+		return *this;
+	}
+
+	// 导出到监控系统：依次以(名字, 值)调用fn，包括计数器以及get/put延迟的p50/p99/p999（纳秒）
+	template<typename Fn>
+	void forEach(Fn&& fn) const
+	{
+		static const char* const kNames[] = {
+			"hits", "misses", "inserts", "updates", "evictions", "expirations",
+			"admissions", "rejections", "lock_acquires", "lock_contended", "lock_wait_ns",
+		};
+		static_assert(sizeof(kNames) / sizeof(kNames[0]) == static_cast<size_t>(LLZXStat::Count), "missing stat name");
+		for (size_t i = 0; i < counters.size(); ++i)
+			fn(kNames[i], counters[i]);
+		fn("get_count", getLatency.count);
+		fn("get_p50_ns", getLatency.percentile(0.5));
+		fn("get_p99_ns", getLatency.percentile(0.99));
+		fn("get_p999_ns", getLatency.percentile(0.999));
+		fn("put_count", putLatency.count);
+		fn("put_p50_ns", putLatency.percentile(0.5));
+		fn("put_p99_ns", putLatency.percentile(0.99));
+		fn("put_p999_ns", putLatency.percentile(0.999));
+	}
+};
+
+#if LLZX_CACHE_ENABLE_STATS
+
+namespace detail
+{
+
+// 线程第一次记录统计时领取一个条带号，之后固定使用
+inline size_t statsStripe()
+{
+	static std::atomic<size_t> next{0};
+	static thread_local size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+	return stripe;
+}
+
+} // namespace detail
+
+// 并发写入的延迟直方图，relaxed原子计数
+class LLZXLatencyHistogram
+{
+public:
+	void record(uint64_t nanos)
+	{
+		buckets_[LLZXLatencySnapshot::bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+		count_.fetch_add(1, std::memory_order_relaxed);
+		totalNanos_.fetch_add(nanos, std::memory_order_relaxed);
+	}
+
+	void snapshotInto(LLZXLatencySnapshot& snapshot) const
+	{
+		for (size_t i = 0; i < LLZXLatencySnapshot::kBuckets; ++i)
+			snapshot.buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+		snapshot.count += count_.load(std::memory_order_relaxed);
+		snapshot.totalNanos += totalNanos_.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, LLZXLatencySnapshot::kBuckets> buckets_{};
+	alignas(kCacheLineSize) std::atomic<uint64_t> count_{0};
+	std::atomic<uint64_t> totalNanos_{0};
+};
+
+// 析构时把经过的时间记入直方图
+class LLZXLatencyTimer
+{
+public:
+	explicit LLZXLatencyTimer(LLZXLatencyHistogram& histogram)
+		: histogram_(histogram)
+		, start_(std::chrono::steady_clock::now())
+	{}
+
+	~LLZXLatencyTimer()
+	{
+		auto elapsed = std::chrono::steady_clock::now() - start_;
+		histogram_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+
+	LLZXLatencyTimer(const LLZXLatencyTimer&) = delete;
+	LLZXLatencyTimer& operator=(const LLZXLatencyTimer&) = delete;
+
+private:
+	LLZXLatencyHistogram&                 histogram_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+// 每个缓存（分片）一份的统计，计数器按线程分条带，每个条带独占缓存行，
+// 共享锁下并发命中的读者不会集中写同一个原子变量
+class LLZXCacheStats
+{
+public:
+	static constexpr bool kEnabled = true;
+
+	void record(LLZXStat stat, uint64_t n = 1)
+	{
+		stripes_[detail::statsStripe() & (kStripes - 1)].counters[static_cast<size_t>(stat)]
+			.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	LLZXLatencyTimer timeGet() { return LLZXLatencyTimer(getLatency_); }
+	LLZXLatencyTimer timePut() { return LLZXLatencyTimer(putLatency_); }
+
+	// 加锁并记录是否发生竞争以及等待时间
+	template<typename Mutex>
+	std::unique_lock<Mutex> lock(Mutex& mutex)
+	{
+		std::unique_lock<Mutex> guard(mutex, std::try_to_lock);
+		if (!guard.owns_lock())
+		{
+			auto start = std::chrono::steady_clock::now();
+			guard.lock();
+			recordWait(std::chrono::steady_clock::now() - start);
+		}
+		record(LLZXStat::LockAcquire);
+		return guard;
+	}
+
+	template<typename Mutex>
+	std::shared_lock<Mutex> lockShared(Mutex& mutex)
+	{
+		std::shared_lock<Mutex> guard(mutex, std::try_to_lock);
+		if (!guard.owns_lock())
+		{
+			auto start = std::chrono::steady_clock::now();
+			guard.lock();
+			recordWait(std::chrono::steady_clock::now() - start);
+		}
+		record(LLZXStat::LockAcquire);
+		return guard;
+	}
+
+	LLZXCacheStatsSnapshot snapshot() const
+	{
+		LLZXCacheStatsSnapshot result;
+		for (const Stripe& stripe : stripes_)
+			for (size_t i = 0; i < result.counters.size(); ++i)
+				result.counters[i] += stripe.counters[i].load(std::memory_order_relaxed);
+		getLatency_.snapshotInto(result.getLatency);
+		putLatency_.snapshotInto(result.putLatency);
+		return result;
+	}
+
+private:
+	static constexpr size_t kStripes = 8;
+
+	struct alignas(kCacheLineSize) Stripe
+	{
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(LLZXStat::Count)> counters{};
+	};
+
+	void recordWait(std::chrono::steady_clock::duration waited)
+	{
+		record(LLZXStat::LockContended);
+		record(LLZXStat::LockWaitNanos,
+			static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+	}
+
+private:
+	std::array<Stripe, kStripes> stripes_;
+	LLZXLatencyHistogram         getLatency_;
+	LLZXLatencyHistogram         putLatency_;
+};
+
+#else
+
+// 关闭统计时的空实现
+class LLZXCacheStats
+{
+public:
+	static constexpr bool kEnabled = false;
+
+	// 非平凡析构，未使用的计时器变量不会产生警告
+	struct Timer
+	{
+		~Timer() {}
+	};
+
+	void record(LLZXStat, uint64_t = 1) {}
+	Timer timeGet() { return Timer{}; }
+	Timer timePut() { return Timer{}; }
+
+	template<typename Mutex>
+	std::unique_lock<Mutex> lock(Mutex& mutex) { return std::unique_lock<Mutex>(mutex); }
+
+	template<typename Mutex>
+	std::shared_lock<Mutex> lockShared(Mutex& mutex) { return std::shared_lock<Mutex>(mutex); }
+
+	LLZXCacheStatsSnapshot snapshot() const { return LLZXCacheStatsSnapshot{}; }
+};
+
+#endif
+
+} // namespace LLZXCache
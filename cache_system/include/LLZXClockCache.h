@@ -0,0 +1,316 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <vector>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+#include "LLZXShardedCache.h"
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+// CLOCK（二次机会）缓存，近似LRU，面向读远多于写的场景
+//   get只持有共享锁：查索引、读值，然后把该槽位的引用位置1（已经是1时不写），不修改任何链表
+//   引用位单独放在一段连续的字节数组中，一个缓存行覆盖64个槽位，节点本身在读路径上只读
+//   put持有独占锁：没有空槽位时，时钟指针从当前位置扫描，引用位为1的清零并跳过，遇到0的驱逐
+// 代价是命中率比精确LRU略低（只区分“最近一圈内访问过”和“没访问过”）
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXClockCache : public LLZXCachePolicy<Key, Value>
+{
+	struct ClockEntry
+	{
+		Key   key_;
+		Value value_;
+	};
+
+public:
+	using NodeMap = Index;
+	using Duration = LLZXExpiry::Duration;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+private:
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+public:
+	explicit LLZXClockCache(int capacity)
+		: capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+		, referenced_(new std::atomic<uint8_t>[capacity_ > 0 ? capacity_ : 1]())
+	{
+		entries_.reserve(capacity_);
+		nodeMap_.reserve(capacity_);
+	}
+
+	void put(const Key& key, const Value& value) override
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		putLocked(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		putLocked(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		putLocked(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		Value value(std::forward<Args>(args)...);
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		putLocked(key, std::move(value));
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return visit<Key, const Visitor&>(key, visitor);
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		// 共享锁下不能删除，过期的元素只当作未命中，留给之后的写操作回收
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot == kNullSlot || expiry_.expired(slot))
+			return false;
+		markReferenced(slot);
+		fn(entries_[slot].value_);
+		return true;
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 批量读取，order含义同LLZXLruCache::getManyIndexed，整批只加一次共享锁
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (j + kPrefetchDistance < count)
+				nodeMap_.prefetch(keys[order ? order[j + kPrefetchDistance] : j + kPrefetchDistance]);
+			size_t i = order ? order[j] : j;
+			SlotIndex slot = nodeMap_.find(keys[i], keyOf());
+			hits[i] = slot != kNullSlot && !expiry_.expired(slot);
+			if (hits[i])
+			{
+				markReferenced(slot);
+				values[i] = entries_[slot].value_;
+				++hitCount;
+			}
+		}
+		return hitCount;
+	}
+
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t i = order ? order[j] : j;
+			putLocked(keys[i], values[i]);
+		}
+	}
+
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+			removeSlot(slot);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+	// 包括已过期但尚未回收的元素
+	size_t size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return nodeMap_.size();
+	}
+
+	// 回收所有已过期的元素，返回回收个数
+	size_t purgeExpired()
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		return purgeExpiredLocked();
+	}
+
+private:
+	static constexpr size_t kPrefetchDistance = 4;
+
+	struct KeyOfSlot
+	{
+		const std::vector<ClockEntry>* entries;
+		const Key& operator()(SlotIndex slot) const { return (*entries)[slot].key_; }
+	};
+
+	KeyOfSlot keyOf() const { return KeyOfSlot{&entries_}; }
+
+	// 共享锁下可能有多个读者同时设置，用relaxed原子操作；先读一次，已置位时不写，避免无谓地弄脏缓存行
+	void markReferenced(SlotIndex slot) const
+	{
+		if (referenced_[slot].load(std::memory_order_relaxed) == 0)
+			referenced_[slot].store(1, std::memory_order_relaxed);
+	}
+
+	template<typename K, typename V>
+	void putLocked(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return;
+
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+		{
+			entries_[slot].value_ = std::forward<V>(value);
+			markReferenced(slot);
+			expiry_.expireAfter(slot, ttl);
+			return;
+		}
+
+		// 已过期的元素回收为空槽位，优先于时钟扫描被复用
+		if (freeSlots_.empty() && entries_.size() >= capacity_)
+			purgeExpiredLocked();
+
+		if (!freeSlots_.empty())
+		{
+			slot = freeSlots_.back();
+			freeSlots_.pop_back();
+			entries_[slot].key_ = std::forward<K>(key);
+			entries_[slot].value_ = std::forward<V>(value);
+		}
+		else if (entries_.size() < capacity_)
+		{
+			slot = static_cast<SlotIndex>(entries_.size());
+			entries_.push_back(ClockEntry{Key(std::forward<K>(key)), Value(std::forward<V>(value))});
+		}
+		else
+		{
+			slot = sweep();
+			nodeMap_.erase(entries_[slot].key_, keyOf());
+			expiry_.cancel(slot);
+			entries_[slot].key_ = std::forward<K>(key);
+			entries_[slot].value_ = std::forward<V>(value);
+		}
+
+		// 新元素引用位为0，一圈之内没有再被访问就会被驱逐，一次性扫描的数据不会挤掉热点
+		referenced_[slot].store(0, std::memory_order_relaxed);
+		nodeMap_.insert(entries_[slot].key_, slot, keyOf());
+		expiry_.expireAfter(slot, ttl);
+	}
+
+	void removeSlot(SlotIndex slot)
+	{
+		nodeMap_.erase(entries_[slot].key_, keyOf());
+		entries_[slot].key_ = Key{};
+		entries_[slot].value_ = Value{};
+		referenced_[slot].store(0, std::memory_order_relaxed);
+		expiry_.cancel(slot);
+		freeSlots_.push_back(slot);
+	}
+
+	size_t purgeExpiredLocked()
+	{
+		return expiry_.purge([this](SlotIndex slot) { removeSlot(slot); });
+	}
+
+	// 时钟指针扫描，返回被驱逐的槽位；最多扫描两圈（第一圈清零所有引用位）
+	SlotIndex sweep()
+	{
+		for (;;)
+		{
+			SlotIndex slot = static_cast<SlotIndex>(hand_);
+			hand_ = hand_ + 1 == entries_.size() ? 0 : hand_ + 1;
+			if (referenced_[slot].load(std::memory_order_relaxed) == 0)
+				return slot;
+			referenced_[slot].store(0, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	size_t                                     capacity_;
+	size_t                                     hand_ = 0;  // 时钟指针
+	NodeMap                                    nodeMap_;
+	alignas(kCacheLineSize) mutable std::shared_mutex mutex_;
+	std::vector<ClockEntry>                    entries_;
+	std::vector<SlotIndex>                     freeSlots_; // 被删除的槽位，插入时优先复用
+	std::unique_ptr<std::atomic<uint8_t>[]>    referenced_; // 引用位，与entries_一一对应
+	LLZXExpiry                                 expiry_;
+};
+
+//分片CLOCK
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXHashClockCache : public LLZXShardedCache<Key, Value, LLZXClockCache<Key, Value, Index>>
+{
+	using SliceCache = LLZXClockCache<Key, Value, Index>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
+
+public:
+	LLZXHashClockCache(size_t capacity, size_t sliceNum, LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
+	{
+		this->initSlices(sliceNum, [](size_t sliceSize) {
+			return SliceCache(static_cast<int>(sliceSize));
+		});
+	}
+};
+
+} // namespace LLZXCache
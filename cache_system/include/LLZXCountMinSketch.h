@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LLZXNodeIndex.h"
+
+namespace LLZXCache
+{
+
+// 4位计数器的Count-Min Sketch，用来近似统计key的访问频率（参考Caffeine的FrequencySketch）
+// 每个uint64_t存放16个计数器，共4行，每次访问只改动4个计数器；计数上限15
+// 总增加次数达到sampleSize后所有计数器减半（老化），旧的热点会逐渐冷却
+// 占用内存只与构造时的预期元素个数有关，约为每个元素1字节，与实际出现过多少个key无关
+// 不是线程安全的，需要由使用方加锁
+class LLZXCountMinSketch
+{
+public:
+	static constexpr uint32_t kMaxCount = 15;
+
+	explicit LLZXCountMinSketch(size_t expectedItems)
+	{
+		size_t words = detail::roundUpPowerOfTwo(std::max<size_t>(expectedItems / 4, 8));
+		table_.assign(words, 0);
+		tableMask_ = words - 1;
+		sampleSize_ = std::max<size_t>(expectedItems, 1) * 10;
+	}
+
+	// 估计频率：4个计数器中的最小值
+	uint32_t estimate(uint64_t hash) const
+	{
+		uint32_t frequency = kMaxCount;
+		for (uint32_t row = 0; row < kDepth; ++row)
+			frequency = std::min(frequency, counterAt(row, hash));
+		return frequency;
+	}
+
+	// 保守更新：只增加等于当前最小值的计数器，减小hash冲突带来的高估
+	void increment(uint64_t hash)
+	{
+		uint32_t frequency = estimate(hash);
+		if (frequency >= kMaxCount)
+			return;
+
+		for (uint32_t row = 0; row < kDepth; ++row)
+		{
+			if (counterAt(row, hash) == frequency)
+			{
+				size_t index, shift;
+				locate(row, hash, index, shift);
+				table_[index] += uint64_t(1) << shift;
+			}
+		}
+
+		if (++additions_ >= sampleSize_)
+			reset();
+	}
+
+	// 所有计数器减半
+	void reset()
+	{
+		for (auto& word : table_)
+			word = (word >> 1) & 0x7777777777777777ULL;
+		additions_ /= 2;
+	}
+
+	void clear()
+	{
+		std::fill(table_.begin(), table_.end(), 0);
+		additions_ = 0;
+	}
+
+	size_t memoryBytes() const { return table_.size() * sizeof(uint64_t); }
+
+private:
+	static constexpr uint32_t kDepth = 4;
+
+	// 每一行使用不同的种子重新混合hash，得到相互独立的位置
+	void locate(uint32_t row, uint64_t hash, size_t& index, size_t& shift) const
+	{
+		static constexpr uint64_t kSeeds[kDepth] = {
+			0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+		uint64_t h = detail::fmix64(hash + kSeeds[row]);
+		index = static_cast<size_t>(h >> 32) & tableMask_;
+		shift = static_cast<size_t>(h & 15) << 2;
+	}
+
+	uint32_t counterAt(uint32_t row, uint64_t hash) const
+	{
+		size_t index, shift;
+		locate(row, hash, index, shift);
+		return static_cast<uint32_t>((table_[index] >> shift) & 0xF);
+	}
+
+private:
+	std::vector<uint64_t> table_;
+	size_t                tableMask_ = 0;
+	size_t                sampleSize_ = 0;
+	size_t                additions_ = 0;
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,558 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+#include "LLZXReadBuffer.h"
+#include "LLZXShardedCache.h"
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+template<typename Key, typename Value, typename Index> class LLZXLfuCache;
+
+template<typename Key, typename Value>
+class LfuNode
+{
+public:
+	LfuNode(Key key, Value value)
+		: key_(std::move(key))
+		, value_(std::move(value))
+		, bucket_(kNullSlot)
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+	{}
+
+	const Key& getKey() const { return key_; }
+	const Value& getValue() const { return value_; }
+
+	template<typename K, typename V>
+	void reset(K&& key, V&& value)
+	{
+		key_ = std::forward<K>(key);
+		value_ = std::forward<V>(value);
+		bucket_ = kNullSlot;
+	}
+
+private:
+	Key       key_;
+	Value     value_;
+	SlotIndex bucket_; // 所在频率桶的下标，节点的访问频率即桶的频率
+	SlotIndex prev_;   // 同一频率桶内的前后节点
+	SlotIndex next_;
+
+	template<typename, typename, typename> friend class LLZXLfuCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
+};
+
+// 频率桶：同一访问频率的节点串成一个链表，桶之间按频率从小到大串成链表
+// 桶也放在slab中，空桶的槽位回收复用
+template<typename NodeList>
+class LfuBucket
+{
+public:
+	LfuBucket(size_t frequency, NodeList nodes)
+		: frequency_(frequency)
+		, nodes_(nodes)
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+	{}
+
+	void reset(size_t frequency, NodeList nodes)
+	{
+		frequency_ = frequency;
+		nodes_ = nodes;
+	}
+
+private:
+	size_t    frequency_;
+	NodeList  nodes_;  // 头部为桶内最久未访问的节点
+	SlotIndex prev_;
+	SlotIndex next_;
+
+	template<typename, typename, typename> friend class LLZXLfuCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
+};
+
+// O(1) LFU缓存：访问时节点移到频率+1的桶（不存在则在当前桶后面新建），
+// 驱逐时取频率最小的桶（桶链表头部）中最久未访问的节点，插入、命中、驱逐都是O(1)
+// 平均访问频率超过maxAverageNum时，所有频率减去maxAverageNum/2（不低于1），
+// 长期热门但已不再访问的key会逐渐降温，不会一直占住缓存
+// 节点存储和索引与LLZXLruCache相同，Buffered读模式下命中先记录到读缓冲，持有独占锁时再回放频率增加
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXLfuCache : public LLZXCachePolicy<Key, Value>
+{
+public:
+	using LfuNodeType = LfuNode<Key, Value>;
+	using NodeSlab = LLZXNodeSlab<LfuNodeType>;
+	using NodeList = LLZXNodeList<NodeSlab>;
+	using BucketType = LfuBucket<NodeList>;
+	using BucketSlab = LLZXNodeSlab<BucketType>;
+	using BucketList = LLZXNodeList<BucketSlab>;
+	using NodeMap = Index;
+	using Duration = LLZXExpiry::Duration;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+	static constexpr size_t kDefaultMaxAverageNum = 1000000;
+
+private:
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+public:
+	explicit LLZXLfuCache(int capacity, size_t maxAverageNum = kDefaultMaxAverageNum,
+		LLZXReadMode readMode = LLZXReadMode::Exclusive)
+		: capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+		, maxAverageNum_(std::max<size_t>(maxAverageNum, 1))
+		, slab_(capacity_)
+	{
+		nodeMap_.reserve(capacity_);
+		if (readMode != LLZXReadMode::Exclusive)
+			readBuffer_ = std::make_unique<LLZXReadBuffer>();
+	}
+
+	~LLZXLfuCache() override = default;
+
+	void put(const Key& key, const Value& value) override
+	{
+		putImpl(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		putImpl(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		putImpl(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		putImpl(key, Value(std::forward<Args>(args)...));
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return lookup(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return lookup(key, visitor);
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return lookup(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		return lookup(key, std::forward<Fn>(fn));
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 批量读取，order含义同LLZXLruCache::getManyIndexed，整批只加一次锁
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		auto process = [&](auto&& onHit) {
+			for (size_t j = 0; j < count; ++j)
+			{
+				if (j + kPrefetchDistance < count)
+					nodeMap_.prefetch(keys[order ? order[j + kPrefetchDistance] : j + kPrefetchDistance]);
+				size_t i = order ? order[j] : j;
+				SlotIndex slot = nodeMap_.find(keys[i], keyOf());
+				hits[i] = slot != kNullSlot && !expiry_.expired(slot);
+				if (hits[i])
+				{
+					values[i] = slab_[slot].getValue();
+					onHit(slot);
+					++hitCount;
+				}
+			}
+		};
+
+		if (readBuffer_)
+		{
+			bool needDrain = false;
+			{
+				std::shared_lock<std::shared_mutex> lock(mutex_);
+				process([&](SlotIndex slot) { needDrain |= readBuffer_->record(slot); });
+			}
+			if (needDrain)
+			{
+				std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+				if (lock.owns_lock())
+					drainReadBuffer();
+			}
+		}
+		else
+		{
+			std::unique_lock<std::shared_mutex> lock(mutex_);
+			process([this](SlotIndex slot) { increaseFrequency(slot); });
+		}
+		return hitCount;
+	}
+
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		if (capacity_ == 0) return;
+
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		drainReadBuffer();
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t i = order ? order[j] : j;
+			putLocked(keys[i], values[i]);
+		}
+	}
+
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		drainReadBuffer();
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+			removeSlot(slot);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+	// 包括已过期但尚未回收的元素
+	size_t size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return nodeMap_.size();
+	}
+
+	// 回收所有已过期的元素，返回回收个数
+	size_t purgeExpired()
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		drainReadBuffer();
+		return purgeExpiredLocked();
+	}
+
+	// 指定key当前的访问频率，不存在时返回0，不算作一次访问
+	template<typename K, typename = EnableIfLookup<K>>
+	size_t frequency(const K& key)
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		drainReadBuffer();
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		return slot == kNullSlot ? 0 : buckets_[slab_[slot].bucket_].frequency_;
+	}
+
+private:
+	static constexpr size_t kPrefetchDistance = 4;
+
+	struct KeyOfSlot
+	{
+		const NodeSlab* slab;
+		const Key& operator()(SlotIndex slot) const { return (*slab)[slot].getKey(); }
+	};
+
+	KeyOfSlot keyOf() const { return KeyOfSlot{&slab_}; }
+
+	template<typename K, typename V>
+	void putImpl(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return;
+
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		drainReadBuffer();
+		putLocked(std::forward<K>(key), std::forward<V>(value), ttl);
+	}
+
+	template<typename K, typename V>
+	void putLocked(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+		{
+			// 更新也算一次访问
+			slab_[slot].value_ = std::forward<V>(value);
+			increaseFrequency(slot);
+			expiry_.expireAfter(slot, ttl);
+			return;
+		}
+
+		// 先回收已过期的元素，仍然满时才驱逐频率最小的元素
+		if (nodeMap_.size() >= capacity_)
+			purgeExpiredLocked();
+		if (nodeMap_.size() >= capacity_)
+		{
+			// 复用被驱逐节点的槽位
+			slot = evictLeastFrequent();
+			slab_[slot].reset(std::forward<K>(key), std::forward<V>(value));
+		}
+		else
+		{
+			slot = slab_.allocate(std::forward<K>(key), std::forward<V>(value));
+		}
+
+		// 新节点频率为1，放入频率最小的桶
+		SlotIndex bucket = bucketList_.front();
+		if (bucket == kNullSlot || buckets_[bucket].frequency_ != 1)
+			bucket = insertBucketAfter(kNullSlot, 1);
+		buckets_[bucket].nodes_.pushBack(slab_, slot);
+		slab_[slot].bucket_ = bucket;
+		nodeMap_.insert(slab_[slot].getKey(), slot, keyOf());
+		expiry_.expireAfter(slot, ttl);
+		addFrequency(1);
+	}
+
+	template<typename K, typename Fn>
+	bool lookup(const K& key, Fn&& onHit)
+	{
+		if (readBuffer_)
+			return lookupBuffered(key, onHit);
+
+		std::unique_lock<std::shared_mutex> lock(mutex_);
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot == kNullSlot)
+			return false;
+		if (expiry_.expired(slot))
+		{
+			removeSlot(slot);
+			return false;
+		}
+		increaseFrequency(slot);
+		onHit(slab_[slot].getValue());
+		return true;
+	}
+
+	// 共享锁下的读路径，命中的槽位记录到读缓冲，频率在回放时再增加
+	template<typename K, typename Fn>
+	bool lookupBuffered(const K& key, Fn& onHit)
+	{
+		bool needDrain = false;
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_);
+			// 共享锁下不能删除，过期的元素只当作未命中
+			SlotIndex slot = nodeMap_.find(key, keyOf());
+			if (slot == kNullSlot || expiry_.expired(slot))
+				return false;
+			onHit(slab_[slot].getValue());
+			needDrain = readBuffer_->record(slot);
+		}
+
+		if (needDrain)
+		{
+			std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+			if (lock.owns_lock())
+				drainReadBuffer();
+		}
+		return true;
+	}
+
+	void drainReadBuffer()
+	{
+		if (!readBuffer_) return;
+		readBuffer_->drain([this](SlotIndex slot) {
+			if (nodeMap_.find(slab_[slot].getKey(), keyOf()) == slot)
+				increaseFrequency(slot);
+		});
+	}
+
+	// 节点移动到频率+1的桶，调用方需持有独占锁
+	void increaseFrequency(SlotIndex slot)
+	{
+		SlotIndex current = slab_[slot].bucket_;
+		size_t target = buckets_[current].frequency_ + 1;
+		SlotIndex next = buckets_[current].next_;
+		if (next == kNullSlot || buckets_[next].frequency_ != target)
+			next = insertBucketAfter(current, target);
+
+		detachFromBucket(slot);
+		buckets_[next].nodes_.pushBack(slab_, slot);
+		slab_[slot].bucket_ = next;
+		addFrequency(target);
+	}
+
+	// 在after之后插入一个空桶，after为kNullSlot时插入到头部
+	SlotIndex insertBucketAfter(SlotIndex after, size_t frequency)
+	{
+		SlotIndex bucket = buckets_.allocate(frequency, NodeList());
+		SlotIndex next = after == kNullSlot ? bucketList_.front() : buckets_[after].next_;
+		bucketList_.insertBefore(buckets_, next, bucket);
+		return bucket;
+	}
+
+	// 节点从所在桶中摘下，桶变空时回收
+	void detachFromBucket(SlotIndex slot)
+	{
+		SlotIndex bucket = slab_[slot].bucket_;
+		buckets_[bucket].nodes_.unlink(slab_, slot);
+		subtractFrequency(buckets_[bucket].frequency_);
+		if (buckets_[bucket].nodes_.empty())
+		{
+			bucketList_.unlink(buckets_, bucket);
+			buckets_.release(bucket);
+		}
+	}
+
+	// 驱逐频率最小的桶中最久未访问的节点，返回其槽位
+	SlotIndex evictLeastFrequent()
+	{
+		SlotIndex bucket = bucketList_.front();
+		SlotIndex victim = buckets_[bucket].nodes_.front();
+		nodeMap_.erase(slab_[victim].getKey(), keyOf());
+		detachFromBucket(victim);
+		expiry_.cancel(victim);
+		return victim;
+	}
+
+	void removeSlot(SlotIndex slot)
+	{
+		nodeMap_.erase(slab_[slot].getKey(), keyOf());
+		detachFromBucket(slot);
+		expiry_.cancel(slot);
+		releaseSlot(slot);
+	}
+
+	size_t purgeExpiredLocked()
+	{
+		return expiry_.purge([this](SlotIndex slot) { removeSlot(slot); });
+	}
+
+	// key和值随即释放（如std::string的堆缓冲），槽位留给之后的插入复用
+	void releaseSlot(SlotIndex slot)
+	{
+		slab_[slot].key_ = Key{};
+		slab_[slot].value_ = Value{};
+		slab_.release(slot);
+	}
+
+	void addFrequency(size_t frequency)
+	{
+		totalFrequency_ += frequency;
+		if (totalFrequency_ / std::max<size_t>(nodeMap_.size(), 1) > maxAverageNum_)
+			decayFrequencies();
+	}
+
+	void subtractFrequency(size_t frequency)
+	{
+		totalFrequency_ -= frequency;
+	}
+
+	// 所有桶的频率减去maxAverageNum/2，不低于1；桶链表保持有序，降到相同频率的相邻桶合并
+	// 代价是O(元素个数)，但只有平均频率累计增长maxAverageNum/2之后才会发生一次
+	void decayFrequencies()
+	{
+		size_t reduce = std::max<size_t>(maxAverageNum_ / 2, 1);
+		totalFrequency_ = 0;
+		SlotIndex kept = kNullSlot;
+		SlotIndex bucket = bucketList_.front();
+		while (bucket != kNullSlot)
+		{
+			SlotIndex next = buckets_[bucket].next_;
+			size_t& frequency = buckets_[bucket].frequency_;
+			frequency = frequency > reduce ? frequency - reduce : 1;
+			if (kept != kNullSlot && buckets_[kept].frequency_ == frequency)
+			{
+				// 合并进前一个桶，原桶中的节点排在后面
+				NodeList& nodes = buckets_[bucket].nodes_;
+				while (!nodes.empty())
+				{
+					SlotIndex slot = nodes.popFront(slab_);
+					buckets_[kept].nodes_.pushBack(slab_, slot);
+					slab_[slot].bucket_ = kept;
+				}
+				bucketList_.unlink(buckets_, bucket);
+				buckets_.release(bucket);
+			}
+			else
+			{
+				kept = bucket;
+			}
+			bucket = next;
+		}
+
+		for (bucket = bucketList_.front(); bucket != kNullSlot; bucket = buckets_[bucket].next_)
+			totalFrequency_ += buckets_[bucket].frequency_ * buckets_[bucket].nodes_.size();
+	}
+
+private:
+	size_t     capacity_;
+	size_t     maxAverageNum_;      // 平均访问频率上限
+	size_t     totalFrequency_ = 0; // 所有节点的访问频率之和
+	NodeMap    nodeMap_;
+	alignas(kCacheLineSize) mutable std::shared_mutex mutex_;
+	NodeSlab   slab_;
+	BucketSlab buckets_;
+	BucketList bucketList_;          // 频率从小到大
+	std::unique_ptr<LLZXReadBuffer> readBuffer_;
+	LLZXExpiry expiry_;
+};
+
+//分片LFU
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXHashLfuCache : public LLZXShardedCache<Key, Value, LLZXLfuCache<Key, Value, Index>>
+{
+	using SliceCache = LLZXLfuCache<Key, Value, Index>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
+
+public:
+	LLZXHashLfuCache(size_t capacity, size_t sliceNum,
+		size_t maxAverageNum = SliceCache::kDefaultMaxAverageNum,
+		LLZXReadMode readMode = LLZXReadMode::Exclusive,
+		LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
+	{
+		this->initSlices(sliceNum, [maxAverageNum, readMode](size_t sliceSize) {
+			return SliceCache(static_cast<int>(sliceSize), maxAverageNum, readMode);
+		});
+	}
+};
+
+} // namespace LLZXCache
@@ -1,20 +1,45 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "LLZXCachePolicy.h"
+#include "LLZXCacheStats.h"
+#include "LLZXCountMinSketch.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+#include "LLZXReadBuffer.h"
+#include "LLZXReadTable.h"
+#include "LLZXShardedCache.h"
+#include "LLZXSingleFlight.h"
+#include "LLZXSnapshot.h"
+#include "LLZXTimingWheel.h"
+#include "LLZXWeigher.h"
 
 namespace LLZXCache
 {
 
-template<typename Key, typename Value> class LLZXLruCache;
+// Index为 key -> 槽位 的索引实现，可选LLZXStdNodeIndex、LLZXFlatNodeIndex或LLZXInlineKeyIndex，
+// 默认的LLZXDefaultNodeIndex对整数、枚举、指针key选择LLZXInlineKeyIndex，其余选择LLZXStdNodeIndex
+// Allocator为节点slab和索引使用的无状态分配器（任意value_type，内部rebind），
+// 例如memory_pool的LLZXPoolAllocator<char>；key/value自身的内存由它们的类型决定，见LLZXPooledCache.h
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>, typename Allocator = std::allocator<char>>
+class LLZXLruCache;
 
 // 定义LRU缓冲节点，包括一个Key和一个值，然后记录访问次数，初始化时次数为1
+// prev_/next_是节点在slab中的下标，链表操作不涉及引用计数
 template<typename Key, typename Value>
 class LruNode
 {
@@ -22,63 +47,128 @@ private:
 	Key key_;
 	Value value_;
 	size_t accessCount_;	//访问次数
-	std::weak_ptr<LruNode<Key, Value>> prev_;
-	std::shared_ptr<LruNode<Key, Value>> next_;
+	SlotIndex prev_;
+	SlotIndex next_;
+	size_t weight_;	//按权重计容量时该节点的权重，按个数计时为1
 
 public:
 	LruNode(Key key, Value value)
-		: key_(key)
-		, value_(value)
+		: key_(std::move(key))
+		, value_(std::move(value))
 		, accessCount_(1)
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+		, weight_(1)
 	{}
 
 	//节点访问器
-	Key getKey() const {return key_;}
-	Value getValue() const {return value_;}
+	const Key& getKey() const {return key_;}
+	const Value& getValue() const {return value_;}
 	void setValue(const Value& value) {value_ = value;}
+	void setValue(Value&& value) {value_ = std::move(value);}
 	size_t getAccessCount() const{return accessCount_;}
 	void incrementAccessCount() { ++accessCount_; }
 
-	friend class LLZXLruCache<Key, Value>;
+	// 槽位复用时覆盖节点内容
+	template<typename K, typename V>
+	void reset(K&& key, V&& value)
+	{
+		key_ = std::forward<K>(key);
+		value_ = std::forward<V>(value);
+		accessCount_ = 1;
+	}
+
+	template<typename, typename, typename, typename> friend class LLZXLruCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
 };
 
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Index, typename Allocator>
 class LLZXLruCache: public LLZXCachePolicy<Key, Value>
 {
+public:
 	using LruNodeType = LruNode<Key, Value>;
-    using NodePtr = std::shared_ptr<LruNodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+	using NodeSlab = LLZXNodeSlab<LruNodeType, Allocator>;
+	using NodeList = LLZXNodeList<NodeSlab>;
+	using NodeMap = typename detail::RebindIndexAllocator<Index, Allocator>::type;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+	// 计重函数，返回一个元素占用的容量（通常是字节数）
+	using Weigher = std::function<size_t(const Key&, const Value&)>;
+	// 元素因容量不足被驱逐时的回调，在缓存锁内调用，回调中不要再访问同一个缓存
+	using EvictionListener = std::function<void(const Key&, const Value&)>;
+	using Duration = LLZXExpiry::Duration;
+	// 同上，额外传入被驱逐元素的剩余存活时间（没有设置过期时间时为kNever），用于把元素降级到下一级存储
+	using TimedEvictionListener = std::function<void(const Key&, const Value&, Duration)>;
+	// LockFree读模式下读者查询的发布表
+	using ReadTable = LLZXReadTable<Key, Value, typename NodeMap::hasher, typename NodeMap::key_equal>;
+
+private:
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+public:
+	// 按元素个数限制容量
+	explicit LLZXLruCache(int capacity, LLZXReadMode readMode = LLZXReadMode::Exclusive)
+		: capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+		, slab_(capacity_)
+	{
+		nodeMap_.reserve(capacity_);
+		if (readMode != LLZXReadMode::Exclusive)
+			readBuffer_ = std::make_unique<LLZXReadBuffer>();
+		if (readMode == LLZXReadMode::LockFree)
+			readTable_ = std::make_unique<ReadTable>(capacity_);
+	}
+
+	// 按权重限制容量：所有元素weigher(key, value)之和不超过maxWeight，
+	// 插入或更新后从最久未访问端驱逐，直到满足预算；单个元素超过maxWeight时不缓存
+	// 元素个数事先未知，slab按需增长
+	LLZXLruCache(size_t maxWeight, Weigher weigher, LLZXReadMode readMode = LLZXReadMode::Exclusive)
+		: capacity_(maxWeight)
+		, weigher_(weigher ? std::move(weigher) : Weigher(LLZXDefaultWeigher<Key, Value, Index>()))
+	{
+		if (readMode != LLZXReadMode::Exclusive)
+			readBuffer_ = std::make_unique<LLZXReadBuffer>();
+		if (readMode == LLZXReadMode::LockFree)
+			readTable_ = std::make_unique<ReadTable>();
+	}
+
+	~LLZXLruCache() override = default;
 
 	// 添加缓存
-	void put(Key key, Value value) override
+	void put(const Key& key, const Value& value) override
 	{
-		if (capacity_ <= 0) return;
+		putImpl(key, value);
+	}
 
-		std::lock_guard<std::mutex> lock(mutex_);
-		auto it = nodeMap_.find(key);
-		if(it != nodeMap_end()) {
-			updateExistingNode(it->second, value);
-			return;
-		}
+	void put(Key&& key, Value&& value) override
+	{
+		putImpl(std::move(key), std::move(value));
+	}
 
-		addNewNode(key, value);
+	// 带过期时间的添加，过期的元素在之后的插入中先于LRU驱逐被回收
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		putImpl(key, value, ttl);
 	}
 
-	bool get(Key key, Value& value) override
+	// 用args原地构造value，只构造一次并移动进节点，不产生拷贝
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
 	{
-		std::lock_guard<std::mutex> lock(mutex_);
-		auto it = nodeMap_.find(key);
-		if(it !=  nodeMap_.end())
-		{
-			updateExistingNode(it->second, value);
-			value = it->second->getValue();
-			return true;
-		}
-		return false;
+		putImpl(key, Value(std::forward<Args>(args)...));
 	}
 
-	Value get(Key key) override
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return lookup(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	Value get(const Key& key) override
     {
         Value value{};
         // memset(&value, 0, sizeof(value));   // memset 是按字节设置内存的，对于复杂类型（如 string）使用 memset 可能会破坏对象的内部结构
@@ -86,218 +176,1180 @@ class LLZXLruCache: public LLZXCachePolicy<Key, Value>
         return value;
     }
 
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return lookup(key, visitor);
+	}
+
+	// 异构查找：索引的hash和比较器都是透明的时候（如LLZXFlatNodeIndex<std::string, LLZXStringHash, std::equal_to<>>），
+	// 可以直接用string_view等类型查找，不构造临时Key
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return lookup(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	// 模板版本的visit，直接调用传入的可调用对象，没有std::function的类型擦除开销
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		return lookup(key, std::forward<Fn>(fn));
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 批量读取的底层实现：处理keys[order[j]]（order为空时按顺序处理），整批只加一次锁
+	// 每批先预取索引表项，再查出槽位并预取节点，最后统一拷贝值，让多个key的访存并行起来
+	// 分片缓存按分片分组后直接传入分组顺序，避免拷贝key
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		SlotIndex slots[kBatchSize];
+
+		auto processBatches = [&](auto&& onHit) {
+			for (size_t begin = 0; begin < count; begin += kBatchSize)
+			{
+				size_t end = std::min(count, begin + kBatchSize);
+				for (size_t j = begin; j < end; ++j)
+					nodeMap_.prefetch(keys[order ? order[j] : j]);
+				for (size_t j = begin; j < end; ++j)
+				{
+					SlotIndex slot = nodeMap_.find(keys[order ? order[j] : j], keyOf());
+					slots[j - begin] = slot;
+					if (slot != kNullSlot)
+						detail::prefetch(&slab_[slot]);
+				}
+				for (size_t j = begin; j < end; ++j)
+				{
+					size_t i = order ? order[j] : j;
+					SlotIndex slot = slots[j - begin];
+					hits[i] = slot != kNullSlot && !expiry_.expired(slot);
+					if (hits[i])
+					{
+						values[i] = slab_[slot].getValue();
+						onHit(slot);
+						++hitCount;
+					}
+				}
+			}
+		};
+
+		if (readBuffer_)
+		{
+			bool needDrain = false;
+			{
+				auto lock = stats_.lockShared(mutex_);
+				processBatches([&](SlotIndex slot) { needDrain |= readBuffer_->record(slot); });
+			}
+			if (needDrain)
+			{
+				std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+				if (lock.owns_lock())
+					drainReadBuffer();
+			}
+		}
+		else
+		{
+			auto lock = stats_.lock(mutex_);
+			processBatches([this](SlotIndex slot) { moveToMostRecent(slot); });
+		}
+		stats_.record(LLZXStat::Hit, hitCount);
+		noteMiss(count - hitCount);
+		return hitCount;
+	}
+
+	// 批量写入的底层实现，order含义同getManyIndexed
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		if (capacity_ == 0) return;
+
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (j + kPrefetchDistance < count)
+				nodeMap_.prefetch(keys[order ? order[j + kPrefetchDistance] : j + kPrefetchDistance]);
+			size_t i = order ? order[j] : j;
+			putLocked(keys[i], values[i]);
+		}
+	}
+
+	// 当前缓存的元素个数，包括已过期但尚未回收的元素
+	size_t size() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return nodeMap_.size();
+	}
+
+	// 当前已使用的容量，按个数计时等于size()
+	size_t weight() const
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		return totalWeight_;
+	}
+
+	// 当前生效的容量，缩小的过程中逐步降到目标值
+	size_t capacity() const { return capacity_; }
+
+	// 累计未命中次数，与LLZX_CACHE_ENABLE_STATS无关，分片缓存据此在分片之间重新分配容量
+	uint64_t missCount() const { return misses_.load(std::memory_order_relaxed); }
+
+	// 在线调整容量（按个数计时为元素个数，按权重计时为权重上限）
+	// 扩大立即生效，slab按需增长；缩小时容量每批只下调kShrinkBatch个元素，批与批之间释放锁，
+	// 读写不会被长时间阻塞，期间的插入也只需要为自己驱逐；之后的setCapacity会中止尚未完成的缩小
+	// 被驱逐元素的key和值随即释放，节点槽位留在slab中供之后的插入复用；
+	// 缩小完成后存活的元素不到槽位数的1/kCompactRatio时整理slab和索引，把不再需要的槽位还给分配器
+	void setCapacity(size_t capacity)
+	{
+		auto lock = stats_.lock(mutex_);
+		uint64_t generation = ++resizeGeneration_;
+		if (capacity >= totalWeight_ || capacity >= capacity_)
+		{
+			capacity_ = capacity;
+			return;
+		}
+
+		while (true)
+		{
+			drainReadBuffer();
+			purgeExpiredLocked();
+			for (size_t n = 0; n < kShrinkBatch && totalWeight_ > capacity && !list_.empty(); ++n)
+				releaseSlot(evictLeastRecent());
+			capacity_ = std::max(capacity, totalWeight_);
+			if (capacity_ == capacity)
+			{
+				if (slab_.slotCount() > kCompactMinSlots && list_.size() < slab_.slotCount() / kCompactRatio)
+					compactLocked();
+				return;
+			}
+
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+			if (resizeGeneration_ != generation)
+				return;
+		}
+	}
+
+	// 统计快照，编译时未打开LLZX_CACHE_ENABLE_STATS时全为0
+	LLZXCacheStatsSnapshot stats() const { return stats_.snapshot(); }
+
+	void setEvictionListener(EvictionListener listener)
+	{
+		if (!listener)
+		{
+			setEvictionListener(TimedEvictionListener());
+			return;
+		}
+		setEvictionListener(TimedEvictionListener(
+			[listener = std::move(listener)](const Key& key, const Value& value, Duration) { listener(key, value); }));
+	}
+
+	void setEvictionListener(TimedEvictionListener listener)
+	{
+		auto lock = stats_.lock(mutex_);
+		evictionListener_ = std::move(listener);
+	}
+
+	// key不存在（或已过期）时才写入，返回是否写入；用于回填从其他地方读到的值，不覆盖并发写入的新值
+	bool putIfAbsent(const Key& key, const Value& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return false;
+
+		auto timer = stats_.timePut();
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		if (findLocked(key) != kNullSlot)
+			return false;
+		putLocked(key, value, ttl);
+		return true;
+	}
+
+	// 非阻塞读取：拿不到锁时立即返回Contended而不等待，命中时把值拷贝到value
+	// 供事件循环线程先试一次，拿不到锁再把阻塞的操作交给其他线程（见LLZXAsyncCache）
+	template<typename K, typename = EnableIfLookup<K>>
+	LLZXTryResult tryGet(const K& key, Value& value)
+	{
+		auto onHit = [&value](const Value& found) { value = found; };
+		bool hit = false;
+		if (readTable_)
+			hit = lookupLockFree(key, onHit);
+		else if (readBuffer_)
+		{
+			std::shared_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+			if (!lock.owns_lock())
+				return LLZXTryResult::Contended;
+			hit = lookupBuffered(key, onHit, std::move(lock));
+		}
+		else
+		{
+			std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+			if (!lock.owns_lock())
+				return LLZXTryResult::Contended;
+			hit = lookupExclusive(key, onHit, std::move(lock));
+		}
+		return hit ? LLZXTryResult::Hit : LLZXTryResult::Miss;
+	}
+
+	// 非阻塞写入：拿不到锁时返回false，什么也不做
+	bool tryPut(const Key& key, const Value& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return true;
+
+		std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+		if (!lock.owns_lock())
+			return false;
+		drainReadBuffer();
+		putLocked(key, value, ttl);
+		return true;
+	}
+
+	// 回收所有已过期的元素，返回回收个数；插入时会自动回收，长时间没有写入时可由LLZXExpiryReaper定期调用
+	size_t purgeExpired()
+	{
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		return purgeExpiredLocked();
+	}
+
+	// 读取，未命中时调用loader(key)加载并写入缓存（ttl为kNever时不过期）
+	// 同一个key的并发未命中只调用一次loader，其余调用方等待同一个结果；加载期间不持有缓存锁
+	// loader抛出的异常传给所有等待者，结果不写入缓存
+	template<typename Loader>
+	Value getOrLoad(const Key& key, Loader&& loader, Duration ttl = LLZXExpiry::kNever)
+	{
+		Value value{};
+		if (this->get(key, value))
+			return value;
+		auto ticket = loads_.join(key);
+		if (!ticket.leader)
+			return ticket.future.get();
+		return runLoad(key, loader, ttl);
+	}
+
+	// 异步版本：命中时返回已就绪的future，否则由executor(std::function<void()>)执行加载
+	// 并发的未命中共享同一个future；默认每次加载起一个分离线程，此时缓存必须比未完成的加载活得更久
+	template<typename Loader, typename Executor = LLZXDetachedExecutor>
+	std::shared_future<Value> getOrLoadAsync(const Key& key, Loader loader,
+		Executor&& executor = Executor(), Duration ttl = LLZXExpiry::kNever)
+	{
+		Value value{};
+		if (this->get(key, value))
+		{
+			std::promise<Value> ready;
+			ready.set_value(std::move(value));
+			return ready.get_future().share();
+		}
+		auto ticket = loads_.join(key);
+		if (!ticket.leader)
+			return ticket.future;
+		try
+		{
+			executor(std::function<void()>([this, key, loader, ttl]() mutable {
+				// 异常已经通过future交给调用方
+				try { runLoad(key, loader, ttl); } catch (...) {}
+			}));
+		}
+		catch (...)
+		{
+			loads_.fail(key, std::current_exception());
+		}
+		return ticket.future;
+	}
+
+	// 批量读取，未命中且没有其他调用方在加载的key一次性交给loader(const std::vector<Key>&)，
+	// loader按相同顺序返回std::vector<Value>；返回直接命中缓存的个数
+	template<typename BatchLoader>
+	size_t getOrLoadMany(const Key* keys, size_t count, Value* values, BatchLoader&& loader,
+		Duration ttl = LLZXExpiry::kNever)
+	{
+		return detail::singleFlightLoadMany(keys, count, values,
+			[this](const Key&) -> LLZXLruCache& { return *this; }, loader, ttl);
+	}
+
+	// 以下三个接口是getOrLoad的组成部分，供分片缓存组合批量加载使用
+	typename LLZXSingleFlight<Key, Value>::Ticket joinLoad(const Key& key)
+	{
+		return loads_.join(key);
+	}
+
+	// 先写入缓存再唤醒等待者，之后到达的调用方直接命中
+	void completeLoad(const Key& key, const Value& value, Duration ttl)
+	{
+		storeLoaded(key, value, ttl);
+		loads_.complete(key, value);
+	}
+
+	void failLoad(const Key& key, std::exception_ptr error)
+	{
+		loads_.fail(key, error);
+	}
+
+	// 把缓存内容按从最久未访问到最近访问的顺序保存到path（格式见LLZXSnapshot.h），用于重启后预热；
+	// 已过期的元素不保存，剩余存活时间一并保存
+	template<typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>>
+	void saveSnapshot(const std::string& path)
+	{
+		detail::writeSnapshot(path, 1, [this](size_t, LLZXSnapshotOutput& out) {
+			return encodeSnapshot<KeySerializer, ValueSerializer>(out);
+		});
+	}
+
+	// 从快照恢复，通常在启动后、开始服务之前调用，返回恢复的元素个数
+	// 文件通过mmap读取，不整体读入堆内存；恢复的元素直接进入主缓存，LLZXLruKCache中不经过访问历史
+	template<typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>>
+	size_t loadSnapshot(const std::string& path, size_t threadNum = 0)
+	{
+		return detail::readSnapshot<KeySerializer, ValueSerializer, Key, Value>(path, threadNum, restoreLimit(),
+			[this](size_t, LLZXSnapshotEntry<Key, Value>* entries, size_t count) {
+				restoreManyIndexed(entries, nullptr, count);
+			});
+	}
+
+	// 以下两个接口是快照的组成部分，供分片缓存逐个分片保存和恢复
+	// 编码期间持有独占锁，分片越小，对正在服务的请求影响越小
+	template<typename KeySerializer, typename ValueSerializer>
+	size_t encodeSnapshot(LLZXSnapshotOutput& out)
+	{
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		size_t count = 0;
+		for (SlotIndex slot = list_.front(); slot != kNullSlot; slot = slab_[slot].next_)
+		{
+			if (expiry_.expired(slot))
+				continue;
+			detail::writeSnapshotTtl(out, expiry_.remaining(slot));
+			KeySerializer::write(out, slab_[slot].getKey());
+			ValueSerializer::write(out, slab_[slot].getValue());
+			++count;
+		}
+		return count;
+	}
+
+	// 最多能容纳的元素个数，按权重计容量时事先无法知道，返回SIZE_MAX
+	size_t restoreLimit() const { return weigher_ ? SIZE_MAX : capacity_.load(); }
+
+	// 按顺序插入entries[order[j]]（order为空时按顺序），整批只加一次锁，元素被移动进缓存
+	void restoreManyIndexed(LLZXSnapshotEntry<Key, Value>* entries, const uint32_t* order, size_t count)
+	{
+		if (capacity_ == 0) return;
+
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		for (size_t j = 0; j < count; ++j)
+		{
+			auto& entry = entries[order ? order[j] : j];
+			putLocked(std::move(entry.key), std::move(entry.value), entry.ttl);
+		}
+	}
+
+
 	// 删除指定元素
-	void remove(Key key)
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if(slot != kNullSlot)
+			removeSlot(slot);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+private:
+	// 经过虚函数读写，LLZXLruKCache的加载结果同样经过访问历史
+	void storeLoaded(const Key& key, const Value& value, Duration ttl)
+	{
+		if (ttl == LLZXExpiry::kNever)
+			this->put(key, value);
+		else
+			this->put(key, value, ttl);
+	}
+
+	// 只读取值，不调整LRU顺序，也不计入命中统计
+	bool peek(const Key& key, Value& value)
+	{
+		auto lock = stats_.lock(mutex_);
+		SlotIndex slot = findLocked(key);
+		if (slot == kNullSlot)
+			return false;
+		value = slab_[slot].getValue();
+		return true;
+	}
+
+	template<typename Loader>
+	Value runLoad(const Key& key, Loader& loader, Duration ttl)
+	{
+		try
+		{
+			// 上一次加载可能在本次未命中之后、登记之前刚刚完成，再查一次主缓存（不记录访问）
+			Value value{};
+			if (!peek(key, value))
+			{
+				value = loader(key);
+				storeLoaded(key, value, ttl);
+			}
+			loads_.complete(key, value);
+			return value;
+		}
+		catch (...)
+		{
+			loads_.fail(key, std::current_exception());
+			throw;
+		}
+	}
+
+protected:
+	// 以下接口供LLZXLruKCache在一把锁内组合主缓存和访问历史的操作，调用方需持有独占锁
+	template<typename, typename, typename, typename> friend class LLZXLruKCache;
+
+	std::shared_mutex& mutex() const { return mutex_; }
+	LLZXCacheStats& statCounters() const { return stats_; }
+
+	void noteMiss(size_t count = 1)
+	{
+		stats_.record(LLZXStat::Miss, count);
+		if (count > 0)
+			misses_.fetch_add(count, std::memory_order_relaxed);
+	}
+	bool hasCapacity() const { return capacity_ > 0; }
+
+	// 已过期的元素在这里顺手回收，视为不存在
+	template<typename K>
+	SlotIndex findLocked(const K& key)
+	{
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot && expiry_.expired(slot))
+		{
+			removeSlot(slot);
+			stats_.record(LLZXStat::Expiration);
+			return kNullSlot;
+		}
+		return slot;
+	}
+
+	void touchLocked(SlotIndex slot) { moveToMostRecent(slot); }
+	Value& valueAtLocked(SlotIndex slot) { return slab_[slot].value_; }
+	void removeLocked(SlotIndex slot) { removeSlot(slot); }
+
+	// 插入或更新，调用方需持有独占锁；ttl为kNever时不过期（同时清除原有的过期时间）
+	template<typename K, typename V>
+	void putLocked(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
 	{
-		std::lock_guard<std::mutex> lock(mutex_);
-		auto it = nodeMap_.find(key);
-		if(it != nodeMap_.end())
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if(slot != kNullSlot)
 		{
-			removeNode(it->second);
-            nodeMap_.erase(it);
+			stats_.record(LLZXStat::Update);
+			slot = updateExistingNode(slot, std::forward<V>(value));
+		}
+		else
+		{
+			stats_.record(LLZXStat::Insert);
+			slot = addNewNode(std::forward<K>(key), std::forward<V>(value));
+		}
+
+		if (slot != kNullSlot)
+		{
+			expiry_.expireAfter(slot, ttl);
+			publish(slot);
 		}
 	}
+
 private:
-	void initializeList()
+	// 扁平索引不保存key，通过槽位回到节点上取key做比较
+	struct KeyOfSlot
 	{
-		//创建首尾虚拟节点
-		dummyHead_ = std::make_shared<LruNodeType>(Key(), Value());
-		dummyTail_ = std::make_shared<LruNodeType>(Key(), Value());
-		dummyHead_->next_ = dummyTail_;
-		dummyTail_->next_ = dummyHead_;
+		const NodeSlab* slab;
+		const Key& operator()(SlotIndex slot) const { return (*slab)[slot].getKey(); }
+	};
+
+	KeyOfSlot keyOf() const { return KeyOfSlot{&slab_}; }
+
+	static constexpr size_t kBatchSize = 16;
+	static constexpr size_t kPrefetchDistance = 4;
+	static constexpr size_t kShrinkBatch = 256; // 在线缩小时每次持锁最多驱逐的元素个数
+	static constexpr size_t kCompactRatio = 4;     // 存活元素少于槽位数的1/4时整理slab
+	static constexpr size_t kCompactMinSlots = 1024; // 槽位数不多时不值得整理
+
+	template<typename K, typename V>
+	void putImpl(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return;
+
+		auto timer = stats_.timePut();
+		auto lock = stats_.lock(mutex_);
+		drainReadBuffer();
+		putLocked(std::forward<K>(key), std::forward<V>(value), ttl);
+	}
+
+	// 命中时以const引用把值交给onHit，在锁内调用
+	template<typename K, typename Fn>
+	bool lookup(const K& key, Fn&& onHit)
+	{
+		auto timer = stats_.timeGet();
+		if (readTable_)
+			return lookupLockFree(key, onHit);
+		if (readBuffer_)
+			return lookupBuffered(key, onHit, stats_.lockShared(mutex_));
+		return lookupExclusive(key, onHit, stats_.lock(mutex_));
 	}
 
-	void updateExistingNode(NodePtr node, const Value& value)
+	// 持有独占锁的读路径：命中时立即调整链表
+	template<typename K, typename Fn>
+	bool lookupExclusive(const K& key, Fn& onHit, std::unique_lock<std::shared_mutex>)
 	{
-		node->setValue(value);
-		moveToMostRecent(node);
+		SlotIndex slot = findLocked(key);
+		if(slot != kNullSlot)
+		{
+			moveToMostRecent(slot);
+			onHit(slab_[slot].getValue());
+			stats_.record(LLZXStat::Hit);
+			return true;
+		}
+		noteMiss();
+		return false;
 	}
-	
-	void addNewNode(const Key& key, const Value& value)
+
+	// 共享锁下的读路径：只读索引和节点值，命中的槽位记录到读缓冲，不修改链表
+	template<typename K, typename Fn>
+	bool lookupBuffered(const K& key, Fn& onHit, std::shared_lock<std::shared_mutex> lock)
 	{
-		if(nodeMap_.size() >= capacity_)
+		// 共享锁下不能删除，过期的元素只当作未命中，留给之后的写操作回收
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot == kNullSlot || expiry_.expired(slot))
 		{
-			//大于容量,驱逐
-			evictLeastRecent();
+			noteMiss();
+			return false;
 		}
+		onHit(slab_[slot].getValue());
+		stats_.record(LLZXStat::Hit);
+		bool needDrain = readBuffer_->record(slot);
+		lock.unlock();
 
-		NodePtr newNode = std::make_shared<LruNodeType>(key, value);
-		insertNode(newNode);
-		nodeMap_[key] = newNode;
+		if (needDrain)
+			tryDrainReadBuffer();
+		return true;
 	}
 
-	// 移动节点到最新位置
-	void moveToMostRecent(NodePtr node) {
-		removeNode(node);
-		insertNode(node);
+	// 无锁读路径：在epoch临界区内查发布表，读到的表项在退出临界区之前不会被释放
+	template<typename K, typename Fn>
+	bool lookupLockFree(const K& key, Fn& onHit)
+	{
+		bool needDrain = false;
+		{
+			LLZXCommon::LLZXEpochGuard guard;
+			const auto* entry = readTable_->find(key);
+			// 过期的元素只当作未命中，留给之后的写操作回收
+			if (!entry || entry->expired())
+			{
+				noteMiss();
+				return false;
+			}
+			onHit(entry->value);
+			stats_.record(LLZXStat::Hit);
+			needDrain = readBuffer_->record(entry->slot);
+		}
+
+		if (needDrain)
+			tryDrainReadBuffer();
+		return true;
+	}
+
+	// 缓冲快满时顺手回放，拿不到锁说明有写者，交给写者回放
+	void tryDrainReadBuffer()
+	{
+		std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+		if (lock.owns_lock())
+			drainReadBuffer();
+	}
+
+	// 把节点当前的值和过期时间发布给无锁读者，调用方需持有独占锁
+	void publish(SlotIndex slot)
+	{
+		if (!readTable_) return;
+		Duration remaining = expiry_.remaining(slot);
+		auto deadline = remaining == LLZXExpiry::kNever ? ReadTable::Clock::time_point::max() : ReadTable::Clock::now() + remaining;
+		readTable_->publish(slab_[slot].getKey(), slab_[slot].getValue(), slot, deadline);
+	}
+
+	// 把读缓冲中记录的命中回放到链表上，调用方需持有独占锁
+	void drainReadBuffer()
+	{
+		if (!readBuffer_) return;
+		readBuffer_->drain([this](SlotIndex slot) {
+			// 记录之后槽位可能已被删除、复用或因整理而不复存在，只回放仍然有效的槽位
+			if (slot < slab_.slotCount() && nodeMap_.find(slab_[slot].getKey(), keyOf()) == slot)
+				moveToMostRecent(slot);
+		});
+	}
+
+	// 按个数计容量时不调用weigher，每个元素权重为1
+	size_t weigh(const Key& key, const Value& value) const
+	{
+		return weigher_ ? weigher_(key, value) : 1;
+	}
+
+	// 返回更新后的槽位，新值超过总预算而不再缓存时返回kNullSlot
+	template<typename V>
+	SlotIndex updateExistingNode(SlotIndex slot, V&& value)
+	{
+		LruNodeType& node = slab_[slot];
+		if (weigher_)
+		{
+			size_t weight = weigh(node.getKey(), value);
+			if (weight > capacity_)
+			{
+				// 新值本身就超过了总预算，不再缓存这个key
+				removeSlot(slot);
+				return kNullSlot;
+			}
+			totalWeight_ = totalWeight_ - node.weight_ + weight;
+			node.weight_ = weight;
+		}
+		node.setValue(std::forward<V>(value));
+		moveToMostRecent(slot);
+
+		// 值变大后可能超出预算，刚更新的节点在最新端，不会被驱逐
+		while (totalWeight_ > capacity_)
+			releaseSlot(evictLeastRecent());
+		return slot;
 	}
 
-	void removeNode(NodePtr node) 
+	// 返回新节点的槽位，单个元素超过总预算而不缓存时返回kNullSlot
+	template<typename K, typename V>
+	SlotIndex addNewNode(K&& key, V&& value)
 	{
-		/*
-		expired() 方法返回一个布尔值：
-		true：表示 weak_ptr 指向的对象已经被销毁（引用计数为0）
-		false：表示 weak_ptr 指向的对象仍然存在
-		*/
-		if(!node->prev_.expired() && node->next_)
+		size_t weight = weigh(key, value);
+		if (weight > capacity_) return kNullSlot;
+
+		// 先回收已过期的元素，腾出的容量不需要再驱逐仍然有效的元素
+		if (totalWeight_ + weight > capacity_)
+			purgeExpiredLocked();
+
+		//大于容量,驱逐，第一个被驱逐节点的槽位直接给新节点复用
+		SlotIndex slot = kNullSlot;
+		while (totalWeight_ + weight > capacity_ && !list_.empty())
 		{
-			auto prev = node->prev_.lock();
-			prev->next_ = node->next_;
-			node->next_->prev_ = prev;
-			node->next_ = nullptr;// 清空next_指针，彻底断开连接
+			SlotIndex victim = evictLeastRecent();
+			if (slot == kNullSlot)
+				slot = victim;
+			else
+				releaseSlot(victim);
 		}
+
+		if (slot != kNullSlot)
+			slab_[slot].reset(std::forward<K>(key), std::forward<V>(value));
+		else
+			slot = slab_.allocate(std::forward<K>(key), std::forward<V>(value));
+
+		slab_[slot].weight_ = weight;
+		totalWeight_ += weight;
+		insertNode(slot);
+		// key已经移动进节点，索引使用节点中的key
+		nodeMap_.insert(slab_[slot].getKey(), slot, keyOf());
+		return slot;
+	}
+
+	size_t purgeExpiredLocked()
+	{
+		size_t purged = expiry_.purge([this](SlotIndex slot) { removeSlot(slot); });
+		stats_.record(LLZXStat::Expiration, purged);
+		return purged;
+	}
+
+	// 从索引和链表中摘除节点并归还槽位
+	void removeSlot(SlotIndex slot)
+	{
+		nodeMap_.erase(slab_[slot].getKey(), keyOf());
+		if (readTable_)
+			readTable_->unpublish(slab_[slot].getKey());
+		removeNode(slot);
+		totalWeight_ -= slab_[slot].weight_;
+		expiry_.cancel(slot);
+		releaseSlot(slot);
+	}
+
+	// 释放key和值占用的资源，槽位留给下一次插入
+	void releaseSlot(SlotIndex slot)
+	{
+		slab_[slot].key_ = Key{};
+		slab_[slot].value_ = Value{};
+		slab_.release(slot);
+	}
+
+	// 把存活的节点按从旧到新的顺序搬进一个大小正好的新slab，重建索引、过期时间和发布表，
+	// 旧slab和旧索引整体释放；调用方持有独占锁并已回放读缓冲，读缓冲中之后出现的旧槽位在回放时被过滤掉
+	void compactLocked()
+	{
+		std::vector<Duration> remaining;
+		remaining.reserve(list_.size());
+		NodeSlab slab(list_.size());
+		NodeList list;
+		for (SlotIndex slot = list_.front(); slot != kNullSlot; slot = slab_[slot].next_)
+		{
+			LruNodeType& node = slab_[slot];
+			remaining.push_back(expiry_.remaining(slot));
+			expiry_.cancel(slot);
+			SlotIndex moved = slab.allocate(std::move(node.key_), std::move(node.value_));
+			slab[moved].accessCount_ = node.accessCount_;
+			slab[moved].weight_ = node.weight_;
+			list.pushBack(slab, moved);
+		}
+
+		slab_ = std::move(slab);
+		list_ = list;
+		nodeMap_ = NodeMap();
+		nodeMap_.reserve(list_.size());
+		for (SlotIndex slot = 0; slot < slab_.slotCount(); ++slot)
+		{
+			nodeMap_.insert(slab_[slot].getKey(), slot, keyOf());
+			if (remaining[slot] != LLZXExpiry::kNever)
+				expiry_.expireAfter(slot, remaining[slot]);
+			publish(slot);
+		}
+	}
+
+	// 移动节点到最新位置
+	void moveToMostRecent(SlotIndex slot)
+	{
+		list_.moveToBack(slab_, slot);
+	}
+
+	void removeNode(SlotIndex slot)
+	{
+		list_.unlink(slab_, slot);
 	}
 
 	// 从尾部插入
-	void insertNode(NodePtr node) {
-		node->next_ = dummyTail_;
-		node->prev_ = dummyTail_->prev_;
-		dummyTail_->prev_.lock()->next_= node;
-		dummyTail_->prev_ = node;
-		//weak_ptr 不能直接访问成员，需要先调用 lock() 获取对应的 shared_ptr，如果 lock() 返回空，说明对象已被销毁
+	void insertNode(SlotIndex slot)
+	{
+		list_.pushBack(slab_, slot);
 	}
-	// 驱逐最近最少访问
-	void evictLeastRecent()
+
+	// 驱逐最近最少访问，返回被驱逐节点的槽位
+	SlotIndex evictLeastRecent()
 	{
-		NodePtr leastRecent = dummyHead_->next_;
-		removeNode(leastRecent);
-		nodeMap_.erase(leastRecent->getKey());
+		SlotIndex leastRecent = list_.popFront(slab_);
+		const LruNodeType& node = slab_[leastRecent];
+		nodeMap_.erase(node.getKey(), keyOf());
+		if (readTable_)
+			readTable_->unpublish(node.getKey());
+		totalWeight_ -= node.weight_;
+		Duration remaining = evictionListener_ ? expiry_.remaining(leastRecent) : LLZXExpiry::kNever;
+		expiry_.cancel(leastRecent);
+		stats_.record(LLZXStat::Eviction);
+		if (evictionListener_)
+			evictionListener_(node.getKey(), node.getValue(), remaining);
+		return leastRecent;
 	}
 
-//可以优化成使用list链表，更加现代
 private:
-    int           capacity_; // 缓存容量
-    NodeMap       nodeMap_; // key -> Node 
-    std::mutex    mutex_;
-    NodePtr       dummyHead_; // 虚拟头结点
-    NodePtr       dummyTail_;
+    std::atomic<size_t> capacity_; // 缓存容量：按个数计时为元素个数，按权重计时为权重上限，可在线调整
+    size_t        totalWeight_ = 0; // 当前已使用的容量
+    Weigher       weigher_;  // 为空时按个数计容量
+    TimedEvictionListener evictionListener_;
+    NodeMap       nodeMap_; // key -> 节点槽位
+    alignas(kCacheLineSize) mutable std::shared_mutex mutex_; // 独占缓存行，分片之间不会因为锁发生伪共享
+    NodeSlab      slab_;    // 节点存储，按容量预分配
+    NodeList      list_;    // 链表头为最久未访问，尾为最近访问
+    std::unique_ptr<LLZXReadBuffer> readBuffer_; // Buffered和LockFree模式下的读缓冲
+    std::unique_ptr<ReadTable> readTable_; // LockFree模式下的发布表
+    LLZXExpiry    expiry_;  // 过期时间，第一次带ttl插入时才创建时间轮
+    LLZXSingleFlight<Key, Value> loads_; // 正在进行的getOrLoad加载
+    mutable LLZXCacheStats stats_; // 命中、驱逐、锁等待等统计
+    std::atomic<uint64_t> misses_{0}; // 累计未命中次数
+    uint64_t      resizeGeneration_ = 0; // 每次setCapacity加一，用于中止过时的缩小
+};
+
+// LRU-K的访问历史记录方式
+//   Exact:  用一个LRU记录最近historyCapacity个key的精确访问次数，并暂存它们最近一次put的值，
+//           历史被淘汰时暂存的值一起释放，内存上限由historyCapacity决定
+//   Sketch: 用Count-Min Sketch近似统计访问次数，只保存计数不保存key和值，
+//           每个被跟踪的key固定约1字节；未达到k次的put直接丢弃值，由第k次put写入主缓存
+//           计数器上限为15，k大于15时按15处理
+enum class LLZXHistoryMode
+{
+	Exact,
+	Sketch,
 };
 
 // LRU优化：Lru-k版本，通过继承的方式进行再优化
-template<typename Key, typename Value>
-class LLZXLruKCache : public LLZXLruCache<Key, Value>
+// 主缓存和访问历史共用基类的一把锁，一次get/put只有一个临界区
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>, typename Allocator = std::allocator<char>>
+class LLZXLruKCache : public LLZXLruCache<Key, Value, Index, Allocator>
 {
+	using BaseCache = LLZXLruCache<Key, Value, Index, Allocator>;
+
+	using Clock = LLZXExpiry::Clock;
+	using Duration = LLZXExpiry::Duration;
+
+	// Exact模式的历史记录：访问次数，以及最近一次put但尚未进入主缓存的值和它的到期时刻
+	struct HistoryEntry
+	{
+		size_t            count = 0;
+		Value             value{};
+		bool              hasValue = false;
+		Clock::time_point expiresAt = Clock::time_point::max();
+	};
+	using HistoryCache = LLZXLruCache<Key, HistoryEntry, Index, Allocator>;
+
 public:
-	LLZXLruKCache(int capacity, int historyCapacity, int k)
-		: LLZXLruCache<Key, Value>(capacity)
-		, historyList_(std::make_unique<LLZXLruCache<Key, size_t>>(historyCapacity))
+	LLZXLruKCache(int capacity, int historyCapacity, int k, LLZXHistoryMode historyMode = LLZXHistoryMode::Exact)
+		: BaseCache(capacity)
 		, k_(k)
-	{}
+	{
+		if (historyMode == LLZXHistoryMode::Sketch)
+		{
+			sketch_ = std::make_unique<LLZXCountMinSketch>(historyCapacity > 0 ? static_cast<size_t>(historyCapacity) : 1);
+			k_ = std::min<int>(k_, LLZXCountMinSketch::kMaxCount);
+		}
+		else
+		{
+			// 暂存的值保存在历史记录节点里，随历史记录一起淘汰，内存上限由historyCapacity决定
+			historyList_ = std::make_unique<HistoryCache>(historyCapacity);
+		}
+	}
 
-	Vaule get(Key key)
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		auto timer = this->statCounters().timeGet();
+		auto lock = this->statCounters().lock(this->mutex());
+		return getWithHistory(key, value);
+	}
+
+	Value get(const Key& key) override
 	{
-		// 首先尝试从主缓存获取数据
 		Value value{};
-		bool inMainCache = LLZXLruCache<Key, Value>::get(key, value);
+		get(key, value);
+		return value; // 未命中时为默认值
+	}
 
-		// 获取并更新访问历史计数
-		size_t historyCount = historyList_->get(key);
-		historyCount++;
-		historyList_->put(key, historyCount);
+	// visit同样记录访问历史，未命中计入k次，达到k次时暂存的值进入主缓存；arena版本的get经由这里
+	bool visit(const Key& key, const typename BaseCache::Visitor& visitor) override
+	{
+		auto timer = this->statCounters().timeGet();
+		auto lock = this->statCounters().lock(this->mutex());
+		return visitWithHistory(key, visitor);
+	}
+
+	// 隐藏基类不经过访问历史的模板visit
+	template<typename Fn>
+	bool visit(const Key& key, Fn&& fn)
+	{
+		auto timer = this->statCounters().timeGet();
+		auto lock = this->statCounters().lock(this->mutex());
+		return visitWithHistory(key, fn);
+	}
+
+	void put(const Key& key, const Value& value) override
+	{
+		auto timer = this->statCounters().timePut();
+		auto lock = this->statCounters().lock(this->mutex());
+		putWithHistory(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		auto timer = this->statCounters().timePut();
+		auto lock = this->statCounters().lock(this->mutex());
+		putWithHistory(std::move(key), std::move(value));
+	}
+
+	// 未达到k次时值连同到期时刻暂存在访问历史中，进入主缓存时只保留剩余的存活时间
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		auto timer = this->statCounters().timePut();
+		auto lock = this->statCounters().lock(this->mutex());
+		putWithHistory(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		Value value(std::forward<Args>(args)...);
+		auto lock = this->statCounters().lock(this->mutex());
+		putWithHistory(key, std::move(value));
+	}
+
+	// 主缓存中没有、访问历史中也没有未过期的暂存值时才写入，写入同样按k次访问决定进入主缓存还是暂存
+	bool putIfAbsent(const Key& key, const Value& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (!this->hasCapacity()) return false;
+
+		auto timer = this->statCounters().timePut();
+		auto lock = this->statCounters().lock(this->mutex());
+		if (this->findLocked(key) != kNullSlot || hasPendingLocked(key))
+			return false;
+		putWithHistory(key, value, ttl);
+		return true;
+	}
 
-		// 如果在主缓存中，直接返回
-		if (inMainCache)
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 非阻塞读写同样经过访问历史：拿不到锁时什么也不记录，返回Contended/false，含义同LLZXLruCache
+	LLZXTryResult tryGet(const Key& key, Value& value)
+	{
+		std::unique_lock<std::shared_mutex> lock(this->mutex(), std::try_to_lock);
+		if (!lock.owns_lock())
+			return LLZXTryResult::Contended;
+		return getWithHistory(key, value) ? LLZXTryResult::Hit : LLZXTryResult::Miss;
+	}
+
+	bool tryPut(const Key& key, const Value& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (!this->hasCapacity()) return true;
+
+		std::unique_lock<std::shared_mutex> lock(this->mutex(), std::try_to_lock);
+		if (!lock.owns_lock())
+			return false;
+		putWithHistory(key, value, ttl);
+		return true;
+	}
+
+	// 批量操作同样经过访问历史，整批只加一次锁
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		auto lock = this->statCounters().lock(this->mutex());
+		for (size_t j = 0; j < count; ++j)
 		{
-			return value;
+			size_t i = order ? order[j] : j;
+			hits[i] = getWithHistory(keys[i], values[i]);
+			hitCount += hits[i];
 		}
+		return hitCount;
+	}
 
-		// 不在，检查是否达到了k次访问
-		if(historyCount >= k_)
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		auto lock = this->statCounters().lock(this->mutex());
+		for (size_t j = 0; j < count; ++j)
 		{
-			auto it = historyValueMap_.find(key);
-			if(it != historyValueMap_.end())
-			{
-				Value storedValue = it->second;
-				historyList_->remove(key);
-				historyValueMap_.erase(it);
+			size_t i = order ? order[j] : j;
+			putWithHistory(keys[i], values[i]);
+		}
+	}
+
+	// 访问历史占用的内存主要部分（不含暂存值本身的堆内存）
+	size_t historyMemoryBytes() const
+	{
+		std::unique_lock<std::shared_mutex> lock(this->mutex());
+		if (sketch_)
+			return sketch_->memoryBytes();
+		return historyList_->size() * sizeof(typename HistoryCache::LruNodeType);
+	}
 
-				LLZXLruCache<Key, Value>::put(key, storedValue);
-				return storedValue;
+private:
+	bool getWithHistory(const Key& key, Value& value)
+	{
+		return visitWithHistory(key, [&value](const Value& found) { value = found; });
+	}
+
+	// 命中（包括这次访问让暂存的值进入主缓存）时在锁内调用fn(值)
+	template<typename Fn>
+	bool visitWithHistory(const Key& key, Fn&& fn)
+	{
+		// 首先尝试从主缓存获取数据，已进入主缓存的key不再记录访问历史
+		LLZXCacheStats& stats = this->statCounters();
+		SlotIndex slot = this->findLocked(key);
+		if (slot != kNullSlot)
+		{
+			this->touchLocked(slot);
+			fn(static_cast<const Value&>(this->valueAtLocked(slot)));
+			stats.record(LLZXStat::Hit);
+			return true;
+		}
+
+		// 获取并更新访问历史计数
+		size_t historyCount = recordAccess(key);
+
+		// 不在，检查是否达到了k次访问；Sketch模式没有暂存值，只能等下一次put写入
+		if (historyList_ && historyCount >= static_cast<size_t>(k_))
+		{
+			SlotIndex history = historyList_->findLocked(key);
+			if (history != kNullSlot && historyList_->valueAtLocked(history).hasValue)
+			{
+				HistoryEntry& entry = historyList_->valueAtLocked(history);
+				Duration ttl = LLZXExpiry::kNever;
+				if (entry.expiresAt != Clock::time_point::max())
+				{
+					ttl = entry.expiresAt - Clock::now();
+					if (ttl <= Duration::zero())
+					{
+						// 暂存的值已经过期，丢弃
+						entry.value = Value{};
+						entry.hasValue = false;
+						this->noteMiss();
+						return false;
+					}
+				}
+				Value pending = std::move(entry.value);
+				historyList_->removeLocked(history);
+				fn(static_cast<const Value&>(pending));
+				BaseCache::putLocked(key, std::move(pending), ttl);
+				stats.record(LLZXStat::Hit);
+				stats.record(LLZXStat::Admission);
+				return true;
 			}
 			//没有找到，返回默认值
 		}
-
-		return value; // 默认值
+		this->noteMiss();
+		return false;
 	}
 
-	void put(Key key, Value value)
+	template<typename K, typename V>
+	void putWithHistory(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
 	{
-		Value exitingValue{};
-		bool inMainCache = LLZXLruCache<Key, Value>::get(key, exitingValue);
-		if(inMainCache)
+		if (!this->hasCapacity()) return;
+
+		if (this->findLocked(key) != kNullSlot)
+		{
+			BaseCache::putLocked(std::forward<K>(key), std::forward<V>(value), ttl);
+			return;
+		}
+
+		size_t historyCount = recordAccess(key);
+		SlotIndex history = historyList_ ? historyList_->findLocked(key) : kNullSlot;
+
+		if (historyCount >= static_cast<size_t>(k_))
 		{
-			LLZXLruCache<Key, Value>::put(key, value);
+			if (history != kNullSlot)
+				historyList_->removeLocked(history);
+			this->statCounters().record(LLZXStat::Admission);
+			BaseCache::putLocked(std::forward<K>(key), std::forward<V>(value), ttl);
 			return;
 		}
 
-		size_t historyCount = historyList_->get(key);
-		historyCount++;
-		historyList_->put(key, historyCount);
+		this->statCounters().record(LLZXStat::Rejection);
+
+		// 保存值到历史记录中，供后续get操作使用；Sketch模式不保存
+		if (history != kNullSlot)
+		{
+			HistoryEntry& entry = historyList_->valueAtLocked(history);
+			entry.value = std::forward<V>(value);
+			entry.hasValue = true;
+			entry.expiresAt = Clock::time_point::max();
+			if (ttl != LLZXExpiry::kNever)
+				entry.expiresAt = ttl < Clock::time_point::max() - Clock::now() ? Clock::now() + ttl : Clock::time_point::max();
+		}
+	}
+
+	// 访问历史中是否有尚未过期的暂存值
+	bool hasPendingLocked(const Key& key)
+	{
+		if (!historyList_) return false;
+		SlotIndex history = historyList_->findLocked(key);
+		if (history == kNullSlot) return false;
+		const HistoryEntry& entry = historyList_->valueAtLocked(history);
+		return entry.hasValue && entry.expiresAt > Clock::now();
+	}
+
+	// 记录一次访问，返回包括本次在内的访问次数
+	size_t recordAccess(const Key& key)
+	{
+		if (sketch_)
+		{
+			uint64_t hash = typename Index::hasher()(key);
+			sketch_->increment(hash);
+			return sketch_->estimate(hash);
+		}
 
-		// 保存值到历史记录映射，供后续get操作使用
-		historyValueMap_[key] = value;
-		
-		if(historyCount >= k_)
+		SlotIndex history = historyList_->findLocked(key);
+		if (history != kNullSlot)
 		{
-			historyList_->remove(key);
-			historyValueMap_.erase(key);
-			LLZXLruCache<Key, Value>::put(key, value);
+			historyList_->touchLocked(history);
+			return ++historyList_->valueAtLocked(history).count;
 		}
+		historyList_->putLocked(key, HistoryEntry{1, Value{}, false});
+		return 1;
 	}
+
 private:
 	int k_;//进入缓存的门槛
-	std::unique_ptr<LLZXLruCache<Key, size_t>> historyList_; // 记录访问历史的缓存
-	std::unordered_map<Key, Value> historyValueMap_; // 记录存储未达到k次访问的数值
+	std::unique_ptr<HistoryCache> historyList_; // Exact模式：记录访问历史的缓存，与主缓存共用一把锁
+	std::unique_ptr<LLZXCountMinSketch> sketch_; // Sketch模式：近似的访问计数
 };
 
 //高并发情况下：分片lru
-template<typename Key, typename Value>
-class LLZXHashLruCache
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>, typename Allocator = std::allocator<char>>
+class LLZXHashLruCache : public LLZXShardedCache<Key, Value, LLZXLruCache<Key, Value, Index, Allocator>>
 {
+	using SliceCache = LLZXLruCache<Key, Value, Index, Allocator>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
+
 public:
-	LLZXHashLruCache(size_t capacity, size_t sliceNum)
-		: capacity_(capacity)
-		, sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-	{
-		size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum));//获得每个分片大小
-		for(int i = 0; i < sliceNum_; ++i)
-		{
-			lruSliceCaches_.emplace_back(std::make_unique<LLZXLruCache<Key, Value>>(sliceSize));//创建切片LRU缓存
-		}
-	}
+	using Weigher = typename SliceCache::Weigher;
 
-	void put(Key key, Value value)
+	LLZXHashLruCache(size_t capacity, size_t sliceNum,
+		LLZXReadMode readMode = LLZXReadMode::Exclusive,
+		LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
 	{
-		// 根据key的hash值选择切片
-		size_t sliceIndex = Hash(key) % sliceNum_;
-		return lruSlieceCaches_[sliceIndex]->put(key, value);
+		this->initSlices(sliceNum, [readMode](size_t sliceSize) {
+			return SliceCache(static_cast<int>(sliceSize), readMode);
+		});
 	}
 
-	bool get(Key key, Value& value)
+	// 按权重限制容量，总权重预算平均分给各个分片
+	LLZXHashLruCache(size_t maxWeight, Weigher weigher, size_t sliceNum,
+		LLZXReadMode readMode = LLZXReadMode::Exclusive,
+		LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(maxWeight, routing)
 	{
-		size_t sliceIndex = Hash(key) % sliceNum_;
-		return lruSliceCaches_[sliceIndex]->get(key, value);
+		this->initSlices(sliceNum, [&weigher, readMode](size_t sliceWeight) {
+			return SliceCache(sliceWeight, weigher, readMode);
+		});
 	}
+};
 
-	Value get(Key key)
-	{
-		Value value;
-		memset(&value, 0, sizeof(value));
-		get(key, value);
-		return value;
-	}
+//分片LRU-K：每个分片是一个独立的LLZXLruKCache，访问历史容量同样平均分给各个分片
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>, typename Allocator = std::allocator<char>>
+class LLZXHashLruKCache : public LLZXShardedCache<Key, Value, LLZXLruKCache<Key, Value, Index, Allocator>>
+{
+	using SliceCache = LLZXLruKCache<Key, Value, Index, Allocator>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
 
-private:
-	size_t Hash(const Key& key)
+public:
+	LLZXHashLruKCache(size_t capacity, size_t historyCapacity, int k, size_t sliceNum,
+		LLZXHistoryMode historyMode = LLZXHistoryMode::Exact,
+		LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
 	{
-		std::hash<Key> hashFunc;
-		return hashFunc(key);
+		this->initSlices(sliceNum, [this, historyCapacity, k, historyMode](size_t sliceSize) {
+			size_t sliceHistory = std::ceil(historyCapacity / static_cast<double>(this->sliceNum()));
+			return SliceCache(static_cast<int>(sliceSize), static_cast<int>(sliceHistory), k, historyMode);
+		});
 	}
-
-private:
-	size_t capacity_;//总容量
-	size_t sliceNum_;//切片数量
-	std::vector<std::unique_ptr<LLZXLruCache<Key, Value>>> lruSliceCaches_;//切片LRU缓存
 };
 
-}
\ No newline at end of file
+} // namespace LLZXCache
@@ -0,0 +1,731 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLZX_GROUP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define LLZX_GROUP_NEON 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace LLZXCache
+{
+
+// key -> 节点槽位 的索引。LRU系列缓存通过模板参数选择索引实现，索引需要提供：
+//   SlotIndex find(const Key&, const KeyOf&) const   未找到返回kNullSlot
+//   void insert(const Key&, SlotIndex, const KeyOf&) 调用方保证key不存在
+//   void erase(const Key&, const KeyOf&)
+//   size_t size() const / void reserve(size_t) / void clear()
+//   hasher: 使用的hash函数类型，分片缓存用同一个hash选择分片
+//   key_equal: 使用的比较器类型，LockFree读模式的发布表用同样的hash和比较器
+//   void prefetch(const K&) const  批量操作时预取key所在的表项
+//   kEntryBytes（可选）: 每个元素在索引中占用的字节数，不含装载率留下的空位，LLZXDefaultWeigher据此计入固定开销
+// 三种索引的最后一个模板参数都是分配器（任意value_type，内部rebind），缓存的Allocator参数会替换掉索引的默认分配器
+// KeyOf是 SlotIndex -> const Key& 的函数对象，扁平索引不保存key本身，比较时回到节点上取key
+// 缓存的默认索引是LLZXDefaultNodeIndex<Key>：整数、枚举、指针key使用LLZXInlineKeyIndex，其余使用LLZXStdNodeIndex
+// kTransparent为true时，find/erase可以直接用与Key可比较的其他类型查找（如用string_view查string）
+
+namespace detail
+{
+
+// 64位finalizer(murmur3 fmix64)，让std::hash<int>这类恒等hash的各个比特都参与到表下标中
+inline uint64_t fmix64(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+// 分片选择用的另一组混合函数(splitmix64 finalizer)，与表内hash的常量不同，
+// 保证分片下标和分片内部的表下标使用的是彼此独立的比特
+inline uint64_t sliceMix64(uint64_t h)
+{
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+	return h;
+}
+
+template<typename T, typename = void>
+struct IsTransparent : std::false_type {};
+
+template<typename T>
+struct IsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+// 向上取整到2的幂，0按1处理
+inline size_t roundUpPowerOfTwo(size_t n)
+{
+	size_t result = 1;
+	while (result < n)
+		result <<= 1;
+	return result;
+}
+
+inline size_t countTrailingZeros64(uint64_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return index;
+#else
+	return static_cast<size_t>(__builtin_ctzll(x));
+#endif
+}
+
+inline size_t countLeadingZeros64(uint64_t x)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanReverse64(&index, x);
+	return 63 - index;
+#else
+	return static_cast<size_t>(__builtin_clzll(x));
+#endif
+}
+
+// 控制字节：最高位为1表示空位或墓碑，否则低7位是key的hash标签
+constexpr int8_t kCtrlEmpty = -128;  // 0b10000000
+constexpr int8_t kCtrlDeleted = -2;  // 0b11111110
+
+// 一组控制字节的匹配结果，每个位置占2^Shift个比特，只有每个位置的最高比特可能为1
+template<size_t Width, size_t Shift>
+class LLZXBitMask
+{
+public:
+	explicit LLZXBitMask(uint64_t bits) : bits_(bits) {}
+
+	explicit operator bool() const { return bits_ != 0; }
+
+	// 以下要求至少有一个位置匹配
+	size_t lowest() const { return countTrailingZeros64(bits_) >> Shift; }
+	size_t trailingLanes() const { return lowest(); }
+	size_t leadingLanes() const
+	{
+		return (countLeadingZeros64(bits_) - (64 - (Width << Shift))) >> Shift;
+	}
+
+	void clearLowest() { bits_ &= bits_ - 1; }
+
+private:
+	uint64_t bits_;
+};
+
+// 一次比较一组控制字节：x86上用SSE2一次比较16个，ARM上用NEON，其余平台按8字节一组用普通整数运算（SWAR）
+// 组的起点不需要对齐，控制字节数组末尾复制了开头的一组，跨过表尾的组也能一次读出
+#if defined(LLZX_GROUP_SSE2)
+
+class LLZXGroup
+{
+public:
+	static constexpr size_t kWidth = 16;
+	using Mask = LLZXBitMask<16, 0>;
+
+	explicit LLZXGroup(const int8_t* ctrl)
+		: ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+	{}
+
+	Mask match(int8_t tag) const
+	{
+		return Mask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl_))));
+	}
+
+	Mask matchEmpty() const
+	{
+		return Mask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(kCtrlEmpty), ctrl_))));
+	}
+
+	// 空位和墓碑的最高位都是1
+	Mask matchEmptyOrDeleted() const
+	{
+		return Mask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_)));
+	}
+
+private:
+	__m128i ctrl_;
+};
+
+#elif defined(LLZX_GROUP_NEON)
+
+class LLZXGroup
+{
+public:
+	static constexpr size_t kWidth = 16;
+	using Mask = LLZXBitMask<16, 2>;
+
+	explicit LLZXGroup(const int8_t* ctrl)
+		: ctrl_(vld1q_s8(ctrl))
+	{}
+
+	Mask match(int8_t tag) const { return toMask(vceqq_s8(ctrl_, vdupq_n_s8(tag))); }
+	Mask matchEmpty() const { return toMask(vceqq_s8(ctrl_, vdupq_n_s8(kCtrlEmpty))); }
+	Mask matchEmptyOrDeleted() const { return toMask(vcltq_s8(ctrl_, vdupq_n_s8(0))); }
+
+private:
+	// NEON没有movemask：每个字节右移后窄化成4比特，得到64位掩码，每个位置只保留最高的比特
+	static Mask toMask(uint8x16_t eq)
+	{
+		uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+		return Mask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL);
+	}
+
+	int8x16_t ctrl_;
+};
+
+#else
+
+class LLZXGroup
+{
+public:
+	static constexpr size_t kWidth = 8;
+	using Mask = LLZXBitMask<8, 3>;
+
+	explicit LLZXGroup(const int8_t* ctrl)
+	{
+		std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+	}
+
+	// 标签相同的字节变成0再找出0字节；匹配位置之后的字节可能误报，调用方总会再比较key
+	Mask match(int8_t tag) const
+	{
+		uint64_t x = ctrl_ ^ (kLsbs * static_cast<uint8_t>(tag));
+		return Mask((x - kLsbs) & ~x & kMsbs);
+	}
+
+	// 空位0x80的第1位为0，墓碑0xFE的第1位为1，左移6位后用它区分两者
+	Mask matchEmpty() const { return Mask(ctrl_ & ~(ctrl_ << 6) & kMsbs); }
+	Mask matchEmptyOrDeleted() const { return Mask(ctrl_ & kMsbs); }
+
+private:
+	static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+	static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+
+	uint64_t ctrl_;
+};
+
+#endif
+
+} // namespace detail
+
+// 可以同时对std::string、std::string_view、const char*求hash的透明hash，
+// 与std::equal_to<>配合使用，查找时不需要构造临时std::string
+struct LLZXStringHash
+{
+	using is_transparent = void;
+
+	size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+	size_t operator()(const std::string& str) const { return std::hash<std::string_view>{}(str); }
+	size_t operator()(const char* str) const { return std::hash<std::string_view>{}(str); }
+};
+
+// 长度不超过16字节、可平凡拷贝的key使用的廉价hash：按字节读成整数，一次乘法再把高位折回低位
+// 只适用于字节相同等价于相等的类型（整数、枚举、指针、没有填充的POD结构体），浮点数等不能使用
+struct LLZXIntHash
+{
+	template<typename K>
+	size_t operator()(const K& key) const
+	{
+		static_assert(std::is_trivially_copyable<K>::value && sizeof(K) <= 16, "LLZXIntHash hashes small trivially copyable keys");
+		static_assert(std::has_unique_object_representations<K>::value,
+			"LLZXIntHash requires keys whose equal values have equal bytes");
+		if constexpr (sizeof(K) <= sizeof(uint64_t))
+		{
+			uint64_t x = 0;
+			std::memcpy(&x, &key, sizeof(K));
+			return static_cast<size_t>(mix(x));
+		}
+		else
+		{
+			uint64_t lo = 0, hi = 0;
+			std::memcpy(&lo, &key, sizeof(lo));
+			std::memcpy(&hi, reinterpret_cast<const char*>(&key) + sizeof(lo), sizeof(K) - sizeof(lo));
+			return static_cast<size_t>(mix(lo ^ mix(hi)));
+		}
+	}
+
+	static uint64_t mix(uint64_t x)
+	{
+		x *= 0x9e3779b97f4a7c15ULL;
+		return x ^ (x >> 32);
+	}
+};
+
+// 默认索引：基于std::unordered_map的链式哈希表
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+	typename Allocator = std::allocator<char>>
+class LLZXStdNodeIndex
+{
+public:
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	// C++17的unordered_map不支持异构查找
+	static constexpr bool kTransparent = false;
+	// 链表节点（next指针 + pair + 缓存的hash）加上一个桶指针
+	static constexpr size_t kEntryBytes = 2 * sizeof(void*) + sizeof(std::pair<const Key, SlotIndex>) + sizeof(size_t);
+
+	template<typename KeyOf>
+	SlotIndex find(const Key& key, const KeyOf&) const
+	{
+		auto it = map_.find(key);
+		return it != map_.end() ? it->second : kNullSlot;
+	}
+
+	template<typename KeyOf>
+	void insert(const Key& key, SlotIndex slot, const KeyOf&)
+	{
+		map_.emplace(key, slot);
+	}
+
+	template<typename KeyOf>
+	void erase(const Key& key, const KeyOf&)
+	{
+		map_.erase(key);
+	}
+
+	// 链式表的桶不对外暴露，无法预取
+	void prefetch(const Key&) const {}
+
+	size_t size() const { return map_.size(); }
+	void reserve(size_t count) { map_.reserve(count); }
+	void clear() { map_.clear(); }
+
+private:
+	using MapAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const Key, SlotIndex>>;
+
+	std::unordered_map<Key, SlotIndex, Hash, KeyEqual, MapAllocator> map_;
+};
+
+// 开放寻址的扁平索引（Robin Hood线性探测 + 后移删除）
+// 每个表项只有8字节：32位hash指纹 + 槽位下标，全部存放在一段连续内存中，
+// 命中时一次探测即可定位，只有指纹相同时才会回到节点上比较key
+template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+	typename Allocator = std::allocator<char>>
+class LLZXFlatNodeIndex
+{
+	struct Entry
+	{
+		uint32_t  hash;
+		SlotIndex slot; // kNullSlot表示空位
+	};
+
+public:
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	static constexpr bool kTransparent = detail::IsTransparent<Hash>::value && detail::IsTransparent<KeyEqual>::value;
+	static constexpr size_t kEntryBytes = sizeof(Entry);
+
+	template<typename K, typename KeyOf>
+	SlotIndex find(const K& key, const KeyOf& keyOf) const
+	{
+		if (size_ == 0) return kNullSlot;
+
+		uint32_t hash = hashOf(key);
+		size_t pos = hash & mask_;
+		for (size_t dist = 0; ; ++dist)
+		{
+			const Entry& entry = entries_[pos];
+			// 遇到空位，或者当前表项离家更近（Robin Hood不变式），说明key不存在
+			if (entry.slot == kNullSlot || probeDistance(entry, pos) < dist)
+				return kNullSlot;
+			if (entry.hash == hash && equal_(keyOf(entry.slot), key))
+				return entry.slot;
+			pos = (pos + 1) & mask_;
+		}
+	}
+
+	template<typename KeyOf>
+	void insert(const Key& key, SlotIndex slot, const KeyOf&)
+	{
+		if ((size_ + 1) * kMaxLoadDen > entries_.size() * kMaxLoadNum)
+			rehash(entries_.empty() ? kMinCapacity : entries_.size() * 2);
+
+		place(Entry{hashOf(key), slot});
+		++size_;
+	}
+
+	template<typename K, typename KeyOf>
+	void erase(const K& key, const KeyOf& keyOf)
+	{
+		if (size_ == 0) return;
+
+		uint32_t hash = hashOf(key);
+		size_t pos = hash & mask_;
+		for (size_t dist = 0; ; ++dist)
+		{
+			const Entry& entry = entries_[pos];
+			if (entry.slot == kNullSlot || probeDistance(entry, pos) < dist)
+				return;
+			if (entry.hash == hash && equal_(keyOf(entry.slot), key))
+				break;
+			pos = (pos + 1) & mask_;
+		}
+
+		// 后移删除：把后面离家有距离的表项依次前移，不需要墓碑
+		size_t next = (pos + 1) & mask_;
+		while (entries_[next].slot != kNullSlot && probeDistance(entries_[next], next) > 0)
+		{
+			entries_[pos] = entries_[next];
+			pos = next;
+			next = (next + 1) & mask_;
+		}
+		entries_[pos].slot = kNullSlot;
+		--size_;
+	}
+
+	template<typename K>
+	void prefetch(const K& key) const
+	{
+		if (!entries_.empty())
+			detail::prefetch(&entries_[hashOf(key) & mask_]);
+	}
+
+	size_t size() const { return size_; }
+
+	void reserve(size_t count)
+	{
+		size_t need = kMinCapacity;
+		while (need * kMaxLoadNum < count * kMaxLoadDen)
+			need *= 2;
+		if (need > entries_.size())
+			rehash(need);
+	}
+
+	void clear()
+	{
+		for (auto& entry : entries_)
+			entry.slot = kNullSlot;
+		size_ = 0;
+	}
+
+private:
+	// 最大装载因子 4/5
+	static constexpr size_t kMaxLoadNum = 4;
+	static constexpr size_t kMaxLoadDen = 5;
+	static constexpr size_t kMinCapacity = 16;
+
+	template<typename K>
+	uint32_t hashOf(const K& key) const
+	{
+		return static_cast<uint32_t>(detail::fmix64(hasher_(key)) >> 32);
+	}
+
+	size_t probeDistance(const Entry& entry, size_t pos) const
+	{
+		return (pos - (entry.hash & mask_)) & mask_;
+	}
+
+	// 插入一个表项，沿途把离家更近的表项换出来继续向后找位置
+	void place(Entry entry)
+	{
+		size_t pos = entry.hash & mask_;
+		size_t dist = 0;
+		while (true)
+		{
+			Entry& cur = entries_[pos];
+			if (cur.slot == kNullSlot)
+			{
+				cur = entry;
+				return;
+			}
+			size_t curDist = probeDistance(cur, pos);
+			if (curDist < dist)
+			{
+				std::swap(cur, entry);
+				dist = curDist;
+			}
+			pos = (pos + 1) & mask_;
+			++dist;
+		}
+	}
+
+	// 表项中保存了hash，扩容时不需要回到节点上重新计算
+	void rehash(size_t newCapacity)
+	{
+		EntryVector old(newCapacity, Entry{0, kNullSlot});
+		old.swap(entries_);
+		mask_ = newCapacity - 1;
+		for (const auto& entry : old)
+		{
+			if (entry.slot != kNullSlot)
+				place(entry);
+		}
+	}
+
+private:
+	using EntryVector = std::vector<Entry, typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>>;
+
+	EntryVector        entries_;
+	size_t             mask_ = 0;
+	size_t             size_ = 0;
+	Hash               hasher_;
+	KeyEqual           equal_;
+};
+
+// 小key的内联索引（分组探测的开放寻址表，思路同SwissTable）
+//   key直接保存在表项里，与槽位下标放在一起（int key的表项只有8字节，一个缓存行放8个），查找不需要回到节点上取key；
+//   另有一个控制字节数组保存每个表项的7位hash标签，查找时一次比较一组（16个）标签，只有标签相同的表项才比较key
+//   删除时若所在位置从未让探测越过（前后一组内有空位）直接置空，否则留下墓碑，墓碑在扩容或同容量重建时清理
+//   表项只有key和槽位，值仍在slab的节点里：命中后还要访问一次节点（取值、更新访问顺序），
+//   小值内联进表项、以及AVX2一次比较32个标签都留作后续工作，目前组宽固定为16（SSE2/NEON）
+// Key需要可平凡拷贝、可默认构造、不超过16字节；Hash默认为LLZXIntHash
+template<typename Key, typename Hash = LLZXIntHash, typename KeyEqual = std::equal_to<Key>,
+	typename Allocator = std::allocator<char>>
+class LLZXInlineKeyIndex
+{
+	static_assert(std::is_trivially_copyable<Key>::value && std::is_default_constructible<Key>::value && sizeof(Key) <= 16,
+		"LLZXInlineKeyIndex stores small trivially copyable keys inline");
+
+	using Group = detail::LLZXGroup;
+
+	struct Entry
+	{
+		Key       key;
+		SlotIndex slot;
+	};
+
+public:
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+	static constexpr bool kTransparent = false;
+	// 表项加一个控制字节
+	static constexpr size_t kEntryBytes = sizeof(Entry) + 1;
+
+	template<typename K, typename KeyOf>
+	SlotIndex find(const K& key, const KeyOf&) const
+	{
+		if (size_ == 0) return kNullSlot;
+		size_t index = locate(key);
+		return index != kNone ? entries_[index].slot : kNullSlot;
+	}
+
+	template<typename KeyOf>
+	void insert(const Key& key, SlotIndex slot, const KeyOf&)
+	{
+		if (growthLeft_ == 0)
+			rehash(size_ * 32 <= capacity_ * 25 && capacity_ > 0 ? capacity_ : grownCapacity());
+
+		size_t hash = hasher_(key);
+		size_t index = findFree(hash);
+		growthLeft_ -= ctrl_[index] == detail::kCtrlEmpty;
+		setCtrl(index, tagOf(hash));
+		entries_[index] = Entry{key, slot};
+		++size_;
+	}
+
+	template<typename K, typename KeyOf>
+	void erase(const K& key, const KeyOf&)
+	{
+		if (size_ == 0) return;
+		size_t index = locate(key);
+		if (index == kNone) return;
+
+		// 包含该位置的连续非空表项不足一组时，任何探测都会在越过它之前遇到空位，可以直接置空
+		auto emptyAfter = Group(&ctrl_[index]).matchEmpty();
+		auto emptyBefore = Group(&ctrl_[(index - Group::kWidth) & mask_]).matchEmpty();
+		bool neverFull = emptyBefore && emptyAfter
+			&& emptyAfter.trailingLanes() + emptyBefore.leadingLanes() < Group::kWidth;
+		setCtrl(index, neverFull ? detail::kCtrlEmpty : detail::kCtrlDeleted);
+		growthLeft_ += neverFull;
+		--size_;
+	}
+
+	template<typename K>
+	void prefetch(const K& key) const
+	{
+		if (capacity_ == 0) return;
+		size_t pos = (hasher_(key) >> 7) & mask_;
+		detail::prefetch(&ctrl_[pos]);
+		detail::prefetch(&entries_[pos]);
+	}
+
+	size_t size() const { return size_; }
+
+	void reserve(size_t count)
+	{
+		size_t need = kMinCapacity;
+		while (maxLoad(need) < count)
+			need *= 2;
+		if (need > capacity_)
+			rehash(need);
+	}
+
+	void clear()
+	{
+		std::fill(ctrl_.begin(), ctrl_.end(), detail::kCtrlEmpty);
+		size_ = 0;
+		growthLeft_ = maxLoad(capacity_);
+	}
+
+private:
+	static constexpr size_t kNone = SIZE_MAX;
+	static constexpr size_t kMinCapacity = 16;
+
+	// 最大装载因子7/8
+	static size_t maxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+	// hash的低7位作标签，其余位决定起始位置
+	static int8_t tagOf(size_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+	size_t grownCapacity() const { return capacity_ == 0 ? kMinCapacity : capacity_ * 2; }
+
+	// 按组做三角探测（每次多跳一组），容量是组宽的2的幂倍时能遍历所有组
+	template<typename K>
+	size_t locate(const K& key) const
+	{
+		size_t hash = hasher_(key);
+		int8_t tag = tagOf(hash);
+		size_t pos = (hash >> 7) & mask_;
+		for (size_t step = Group::kWidth; ; step += Group::kWidth)
+		{
+			Group group(&ctrl_[pos]);
+			for (auto match = group.match(tag); match; match.clearLowest())
+			{
+				size_t index = (pos + match.lowest()) & mask_;
+				if (equal_(entries_[index].key, key))
+					return index;
+			}
+			if (group.matchEmpty())
+				return kNone;
+			pos = (pos + step) & mask_;
+		}
+	}
+
+	// 第一个空位或墓碑，调用方保证有剩余空间
+	size_t findFree(size_t hash) const
+	{
+		size_t pos = (hash >> 7) & mask_;
+		for (size_t step = Group::kWidth; ; step += Group::kWidth)
+		{
+			auto free = Group(&ctrl_[pos]).matchEmptyOrDeleted();
+			if (free)
+				return (pos + free.lowest()) & mask_;
+			pos = (pos + step) & mask_;
+		}
+	}
+
+	// 开头一组控制字节在数组末尾另存一份
+	void setCtrl(size_t index, int8_t value)
+	{
+		ctrl_[index] = value;
+		if (index < Group::kWidth)
+			ctrl_[index + capacity_] = value;
+	}
+
+	// 表项中保存了key，重建时直接重新计算hash
+	void rehash(size_t newCapacity)
+	{
+		CtrlVector oldCtrl(newCapacity + Group::kWidth, detail::kCtrlEmpty);
+		EntryVector oldEntries(newCapacity);
+		oldCtrl.swap(ctrl_);
+		oldEntries.swap(entries_);
+		size_t oldCapacity = capacity_;
+		capacity_ = newCapacity;
+		mask_ = newCapacity - 1;
+		for (size_t i = 0; i < oldCapacity; ++i)
+		{
+			if (oldCtrl[i] < 0)
+				continue;
+			const Entry& entry = oldEntries[i];
+			size_t hash = hasher_(entry.key);
+			size_t index = findFree(hash);
+			setCtrl(index, tagOf(hash));
+			entries_[index] = entry;
+		}
+		growthLeft_ = maxLoad(capacity_) - size_;
+	}
+
+private:
+	using CtrlVector = std::vector<int8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<int8_t>>;
+	using EntryVector = std::vector<Entry, typename std::allocator_traits<Allocator>::template rebind_alloc<Entry>>;
+
+	CtrlVector  ctrl_;
+	EntryVector entries_;
+	size_t      capacity_ = 0;
+	size_t      mask_ = 0;
+	size_t      size_ = 0;
+	size_t      growthLeft_ = 0; // 还能占用的空位数，墓碑不算空位
+	Hash        hasher_;
+	KeyEqual    equal_;
+};
+
+namespace detail
+{
+
+// 可以内联保存在索引里并使用LLZXIntHash的key：整数、枚举和指针
+template<typename Key>
+struct UsesInlineIndex : std::integral_constant<bool,
+	(std::is_integral<Key>::value || std::is_enum<Key>::value || std::is_pointer<Key>::value) && sizeof(Key) <= 16> {};
+
+template<typename Key, bool = UsesInlineIndex<Key>::value>
+struct DefaultNodeIndex
+{
+	using type = LLZXStdNodeIndex<Key>;
+};
+
+template<typename Key>
+struct DefaultNodeIndex<Key, true>
+{
+	using type = LLZXInlineKeyIndex<Key>;
+};
+
+} // namespace detail
+
+// 缓存模板的默认索引类型
+template<typename Key>
+using LLZXDefaultNodeIndex = typename detail::DefaultNodeIndex<Key>::type;
+
+namespace detail
+{
+
+// 把索引的默认分配器换成缓存的Allocator；索引显式指定了分配器，或者是其他索引类型时保持不变
+template<typename Index, typename Allocator>
+struct RebindIndexAllocator
+{
+	using type = Index;
+};
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+struct RebindIndexAllocator<LLZXStdNodeIndex<Key, Hash, KeyEqual, std::allocator<char>>, Allocator>
+{
+	using type = LLZXStdNodeIndex<Key, Hash, KeyEqual, Allocator>;
+};
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+struct RebindIndexAllocator<LLZXFlatNodeIndex<Key, Hash, KeyEqual, std::allocator<char>>, Allocator>
+{
+	using type = LLZXFlatNodeIndex<Key, Hash, KeyEqual, Allocator>;
+};
+
+template<typename Key, typename Hash, typename KeyEqual, typename Allocator>
+struct RebindIndexAllocator<LLZXInlineKeyIndex<Key, Hash, KeyEqual, std::allocator<char>>, Allocator>
+{
+	using type = LLZXInlineKeyIndex<Key, Hash, KeyEqual, Allocator>;
+};
+
+} // namespace detail
+
+} // namespace LLZXCache
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace LLZXCache
+{
+
+// 节点在slab中的下标，链表的prev/next都用下标表示，不再使用shared_ptr/weak_ptr
+using SlotIndex = uint32_t;
+constexpr SlotIndex kNullSlot = std::numeric_limits<SlotIndex>::max();
+
+// 预分配的节点数组：按容量一次性reserve，空闲槽位通过next_串成空闲链表
+// 被驱逐节点的槽位直接回收给下一次插入使用，命中路径不会触碰分配器
+// Node需要提供prev_/next_两个SlotIndex成员，并提供(Key, Value)构造
+// Allocator可以是任意value_type的无状态分配器，内部rebind到Node
+template<typename Node, typename Allocator = std::allocator<char>>
+class LLZXNodeSlab
+{
+public:
+	explicit LLZXNodeSlab(size_t reserveCount = 0)
+	{
+		nodes_.reserve(reserveCount);
+	}
+
+	// 分配一个槽位，优先复用空闲链表中的槽位
+	template<typename K, typename V>
+	SlotIndex allocate(K&& key, V&& value)
+	{
+		if (freeHead_ != kNullSlot)
+		{
+			SlotIndex slot = freeHead_;
+			Node& node = nodes_[slot];
+			freeHead_ = node.next_;
+			node.reset(std::forward<K>(key), std::forward<V>(value));
+			node.prev_ = node.next_ = kNullSlot;
+			--freeCount_;
+			return slot;
+		}
+
+		SlotIndex slot = static_cast<SlotIndex>(nodes_.size());
+		nodes_.emplace_back(std::forward<K>(key), std::forward<V>(value));
+		return slot;
+	}
+
+	// 归还槽位，节点对象本身保留，等待下一次allocate覆盖
+	void release(SlotIndex slot)
+	{
+		Node& node = nodes_[slot];
+		node.prev_ = kNullSlot;
+		node.next_ = freeHead_;
+		freeHead_ = slot;
+		++freeCount_;
+	}
+
+	Node& operator[](SlotIndex slot) { return nodes_[slot]; }
+	const Node& operator[](SlotIndex slot) const { return nodes_[slot]; }
+
+	size_t size() const { return nodes_.size() - freeCount_; }
+	// 已经构造的槽位数，包括空闲链表中的槽位
+	size_t slotCount() const { return nodes_.size(); }
+	void reserve(size_t count) { nodes_.reserve(count); }
+
+private:
+	using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+
+	std::vector<Node, NodeAllocator> nodes_;
+	SlotIndex                        freeHead_ = kNullSlot; // 空闲链表头
+	size_t                           freeCount_ = 0;
+};
+
+// 基于slab下标的侵入式双向链表，不使用哨兵节点，多个链表可以共享同一个slab
+// head_为最久未访问端，tail_为最近访问端
+template<typename Slab>
+class LLZXNodeList
+{
+public:
+	SlotIndex front() const { return head_; }
+	SlotIndex back() const { return tail_; }
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	// 从尾部插入
+	void pushBack(Slab& slab, SlotIndex slot)
+	{
+		auto& node = slab[slot];
+		node.prev_ = tail_;
+		node.next_ = kNullSlot;
+		if (tail_ != kNullSlot)
+			slab[tail_].next_ = slot;
+		else
+			head_ = slot;
+		tail_ = slot;
+		++size_;
+	}
+
+	// 插入到before之前，before为kNullSlot时等同于pushBack
+	void insertBefore(Slab& slab, SlotIndex before, SlotIndex slot)
+	{
+		if (before == kNullSlot)
+		{
+			pushBack(slab, slot);
+			return;
+		}
+
+		auto& node = slab[slot];
+		auto& next = slab[before];
+		node.prev_ = next.prev_;
+		node.next_ = before;
+		if (next.prev_ != kNullSlot)
+			slab[next.prev_].next_ = slot;
+		else
+			head_ = slot;
+		next.prev_ = slot;
+		++size_;
+	}
+
+	void unlink(Slab& slab, SlotIndex slot)
+	{
+		auto& node = slab[slot];
+		if (node.prev_ != kNullSlot)
+			slab[node.prev_].next_ = node.next_;
+		else
+			head_ = node.next_;
+
+		if (node.next_ != kNullSlot)
+			slab[node.next_].prev_ = node.prev_;
+		else
+			tail_ = node.prev_;
+
+		node.prev_ = node.next_ = kNullSlot;
+		--size_;
+	}
+
+	// 移动节点到最新位置
+	void moveToBack(Slab& slab, SlotIndex slot)
+	{
+		if (slot == tail_) return;
+		unlink(slab, slot);
+		pushBack(slab, slot);
+	}
+
+	// 弹出最久未访问的节点，链表为空时返回kNullSlot
+	SlotIndex popFront(Slab& slab)
+	{
+		SlotIndex slot = head_;
+		if (slot != kNullSlot)
+			unlink(slab, slot);
+		return slot;
+	}
+
+	void clear()
+	{
+		head_ = tail_ = kNullSlot;
+		size_ = 0;
+	}
+
+private:
+	SlotIndex head_ = kNullSlot;
+	SlotIndex tail_ = kNullSlot;
+	size_t    size_ = 0;
+};
+
+} // namespace LLZXCache
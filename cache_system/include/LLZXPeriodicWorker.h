@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace LLZXCache
+{
+
+// 后台线程每隔interval调用一次task，析构时唤醒线程并等待它退出（正在执行的task会先执行完）
+// LLZXExpiryReaper、LLZXSliceRebalancer等定期维护任务都建立在它之上，task引用的对象需要比它活得更久
+class LLZXPeriodicWorker
+{
+public:
+	LLZXPeriodicWorker(std::function<void()> task, std::chrono::milliseconds interval)
+		: task_(std::move(task))
+		, interval_(interval)
+		, thread_([this] { run(); })
+	{}
+
+	~LLZXPeriodicWorker()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		thread_.join();
+	}
+
+	LLZXPeriodicWorker(const LLZXPeriodicWorker&) = delete;
+	LLZXPeriodicWorker& operator=(const LLZXPeriodicWorker&) = delete;
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!cv_.wait_for(lock, interval_, [this] { return stop_; }))
+		{
+			lock.unlock();
+			task_();
+			lock.lock();
+		}
+	}
+
+private:
+	std::function<void()>     task_;
+	std::chrono::milliseconds interval_;
+	std::mutex                mutex_;
+	std::condition_variable   cv_;
+	bool                      stop_ = false;
+	std::thread               thread_; // 最后初始化，线程启动时task和同步原语已经构造好
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#ifdef LLZX_HAVE_NUMA
+#include <numa.h>
+#include <sched.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace LLZXCache
+{
+
+// 缓存行大小，用于对齐/填充会被不同线程频繁写入的数据，避免伪共享
+// GCC在头文件中使用hardware_destructive_interference_size会给出ABI不稳定的警告，
+// 这里的值只影响进程内的内存布局，不跨编译单元传递，所以屏蔽该警告
+#if defined(__cpp_lib_hardware_interference_size)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+constexpr size_t kCacheLineSize = std::hardware_destructive_interference_size;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+constexpr size_t kCacheLineSize = 64;
+#endif
+
+namespace detail
+{
+
+// 软件预取，批量操作时提前把下一批要访问的表项/节点拉进缓存
+inline void prefetch(const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+// 自旋等待时让出流水线（超线程的另一个逻辑核可以继续执行）
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+// 把当前线程绑定到进程允许使用的第cpu个CPU（超出个数时取模），只在Linux上生效，失败时返回false
+inline bool pinCurrentThread(size_t cpu)
+{
+#if defined(__linux__)
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+		return false;
+	size_t target = cpu % static_cast<size_t>(CPU_COUNT(&allowed));
+	for (int i = 0; i < CPU_SETSIZE; ++i)
+	{
+		if (!CPU_ISSET(i, &allowed))
+			continue;
+		if (target-- == 0)
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(i, &set);
+			return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+		}
+	}
+	return false;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+// NUMA相关的封装，编译时定义LLZX_HAVE_NUMA并链接libnuma后生效，
+// 否则视为只有一个节点，内存按缓存行对齐分配
+inline int numaNodeCount()
+{
+#ifdef LLZX_HAVE_NUMA
+	if (numa_available() >= 0)
+		return numa_max_node() + 1;
+#endif
+	return 1;
+}
+
+// 当前线程所在CPU对应的NUMA节点
+inline int currentNumaNode()
+{
+#ifdef LLZX_HAVE_NUMA
+	if (numa_available() >= 0)
+	{
+		int cpu = sched_getcpu();
+		if (cpu >= 0)
+		{
+			int node = numa_node_of_cpu(cpu);
+			if (node >= 0)
+				return node;
+		}
+	}
+#endif
+	return 0;
+}
+
+// 在指定节点上分配内存（至少按缓存行对齐）
+inline void* allocateOnNode(size_t size, int node)
+{
+#ifdef LLZX_HAVE_NUMA
+	if (numa_available() >= 0)
+	{
+		void* ptr = numa_alloc_onnode(size, node);
+		if (ptr == nullptr)
+			throw std::bad_alloc();
+		return ptr;
+	}
+#endif
+	(void)node;
+	return ::operator new(size, std::align_val_t(kCacheLineSize));
+}
+
+inline void deallocateOnNode(void* ptr, size_t size)
+{
+#ifdef LLZX_HAVE_NUMA
+	if (numa_available() >= 0)
+	{
+		numa_free(ptr, size);
+		return;
+	}
+#endif
+	(void)size;
+	::operator delete(ptr, std::align_val_t(kCacheLineSize));
+}
+
+} // namespace detail
+
+} // namespace LLZXCache
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "LLZXLruCache.h"
+#include "LLZXMemoryPool.h"
+
+// 从memory_pool分配内存的LRU系列缓存，需要链接memory_pool（顶层BUILD_MEMORY_POOL打开时cache_system自动链接）
+// 节点slab和索引（std::unordered_map的每个节点、扁平索引的表）都从线程缓存分配，
+// 多线程并发插入时不再争用malloc的arena锁；key/value要用池化的类型（如LLZXPoolString）才会从池中分配
+
+namespace LLZXCache
+{
+
+using LLZXPoolByteAllocator = LLZXMemoryPool::LLZXPoolAllocator<char>;
+
+// 内容从内存池分配的字符串，短字符串仍然走SSO不分配
+using LLZXPoolString = std::basic_string<char, std::char_traits<char>, LLZXPoolByteAllocator>;
+
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+using LLZXPooledLruCache = LLZXLruCache<Key, Value, Index, LLZXPoolByteAllocator>;
+
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+using LLZXPooledLruKCache = LLZXLruKCache<Key, Value, Index, LLZXPoolByteAllocator>;
+
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+using LLZXPooledHashLruCache = LLZXHashLruCache<Key, Value, Index, LLZXPoolByteAllocator>;
+
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+using LLZXPooledHashLruKCache = LLZXHashLruKCache<Key, Value, Index, LLZXPoolByteAllocator>;
+
+} // namespace LLZXCache
+
+// 标准库只为std::string等默认分配器的字符串提供hash，这里按内容hash，与std::string的结果一致
+namespace std
+{
+
+template<>
+struct hash<LLZXCache::LLZXPoolString>
+{
+	size_t operator()(const LLZXCache::LLZXPoolString& str) const
+	{
+		return std::hash<std::string_view>{}(std::string_view(str.data(), str.size()));
+	}
+};
+
+} // namespace std
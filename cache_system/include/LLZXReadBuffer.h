@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+
+namespace LLZXCache
+{
+
+// 读路径的并发模式
+//   Exclusive: get和put一样持有独占锁，命中时立即调整链表（原有行为）
+//   Buffered:  get只持有共享锁，命中的槽位先记录到分条的读缓冲中，
+//              之后在持有独占锁时（put或者缓冲接近写满时）批量回放到链表上
+//   LockFree:  get不加锁，从写者发布的只读表（LLZXReadTable）中读取值，访问记录同Buffered；
+//              被替换或删除的表项按epoch回收。每个元素的key和value多存一份，写操作多一次拷贝，
+//              适合读远多于写的场景；目前只有LLZXLruCache支持，其他缓存按Buffered处理
+//              代价：每次写入都new一个表项（不复用），旧表项攒到epoch推进后才批量释放。cache_bench中
+//              （zipf、10%写、16字节value）每个元素约272字节，Buffered约118字节；写入和批量回收使p999
+//              从约3.6us升到10us以上。表项复用需要跨缓存共享的回收池，留作后续工作
+enum class LLZXReadMode
+{
+	Exclusive,
+	Buffered,
+	LockFree,
+};
+
+// 分条的有损读缓冲（参考Caffeine的read buffer）
+// 每个线程固定映射到一条环形缓冲，记录命中的槽位；缓冲满或CAS竞争失败时直接丢弃本次记录，
+// 只会让LRU顺序略微不精确，不影响正确性。回放(drain)必须在持有缓存独占锁时进行
+class LLZXReadBuffer
+{
+public:
+	static constexpr uint32_t kStripeSize = 32;
+	static constexpr uint32_t kDrainThreshold = kStripeSize / 2;
+
+	LLZXReadBuffer()
+	{
+		size_t stripes = 1;
+		size_t hardware = std::thread::hardware_concurrency();
+		while (stripes < hardware * 2 && stripes < kMaxStripes)
+			stripes <<= 1;
+		stripeMask_ = stripes - 1;
+		stripes_ = std::make_unique<Stripe[]>(stripes);
+	}
+
+	// 记录一次命中，返回true表示这条缓冲需要尽快回放
+	bool record(SlotIndex slot)
+	{
+		Stripe& stripe = stripes_[threadProbe() & stripeMask_];
+		uint32_t write = stripe.writeCount.load(std::memory_order_relaxed);
+		uint32_t read = stripe.readCount.load(std::memory_order_acquire);
+		if (write - read >= kStripeSize)
+			return true;
+		if (!stripe.writeCount.compare_exchange_strong(write, write + 1, std::memory_order_relaxed))
+			return false;
+		stripe.slots[write & (kStripeSize - 1)].store(slot, std::memory_order_release);
+		return write + 1 - read >= kDrainThreshold;
+	}
+
+	// 回放所有缓冲中的记录，调用方需要持有独占锁
+	template<typename Fn>
+	void drain(Fn&& fn)
+	{
+		for (size_t i = 0; i <= stripeMask_; ++i)
+		{
+			Stripe& stripe = stripes_[i];
+			uint32_t read = stripe.readCount.load(std::memory_order_relaxed);
+			uint32_t write = stripe.writeCount.load(std::memory_order_acquire);
+			for (; read != write; ++read)
+			{
+				// 写者可能已经占了位置但还没写入，这种记录直接跳过
+				SlotIndex slot = stripe.slots[read & (kStripeSize - 1)].exchange(kNullSlot, std::memory_order_acquire);
+				if (slot != kNullSlot)
+					fn(slot);
+			}
+			stripe.readCount.store(write, std::memory_order_release);
+		}
+	}
+
+private:
+	static constexpr size_t kMaxStripes = 64;
+
+	// 独占一个缓存行，避免不同线程的缓冲之间伪共享
+	struct alignas(kCacheLineSize) Stripe
+	{
+		std::atomic<uint32_t>  writeCount{0};
+		std::atomic<uint32_t>  readCount{0};
+		std::atomic<SlotIndex> slots[kStripeSize];
+
+		Stripe()
+		{
+			for (auto& slot : slots)
+				slot.store(kNullSlot, std::memory_order_relaxed);
+		}
+	};
+
+	static size_t threadProbe()
+	{
+		static thread_local size_t probe = std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9e3779b97f4a7c15ULL >> 32;
+		return probe;
+	}
+
+private:
+	std::unique_ptr<Stripe[]> stripes_;
+	size_t                    stripeMask_ = 0;
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "LLZXEpoch.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+
+namespace LLZXCache
+{
+
+// LockFree读模式下供读者无锁查询的发布表（开放寻址 + 线性探测，表项是指向不可变Entry的原子指针）
+//   写者持有缓存独占锁，每次插入/更新都发布一个新的Entry并替换旧指针，删除时换成墓碑；
+//   被替换下来的Entry和扩容后的旧表交给LLZXEpoch retire，等读者都离开之后再批量释放
+//   读者在LLZXEpochGuard内find，拿到的Entry在退出临界区之前一直有效
+// 墓碑占用的位置在扩容时清理，表中活跃表项与墓碑之和不超过一半，探测总能遇到空位
+template<typename Key, typename Value, typename Hash, typename KeyEqual>
+class LLZXReadTable
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry
+	{
+		uint64_t          hash;
+		Key               key;
+		Value             value;
+		SlotIndex         slot;     // 节点槽位，读者用它记录访问
+		Clock::time_point deadline; // 过期时刻，不过期为time_point::max()
+
+		bool expired() const { return deadline != Clock::time_point::max() && Clock::now() >= deadline; }
+	};
+
+	explicit LLZXReadTable(size_t expected = 0)
+		: table_(new Table(capacityFor(expected)))
+	{}
+
+	// 析构时不能再有读者
+	~LLZXReadTable()
+	{
+		Table* table = table_.load(std::memory_order_relaxed);
+		for (size_t i = 0; i <= table->mask; ++i)
+		{
+			Entry* entry = table->slots[i].load(std::memory_order_relaxed);
+			if (entry && entry != tombstone())
+				delete entry;
+		}
+		delete table;
+	}
+
+	LLZXReadTable(const LLZXReadTable&) = delete;
+	LLZXReadTable& operator=(const LLZXReadTable&) = delete;
+
+	// 读者接口，调用方处于LLZXEpochGuard内
+	template<typename K>
+	const Entry* find(const K& key) const
+	{
+		uint64_t hash = hashOf(key);
+		const Table* table = table_.load(std::memory_order_acquire);
+		for (size_t pos = hash & table->mask; ; pos = (pos + 1) & table->mask)
+		{
+			const Entry* entry = table->slots[pos].load(std::memory_order_acquire);
+			if (!entry)
+				return nullptr;
+			if (entry != tombstone() && entry->hash == hash && equal_(entry->key, key))
+				return entry;
+		}
+	}
+
+	// 以下为写者接口，调用方持有缓存的独占锁
+
+	// 插入或替换key对应的表项
+	void publish(const Key& key, const Value& value, SlotIndex slot, Clock::time_point deadline)
+	{
+		uint64_t hash = hashOf(key);
+		Entry* fresh = new Entry{hash, key, value, slot, deadline};
+		Table* table = table_.load(std::memory_order_relaxed);
+
+		size_t target = kNone;
+		size_t pos = hash & table->mask;
+		for (; ; pos = (pos + 1) & table->mask)
+		{
+			Entry* entry = table->slots[pos].load(std::memory_order_relaxed);
+			if (!entry)
+				break;
+			if (entry == tombstone())
+			{
+				if (target == kNone)
+					target = pos;
+				continue;
+			}
+			if (entry->hash == hash && equal_(entry->key, key))
+			{
+				table->slots[pos].store(fresh, std::memory_order_release);
+				LLZXCommon::LLZXEpoch::retire(entry);
+				return;
+			}
+		}
+
+		if (target == kNone)
+		{
+			target = pos;
+			++used_;
+		}
+		table->slots[target].store(fresh, std::memory_order_release);
+		++live_;
+
+		if (used_ * 2 > table->mask + 1)
+			rebuild(capacityFor(live_));
+	}
+
+	void unpublish(const Key& key)
+	{
+		uint64_t hash = hashOf(key);
+		Table* table = table_.load(std::memory_order_relaxed);
+		for (size_t pos = hash & table->mask; ; pos = (pos + 1) & table->mask)
+		{
+			Entry* entry = table->slots[pos].load(std::memory_order_relaxed);
+			if (!entry)
+				return;
+			if (entry != tombstone() && entry->hash == hash && equal_(entry->key, key))
+			{
+				table->slots[pos].store(tombstone(), std::memory_order_release);
+				LLZXCommon::LLZXEpoch::retire(entry);
+				--live_;
+				return;
+			}
+		}
+	}
+
+	size_t size() const { return live_; }
+
+private:
+	struct Table
+	{
+		explicit Table(size_t capacity)
+			: mask(capacity - 1)
+			, slots(new std::atomic<Entry*>[capacity]())
+		{}
+
+		size_t                                mask;
+		std::unique_ptr<std::atomic<Entry*>[]> slots;
+	};
+
+	static constexpr size_t kNone = SIZE_MAX;
+	static constexpr size_t kMinCapacity = 16;
+
+	static Entry* tombstone() { return reinterpret_cast<Entry*>(uintptr_t(1)); }
+
+	// 活跃表项不超过1/4，留出墓碑积累的空间
+	static size_t capacityFor(size_t count)
+	{
+		return detail::roundUpPowerOfTwo(count * 4 > kMinCapacity ? count * 4 : kMinCapacity);
+	}
+
+	template<typename K>
+	uint64_t hashOf(const K& key) const
+	{
+		return detail::fmix64(hasher_(key));
+	}
+
+	// 把活跃表项搬到新表后整体替换，旧表只释放指针数组，Entry由新表继续持有
+	void rebuild(size_t capacity)
+	{
+		Table* old = table_.load(std::memory_order_relaxed);
+		Table* table = new Table(capacity);
+		for (size_t i = 0; i <= old->mask; ++i)
+		{
+			Entry* entry = old->slots[i].load(std::memory_order_relaxed);
+			if (!entry || entry == tombstone())
+				continue;
+			size_t pos = entry->hash & table->mask;
+			while (table->slots[pos].load(std::memory_order_relaxed))
+				pos = (pos + 1) & table->mask;
+			table->slots[pos].store(entry, std::memory_order_relaxed);
+		}
+		used_ = live_;
+		table_.store(table, std::memory_order_release);
+		LLZXCommon::LLZXEpoch::retire(old);
+	}
+
+private:
+	std::atomic<Table*> table_;
+	size_t              live_ = 0; // 活跃表项个数
+	size_t              used_ = 0; // 活跃表项与墓碑之和
+	Hash                hasher_;
+	KeyEqual            equal_;
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "LLZXLruCache.h"
+#include "LLZXSingleFlight.h"
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+// 固定线程数、有界队列的后台执行器，用于刷新缓存
+// 队列满时拒绝新任务而不是阻塞调用方，刷新只是尽力而为，被拒绝时继续返回旧值
+// 析构时丢弃尚未开始的任务，等待正在执行的任务结束
+class LLZXRefreshExecutor
+{
+public:
+	explicit LLZXRefreshExecutor(size_t threadNum = 1, size_t maxQueued = 1024)
+		: maxQueued_(maxQueued > 0 ? maxQueued : 1)
+	{
+		threadNum = threadNum > 0 ? threadNum : 1;
+		workers_.reserve(threadNum);
+		for (size_t i = 0; i < threadNum; ++i)
+			workers_.emplace_back([this] { run(); });
+	}
+
+	~LLZXRefreshExecutor()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+			tasks_.clear();
+		}
+		cv_.notify_all();
+		for (auto& worker : workers_)
+			worker.join();
+	}
+
+	LLZXRefreshExecutor(const LLZXRefreshExecutor&) = delete;
+	LLZXRefreshExecutor& operator=(const LLZXRefreshExecutor&) = delete;
+
+	// 队列已满或已经停止时返回false
+	bool trySubmit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (stop_ || tasks_.size() >= maxQueued_)
+			{
+				rejected_.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			tasks_.push_back(std::move(task));
+		}
+		cv_.notify_one();
+		return true;
+	}
+
+	// 因队列满被拒绝的任务数
+	size_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;)
+		{
+			cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+			if (stop_)
+				return;
+			std::function<void()> task = std::move(tasks_.front());
+			tasks_.pop_front();
+			lock.unlock();
+			task();
+			task = nullptr; // 在锁外释放任务捕获的状态
+			lock.lock();
+		}
+	}
+
+private:
+	size_t                            maxQueued_;
+	std::mutex                        mutex_;
+	std::condition_variable           cv_;
+	std::deque<std::function<void()>> tasks_;
+	std::atomic<size_t>               rejected_{0};
+	bool                              stop_ = false;
+	std::vector<std::thread>          workers_; // 最后初始化，线程启动时其他成员已经就绪
+};
+
+// 写入后定期刷新的分片LRU缓存（refresh-after-write / stale-while-revalidate）
+//   写入超过refreshAfter的元素仍然直接返回，同时在后台执行器中重新加载，热点key到期时读路径不会阻塞在加载上
+//   写入超过expireAfter的元素真正过期（由底层LLZXHashLruCache的TTL回收），之后的读取同步加载
+//   同一个key的后台刷新和同步加载共用一次加载，不会因为并发访问重复刷新
+//   刷新失败时保留旧值，下一次访问再尝试；执行器队列满时本次不刷新
+// 后台任务持有内部状态的shared_ptr，缓存对象先于尚未完成的刷新析构也是安全的
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXRefreshingLruCache
+{
+public:
+	using Clock = LLZXExpiry::Clock;
+	using Duration = LLZXExpiry::Duration;
+	using Loader = std::function<Value(const Key&)>;
+
+	// executor为空时创建一个单线程的执行器；多个缓存可以共享同一个执行器
+	LLZXRefreshingLruCache(size_t capacity, size_t sliceNum, Loader loader,
+		Duration refreshAfter, Duration expireAfter = LLZXExpiry::kNever,
+		std::shared_ptr<LLZXRefreshExecutor> executor = nullptr)
+		: state_(std::make_shared<State>(capacity, sliceNum, std::move(loader), refreshAfter, expireAfter))
+		, executor_(executor ? std::move(executor) : std::make_shared<LLZXRefreshExecutor>())
+	{}
+
+	// 读取，未命中时同步加载；需要刷新时返回当前值并安排后台刷新
+	Value get(const Key& key)
+	{
+		Entry entry;
+		if (state_->cache.get(key, entry))
+		{
+			maybeRefresh(key, entry);
+			return std::move(entry.value);
+		}
+		return state_->load(key);
+	}
+
+	// 只读取已缓存的值，不同步加载，需要刷新时同样安排后台刷新
+	bool getIfPresent(const Key& key, Value& value)
+	{
+		Entry entry;
+		if (!state_->cache.get(key, entry))
+			return false;
+		maybeRefresh(key, entry);
+		value = std::move(entry.value);
+		return true;
+	}
+
+	void put(const Key& key, const Value& value)
+	{
+		state_->store(key, value);
+	}
+
+	void remove(const Key& key)
+	{
+		state_->cache.remove(key);
+	}
+
+	// 立即安排一次后台刷新（已有加载在进行时不重复安排），返回是否被执行器接受
+	bool refresh(const Key& key)
+	{
+		Entry entry;
+		if (!state_->cache.get(key, entry))
+			return false;
+		return scheduleRefresh(key, entry.value);
+	}
+
+	size_t purgeExpired() { return state_->cache.purgeExpired(); }
+
+	const LLZXRefreshExecutor& executor() const { return *executor_; }
+
+private:
+	struct Entry
+	{
+		Value             value{};
+		Clock::time_point writtenAt{};
+	};
+
+	// 后台任务需要访问的部分，由缓存对象和未完成的刷新任务共同持有
+	struct State
+	{
+		State(size_t capacity, size_t sliceNum, Loader loaderFn, Duration refresh, Duration expire)
+			: cache(capacity, sliceNum)
+			, loader(std::move(loaderFn))
+			, refreshAfter(refresh)
+			, expireAfter(expire)
+		{}
+
+		void store(const Key& key, const Value& value)
+		{
+			Entry entry{value, Clock::now()};
+			if (expireAfter == LLZXExpiry::kNever)
+				cache.put(key, entry);
+			else
+				cache.put(key, entry, expireAfter);
+		}
+
+		// 同步加载：合并到正在进行的加载（包括后台刷新）上
+		Value load(const Key& key)
+		{
+			auto ticket = flights.join(key);
+			if (!ticket.leader)
+				return ticket.future.get();
+			return runLoad(key);
+		}
+
+		// 由加载者调用，结果写入缓存后唤醒等待者
+		Value runLoad(const Key& key)
+		{
+			try
+			{
+				Value value = loader(key);
+				store(key, value);
+				flights.complete(key, value);
+				return value;
+			}
+			catch (...)
+			{
+				flights.fail(key, std::current_exception());
+				throw;
+			}
+		}
+
+		LLZXHashLruCache<Key, Entry, Index> cache;
+		LLZXSingleFlight<Key, Value>        flights;
+		Loader                              loader;
+		Duration                            refreshAfter;
+		Duration                            expireAfter;
+	};
+
+	void maybeRefresh(const Key& key, const Entry& entry)
+	{
+		if (Clock::now() - entry.writtenAt >= state_->refreshAfter)
+			scheduleRefresh(key, entry.value);
+	}
+
+	bool scheduleRefresh(const Key& key, const Value& stale)
+	{
+		auto ticket = state_->flights.join(key);
+		if (!ticket.leader)
+			return false;
+
+		std::shared_ptr<State> state = state_;
+		bool accepted = executor_->trySubmit([state, key] {
+			// 失败时保留旧值，异常已经交给了合并到这次加载上的调用方
+			try { state->runLoad(key); } catch (...) {}
+		});
+		// 没有安排上时用旧值结束这次加载，期间合并进来的调用方拿到旧值
+		if (!accepted)
+			state_->flights.complete(key, stale);
+		return accepted;
+	}
+
+private:
+	std::shared_ptr<State>               state_;
+	std::shared_ptr<LLZXRefreshExecutor> executor_;
+};
+
+} // namespace LLZXCache
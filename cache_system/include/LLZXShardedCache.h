@@ -0,0 +1,581 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXCacheStats.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXPeriodicWorker.h"
+#include "LLZXPlatform.h"
+#include "LLZXSingleFlight.h"
+#include "LLZXSnapshot.h"
+
+namespace LLZXCache
+{
+
+// 分片的路由方式
+//   KeyHash:   按key的hash选择分片，分片按序号轮流分布在各个NUMA节点上
+//   NumaLocal: 每个NUMA节点拥有一组自己的分片，线程只访问本节点的分片，读路径不跨socket；
+//              put/remove会使其他节点上的同一key失效，适合读多写少、允许各节点各自缓存一份的场景
+enum class LLZXSliceRouting
+{
+	KeyHash,
+	NumaLocal,
+};
+
+//高并发情况下：分片缓存的通用实现，SliceCache是每个分片使用的缓存类型（如LLZXLruCache、LLZXLruKCache）
+// 分片数向上取整到2的幂，分片下标 = sliceMix64(hash(key)) & sliceMask_，避免取模除法，
+// 同时让连续的整数key均匀散开（libstdc++中std::hash<int>是恒等映射）
+// 每个分片单独分配在其所属NUMA节点的内存上，并按缓存行对齐，相邻分片的锁不会落在同一缓存行
+// SliceCache需要提供：put（含带ttl的版本）/get/visit/remove/emplace/size/purgeExpired、getManyIndexed/putManyIndexed，
+// 以及NodeMap类型（其hasher用于选择分片，kTransparent决定是否支持异构查找）
+// getOrLoad系列接口只在分片类型提供getOrLoad/getOrLoadAsync/joinLoad/completeLoad/failLoad时可用（如LLZXLruCache）
+// saveSnapshot/loadSnapshot只在分片类型提供encodeSnapshot/restoreLimit/restoreManyIndexed时可用（如LLZXLruCache）
+// setCapacity/rebalance只在分片类型提供capacity/setCapacity/missCount时可用（如LLZXLruCache）
+// tryGet/tryPut只在分片类型提供同名接口时可用（如LLZXLruCache）
+// 派生类在构造函数中调用initSlices创建分片
+template<typename Key, typename Value, typename SliceCache>
+class LLZXShardedCache : public LLZXCachePolicy<Key, Value>
+{
+	using Index = typename SliceCache::NodeMap;
+
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+	// 分片通过placement new构造在指定节点的内存上，析构时归还到对应节点
+	struct SliceDeleter
+	{
+		void operator()(SliceCache* slice) const
+		{
+			slice->~SliceCache();
+			detail::deallocateOnNode(slice, sizeof(SliceCache));
+		}
+	};
+	using SlicePtr = std::unique_ptr<SliceCache, SliceDeleter>;
+
+public:
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+	void put(const Key& key, const Value& value) override
+	{
+		// 根据key的hash值选择切片
+		size_t sliceIndex = sliceIndexOf(key);
+		invalidateRemoteReplicas(key, sliceIndex);
+		sliceCaches_[sliceIndex]->put(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		size_t sliceIndex = sliceIndexOf(key);
+		invalidateRemoteReplicas(key, sliceIndex);
+		sliceCaches_[sliceIndex]->put(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, std::chrono::steady_clock::duration ttl) override
+	{
+		size_t sliceIndex = sliceIndexOf(key);
+		invalidateRemoteReplicas(key, sliceIndex);
+		sliceCaches_[sliceIndex]->put(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		size_t sliceIndex = sliceIndexOf(key);
+		invalidateRemoteReplicas(key, sliceIndex);
+		sliceCaches_[sliceIndex]->emplace(key, std::forward<Args>(args)...);
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return sliceCaches_[sliceIndexOf(key)]->get(key, value);
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return sliceCaches_[sliceIndexOf(key)]->visit(key, visitor);
+	}
+
+	// 按分片分组后每个分片只加一次锁
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		const SliceGroups& groups = groupBySlice(keys, count);
+		size_t hitCount = 0;
+		for (size_t slice = 0; slice < sliceNum_; ++slice)
+		{
+			size_t begin = groups.begin[slice], end = groups.begin[slice + 1];
+			if (begin != end)
+				hitCount += sliceCaches_[slice]->getManyIndexed(keys, groups.order.data() + begin, end - begin, values, hits);
+		}
+		return hitCount;
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		const SliceGroups& groups = groupBySlice(keys, count);
+		for (size_t slice = 0; slice < sliceNum_; ++slice)
+		{
+			size_t begin = groups.begin[slice], end = groups.begin[slice + 1];
+			if (begin == end)
+				continue;
+			for (size_t j = begin; j < end; ++j)
+				invalidateRemoteReplicas(keys[groups.order[j]], slice);
+			sliceCaches_[slice]->putManyIndexed(keys, values, groups.order.data() + begin, end - begin);
+		}
+	}
+
+	// 异构查找，要求索引的hash是透明的，分片选择和分片内查找使用同一个hash
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return sliceCaches_[sliceIndexOf(key)]->get(key, value);
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		return sliceCaches_[sliceIndexOf(key)]->visit(key, std::forward<Fn>(fn));
+	}
+
+	// 非阻塞读写，只在分片类型提供tryGet/tryPut时可用（如LLZXLruCache），只尝试key所在分片的锁
+	template<typename K, typename = EnableIfLookup<K>>
+	LLZXTryResult tryGet(const K& key, Value& value)
+	{
+		return sliceCaches_[sliceIndexOf(key)]->tryGet(key, value);
+	}
+
+	bool tryPut(const Key& key, const Value& value, std::chrono::steady_clock::duration ttl = LLZXExpiry::kNever)
+	{
+		// NumaLocal模式下写入成功后才让其他节点的副本失效，这一步仍会等待那些分片的锁
+		size_t sliceIndex = sliceIndexOf(key);
+		if (!sliceCaches_[sliceIndex]->tryPut(key, value, ttl))
+			return false;
+		invalidateRemoteReplicas(key, sliceIndex);
+		return true;
+	}
+
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		size_t sliceIndex = sliceIndexOf(key);
+		invalidateRemoteReplicas(key, sliceIndex);
+		sliceCaches_[sliceIndex]->remove(key);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+	// 加载由key所在分片合并，含义同LLZXLruCache::getOrLoad
+	template<typename Loader>
+	Value getOrLoad(const Key& key, Loader&& loader, std::chrono::steady_clock::duration ttl = LLZXExpiry::kNever)
+	{
+		return sliceCaches_[sliceIndexOf(key)]->getOrLoad(key, std::forward<Loader>(loader), ttl);
+	}
+
+	template<typename Loader, typename Executor = LLZXDetachedExecutor>
+	std::shared_future<Value> getOrLoadAsync(const Key& key, Loader loader,
+		Executor&& executor = Executor(), std::chrono::steady_clock::duration ttl = LLZXExpiry::kNever)
+	{
+		return sliceCaches_[sliceIndexOf(key)]->getOrLoadAsync(key, std::move(loader),
+			std::forward<Executor>(executor), ttl);
+	}
+
+	// 跨分片的批量加载：所有分片中需要加载的key合并成一次loader调用
+	template<typename BatchLoader>
+	size_t getOrLoadMany(const Key* keys, size_t count, Value* values, BatchLoader&& loader,
+		std::chrono::steady_clock::duration ttl = LLZXExpiry::kNever)
+	{
+		return detail::singleFlightLoadMany(keys, count, values,
+			[this](const Key& key) -> SliceCache& { return *sliceCaches_[sliceIndexOf(key)]; }, loader, ttl);
+	}
+
+	// 逐个分片保存快照，每个分片在自己的锁内编码，同一时刻只锁住一个分片
+	template<typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>>
+	void saveSnapshot(const std::string& path)
+	{
+		detail::writeSnapshot(path, sliceNum_, [this](size_t slice, LLZXSnapshotOutput& out) {
+			return sliceCaches_[slice]->template encodeSnapshot<KeySerializer, ValueSerializer>(out);
+		});
+	}
+
+	// 用threadNum个线程（0表示硬件线程数）并行恢复，每个线程负责快照中的一部分分片，
+	// 分片数和hash与保存时相同时各线程写入不同的分片，互不竞争；不同时按key重新路由，结果同样正确
+	template<typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>>
+	size_t loadSnapshot(const std::string& path, size_t threadNum = 0)
+	{
+		size_t limit = 0;
+		for (const auto& slice : sliceCaches_)
+			limit = slice->restoreLimit() == SIZE_MAX ? SIZE_MAX : limit + slice->restoreLimit();
+		return detail::readSnapshot<KeySerializer, ValueSerializer, Key, Value>(path, threadNum, limit,
+			[this](size_t, LLZXSnapshotEntry<Key, Value>* entries, size_t count) {
+				restoreBatch(entries, count);
+			});
+	}
+
+	// 含义同LLZXLruCache::putIfAbsent，要求分片类型提供putIfAbsent
+	bool putIfAbsent(const Key& key, const Value& value, std::chrono::steady_clock::duration ttl = LLZXExpiry::kNever)
+	{
+		size_t sliceIndex = sliceIndexOf(key);
+		if (!sliceCaches_[sliceIndex]->putIfAbsent(key, value, ttl))
+			return false;
+		invalidateRemoteReplicas(key, sliceIndex);
+		return true;
+	}
+
+	// 给每个分片设置同一个驱逐回调，回调在各分片的锁内调用，可能被多个线程并发调用
+	template<typename Listener>
+	void setEvictionListener(const Listener& listener)
+	{
+		for (auto& slice : sliceCaches_)
+			slice->setEvictionListener(listener);
+	}
+
+	size_t sliceNum() const { return sliceNum_; }
+
+	// 总容量（所有分片容量之和的目标值）
+	size_t capacity() const
+	{
+		std::lock_guard<std::mutex> lock(resizeMutex_);
+		return capacity_;
+	}
+
+	// 在线调整总容量，各分片按当前的容量份额等比例缩放（rebalance之后的分配得以保留）
+	// 逐个分片调整，先缩小的分片后扩大的分片，任一时刻只有一个分片在驱逐，整体占用不会先涨后落
+	void setCapacity(size_t capacity)
+	{
+		std::lock_guard<std::mutex> lock(resizeMutex_);
+		std::vector<size_t> current = sliceCapacities();
+		std::vector<double> weights(current.begin(), current.end());
+		capacity_ = capacity;
+		applyCapacities(distribute(weights, capacity));
+	}
+
+	// 按上次调用以来各分片的未命中数重新分配容量，总容量不变，通常由LLZXSliceRebalancer定期调用
+	//   每个分片保底得到平均份额的minShare，其余容量按未命中数的比例分配，未命中多说明工作集超出了分片容量；
+	//   每次只向目标移动step的比例，避免在短时的突发上来回振荡；期间没有未命中时不调整
+	void rebalance(double step = 0.25, double minShare = 0.25)
+	{
+		std::lock_guard<std::mutex> lock(resizeMutex_);
+		lastMisses_.resize(sliceNum_, 0);
+		std::vector<double> misses(sliceNum_);
+		double totalMisses = 0;
+		for (size_t i = 0; i < sliceNum_; ++i)
+		{
+			uint64_t count = sliceCaches_[i]->missCount();
+			misses[i] = static_cast<double>(count - lastMisses_[i]);
+			lastMisses_[i] = count;
+			totalMisses += misses[i];
+		}
+		if (totalMisses == 0 || sliceNum_ == 1)
+			return;
+
+		step = std::min(std::max(step, 0.0), 1.0);
+		minShare = std::min(std::max(minShare, 0.0), 1.0);
+		double total = static_cast<double>(capacity_);
+		double floor = total / static_cast<double>(sliceNum_) * minShare;
+		double spread = total - floor * static_cast<double>(sliceNum_);
+		std::vector<double> weights(sliceNum_);
+		for (size_t i = 0; i < sliceNum_; ++i)
+		{
+			double current = static_cast<double>(sliceCaches_[i]->capacity());
+			double target = floor + spread * misses[i] / totalMisses;
+			weights[i] = current + step * (target - current);
+		}
+		applyCapacities(distribute(weights, capacity_));
+	}
+
+	// 每个分片当前的容量
+	std::vector<size_t> sliceCapacities() const
+	{
+		std::vector<size_t> capacities;
+		capacities.reserve(sliceNum_);
+		for (const auto& slice : sliceCaches_)
+			capacities.push_back(slice->capacity());
+		return capacities;
+	}
+
+	// 依次回收每个分片中已过期的元素，返回回收总数
+	size_t purgeExpired()
+	{
+		size_t purged = 0;
+		for (auto& slice : sliceCaches_)
+			purged += slice->purgeExpired();
+		return purged;
+	}
+
+	// 各分片统计之和，要求分片类型提供stats()
+	LLZXCacheStatsSnapshot stats() const
+	{
+		LLZXCacheStatsSnapshot total;
+		for (const auto& slice : sliceCaches_)
+			total += slice->stats();
+		return total;
+	}
+
+	// 每个分片各自的统计，用于定位热点分片或锁竞争集中的分片
+	std::vector<LLZXCacheStatsSnapshot> sliceStats() const
+	{
+		std::vector<LLZXCacheStatsSnapshot> stats;
+		stats.reserve(sliceNum_);
+		for (const auto& slice : sliceCaches_)
+			stats.push_back(slice->stats());
+		return stats;
+	}
+
+	// 每个分片当前的元素个数，用于观察分片间负载是否均衡
+	std::vector<size_t> sliceOccupancy() const
+	{
+		std::vector<size_t> occupancy;
+		occupancy.reserve(sliceNum_);
+		for (const auto& slice : sliceCaches_)
+			occupancy.push_back(slice->size());
+		return occupancy;
+	}
+
+protected:
+	LLZXShardedCache(size_t capacity, LLZXSliceRouting routing)
+		: capacity_(capacity)
+		, routing_(routing)
+		, numaNodes_(static_cast<size_t>(detail::numaNodeCount()))
+	{}
+
+	// 分片数确定后依次在对应节点上构造分片，makeCache(分片容量)返回构造好的分片
+	template<typename MakeCache>
+	void initSlices(size_t sliceNum, const MakeCache& makeCache)
+	{
+		size_t requested = sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency();
+		if (routing_ == LLZXSliceRouting::NumaLocal)
+		{
+			// 每个节点一组分片，组内分片数为2的幂
+			nodeSliceNum_ = detail::roundUpPowerOfTwo((requested + numaNodes_ - 1) / numaNodes_);
+			sliceNum_ = nodeSliceNum_ * numaNodes_;
+		}
+		else
+		{
+			sliceNum_ = detail::roundUpPowerOfTwo(requested);
+			nodeSliceNum_ = sliceNum_;
+		}
+		sliceMask_ = nodeSliceNum_ - 1;
+
+		size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));//获得每个分片大小
+		for(size_t i = 0; i < sliceNum_; ++i)
+		{
+			int node = static_cast<int>(routing_ == LLZXSliceRouting::NumaLocal ? i / nodeSliceNum_ : i % numaNodes_);
+			sliceCaches_.push_back(makeSlice(node, [&] { return makeCache(sliceSize); }));//创建切片缓存
+		}
+	}
+
+private:
+	// 分片类型不可拷贝也不可移动（持有锁），通过保证拷贝消除直接构造在节点内存上
+	template<typename Construct>
+	static SlicePtr makeSlice(int node, const Construct& construct)
+	{
+		void* memory = detail::allocateOnNode(sizeof(SliceCache), node);
+		try
+		{
+			return SlicePtr(new (memory) SliceCache(construct()));
+		}
+		catch (...)
+		{
+			detail::deallocateOnNode(memory, sizeof(SliceCache));
+			throw;
+		}
+	}
+
+	// 与分片内索引使用同一个hash函数，保证异构查找时落到同一个分片
+	template<typename K>
+	size_t Hash(const K& key) const
+	{
+		typename Index::hasher hashFunc;
+		return hashFunc(key);
+	}
+
+	template<typename K>
+	size_t sliceIndexOf(const K& key) const
+	{
+		size_t inNode = detail::sliceMix64(Hash(key)) & sliceMask_;
+		if (routing_ != LLZXSliceRouting::NumaLocal)
+			return inNode;
+		return localNode() * nodeSliceNum_ + inNode;
+	}
+
+	// 批量操作时按分片分组的结果：order中[begin[s], begin[s+1])是落在分片s上的key下标
+	struct SliceGroups
+	{
+		std::vector<uint32_t> sliceOf;
+		std::vector<uint32_t> order;
+		std::vector<size_t>   begin;
+		std::vector<size_t>   cursor;
+	};
+
+	// 计数排序把keys的下标按分片分组，缓冲是线程局部的，批量调用之间复用，不重复分配
+	const SliceGroups& groupBySlice(const Key* keys, size_t count) const
+	{
+		static thread_local SliceGroups groups;
+		groups.sliceOf.resize(count);
+		groups.order.resize(count);
+		groups.begin.assign(sliceNum_ + 1, 0);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			groups.sliceOf[i] = static_cast<uint32_t>(sliceIndexOf(keys[i]));
+			++groups.begin[groups.sliceOf[i] + 1];
+		}
+		for (size_t slice = 0; slice < sliceNum_; ++slice)
+			groups.begin[slice + 1] += groups.begin[slice];
+
+		groups.cursor.assign(groups.begin.begin(), groups.begin.end() - 1);
+		for (size_t i = 0; i < count; ++i)
+			groups.order[groups.cursor[groups.sliceOf[i]]++] = static_cast<uint32_t>(i);
+		return groups;
+	}
+
+	// 按weights的比例把total分给各分片，舍入的零头给小数部分最大的分片，总和恰好为total
+	static std::vector<size_t> distribute(const std::vector<double>& weights, size_t total)
+	{
+		double sum = 0;
+		for (double weight : weights)
+			sum += std::max(weight, 0.0);
+		std::vector<size_t> shares(weights.size(), 0);
+		if (weights.empty())
+			return shares;
+		if (sum <= 0)
+			return distribute(std::vector<double>(weights.size(), 1.0), total);
+
+		std::vector<std::pair<double, size_t>> fractions;
+		size_t assigned = 0;
+		for (size_t i = 0; i < weights.size(); ++i)
+		{
+			double exact = static_cast<double>(total) * std::max(weights[i], 0.0) / sum;
+			shares[i] = std::min(static_cast<size_t>(exact), total - assigned);
+			assigned += shares[i];
+			fractions.emplace_back(exact - static_cast<double>(shares[i]), i);
+		}
+		std::sort(fractions.begin(), fractions.end(), std::greater<std::pair<double, size_t>>());
+		for (size_t j = 0; assigned < total; j = (j + 1) % fractions.size(), ++assigned)
+			++shares[fractions[j].second];
+		return shares;
+	}
+
+	void applyCapacities(const std::vector<size_t>& capacities)
+	{
+		for (size_t i = 0; i < sliceNum_; ++i)
+			if (capacities[i] < sliceCaches_[i]->capacity())
+				sliceCaches_[i]->setCapacity(capacities[i]);
+		for (size_t i = 0; i < sliceNum_; ++i)
+			if (capacities[i] > sliceCaches_[i]->capacity())
+				sliceCaches_[i]->setCapacity(capacities[i]);
+	}
+
+	// 一批元素通常都属于同一个分片，直接整批插入；否则按分片稳定分组，保持组内的访问顺序
+	void restoreBatch(LLZXSnapshotEntry<Key, Value>* entries, size_t count)
+	{
+		if (count == 0)
+			return;
+		uint32_t sliceOf[detail::kSnapshotBatchSize];
+		bool sameSlice = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			sliceOf[i] = static_cast<uint32_t>(sliceIndexOf(entries[i].key));
+			sameSlice &= sliceOf[i] == sliceOf[0];
+		}
+		if (sameSlice)
+		{
+			sliceCaches_[sliceOf[0]]->restoreManyIndexed(entries, nullptr, count);
+			return;
+		}
+
+		uint32_t order[detail::kSnapshotBatchSize];
+		for (size_t i = 0; i < count; ++i)
+			order[i] = static_cast<uint32_t>(i);
+		std::stable_sort(order, order + count, [&sliceOf](uint32_t a, uint32_t b) { return sliceOf[a] < sliceOf[b]; });
+		for (size_t begin = 0, end; begin < count; begin = end)
+		{
+			for (end = begin + 1; end < count && sliceOf[order[end]] == sliceOf[order[begin]]; ++end) {}
+			sliceCaches_[sliceOf[order[begin]]]->restoreManyIndexed(entries, order + begin, end - begin);
+		}
+	}
+
+	// 线程所在节点缓存在thread_local中，每隔一段时间重新查询一次，以跟上线程迁移
+	size_t localNode() const
+	{
+		static thread_local size_t node = 0;
+		static thread_local unsigned calls = 0;
+		if ((calls++ & 1023) == 0)
+			node = static_cast<size_t>(detail::currentNumaNode());
+		return node < numaNodes_ ? node : 0;
+	}
+
+	// NumaLocal模式下，写操作让其他节点上同一key的副本失效
+	template<typename K>
+	void invalidateRemoteReplicas(const K& key, size_t sliceIndex)
+	{
+		if (routing_ != LLZXSliceRouting::NumaLocal || numaNodes_ == 1)
+			return;
+		size_t inNode = sliceIndex & sliceMask_;
+		for (size_t node = 0; node < numaNodes_; ++node)
+		{
+			size_t index = node * nodeSliceNum_ + inNode;
+			if (index != sliceIndex)
+				sliceCaches_[index]->remove(key);
+		}
+	}
+
+private:
+	size_t capacity_;//总容量，由resizeMutex_保护
+	mutable std::mutex resizeMutex_;//串行化setCapacity和rebalance
+	std::vector<uint64_t> lastMisses_;//上次rebalance时各分片的累计未命中数
+	size_t sliceNum_;//切片数量，2的幂
+	size_t nodeSliceNum_;//每个NUMA节点上的切片数量（KeyHash模式下等于sliceNum_）
+	size_t sliceMask_;
+	LLZXSliceRouting routing_;
+	size_t numaNodes_;
+	std::vector<SlicePtr> sliceCaches_;//切片缓存
+};
+
+// 后台线程每隔interval调用一次cache.rebalance(step, minShare)，析构时停止，cache需要比它活得更久
+class LLZXSliceRebalancer
+{
+public:
+	template<typename Cache>
+	explicit LLZXSliceRebalancer(Cache& cache, std::chrono::milliseconds interval = std::chrono::milliseconds(1000),
+		double step = 0.25, double minShare = 0.25)
+		: worker_([&cache, step, minShare] { cache.rebalance(step, minShare); }, interval)
+	{}
+
+private:
+	LLZXPeriodicWorker worker_;
+};
+
+} // namespace LLZXCache
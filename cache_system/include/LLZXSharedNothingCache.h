@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXLruCache.h"
+#include "LLZXMpscQueue.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXPlatform.h"
+
+namespace LLZXCache
+{
+
+// 每核一个线程、互不共享的分片LRU
+//   LLZXHashLruCache允许任意线程访问任意分片，多核下分片的锁和节点所在的缓存行在核之间来回迁移；
+//   这里每个分片只属于一个工作线程，其他线程把请求放进该工作线程的MPSC无锁队列，由它按批依次执行，
+//   分片数据只被所属线程访问，一直留在该核的缓存里（分片自身的锁只会被所属线程获取，从不发生争用）
+//   调用方在请求完成之前自旋等待，getMany/putMany按分片分组，每个分片只入队一次、整批只加一次锁
+//   工作线程可以绑定到各自的CPU上，分片在工作线程里构造，内存分配在该线程所在的NUMA节点
+//   队列满时调用方自旋重试；访问者回调在工作线程上执行，回调中不能再访问同一个缓存
+//   工作线程上抛出的异常（分配失败、访问者回调抛出等）随请求带回，在调用方线程上重新抛出；
+//   构造分片失败时构造函数停止已启动的工作线程并抛出该异常
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>, typename Allocator = std::allocator<char>>
+class LLZXSharedNothingCache : public LLZXCachePolicy<Key, Value>
+{
+	using SliceCache = LLZXLruCache<Key, Value, Index, Allocator>;
+	using Hash = typename Index::hasher;
+	using Duration = std::chrono::steady_clock::duration;
+
+public:
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+	using LLZXCachePolicy<Key, Value>::get;
+
+	// workerNum为0时取CPU核数，向上取整到2的幂；pinWorkers为true时第i个工作线程绑定到第i个CPU
+	explicit LLZXSharedNothingCache(size_t capacity, size_t workerNum = 0, bool pinWorkers = false,
+		size_t queueCapacity = 1024)
+	{
+		size_t requested = workerNum > 0 ? workerNum : std::thread::hardware_concurrency();
+		size_t count = detail::roundUpPowerOfTwo(requested > 0 ? requested : 1);
+		workerMask_ = count - 1;
+		size_t sliceSize = std::ceil(capacity / static_cast<double>(count));
+
+		workers_.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+			workers_.push_back(std::make_unique<Worker>(queueCapacity));
+		// 分片在各自的工作线程里构造，等所有分片就绪后再返回
+		try
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				Worker& worker = *workers_[i];
+				worker.thread = std::thread([this, &worker, i, sliceSize, pinWorkers] {
+					std::exception_ptr error;
+					try
+					{
+						if (pinWorkers)
+							detail::pinCurrentThread(i);
+						worker.slice = makeSlice(sliceSize);
+					}
+					catch (...)
+					{
+						error = std::current_exception();
+					}
+					{
+						std::lock_guard<std::mutex> lock(startMutex_);
+						if (error && !startError_)
+							startError_ = error;
+						++started_;
+					}
+					startCv_.notify_one();
+					if (!error)
+						run(worker);
+				});
+			}
+		}
+		catch (...)
+		{
+			shutdown();
+			throw;
+		}
+
+		std::unique_lock<std::mutex> lock(startMutex_);
+		startCv_.wait(lock, [this] { return started_ == workers_.size(); });
+		if (startError_)
+		{
+			lock.unlock();
+			shutdown();
+			std::rethrow_exception(startError_);
+		}
+	}
+
+	~LLZXSharedNothingCache() override
+	{
+		shutdown();
+	}
+
+	LLZXSharedNothingCache(const LLZXSharedNothingCache&) = delete;
+	LLZXSharedNothingCache& operator=(const LLZXSharedNothingCache&) = delete;
+
+	void put(const Key& key, const Value& value) override
+	{
+		Request request{Op::Put};
+		request.keys = &key;
+		request.input = &value;
+		request.ttl = LLZXExpiry::kNever;
+		execute(workerOf(key), request);
+	}
+
+	// 右值版本由工作线程把key和value移动进分片，调用方等待期间两者保持有效
+	void put(Key&& key, Value&& value) override
+	{
+		Request request{Op::PutMove};
+		request.movedKey = &key;
+		request.values = &value;
+		execute(workerOf(key), request);
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		Request request{Op::Put};
+		request.keys = &key;
+		request.input = &value;
+		request.ttl = ttl;
+		execute(workerOf(key), request);
+	}
+
+	bool get(const Key& key, Value& value) override
+	{
+		Request request{Op::Get};
+		request.keys = &key;
+		request.values = &value;
+		execute(workerOf(key), request);
+		return request.result != 0;
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		Request request{Op::Visit};
+		request.keys = &key;
+		request.visitor = &visitor;
+		execute(workerOf(key), request);
+		return request.result != 0;
+	}
+
+	void remove(const Key& key)
+	{
+		Request request{Op::Remove};
+		request.keys = &key;
+		execute(workerOf(key), request);
+	}
+
+	// 按工作线程分组，每个工作线程收到一个请求，在自己的分片上整批执行
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return executeGrouped(Op::GetMany, keys, count, values, nullptr, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		executeGrouped(Op::PutMany, keys, count, nullptr, values, nullptr);
+	}
+
+	// 各分片元素个数之和
+	size_t size()
+	{
+		return broadcast(Op::Size);
+	}
+
+	// 回收所有已过期的元素；工作线程空闲时也会自行回收
+	size_t purgeExpired()
+	{
+		return broadcast(Op::Purge);
+	}
+
+	size_t workerCount() const { return workers_.size(); }
+
+private:
+	enum class Op
+	{
+		Get,
+		Put,
+		PutMove,
+		Visit,
+		Remove,
+		GetMany,
+		PutMany,
+		Size,
+		Purge,
+	};
+
+	// 请求位于调用方的栈上，调用方在remaining归零之前不会返回
+	struct Request
+	{
+		Op                   op;
+		const Key*           keys = nullptr;
+		Key*                 movedKey = nullptr; // PutMove：工作线程从这里移动key
+		const uint32_t*      order = nullptr; // 批量请求中属于本分片的下标
+		size_t               count = 1;
+		Value*               values = nullptr;
+		const Value*         input = nullptr;
+		bool*                hits = nullptr;
+		const Visitor*       visitor = nullptr;
+		Duration             ttl{};
+		size_t               result = 0;
+		std::exception_ptr   error{};             // 工作线程执行时抛出的异常
+		std::atomic<size_t>* remaining = nullptr; // 同一次调用发出的、尚未完成的请求个数
+	};
+
+	struct SliceDeleter
+	{
+		void operator()(SliceCache* slice) const
+		{
+			slice->~SliceCache();
+			detail::deallocateOnNode(slice, sizeof(SliceCache));
+		}
+	};
+
+	// 工作线程的状态独占缓存行，生产者只写队列的tail和sleeping
+	struct alignas(kCacheLineSize) Worker
+	{
+		explicit Worker(size_t queueCapacity) : queue(queueCapacity) {}
+
+		LLZXCommon::LLZXMpscQueue<Request*> queue;
+		std::unique_ptr<SliceCache, SliceDeleter> slice;
+		std::atomic<bool>        sleeping{false};
+		std::mutex               mutex;
+		std::condition_variable  cv;
+		std::thread              thread;
+	};
+
+	// 工作线程一次最多取出的请求数
+	static constexpr size_t kDrainBatch = 64;
+	// 等待时先自旋kSpins轮，再让出CPU kYields次（工作线程之后进入休眠）；
+	// 线程数超过核数时自旋只会拖住持有CPU的对方，所以自旋阶段很短
+	static constexpr size_t kSpins = 128;
+	static constexpr size_t kYields = 64;
+	// 休眠期间定期醒来回收过期元素
+	static constexpr std::chrono::milliseconds kPurgeInterval{100};
+
+	static std::unique_ptr<SliceCache, SliceDeleter> makeSlice(size_t sliceSize)
+	{
+		void* memory = detail::allocateOnNode(sizeof(SliceCache), detail::currentNumaNode());
+		try
+		{
+			return std::unique_ptr<SliceCache, SliceDeleter>(new (memory) SliceCache(static_cast<int>(sliceSize)));
+		}
+		catch (...)
+		{
+			detail::deallocateOnNode(memory, sizeof(SliceCache));
+			throw;
+		}
+	}
+
+	// 通知所有工作线程退出并等待，已经入队的请求会先执行完
+	void shutdown()
+	{
+		stop_.store(true, std::memory_order_seq_cst);
+		for (auto& worker : workers_)
+			wake(*worker);
+		for (auto& worker : workers_)
+		{
+			if (worker->thread.joinable())
+				worker->thread.join();
+		}
+	}
+
+	size_t workerOf(const Key& key) const
+	{
+		return detail::sliceMix64(Hash()(key)) & workerMask_;
+	}
+
+	void execute(size_t index, Request& request)
+	{
+		std::atomic<size_t> remaining{1};
+		request.remaining = &remaining;
+		submit(index, &request);
+		waitFor(remaining);
+		if (request.error)
+			std::rethrow_exception(request.error);
+	}
+
+	size_t executeGrouped(Op op, const Key* keys, size_t count, Value* values, const Value* input, bool* hits)
+	{
+		if (count == 0)
+			return 0;
+
+		// 计数排序：order按工作线程分组保存下标
+		size_t workerNum = workers_.size();
+		std::vector<uint32_t> offsets(workerNum + 1, 0);
+		std::vector<uint32_t> owners(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			owners[i] = static_cast<uint32_t>(workerOf(keys[i]));
+			++offsets[owners[i] + 1];
+		}
+		for (size_t w = 0; w < workerNum; ++w)
+			offsets[w + 1] += offsets[w];
+		std::vector<uint32_t> order(count);
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < count; ++i)
+			order[cursor[owners[i]]++] = static_cast<uint32_t>(i);
+
+		std::vector<Request> requests;
+		std::vector<size_t> targets;
+		requests.reserve(workerNum);
+		targets.reserve(workerNum);
+		for (size_t w = 0; w < workerNum; ++w)
+		{
+			if (offsets[w] == offsets[w + 1])
+				continue;
+			Request request{op};
+			request.keys = keys;
+			request.order = order.data() + offsets[w];
+			request.count = offsets[w + 1] - offsets[w];
+			request.values = values;
+			request.input = input;
+			request.hits = hits;
+			requests.push_back(request);
+			targets.push_back(w);
+		}
+		return submitAll(requests, targets.data());
+	}
+
+	// 每个工作线程收到同一种请求，结果求和
+	size_t broadcast(Op op)
+	{
+		std::vector<Request> requests(workers_.size(), Request{op});
+		std::vector<size_t> targets(workers_.size());
+		for (size_t w = 0; w < targets.size(); ++w)
+			targets[w] = w;
+		return submitAll(requests, targets.data());
+	}
+
+	// requests[i]交给第targets[i]个工作线程，全部入队之后再统一等待，各分片并行执行；返回结果之和
+	size_t submitAll(std::vector<Request>& requests, const size_t* targets)
+	{
+		std::atomic<size_t> remaining{requests.size()};
+		for (size_t i = 0; i < requests.size(); ++i)
+		{
+			requests[i].remaining = &remaining;
+			submit(targets[i], &requests[i]);
+		}
+		waitFor(remaining);
+		size_t total = 0;
+		for (const Request& request : requests)
+		{
+			if (request.error)
+				std::rethrow_exception(request.error);
+			total += request.result;
+		}
+		return total;
+	}
+
+	// 放入队列后唤醒可能正在休眠的工作线程；队列满时自旋等待工作线程取走请求
+	void submit(size_t index, Request* request)
+	{
+		Worker& worker = *workers_[index];
+		while (!worker.queue.tryPush(request))
+			std::this_thread::yield();
+		// 与工作线程的"先置sleeping再检查队列"配对，保证两者至少有一方看到对方的写入
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (worker.sleeping.load(std::memory_order_relaxed))
+			wake(worker);
+	}
+
+	static void wake(Worker& worker)
+	{
+		{
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.sleeping.store(false, std::memory_order_relaxed);
+		}
+		worker.cv.notify_one();
+	}
+
+	// 请求通常在几微秒内完成，先自旋，较久未完成时让出CPU
+	static void waitFor(const std::atomic<size_t>& remaining)
+	{
+		for (size_t spins = 0; remaining.load(std::memory_order_acquire) != 0; ++spins)
+		{
+			if (spins < kSpins)
+				detail::cpuRelax();
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	void run(Worker& worker)
+	{
+		Request* batch[kDrainBatch];
+		size_t idle = 0;
+		for (;;)
+		{
+			size_t count = worker.queue.popMany(batch, kDrainBatch);
+			if (count > 0)
+			{
+				for (size_t i = 0; i < count; ++i)
+					process(*worker.slice, *batch[i]);
+				idle = 0;
+				continue;
+			}
+			if (stop_.load(std::memory_order_acquire) && worker.queue.empty())
+				return;
+			if (++idle < kSpins + kYields)
+			{
+				if (idle < kSpins)
+					detail::cpuRelax();
+				else
+					std::this_thread::yield();
+				continue;
+			}
+
+			// 长时间没有请求：顺便回收过期元素，然后休眠到有新请求或下一个回收周期
+			worker.slice->purgeExpired();
+			worker.sleeping.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!worker.queue.empty() || stop_.load(std::memory_order_relaxed))
+			{
+				worker.sleeping.store(false, std::memory_order_relaxed);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(worker.mutex);
+			worker.cv.wait_for(lock, kPurgeInterval, [&worker] {
+				return !worker.sleeping.load(std::memory_order_relaxed);
+			});
+			worker.sleeping.store(false, std::memory_order_relaxed);
+			idle = 0;
+		}
+	}
+
+	// 完成后最后访问的是remaining，之后请求所在的栈帧可能已经不存在；
+	// 异常记录在请求中，无论成功与否都要让remaining减一，调用方才不会一直等待
+	static void process(SliceCache& slice, Request& request)
+	{
+		try
+		{
+			dispatch(slice, request);
+		}
+		catch (...)
+		{
+			request.error = std::current_exception();
+		}
+		request.remaining->fetch_sub(1, std::memory_order_release);
+	}
+
+	static void dispatch(SliceCache& slice, Request& request)
+	{
+		switch (request.op)
+		{
+		case Op::Get:
+			request.result = slice.get(*request.keys, *request.values);
+			break;
+		case Op::Put:
+			slice.put(*request.keys, *request.input, request.ttl);
+			break;
+		case Op::PutMove:
+			slice.put(std::move(*request.movedKey), std::move(*request.values));
+			break;
+		case Op::Visit:
+			request.result = slice.visit(*request.keys, *request.visitor);
+			break;
+		case Op::Remove:
+			slice.remove(*request.keys);
+			break;
+		case Op::GetMany:
+			request.result = slice.getManyIndexed(request.keys, request.order, request.count, request.values, request.hits);
+			break;
+		case Op::PutMany:
+			slice.putManyIndexed(request.keys, request.input, request.order, request.count);
+			break;
+		case Op::Size:
+			request.result = slice.size();
+			break;
+		case Op::Purge:
+			request.result = slice.purgeExpired();
+			break;
+		}
+	}
+
+private:
+	std::vector<std::unique_ptr<Worker>> workers_;
+	size_t                               workerMask_;
+	std::atomic<bool>                    stop_{false};
+	std::mutex                           startMutex_;
+	std::condition_variable              startCv_;
+	size_t                               started_ = 0;
+	std::exception_ptr                   startError_; // 第一个构造失败的分片抛出的异常
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+// 同一个key的并发加载合并为一次（single-flight）
+// 第一个未命中的调用方成为加载者，其他调用方拿到同一个shared_future等待结果；
+// 加载者在把结果写入缓存之后调用complete/fail，之后到达的调用方直接命中缓存
+// 只在登记/摘除时持有自己的锁，加载过程中不持有任何锁
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class LLZXSingleFlight
+{
+public:
+	using Future = std::shared_future<Value>;
+
+	struct Ticket
+	{
+		Future future;
+		bool   leader; // true表示调用方负责执行加载，结束后必须调用complete或fail
+	};
+
+	Ticket join(const Key& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = flights_.find(key);
+		if (it != flights_.end())
+			return Ticket{it->second.future, false};
+
+		Flight& flight = flights_[key];
+		flight.future = flight.promise.get_future().share();
+		return Ticket{flight.future, true};
+	}
+
+	void complete(const Key& key, const Value& value)
+	{
+		take(key).set_value(value);
+	}
+
+	void fail(const Key& key, std::exception_ptr error)
+	{
+		take(key).set_exception(error);
+	}
+
+	// 正在加载中的key个数
+	size_t inFlight() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return flights_.size();
+	}
+
+private:
+	struct Flight
+	{
+		std::promise<Value> promise;
+		Future              future;
+	};
+
+	// 先从表中摘除再设置结果，等待者被唤醒时不会再看到这次加载
+	std::promise<Value> take(const Key& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = flights_.find(key);
+		std::promise<Value> promise = std::move(it->second.promise);
+		flights_.erase(it);
+		return promise;
+	}
+
+private:
+	mutable std::mutex                                  mutex_;
+	std::unordered_map<Key, Flight, Hash, KeyEqual>     flights_;
+};
+
+// 默认的异步执行方式：每次加载起一个分离线程
+// 缓存对象必须比尚未完成的加载活得更久；需要限制并发时传入自己的线程池
+struct LLZXDetachedExecutor
+{
+	void operator()(std::function<void()> task) const
+	{
+		std::thread(std::move(task)).detach();
+	}
+};
+
+namespace detail
+{
+
+// 批量加载的公共实现，cacheOf(key)返回key所在的缓存（分片），需要提供get/joinLoad/completeLoad/failLoad
+// 未命中且没有其他人在加载的key一次性交给loader(std::vector<Key>)，loader按相同顺序返回std::vector<Value>；
+// 已经有人在加载的key等待其结果。返回直接命中缓存的个数
+template<typename Key, typename Value, typename CacheOf, typename BatchLoader>
+size_t singleFlightLoadMany(const Key* keys, size_t count, Value* values,
+	const CacheOf& cacheOf, BatchLoader& loader, LLZXExpiry::Duration ttl)
+{
+	size_t hitCount = 0;
+	std::vector<size_t> led;
+	std::vector<std::pair<size_t, std::shared_future<Value>>> waiting;
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto& cache = cacheOf(keys[i]);
+		if (cache.get(keys[i], values[i]))
+		{
+			++hitCount;
+			continue;
+		}
+		auto ticket = cache.joinLoad(keys[i]);
+		if (ticket.leader)
+			led.push_back(i);
+		else
+			waiting.emplace_back(i, std::move(ticket.future));
+	}
+
+	if (!led.empty())
+	{
+		std::vector<Key> missing;
+		missing.reserve(led.size());
+		for (size_t i : led)
+			missing.push_back(keys[i]);
+
+		std::vector<Value> loaded;
+		try
+		{
+			loaded = loader(missing);
+			if (loaded.size() != missing.size())
+				throw std::length_error("batch loader returned a wrong number of values");
+		}
+		catch (...)
+		{
+			std::exception_ptr error = std::current_exception();
+			for (size_t i : led)
+				cacheOf(keys[i]).failLoad(keys[i], error);
+			throw;
+		}
+
+		for (size_t j = 0; j < led.size(); ++j)
+		{
+			size_t i = led[j];
+			cacheOf(keys[i]).completeLoad(keys[i], loaded[j], ttl);
+			values[i] = std::move(loaded[j]);
+		}
+	}
+
+	// 同一批中重复的key也在这里等待，它们的加载在上面已经完成
+	for (auto& entry : waiting)
+		values[entry.first] = entry.second.get();
+	return hitCount;
+}
+
+} // namespace detail
+
+} // namespace LLZXCache
@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LLZX_HAVE_MMAP 1
+#endif
+
+#include "LLZXNodeIndex.h"
+
+namespace LLZXCache
+{
+
+// 缓存快照的二进制格式（本机字节序，只用于同一架构上的重启预热）
+//   文件头：8字节魔数"LLZXSNP1"、uint32_t版本、uint32_t分片数、int64_t保存时刻（system_clock纳秒），
+//           之后每个分片一项{偏移, 字节数, 元素个数, 校验和}，均为uint64_t
+//   分片数据：元素按从最久未访问到最近访问的顺序排列，每个元素依次是剩余存活时间（varint，0表示不过期，
+//           否则为纳秒数+1）、key、value，key和value的编码由序列化器决定
+// 恢复时每个分片按文件中的顺序插入，最近访问的元素最后插入；容量小于快照时每个分片只恢复最近访问的一段
+
+// 序列化器写入的目标，内容先在内存中攒成一个分片，再整体写入文件
+class LLZXSnapshotOutput
+{
+public:
+	void write(const void* data, size_t size)
+	{
+		buffer_.append(static_cast<const char*>(data), size);
+	}
+
+	// LEB128变长整数，小于128的值只占1字节
+	void writeVarint(uint64_t value)
+	{
+		char bytes[10];
+		size_t size = 0;
+		while (value >= 0x80)
+		{
+			bytes[size++] = static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+		bytes[size++] = static_cast<char>(value);
+		buffer_.append(bytes, size);
+	}
+
+	// 覆盖已写入的[offset, offset + size)，用于回填先预留的长度等字段
+	void overwrite(size_t offset, const void* data, size_t size)
+	{
+		std::memcpy(&buffer_[offset], data, size);
+	}
+
+	const char* data() const { return buffer_.data(); }
+	size_t size() const { return buffer_.size(); }
+	void clear() { buffer_.clear(); }
+
+private:
+	std::string buffer_;
+};
+
+// 序列化器读取的来源，直接指向映射的文件内存，不拷贝；越界时返回false
+class LLZXSnapshotInput
+{
+public:
+	LLZXSnapshotInput(const char* begin, const char* end)
+		: pos_(begin)
+		, end_(end)
+	{}
+
+	bool read(void* out, size_t size)
+	{
+		const char* bytes = take(size);
+		if (bytes == nullptr)
+			return false;
+		std::memcpy(out, bytes, size);
+		return true;
+	}
+
+	bool readVarint(uint64_t& value)
+	{
+		value = 0;
+		for (unsigned shift = 0; shift < 64 && pos_ != end_; shift += 7)
+		{
+			uint8_t byte = static_cast<uint8_t>(*pos_++);
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	// 取出接下来的size字节，返回指向文件内存的指针，剩余不足时返回nullptr
+	const char* take(size_t size)
+	{
+		if (static_cast<size_t>(end_ - pos_) < size)
+			return nullptr;
+		const char* bytes = pos_;
+		pos_ += size;
+		return bytes;
+	}
+
+	bool empty() const { return pos_ == end_; }
+
+private:
+	const char* pos_;
+	const char* end_;
+};
+
+// key/value的序列化器：提供
+//   static void write(LLZXSnapshotOutput&, const T&)
+//   static bool read(LLZXSnapshotInput&, T&)    数据不完整时返回false
+// 内置平凡可拷贝类型（按字节拷贝）、std::string和std::vector的实现，其他类型可以特化LLZXSerializer，
+// 或者把自定义的序列化器作为saveSnapshot/loadSnapshot的模板参数传入
+template<typename T, typename Enable = void>
+struct LLZXSerializer
+{
+	static_assert(sizeof(T) == 0, "no LLZXSerializer for this type, specialize it or pass a serializer explicitly");
+};
+
+template<typename T>
+struct LLZXSerializer<T, std::enable_if_t<std::is_trivially_copyable<T>::value>>
+{
+	static void write(LLZXSnapshotOutput& out, const T& value) { out.write(&value, sizeof(T)); }
+	static bool read(LLZXSnapshotInput& in, T& value) { return in.read(&value, sizeof(T)); }
+};
+
+template<>
+struct LLZXSerializer<std::string>
+{
+	static void write(LLZXSnapshotOutput& out, const std::string& value)
+	{
+		out.writeVarint(value.size());
+		out.write(value.data(), value.size());
+	}
+
+	static bool read(LLZXSnapshotInput& in, std::string& value)
+	{
+		uint64_t size;
+		const char* bytes;
+		if (!in.readVarint(size) || (bytes = in.take(static_cast<size_t>(size))) == nullptr)
+			return false;
+		value.assign(bytes, static_cast<size_t>(size));
+		return true;
+	}
+};
+
+template<typename T>
+struct LLZXSerializer<std::vector<T>>
+{
+	static void write(LLZXSnapshotOutput& out, const std::vector<T>& value)
+	{
+		out.writeVarint(value.size());
+		for (const T& item : value)
+			LLZXSerializer<T>::write(out, item);
+	}
+
+	static bool read(LLZXSnapshotInput& in, std::vector<T>& value)
+	{
+		uint64_t size;
+		if (!in.readVarint(size))
+			return false;
+		value.clear();
+		// 不按文件中的长度预留，损坏的长度不会导致巨大的分配
+		for (uint64_t i = 0; i < size; ++i)
+		{
+			T item{};
+			if (!LLZXSerializer<T>::read(in, item))
+				return false;
+			value.push_back(std::move(item));
+		}
+		return true;
+	}
+};
+
+// 恢复时解码出的一个元素，ttl为kNever表示不过期
+template<typename Key, typename Value>
+struct LLZXSnapshotEntry
+{
+	Key                                 key{};
+	Value                               value{};
+	std::chrono::steady_clock::duration ttl = std::chrono::steady_clock::duration::max();
+};
+
+namespace detail
+{
+
+constexpr char kSnapshotMagic[8] = {'L', 'L', 'Z', 'X', 'S', 'N', 'P', '1'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kSnapshotBatchSize = 256; // 恢复时每批插入的元素个数，一批只加一次锁
+
+struct SnapshotHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t sliceCount;
+	int64_t  savedAt;
+};
+
+struct SnapshotSliceInfo
+{
+	uint64_t offset;
+	uint64_t bytes;
+	uint64_t count;
+	uint64_t checksum;
+};
+
+// 4路并行的乘法混合，只用于发现截断和损坏
+inline uint64_t snapshotChecksum(const char* data, size_t size)
+{
+	uint64_t lanes[4] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL};
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		for (size_t lane = 0; lane < 4; ++lane)
+		{
+			uint64_t word;
+			std::memcpy(&word, data + i + lane * 8, 8);
+			lanes[lane] = (lanes[lane] ^ word) * 0x9fb21c651e98df25ULL;
+			lanes[lane] ^= lanes[lane] >> 29;
+		}
+	}
+	uint64_t h = size;
+	for (; i < size; ++i)
+		h = (h ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ULL;
+	for (uint64_t lane : lanes)
+		h = sliceMix64(h ^ lane);
+	return h;
+}
+
+inline int64_t snapshotNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 以ttl为kNever表示不过期
+inline void writeSnapshotTtl(LLZXSnapshotOutput& out, std::chrono::steady_clock::duration ttl)
+{
+	if (ttl == std::chrono::steady_clock::duration::max())
+	{
+		out.writeVarint(0);
+		return;
+	}
+	auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count();
+	out.writeVarint(static_cast<uint64_t>(std::max<int64_t>(nanos, 0)) + 1);
+}
+
+// 依次写出sliceCount个分片，encode(i, out)把第i个分片编码进out并返回元素个数
+// 先写到path.tmp再改名，进程中途退出时不会留下半个快照；同一时刻内存中只有一个分片的编码结果
+template<typename Encode>
+void writeSnapshot(const std::string& path, size_t sliceCount, Encode&& encode)
+{
+	std::string tmpPath = path + ".tmp";
+	std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+	if (file == nullptr)
+		throw std::runtime_error("cannot open snapshot file: " + tmpPath);
+
+	try
+	{
+		SnapshotHeader header{};
+		std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+		header.version = kSnapshotVersion;
+		header.sliceCount = static_cast<uint32_t>(sliceCount);
+		header.savedAt = snapshotNow();
+
+		std::vector<SnapshotSliceInfo> slices(sliceCount);
+		uint64_t offset = sizeof(header) + sizeof(SnapshotSliceInfo) * sliceCount;
+		if (std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0)
+			throw std::runtime_error("cannot write snapshot file: " + tmpPath);
+
+		LLZXSnapshotOutput out;
+		for (size_t i = 0; i < sliceCount; ++i)
+		{
+			out.clear();
+			slices[i].count = encode(i, out);
+			slices[i].offset = offset;
+			slices[i].bytes = out.size();
+			slices[i].checksum = snapshotChecksum(out.data(), out.size());
+			if (std::fwrite(out.data(), 1, out.size(), file) != out.size())
+				throw std::runtime_error("cannot write snapshot file: " + tmpPath);
+			offset += out.size();
+		}
+
+		if (std::fseek(file, 0, SEEK_SET) != 0
+			|| std::fwrite(&header, sizeof(header), 1, file) != 1
+			|| (sliceCount > 0 && std::fwrite(slices.data(), sizeof(SnapshotSliceInfo), sliceCount, file) != sliceCount)
+			|| std::fflush(file) != 0)
+			throw std::runtime_error("cannot write snapshot file: " + tmpPath);
+#ifdef LLZX_HAVE_MMAP
+		::fsync(::fileno(file));
+#endif
+	}
+	catch (...)
+	{
+		std::fclose(file);
+		std::remove(tmpPath.c_str());
+		throw;
+	}
+
+	if (std::fclose(file) != 0 || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		std::remove(tmpPath.c_str());
+		throw std::runtime_error("cannot write snapshot file: " + path);
+	}
+}
+
+// 只读映射整个快照文件，不支持mmap的平台退化为读入内存
+class SnapshotFile
+{
+public:
+	explicit SnapshotFile(const std::string& path)
+	{
+#ifdef LLZX_HAVE_MMAP
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw std::runtime_error("cannot open snapshot file: " + path);
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+		{
+			::close(fd);
+			throw std::runtime_error("cannot open snapshot file: " + path);
+		}
+		size_ = static_cast<size_t>(st.st_size);
+		if (size_ > 0)
+		{
+			void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapped == MAP_FAILED)
+			{
+				::close(fd);
+				throw std::runtime_error("cannot map snapshot file: " + path);
+			}
+			data_ = static_cast<const char*>(mapped);
+			// 各分片由不同线程顺序读取，提前预读
+			::madvise(mapped, size_, MADV_WILLNEED);
+		}
+		::close(fd);
+#else
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			throw std::runtime_error("cannot open snapshot file: " + path);
+		char chunk[1 << 16];
+		for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;)
+			buffer_.append(chunk, n);
+		std::fclose(file);
+		data_ = buffer_.data();
+		size_ = buffer_.size();
+#endif
+
+		try
+		{
+			validate(path);
+		}
+		catch (...)
+		{
+			unmap();
+			throw;
+		}
+	}
+
+	~SnapshotFile() { unmap(); }
+
+	SnapshotFile(const SnapshotFile&) = delete;
+	SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+	size_t sliceCount() const { return header_.sliceCount; }
+	int64_t savedAt() const { return header_.savedAt; }
+
+	// 第i个分片的数据，校验和不符时抛出异常
+	LLZXSnapshotInput slice(size_t i) const
+	{
+		SnapshotSliceInfo info = sliceInfo(i);
+		const char* begin = data_ + info.offset;
+		if (snapshotChecksum(begin, static_cast<size_t>(info.bytes)) != info.checksum)
+			throw std::runtime_error("snapshot slice checksum mismatch");
+		return LLZXSnapshotInput(begin, begin + info.bytes);
+	}
+
+	size_t sliceEntries(size_t i) const { return static_cast<size_t>(sliceInfo(i).count); }
+
+private:
+	SnapshotSliceInfo sliceInfo(size_t i) const
+	{
+		SnapshotSliceInfo info;
+		std::memcpy(&info, data_ + sizeof(SnapshotHeader) + i * sizeof(SnapshotSliceInfo), sizeof(info));
+		return info;
+	}
+
+	void validate(const std::string& path)
+	{
+		if (size_ < sizeof(SnapshotHeader))
+			throw std::runtime_error("not a snapshot file: " + path);
+		std::memcpy(&header_, data_, sizeof(header_));
+		if (std::memcmp(header_.magic, kSnapshotMagic, sizeof(header_.magic)) != 0)
+			throw std::runtime_error("not a snapshot file: " + path);
+		if (header_.version != kSnapshotVersion)
+			throw std::runtime_error("unsupported snapshot version: " + path);
+		if ((size_ - sizeof(SnapshotHeader)) / sizeof(SnapshotSliceInfo) < header_.sliceCount)
+			throw std::runtime_error("truncated snapshot file: " + path);
+		for (size_t i = 0; i < header_.sliceCount; ++i)
+		{
+			SnapshotSliceInfo info = sliceInfo(i);
+			if (info.offset > size_ || info.bytes > size_ - info.offset)
+				throw std::runtime_error("truncated snapshot file: " + path);
+		}
+	}
+
+	void unmap()
+	{
+#ifdef LLZX_HAVE_MMAP
+		if (data_ != nullptr)
+			::munmap(const_cast<char*>(data_), size_);
+#endif
+		data_ = nullptr;
+	}
+
+private:
+	const char*    data_ = nullptr;
+	size_t         size_ = 0;
+	SnapshotHeader header_{};
+#ifndef LLZX_HAVE_MMAP
+	std::string    buffer_;
+#endif
+};
+
+// 用threadNum个线程（0表示硬件线程数，不超过分片数）并行解码各个分片，
+// 每解码出一批元素调用sink(快照分片下标, entries, count)，sink可以移走元素；返回恢复的元素个数
+// 剩余存活时间扣除了从保存到现在经过的时间，已经过期的元素直接跳过
+// 快照元素多于maxEntries时，每个分片按比例只恢复最近访问的一段：各分片之间没有全局的访问顺序，
+// 整体按顺序插入会让后面分片中较冷的元素挤掉前面分片中的热点
+template<typename KeySerializer, typename ValueSerializer, typename Key, typename Value, typename Sink>
+size_t readSnapshot(const std::string& path, size_t threadNum, size_t maxEntries, Sink&& sink)
+{
+	using Entry = LLZXSnapshotEntry<Key, Value>;
+	using Duration = std::chrono::steady_clock::duration;
+
+	SnapshotFile file(path);
+	size_t sliceCount = file.sliceCount();
+	Duration elapsed = std::chrono::duration_cast<Duration>(
+		std::chrono::nanoseconds(std::max<int64_t>(snapshotNow() - file.savedAt(), 0)));
+
+	uint64_t totalEntries = 0;
+	for (size_t i = 0; i < sliceCount; ++i)
+		totalEntries += file.sliceEntries(i);
+	double keepRatio = totalEntries > maxEntries ? static_cast<double>(maxEntries) / static_cast<double>(totalEntries) : 1.0;
+
+	std::atomic<size_t> nextSlice{0};
+	std::atomic<size_t> restored{0};
+	std::exception_ptr error;
+	std::mutex errorMutex;
+
+	auto worker = [&] {
+		try
+		{
+			std::vector<Entry> batch(kSnapshotBatchSize);
+			for (size_t slice; (slice = nextSlice.fetch_add(1)) < sliceCount;)
+			{
+				LLZXSnapshotInput in = file.slice(slice);
+				size_t remaining = file.sliceEntries(slice), filled = 0, kept = 0;
+				size_t skip = remaining - static_cast<size_t>(std::ceil(static_cast<double>(remaining) * keepRatio));
+				for (; remaining > 0; --remaining)
+				{
+					Entry& entry = batch[filled];
+					uint64_t ttl;
+					if (!in.readVarint(ttl) || !KeySerializer::read(in, entry.key) || !ValueSerializer::read(in, entry.value))
+						throw std::runtime_error("corrupt snapshot slice");
+					if (skip > 0)
+					{
+						--skip;
+						continue;
+					}
+					if (ttl != 0)
+					{
+						Duration left = std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(ttl - 1));
+						if (left <= elapsed)
+							continue;
+						entry.ttl = left - elapsed;
+					}
+					else
+						entry.ttl = Duration::max();
+
+					if (++filled == batch.size())
+					{
+						sink(slice, batch.data(), filled);
+						kept += filled;
+						filled = 0;
+					}
+				}
+				if (filled > 0)
+					sink(slice, batch.data(), filled);
+				restored.fetch_add(kept + filled, std::memory_order_relaxed);
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error)
+				error = std::current_exception();
+			// 让其他线程尽快停下
+			nextSlice.store(sliceCount);
+		}
+	};
+
+	size_t threads = threadNum > 0 ? threadNum : std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<size_t>(1, std::min(threads, sliceCount));
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < threads; ++i)
+		workers.emplace_back(worker);
+	worker();
+	for (auto& thread : workers)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+	return restored.load();
+}
+
+} // namespace detail
+
+} // namespace LLZXCache
@@ -0,0 +1,631 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXLruCache.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXPlatform.h"
+#include "LLZXSnapshot.h"
+
+namespace LLZXCache
+{
+
+// 日志结构的磁盘缓存层，存放从内存层驱逐下来的元素
+//   写入：demote只把元素放进内存中的待写队列，不做任何IO；后台线程把攒下的一批元素编码成一块连续的数据，
+//         用一次pwrite追加到当前段文件的末尾，全部是大块顺序写；队列满时丢弃新降级的元素，从不阻塞调用方
+//   空间：数据分成固定大小的段文件，总大小超过capacityBytes时整段删除最旧的段（FIFO），不做段内合并
+//   索引：内存中只保存 key的64位hash -> {段号, 偏移, 长度}，不保存key和值；读取时校验记录中的hash和key，
+//         hash冲突时后写入的覆盖先写入的，被覆盖的元素视为丢失
+//   读取：从索引找到位置后在锁外pread读出记录，段被删除时已打开的文件描述符由shared_ptr保持有效
+// 记录格式：uint32_t记录长度、uint64_t key的hash、int64_t过期时刻（steady_clock纳秒，0为不过期）、key、value
+// 磁盘层只是缓存，不在进程之间保留，打开目录时删除其中已有的段文件
+template<typename Key, typename Value,
+	typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>,
+	typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class LLZXDiskTier
+{
+public:
+	using Duration = std::chrono::steady_clock::duration;
+
+	LLZXDiskTier(const std::string& directory, uint64_t capacityBytes,
+		size_t segmentBytes = size_t(64) << 20, size_t maxPending = size_t(1) << 16)
+		: directory_(directory)
+		, capacityBytes_(std::max<uint64_t>(capacityBytes, segmentBytes))
+		, segmentBytes_(std::max<size_t>(segmentBytes, 4096))
+		, maxPending_(std::max<size_t>(maxPending, 1))
+	{
+		if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST)
+			throw std::runtime_error("cannot create disk tier directory: " + directory_);
+		removeStaleSegments();
+		openSegment();
+		writer_ = std::thread([this] { run(); });
+	}
+
+	~LLZXDiskTier()
+	{
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex_);
+			stop_ = true;
+		}
+		pendingCv_.notify_one();
+		writer_.join();
+		for (const auto& segment : segments_)
+			::unlink(segment->path.c_str());
+	}
+
+	LLZXDiskTier(const LLZXDiskTier&) = delete;
+	LLZXDiskTier& operator=(const LLZXDiskTier&) = delete;
+
+	// 降级一个元素，ttl为剩余存活时间（kNever表示不过期）；只拷贝进待写队列，可以在内存层的锁内调用
+	void demote(const Key& key, const Value& value, Duration ttl = Duration::max())
+	{
+		if (ttl <= Duration::zero())
+			return;
+		uint64_t hash = hashOf(key);
+		int64_t deadline = deadlineOf(ttl);
+		std::lock_guard<std::mutex> lock(pendingMutex_);
+		if (pending_.size() >= maxPending_)
+		{
+			dropped_.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		uint64_t seq = pendingBase_ + pending_.size();
+		pending_.push_back(Pending{hash, deadline, key, value});
+		// 索引先指向待写队列，写盘之后再改为磁盘位置；在待写队列的锁内登记，写线程不会先于登记处理这个元素
+		IndexStripe& stripe = stripeOf(hash);
+		std::lock_guard<std::mutex> indexLock(stripe.mutex);
+		stripe.map[hash] = Location{kPendingSegment, 0, seq};
+		if (pending_.size() == kBatchEntries)
+			pendingCv_.notify_one();
+	}
+
+	// 读取并从磁盘层删除（用于提升回内存层），命中时ttl为剩余存活时间
+	bool take(const Key& key, Value& value, Duration& ttl)
+	{
+		return lookup(key, value, ttl, true);
+	}
+
+	// 只读取，不删除
+	bool get(const Key& key, Value& value)
+	{
+		Duration ttl;
+		return lookup(key, value, ttl, false);
+	}
+
+	// 删除key，内存层写入新值或删除时调用，保证磁盘层不会留下旧值
+	void erase(const Key& key)
+	{
+		uint64_t hash = hashOf(key);
+		IndexStripe& stripe = stripeOf(hash);
+		std::lock_guard<std::mutex> lock(stripe.mutex);
+		stripe.map.erase(hash);
+	}
+
+	// 等待调用之前降级的元素全部写盘
+	void flush()
+	{
+		std::unique_lock<std::mutex> lock(pendingMutex_);
+		uint64_t target = pendingBase_ + pending_.size();
+		flushRequested_ = true;
+		pendingCv_.notify_one();
+		flushedCv_.wait(lock, [&] { return flushedSeq_ >= target; });
+	}
+
+	// 索引中的元素个数（包括尚未写盘的）
+	size_t size() const
+	{
+		size_t total = 0;
+		for (const auto& stripe : stripes_)
+		{
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			total += stripe.map.size();
+		}
+		return total;
+	}
+
+	// 段文件占用的字节数，包括已被覆盖或删除、等待整段回收的记录
+	uint64_t bytes() const
+	{
+		std::lock_guard<std::mutex> lock(segmentMutex_);
+		return totalBytes_;
+	}
+
+	// 因待写队列已满或写盘失败而丢弃的元素个数
+	uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr uint32_t kPendingSegment = UINT32_MAX;
+	static constexpr size_t kBatchEntries = 1024; // 攒够这么多元素立即写盘
+	static constexpr size_t kStripeNum = 16;
+	static constexpr auto kFlushInterval = std::chrono::milliseconds(10);
+
+	// 段号为kPendingSegment时offset是待写队列中的序号
+	struct Location
+	{
+		uint32_t segment;
+		uint32_t length;
+		uint64_t offset;
+
+		bool operator==(const Location& other) const
+		{
+			return segment == other.segment && length == other.length && offset == other.offset;
+		}
+	};
+
+	struct Pending
+	{
+		uint64_t hash;
+		int64_t  deadline;
+		Key      key;
+		Value    value;
+	};
+
+	struct Segment
+	{
+		uint32_t              id;
+		int                   fd;
+		std::string           path;
+		uint64_t              size = 0;
+		std::vector<uint64_t> hashes; // 写入这个段的key的hash，删除段时据此清理索引，只由写线程访问
+
+		~Segment() { ::close(fd); }
+	};
+
+	// 索引按hash分成多段，内存层的每次写入都要删除磁盘层的旧值，分段减少竞争
+	struct IndexStripe
+	{
+		alignas(kCacheLineSize) mutable std::mutex mutex;
+		std::unordered_map<uint64_t, Location> map;
+	};
+
+	uint64_t hashOf(const Key& key) const { return detail::sliceMix64(Hash()(key)); }
+
+	IndexStripe& stripeOf(uint64_t hash) { return stripes_[hash >> 60 & (kStripeNum - 1)]; }
+
+	static int64_t nowNanos()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static int64_t deadlineOf(Duration ttl)
+	{
+		if (ttl == Duration::max())
+			return 0;
+		int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count();
+		int64_t now = nowNanos();
+		return nanos > INT64_MAX - now ? 0 : now + nanos;
+	}
+
+	// 命中时返回剩余存活时间
+	static bool alive(int64_t deadline, Duration& ttl)
+	{
+		if (deadline == 0)
+		{
+			ttl = Duration::max();
+			return true;
+		}
+		int64_t left = deadline - nowNanos();
+		ttl = std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(left));
+		return left > 0;
+	}
+
+	std::string segmentPath(uint32_t id) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "/segment-%06u.log", id);
+		return directory_ + name;
+	}
+
+	bool lookup(const Key& key, Value& value, Duration& ttl, bool remove)
+	{
+		uint64_t hash = hashOf(key);
+		IndexStripe& stripe = stripeOf(hash);
+		std::unique_lock<std::mutex> lock(stripe.mutex);
+		auto it = stripe.map.find(hash);
+		if (it == stripe.map.end())
+			return false;
+
+		// 读取期间位置可能改变（如刚刚写盘，或同一个key又被降级），改变时按新位置再读一次，取到最新的值
+		for (int attempt = 0;; ++attempt)
+		{
+			Location location = it->second;
+			lock.unlock();
+			bool found = location.segment == kPendingSegment
+				? readPending(key, location.offset, value, ttl)
+				: readRecord(key, location, value, ttl);
+			lock.lock();
+
+			it = stripe.map.find(hash);
+			if (it == stripe.map.end())
+				return found;
+			bool moved = !(it->second == location);
+			if (moved && attempt == 0)
+				continue;
+			// 取出时删除索引当前指向的项，即使它在读取期间被挪到了别处，否则磁盘层会留下一份已经提升的旧值；
+			// 过期或校验失败时只删除仍指向同一位置的项
+			if ((remove && found) || (!found && !moved))
+				stripe.map.erase(it);
+			return found;
+		}
+	}
+
+	bool readPending(const Key& key, uint64_t seq, Value& value, Duration& ttl)
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex_);
+		const Pending* entry = nullptr;
+		if (seq >= pendingBase_ && seq - pendingBase_ < pending_.size())
+			entry = &pending_[static_cast<size_t>(seq - pendingBase_)];
+		else if (seq >= writingBase_ && seq - writingBase_ < writing_.size())
+			entry = &writing_[static_cast<size_t>(seq - writingBase_)];
+		if (entry == nullptr || !KeyEqual()(entry->key, key) || !alive(entry->deadline, ttl))
+			return false;
+		value = entry->value;
+		return true;
+	}
+
+	bool readRecord(const Key& key, const Location& location, Value& value, Duration& ttl)
+	{
+		std::shared_ptr<Segment> segment;
+		{
+			std::lock_guard<std::mutex> lock(segmentMutex_);
+			if (segments_.empty() || location.segment < segments_.front()->id)
+				return false;
+			segment = segments_[location.segment - segments_.front()->id];
+		}
+
+		static thread_local std::string buffer;
+		buffer.resize(location.length);
+		size_t done = 0;
+		while (done < location.length)
+		{
+			ssize_t n = ::pread(segment->fd, &buffer[done], location.length - done,
+				static_cast<off_t>(location.offset + done));
+			if (n <= 0)
+			{
+				if (n < 0 && errno == EINTR)
+					continue;
+				return false;
+			}
+			done += static_cast<size_t>(n);
+		}
+
+		LLZXSnapshotInput in(buffer.data(), buffer.data() + buffer.size());
+		uint32_t length;
+		uint64_t hash;
+		int64_t deadline;
+		Key storedKey{};
+		if (!in.read(&length, sizeof(length)) || length != location.length
+			|| !in.read(&hash, sizeof(hash)) || !in.read(&deadline, sizeof(deadline))
+			|| !KeySerializer::read(in, storedKey) || !KeyEqual()(storedKey, key)
+			|| !alive(deadline, ttl))
+			return false;
+		return ValueSerializer::read(in, value);
+	}
+
+	// 上一个进程留下的段文件不再有索引，直接删除
+	void removeStaleSegments()
+	{
+		DIR* dir = ::opendir(directory_.c_str());
+		if (dir == nullptr)
+			return;
+		while (const dirent* entry = ::readdir(dir))
+		{
+			unsigned id;
+			char tail;
+			if (std::sscanf(entry->d_name, "segment-%u.lo%c", &id, &tail) == 2 && tail == 'g')
+				::unlink((directory_ + "/" + entry->d_name).c_str());
+		}
+		::closedir(dir);
+	}
+
+	void openSegment()
+	{
+		auto segment = std::make_shared<Segment>();
+		segment->id = nextSegmentId_++;
+		segment->path = segmentPath(segment->id);
+		segment->fd = ::open(segment->path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (segment->fd < 0)
+			throw std::runtime_error("cannot create disk tier segment: " + segment->path);
+		std::lock_guard<std::mutex> lock(segmentMutex_);
+		segments_.push_back(std::move(segment));
+	}
+
+	// 删除最旧的段，只删除仍指向这个段的索引项
+	void dropOldestSegment()
+	{
+		std::shared_ptr<Segment> oldest;
+		{
+			std::lock_guard<std::mutex> lock(segmentMutex_);
+			oldest = segments_.front();
+			segments_.pop_front();
+			totalBytes_ -= oldest->size;
+		}
+		for (uint64_t hash : oldest->hashes)
+		{
+			IndexStripe& stripe = stripeOf(hash);
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			auto it = stripe.map.find(hash);
+			if (it != stripe.map.end() && it->second.segment == oldest->id)
+				stripe.map.erase(it);
+		}
+		::unlink(oldest->path.c_str());
+	}
+
+	void run()
+	{
+		LLZXSnapshotOutput out;
+		std::vector<uint32_t> lengths;
+		std::unique_lock<std::mutex> lock(pendingMutex_);
+		while (true)
+		{
+			pendingCv_.wait_for(lock, kFlushInterval, [this] {
+				return stop_ || flushRequested_ || pending_.size() >= kBatchEntries;
+			});
+			if (pending_.empty())
+			{
+				flushRequested_ = false;
+				flushedSeq_ = pendingBase_;
+				flushedCv_.notify_all();
+				if (stop_)
+					return;
+				continue;
+			}
+
+			// 交换出整批待写元素，编码和写盘期间不持有锁，降级可以继续进入新的队列
+			writing_.swap(pending_);
+			writingBase_ = pendingBase_;
+			pendingBase_ += writing_.size();
+			flushRequested_ = false;
+			lock.unlock();
+
+			writeBatch(out, lengths);
+
+			lock.lock();
+			flushedSeq_ = writingBase_ + writing_.size();
+			writing_.clear();
+			flushedCv_.notify_all();
+		}
+	}
+
+	void writeBatch(LLZXSnapshotOutput& out, std::vector<uint32_t>& lengths)
+	{
+		out.clear();
+		lengths.clear();
+		for (const Pending& entry : writing_)
+		{
+			size_t begin = out.size();
+			uint32_t placeholder = 0;
+			out.write(&placeholder, sizeof(placeholder));
+			out.write(&entry.hash, sizeof(entry.hash));
+			out.write(&entry.deadline, sizeof(entry.deadline));
+			KeySerializer::write(out, entry.key);
+			ValueSerializer::write(out, entry.value);
+			lengths.push_back(static_cast<uint32_t>(out.size() - begin));
+		}
+		// 长度在编码完整个记录之后回填
+		for (size_t i = 0, offset = 0; i < lengths.size(); offset += lengths[i++])
+			out.overwrite(offset, &lengths[i], sizeof(uint32_t));
+
+		// 当前段放不下这一批时换一个新段，总大小超出预算时整段删除最旧的段
+		Segment* segment = segments_.back().get();
+		if (segment->size > 0 && segment->size + out.size() > segmentBytes_)
+		{
+			openSegment();
+			segment = segments_.back().get();
+			while (bytes() > capacityBytes_ && segments_.size() > 1)
+				dropOldestSegment();
+		}
+
+		uint64_t base = segment->size;
+		bool written = true;
+		for (size_t done = 0; done < out.size();)
+		{
+			ssize_t n = ::pwrite(segment->fd, out.data() + done, out.size() - done, static_cast<off_t>(base + done));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+			{
+				// 写盘失败（如磁盘已满）时整批丢弃
+				written = false;
+				dropped_.fetch_add(writing_.size(), std::memory_order_relaxed);
+				break;
+			}
+			done += static_cast<size_t>(n);
+		}
+
+		if (written)
+		{
+			std::lock_guard<std::mutex> lock(segmentMutex_);
+			segment->size += out.size();
+			totalBytes_ += out.size();
+		}
+
+		uint64_t offset = base;
+		for (size_t i = 0; i < writing_.size(); offset += lengths[i++])
+		{
+			const Pending& entry = writing_[i];
+			IndexStripe& stripe = stripeOf(entry.hash);
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			auto it = stripe.map.find(entry.hash);
+			// 降级之后又被提升、删除或再次降级的元素不更新索引
+			if (it == stripe.map.end() || !(it->second == Location{kPendingSegment, 0, writingBase_ + i}))
+				continue;
+			if (written)
+			{
+				it->second = Location{segment->id, lengths[i], offset};
+				segment->hashes.push_back(entry.hash);
+			}
+			else
+				stripe.map.erase(it);
+		}
+	}
+
+private:
+	std::string                          directory_;
+	uint64_t                             capacityBytes_;
+	size_t                               segmentBytes_;
+	size_t                               maxPending_;
+	IndexStripe                          stripes_[kStripeNum];
+
+	std::mutex                           pendingMutex_;
+	std::condition_variable              pendingCv_;
+	std::condition_variable              flushedCv_;
+	std::vector<Pending>                 pending_;         // 等待写盘的元素
+	std::vector<Pending>                 writing_;         // 写线程正在写盘的一批，写线程编码时只读
+	uint64_t                             pendingBase_ = 0; // pending_[0]的序号
+	uint64_t                             writingBase_ = 0; // writing_[0]的序号
+	uint64_t                             flushedSeq_ = 0;  // 序号小于它的元素都已处理
+	bool                                 flushRequested_ = false;
+	bool                                 stop_ = false;
+
+	mutable std::mutex                   segmentMutex_;
+	std::deque<std::shared_ptr<Segment>> segments_;        // 按段号递增，只有写线程增删
+	uint32_t                             nextSegmentId_ = 0;
+	uint64_t                             totalBytes_ = 0;
+
+	std::atomic<uint64_t>                dropped_{0};
+	std::thread                          writer_;          // 最后构造，启动时其他成员已经就绪
+};
+
+// 两级缓存：内存中的分片LRU加磁盘层
+//   内存层驱逐的元素（连同剩余存活时间）降级到磁盘层，内存层的读写路径上没有任何磁盘IO
+//   内存未命中时查磁盘层，命中后从磁盘层取出并提升回内存层；提升用putIfAbsent，不覆盖并发写入的新值
+//   写入和删除先操作内存层再删除磁盘层中的旧值，同一个key只在一级中有效；顺序反过来时，
+//   两步之间被驱逐的旧值会在删除之后降级到磁盘层；通过memory()直接写入内存层不会清理磁盘层
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>,
+	typename KeySerializer = LLZXSerializer<Key>, typename ValueSerializer = LLZXSerializer<Value>>
+class LLZXTieredCache : public LLZXCachePolicy<Key, Value>
+{
+public:
+	using MemoryTier = LLZXHashLruCache<Key, Value, Index>;
+	using DiskTier = LLZXDiskTier<Key, Value, KeySerializer, ValueSerializer, typename Index::hasher>;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+	using Duration = std::chrono::steady_clock::duration;
+
+	// memoryCapacity为内存层元素个数，磁盘层的段文件放在directory下，总大小不超过diskCapacityBytes
+	LLZXTieredCache(size_t memoryCapacity, size_t sliceNum, const std::string& directory, uint64_t diskCapacityBytes,
+		size_t segmentBytes = size_t(64) << 20, LLZXReadMode readMode = LLZXReadMode::Exclusive)
+		: disk_(directory, diskCapacityBytes, segmentBytes)
+		, memory_(memoryCapacity, sliceNum, readMode)
+	{
+		memory_.setEvictionListener([this](const Key& key, const Value& value, Duration ttl) {
+			disk_.demote(key, value, ttl);
+		});
+	}
+
+	void put(const Key& key, const Value& value) override
+	{
+		memory_.put(key, value);
+		disk_.erase(key);
+	}
+
+	// 写入内存层之后还要用key删除磁盘层的旧值，key和value都不移动
+	void put(Key&& key, Value&& value) override
+	{
+		put(static_cast<const Key&>(key), static_cast<const Value&>(value));
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		memory_.put(key, value, ttl);
+		disk_.erase(key);
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return memory_.get(key, value) || promote(key, value);
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		if (memory_.visit(key, visitor))
+			return true;
+		Value value{};
+		if (!promote(key, value))
+			return false;
+		visitor(value);
+		return true;
+	}
+
+	// 内存层按分片批量读取，未命中的再逐个查磁盘层
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		size_t hitCount = memory_.getMany(keys, count, values, hits);
+		for (size_t i = 0; i < count && hitCount < count; ++i)
+		{
+			if (!hits[i] && promote(keys[i], values[i]))
+			{
+				hits[i] = true;
+				++hitCount;
+			}
+		}
+		return hitCount;
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		memory_.putMany(keys, values, count);
+		for (size_t i = 0; i < count; ++i)
+			disk_.erase(keys[i]);
+	}
+
+	void remove(const Key& key)
+	{
+		memory_.remove(key);
+		disk_.erase(key);
+	}
+
+	// 等待已降级的元素全部写盘
+	void flush() { disk_.flush(); }
+
+	MemoryTier& memory() { return memory_; }
+	DiskTier& disk() { return disk_; }
+
+private:
+	bool promote(const Key& key, Value& value)
+	{
+		Duration ttl;
+		if (!disk_.take(key, value, ttl))
+			return false;
+		memory_.putIfAbsent(key, value, ttl);
+		return true;
+	}
+
+private:
+	DiskTier   disk_;   // 先于内存层构造、后于内存层析构，内存层析构前不会再有降级
+	MemoryTier memory_;
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LLZXNodeSlab.h"
+#include "LLZXPeriodicWorker.h"
+
+namespace LLZXCache
+{
+
+// 分层时间轮（参考Linux内核定时器/Kafka的实现），时间以tick为单位
+//   共kLevels层，每层64个桶；第L层的一个桶覆盖64^L个tick，层数足够覆盖整个64位tick范围
+//   元素按 deadline ^ 当前tick 的最高不同位放到对应层，低层转完一圈时把上一层当前桶的元素重新分配到低层
+//   每个元素最多被重新分配kLevels次，插入、删除O(1)，到期处理均摊O(1)
+//   连续几层为空时时间直接跳到下一次需要处理的边界，长时间没有推进也不会逐tick空转
+// 元素用缓存中的槽位下标表示，链接信息保存在时间轮自己的数组中，不占用节点的空间
+// 不是线程安全的，由使用方加锁
+class LLZXTimingWheel
+{
+public:
+	static constexpr uint32_t kBits = 6;
+	static constexpr uint32_t kBuckets = 1u << kBits;
+	static constexpr uint32_t kLevels = (64 + kBits - 1) / kBits;
+
+	explicit LLZXTimingWheel(uint64_t now = 0)
+		: current_(now)
+	{
+		heads_.fill(kNullSlot);
+	}
+
+	// 设置slot的到期tick，已经设置过时覆盖；deadline不晚于当前tick时在下一个tick到期
+	void schedule(SlotIndex slot, uint64_t deadline)
+	{
+		if (slot >= links_.size())
+			links_.resize(std::max<size_t>(slot + 1, links_.size() * 2), Link{});
+		cancel(slot);
+		links_[slot].deadline = deadline;
+		place(slot, std::max(deadline, current_ + 1));
+		++size_;
+	}
+
+	void cancel(SlotIndex slot)
+	{
+		if (!scheduled(slot))
+			return;
+		unlink(slot);
+		--size_;
+	}
+
+	bool scheduled(SlotIndex slot) const
+	{
+		return slot < links_.size() && links_[slot].bucket != kNoBucket;
+	}
+
+	uint64_t deadlineOf(SlotIndex slot) const { return links_[slot].deadline; }
+
+	size_t size() const { return size_; }
+	uint64_t now() const { return current_; }
+
+	// 推进到now，对每个到期的槽位调用onExpired(slot)，调用前槽位已从时间轮摘除；返回到期个数
+	template<typename Fn>
+	size_t advance(uint64_t now, Fn&& onExpired)
+	{
+		size_t expired = 0;
+		while (current_ < now)
+		{
+			if (size_ == 0)
+			{
+				current_ = now;
+				break;
+			}
+
+			// 第0..L-1层都为空时，下一次需要处理的时刻是第L-1层转完一圈的边界
+			uint64_t next = current_ + 1;
+			for (uint32_t level = 0; level + 1 < kLevels && levelCount_[level] == 0; ++level)
+				next = (current_ | lowMask(level + 1)) + 1;
+			if (next > now)
+			{
+				current_ = now;
+				break;
+			}
+			current_ = next;
+
+			// 从高层往低层依次把当前桶分配下去，最后处理第0层当前桶中到期的元素
+			uint32_t top = 0;
+			while (top + 1 < kLevels && (current_ & lowMask(top + 1)) == 0)
+				++top;
+			for (uint32_t level = top; level >= 1; --level)
+				cascade(level);
+
+			uint32_t bucket = static_cast<uint32_t>(current_ & (kBuckets - 1));
+			while (heads_[bucket] != kNullSlot)
+			{
+				SlotIndex slot = heads_[bucket];
+				unlink(slot);
+				--size_;
+				++expired;
+				onExpired(slot);
+			}
+		}
+		return expired;
+	}
+
+	void clear()
+	{
+		links_.clear();
+		heads_.fill(kNullSlot);
+		levelCount_.fill(0);
+		size_ = 0;
+	}
+
+private:
+	static constexpr uint32_t kNoBucket = UINT32_MAX;
+
+	struct Link
+	{
+		uint64_t  deadline = 0;
+		SlotIndex prev = kNullSlot;
+		SlotIndex next = kNullSlot;
+		uint32_t  bucket = kNoBucket;
+	};
+
+	static uint64_t lowMask(uint32_t levels)
+	{
+		return (uint64_t(1) << (kBits * levels)) - 1;
+	}
+
+	// tick不早于current_，按与current_的最高不同位选择层
+	void place(SlotIndex slot, uint64_t tick)
+	{
+		uint64_t diff = tick ^ current_;
+		uint32_t level = diff == 0 ? 0 : (63 - static_cast<uint32_t>(__builtin_clzll(diff))) / kBits;
+		uint32_t bucket = level * kBuckets + static_cast<uint32_t>((tick >> (kBits * level)) & (kBuckets - 1));
+
+		Link& link = links_[slot];
+		link.bucket = bucket;
+		link.prev = kNullSlot;
+		link.next = heads_[bucket];
+		if (link.next != kNullSlot)
+			links_[link.next].prev = slot;
+		heads_[bucket] = slot;
+		++levelCount_[level];
+	}
+
+	void unlink(SlotIndex slot)
+	{
+		Link& link = links_[slot];
+		if (link.prev != kNullSlot)
+			links_[link.prev].next = link.next;
+		else
+			heads_[link.bucket] = link.next;
+		if (link.next != kNullSlot)
+			links_[link.next].prev = link.prev;
+		--levelCount_[link.bucket / kBuckets];
+		link.bucket = kNoBucket;
+		link.prev = link.next = kNullSlot;
+	}
+
+	// 第level层当前桶中的元素高位已经与current_一致，按剩余的低位重新放到更低的层
+	void cascade(uint32_t level)
+	{
+		uint32_t bucket = level * kBuckets + static_cast<uint32_t>((current_ >> (kBits * level)) & (kBuckets - 1));
+		while (heads_[bucket] != kNullSlot)
+		{
+			SlotIndex slot = heads_[bucket];
+			unlink(slot);
+			// 调度时已经过期的元素按current_+1放置，可能落在高层，这里同样不能早于当前tick
+			place(slot, std::max(links_[slot].deadline, current_));
+		}
+	}
+
+private:
+	std::vector<Link>                          links_;     // 按槽位下标保存的链接信息
+	std::array<SlotIndex, kLevels * kBuckets>  heads_;     // 每个桶的链表头
+	std::array<size_t, kLevels>                levelCount_{};
+	uint64_t                                   current_;
+	size_t                                     size_ = 0;
+};
+
+// 缓存使用的过期时间管理：在时间轮之上加上时钟，时间轮在第一次设置TTL时才创建，
+// 不使用TTL的缓存只多一个空指针，读写路径上不读时钟
+// 元素的存活时间至少为ttl，最多再多一个tick
+class LLZXExpiry
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using Duration = Clock::duration;
+
+	// 表示不过期
+	static constexpr Duration kNever = Duration::max();
+
+	explicit LLZXExpiry(Duration tick = std::chrono::milliseconds(1))
+		: tick_(std::max<Duration>(tick, Duration(1)))
+		, origin_(Clock::now())
+	{}
+
+	// 设置slot在ttl之后过期，kNever表示取消过期时间
+	void expireAfter(SlotIndex slot, Duration ttl)
+	{
+		if (ttl == kNever)
+		{
+			cancel(slot);
+			return;
+		}
+		if (!wheel_)
+			wheel_ = std::make_unique<LLZXTimingWheel>(nowTick());
+		wheel_->schedule(slot, deadlineTick(ttl));
+	}
+
+	void cancel(SlotIndex slot)
+	{
+		if (wheel_)
+			wheel_->cancel(slot);
+	}
+
+	// 只读检查，可以在共享锁下调用
+	bool expired(SlotIndex slot) const
+	{
+		return wheel_ && wheel_->scheduled(slot) && wheel_->deadlineOf(slot) <= nowTick();
+	}
+
+	// 剩余存活时间，没有设置过期时间时返回kNever
+	Duration remaining(SlotIndex slot) const
+	{
+		if (!wheel_ || !wheel_->scheduled(slot))
+			return kNever;
+		uint64_t now = nowTick(), deadline = wheel_->deadlineOf(slot);
+		return deadline > now ? tick_ * static_cast<Duration::rep>(deadline - now) : Duration::zero();
+	}
+
+	// 把到期的元素交给onExpired(slot)回收，没有设置过TTL时不读时钟，直接返回
+	template<typename Fn>
+	size_t purge(Fn&& onExpired)
+	{
+		if (!wheel_ || wheel_->size() == 0)
+			return 0;
+		return wheel_->advance(nowTick(), std::forward<Fn>(onExpired));
+	}
+
+	size_t size() const { return wheel_ ? wheel_->size() : 0; }
+
+private:
+	uint64_t nowTick() const
+	{
+		return static_cast<uint64_t>((Clock::now() - origin_) / tick_);
+	}
+
+	// 到期tick向上取整，保证至少存活ttl
+	uint64_t deadlineTick(Duration ttl) const
+	{
+		Duration elapsed = Clock::now() - origin_;
+		ttl = std::max(ttl, Duration::zero());
+		if (ttl > Duration::max() - elapsed)
+			return UINT64_MAX;
+		Duration deadline = elapsed + ttl;
+		return static_cast<uint64_t>((deadline + tick_ - Duration(1)) / tick_);
+	}
+
+private:
+	Duration                         tick_;
+	Clock::time_point                origin_;
+	std::unique_ptr<LLZXTimingWheel> wheel_;
+};
+
+// 可选的后台清理线程：每隔interval调用一次cache.purgeExpired()，
+// 即使长时间没有写操作，过期元素也会被及时回收；析构时停止线程
+class LLZXExpiryReaper
+{
+public:
+	template<typename Cache>
+	explicit LLZXExpiryReaper(Cache& cache, std::chrono::milliseconds interval = std::chrono::milliseconds(100))
+		: worker_([&cache] { cache.purgeExpired(); }, interval)
+	{}
+
+private:
+	LLZXPeriodicWorker worker_;
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,443 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXCountMinSketch.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+#include "LLZXPlatform.h"
+#include "LLZXShardedCache.h"
+#include "LLZXTimingWheel.h"
+
+namespace LLZXCache
+{
+
+template<typename Key, typename Value, typename Index> class LLZXTinyLfuCache;
+
+// W-TinyLFU节点：除了链表下标外，记录节点当前所在的区域
+template<typename Key, typename Value>
+class TinyLfuNode
+{
+public:
+	enum class Segment : uint8_t
+	{
+		Window,    // 窗口LRU，新元素先进入这里
+		Probation, // 主缓存的试用区
+		Protected, // 主缓存的保护区，在试用区再次命中后晋升到这里
+	};
+
+	TinyLfuNode(Key key, Value value)
+		: key_(std::move(key))
+		, value_(std::move(value))
+		, prev_(kNullSlot)
+		, next_(kNullSlot)
+		, segment_(Segment::Window)
+	{}
+
+	const Key& getKey() const { return key_; }
+	const Value& getValue() const { return value_; }
+
+	template<typename K, typename V>
+	void reset(K&& key, V&& value)
+	{
+		key_ = std::forward<K>(key);
+		value_ = std::forward<V>(value);
+		segment_ = Segment::Window;
+	}
+
+private:
+	Key       key_;
+	Value     value_;
+	SlotIndex prev_;
+	SlotIndex next_;
+	Segment   segment_;
+
+	template<typename, typename, typename> friend class LLZXTinyLfuCache;
+	template<typename, typename> friend class LLZXNodeSlab;
+	template<typename> friend class LLZXNodeList;
+};
+
+// W-TinyLFU缓存（参考Caffeine）
+//   窗口LRU(约1%容量)吸收新元素和突发流量；主缓存为分段LRU，试用区约20%，保护区约80%
+//   元素被挤出窗口时，与试用区最久未访问的元素比较Count-Min Sketch估计的访问频率，频率更高的留下
+//   周期性扫描只会冲刷窗口，不会把主缓存中的热点换出去；Sketch定期减半，访问频率会随时间老化
+// 命中路径是O(1)的链表调整加一次Sketch计数，没有经典LFU的堆/有序结构开销
+// 节点存储和索引与LLZXLruCache相同（LLZXNodeSlab + LLZXNodeList + Index）
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXTinyLfuCache : public LLZXCachePolicy<Key, Value>
+{
+public:
+	using NodeType = TinyLfuNode<Key, Value>;
+	using Segment = typename NodeType::Segment;
+	using NodeSlab = LLZXNodeSlab<NodeType>;
+	using NodeList = LLZXNodeList<NodeSlab>;
+	using NodeMap = Index;
+	using Duration = LLZXExpiry::Duration;
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+private:
+	template<typename K>
+	using EnableIfLookup = std::enable_if_t<std::is_same<K, Key>::value || Index::kTransparent>;
+	template<typename K>
+	using EnableIfHeterogeneous = std::enable_if_t<!std::is_same<K, Key>::value && Index::kTransparent>;
+
+public:
+	explicit LLZXTinyLfuCache(int capacity)
+		: capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+		, slab_(capacity_)
+		, sketch_(std::max<size_t>(capacity_, 1))
+	{
+		nodeMap_.reserve(capacity_);
+		windowCapacity_ = std::max<size_t>(1, capacity_ / 100);
+		size_t mainCapacity = capacity_ > windowCapacity_ ? capacity_ - windowCapacity_ : 0;
+		protectedCapacity_ = mainCapacity * 4 / 5;
+		mainCapacity_ = mainCapacity;
+	}
+
+	void put(const Key& key, const Value& value) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, Duration ttl) override
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, value, ttl);
+	}
+
+	template<typename... Args>
+	void emplace(const Key& key, Args&&... args)
+	{
+		Value value(std::forward<Args>(args)...);
+		std::lock_guard<std::mutex> lock(mutex_);
+		putLocked(key, std::move(value));
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	Value get(const Key& key) override
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		return visit<Key, const Visitor&>(key, visitor);
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	bool get(const K& key, Value& value)
+	{
+		return visit(key, [&value](const Value& cached) { value = cached; });
+	}
+
+	template<typename K, typename = EnableIfHeterogeneous<K>>
+	Value get(const K& key)
+	{
+		Value value{};
+		get(key, value);
+		return value;
+	}
+
+	template<typename K, typename Fn, typename = EnableIfLookup<K>>
+	bool visit(const K& key, Fn&& fn)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		SlotIndex slot = lookupLocked(key);
+		if (slot == kNullSlot)
+			return false;
+		fn(slab_[slot].getValue());
+		return true;
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		return getManyIndexed(keys, nullptr, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		putManyIndexed(keys, values, nullptr, count);
+	}
+
+	// 批量读取，order含义同LLZXLruCache::getManyIndexed，整批只加一次锁
+	size_t getManyIndexed(const Key* keys, const uint32_t* order, size_t count, Value* values, bool* hits)
+	{
+		size_t hitCount = 0;
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			if (j + kPrefetchDistance < count)
+				nodeMap_.prefetch(keys[order ? order[j + kPrefetchDistance] : j + kPrefetchDistance]);
+			size_t i = order ? order[j] : j;
+			SlotIndex slot = lookupLocked(keys[i]);
+			hits[i] = slot != kNullSlot;
+			if (hits[i])
+			{
+				values[i] = slab_[slot].getValue();
+				++hitCount;
+			}
+		}
+		return hitCount;
+	}
+
+	void putManyIndexed(const Key* keys, const Value* values, const uint32_t* order, size_t count)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t j = 0; j < count; ++j)
+		{
+			size_t i = order ? order[j] : j;
+			putLocked(keys[i], values[i]);
+		}
+	}
+
+	template<typename K, typename = EnableIfLookup<K>>
+	void remove(const K& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot)
+			removeSlot(slot);
+	}
+
+	void remove(const Key& key)
+	{
+		remove<Key>(key);
+	}
+
+	// 包括已过期但尚未回收的元素
+	size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return nodeMap_.size();
+	}
+
+	// 回收所有已过期的元素，返回回收个数
+	size_t purgeExpired()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return purgeExpiredLocked();
+	}
+
+private:
+	static constexpr size_t kPrefetchDistance = 4;
+
+	struct KeyOfSlot
+	{
+		const NodeSlab* slab;
+		const Key& operator()(SlotIndex slot) const { return (*slab)[slot].getKey(); }
+	};
+
+	KeyOfSlot keyOf() const { return KeyOfSlot{&slab_}; }
+
+	template<typename K>
+	uint64_t hashOf(const K& key) const
+	{
+		return typename Index::hasher()(key);
+	}
+
+	NodeList& listOf(Segment segment)
+	{
+		switch (segment)
+		{
+		case Segment::Window:    return window_;
+		case Segment::Probation: return probation_;
+		default:                 return protected_;
+		}
+	}
+
+	// 查找并记录一次访问，命中时按所在区域调整位置，调用方需持有锁
+	template<typename K>
+	SlotIndex lookupLocked(const K& key)
+	{
+		sketch_.increment(hashOf(key));
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		if (slot != kNullSlot && expiry_.expired(slot))
+		{
+			removeSlot(slot);
+			return kNullSlot;
+		}
+		if (slot != kNullSlot)
+			onHit(slot);
+		return slot;
+	}
+
+	void onHit(SlotIndex slot)
+	{
+		NodeType& node = slab_[slot];
+		switch (node.segment_)
+		{
+		case Segment::Window:
+			window_.moveToBack(slab_, slot);
+			break;
+		case Segment::Probation:
+			// 试用区再次命中，晋升到保护区；保护区超出容量时把最久未访问的降级回试用区
+			probation_.unlink(slab_, slot);
+			node.segment_ = Segment::Protected;
+			protected_.pushBack(slab_, slot);
+			while (protected_.size() > protectedCapacity_)
+			{
+				SlotIndex demoted = protected_.popFront(slab_);
+				slab_[demoted].segment_ = Segment::Probation;
+				probation_.pushBack(slab_, demoted);
+			}
+			break;
+		case Segment::Protected:
+			protected_.moveToBack(slab_, slot);
+			break;
+		}
+	}
+
+	template<typename K, typename V>
+	void putLocked(K&& key, V&& value, Duration ttl = LLZXExpiry::kNever)
+	{
+		if (capacity_ == 0) return;
+
+		SlotIndex slot = nodeMap_.find(key, keyOf());
+		sketch_.increment(hashOf(key));
+		if (slot != kNullSlot)
+		{
+			slab_[slot].value_ = std::forward<V>(value);
+			onHit(slot);
+			expiry_.expireAfter(slot, ttl);
+			return;
+		}
+
+		// 总量已满时先回收已过期的元素，仍然不够再腾出一个槽位，腾出的槽位直接给新元素复用
+		if (nodeMap_.size() >= capacity_)
+			purgeExpiredLocked();
+		SlotIndex reuse = nodeMap_.size() >= capacity_ ? evictOne() : kNullSlot;
+		if (reuse != kNullSlot)
+		{
+			slab_[reuse].reset(std::forward<K>(key), std::forward<V>(value));
+			slot = reuse;
+		}
+		else
+		{
+			slot = slab_.allocate(std::forward<K>(key), std::forward<V>(value));
+		}
+
+		window_.pushBack(slab_, slot);
+		nodeMap_.insert(slab_[slot].getKey(), slot, keyOf());
+		expiry_.expireAfter(slot, ttl);
+		// 新元素进入窗口后，窗口超出容量的部分移交给主缓存做准入判断
+		while (window_.size() > windowCapacity_ && mainCapacity_ > 0)
+		{
+			SlotIndex candidate = window_.popFront(slab_);
+			slab_[candidate].segment_ = Segment::Probation;
+			probation_.pushBack(slab_, candidate);
+		}
+	}
+
+	// 淘汰一个元素并返回它的槽位
+	// 候选者是窗口中最久未访问的元素，受害者是主缓存中最久未访问的元素（优先取试用区），
+	// 两者比较Sketch估计的访问频率，频率更高的留在主缓存；主缓存容量为0时窗口退化为普通LRU
+	SlotIndex evictOne()
+	{
+		NodeList& mainList = probation_.empty() ? protected_ : probation_;
+		SlotIndex victim;
+		if (mainList.empty())
+		{
+			victim = window_.popFront(slab_);
+		}
+		else if (window_.empty())
+		{
+			victim = mainList.popFront(slab_);
+		}
+		else
+		{
+			SlotIndex candidate = window_.popFront(slab_);
+			SlotIndex mainVictim = mainList.front();
+			uint32_t candidateFreq = sketch_.estimate(hashOf(slab_[candidate].getKey()));
+			uint32_t victimFreq = sketch_.estimate(hashOf(slab_[mainVictim].getKey()));
+			if (candidateFreq > victimFreq)
+			{
+				mainList.unlink(slab_, mainVictim);
+				slab_[candidate].segment_ = Segment::Probation;
+				probation_.pushBack(slab_, candidate);
+				victim = mainVictim;
+			}
+			else
+			{
+				victim = candidate;
+			}
+		}
+
+		nodeMap_.erase(slab_[victim].getKey(), keyOf());
+		expiry_.cancel(victim);
+		return victim;
+	}
+
+	// 从索引和所在区域中摘除节点并归还槽位
+	void removeSlot(SlotIndex slot)
+	{
+		nodeMap_.erase(slab_[slot].getKey(), keyOf());
+		listOf(slab_[slot].segment_).unlink(slab_, slot);
+		expiry_.cancel(slot);
+		releaseSlot(slot);
+	}
+
+	size_t purgeExpiredLocked()
+	{
+		return expiry_.purge([this](SlotIndex slot) { removeSlot(slot); });
+	}
+
+	// key和值随即释放（如std::string的堆缓冲），槽位留给之后的插入复用
+	void releaseSlot(SlotIndex slot)
+	{
+		slab_[slot].key_ = Key{};
+		slab_[slot].value_ = Value{};
+		slab_.release(slot);
+	}
+
+private:
+	size_t   capacity_;          // 总容量
+	size_t   windowCapacity_;    // 窗口容量
+	size_t   mainCapacity_;      // 主缓存容量（试用区+保护区）
+	size_t   protectedCapacity_; // 保护区容量
+	NodeMap  nodeMap_;
+	alignas(kCacheLineSize) mutable std::mutex mutex_;
+	NodeSlab slab_;
+	NodeList window_;
+	NodeList probation_;
+	NodeList protected_;
+	LLZXCountMinSketch sketch_; // 访问频率估计，准入判断时使用
+	LLZXExpiry         expiry_;
+};
+
+//分片W-TinyLFU
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+class LLZXHashTinyLfuCache : public LLZXShardedCache<Key, Value, LLZXTinyLfuCache<Key, Value, Index>>
+{
+	using SliceCache = LLZXTinyLfuCache<Key, Value, Index>;
+	using ShardedCache = LLZXShardedCache<Key, Value, SliceCache>;
+
+public:
+	LLZXHashTinyLfuCache(size_t capacity, size_t sliceNum, LLZXSliceRouting routing = LLZXSliceRouting::KeyHash)
+		: ShardedCache(capacity, routing)
+	{
+		this->initSlices(sliceNum, [](size_t sliceSize) {
+			return SliceCache(static_cast<int>(sliceSize));
+		});
+	}
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXCachePolicy.h"
+#include "LLZXNodeIndex.h"
+#include "LLZXPlatform.h"
+
+namespace LLZXCache
+{
+
+// 访问trace的二进制格式（本机字节序）
+//   文件头：8字节魔数"LLZXTRC1"，uint64_t采样阈值（key的混合hash小于阈值的访问才被记录，UINT64_MAX表示全部记录）
+//   之后每条访问一个uint64_t：最高位是操作类型（0为get，1为put），低63位是key的混合hash
+// 同一线程的访问保持顺序；不同线程的记录按刷盘批次交错，顺序只精确到刷盘间隔
+enum class LLZXTraceOp : uint8_t
+{
+	Get = 0,
+	Put = 1,
+};
+
+namespace detail
+{
+
+constexpr char kTraceMagic[8] = {'L', 'L', 'Z', 'X', 'T', 'R', 'C', '1'};
+constexpr uint64_t kTraceOpBit = uint64_t(1) << 63;
+
+inline uint64_t traceThreshold(double sampleRate)
+{
+	if (!(sampleRate < 1.0))
+		return UINT64_MAX;
+	if (!(sampleRate > 0.0))
+		return 0;
+	double threshold = sampleRate * 18446744073709551616.0;
+	return threshold < 18446744073709549568.0 ? static_cast<uint64_t>(threshold) : UINT64_MAX - 1;
+}
+
+} // namespace detail
+
+inline uint64_t traceKeyOf(uint64_t record) { return record & ~detail::kTraceOpBit; }
+inline LLZXTraceOp traceOpOf(uint64_t record) { return (record & detail::kTraceOpBit) ? LLZXTraceOp::Put : LLZXTraceOp::Get; }
+
+// 访问trace记录器
+//   每个线程第一次记录时分配一个单生产者单消费者的环形缓冲，记录只写本线程的缓冲，没有锁也没有共享写
+//   后台线程每隔flushInterval把所有缓冲中的记录写入文件；缓冲满时丢弃新记录并计数，不阻塞业务线程
+//   sampleRate小于1时按key的hash做空间采样（SHARDS），同一个key要么全部记录要么全部不记录，
+//   回放时把缓存容量同样乘以采样率即可得到近似的命中率曲线
+class LLZXTraceRecorder
+{
+public:
+	explicit LLZXTraceRecorder(const std::string& path, double sampleRate = 1.0,
+		size_t ringCapacity = size_t(1) << 16,
+		std::chrono::milliseconds flushInterval = std::chrono::milliseconds(5))
+		: id_(nextId().fetch_add(1, std::memory_order_relaxed) + 1)
+		, threshold_(detail::traceThreshold(sampleRate))
+		, ringCapacity_(detail::roundUpPowerOfTwo(std::max<size_t>(ringCapacity, 64)))
+		, flushInterval_(flushInterval)
+	{
+		file_ = std::fopen(path.c_str(), "wb");
+		if (file_ == nullptr)
+			throw std::runtime_error("cannot open trace file: " + path);
+		std::fwrite(detail::kTraceMagic, 1, sizeof(detail::kTraceMagic), file_);
+		std::fwrite(&threshold_, sizeof(threshold_), 1, file_);
+		flusher_ = std::thread([this] { run(); });
+	}
+
+	~LLZXTraceRecorder()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		cv_.notify_one();
+		flusher_.join();
+		flush();
+		std::fclose(file_);
+	}
+
+	LLZXTraceRecorder(const LLZXTraceRecorder&) = delete;
+	LLZXTraceRecorder& operator=(const LLZXTraceRecorder&) = delete;
+
+	// keyHash是key的hash（如std::hash<Key>的结果），内部会再混合一次，std::hash<整数>是恒等映射也可以直接采样
+	void record(uint64_t keyHash, LLZXTraceOp op)
+	{
+		uint64_t mixed = detail::sliceMix64(keyHash);
+		if (threshold_ != UINT64_MAX && mixed >= threshold_)
+			return;
+		uint64_t value = (mixed & ~detail::kTraceOpBit) | (op == LLZXTraceOp::Put ? detail::kTraceOpBit : 0);
+		localRing().push(value);
+	}
+
+	template<typename Key, typename Hash = std::hash<Key>>
+	void recordKey(const Key& key, LLZXTraceOp op)
+	{
+		record(static_cast<uint64_t>(Hash()(key)), op);
+	}
+
+	// 立即把所有缓冲中的记录写入文件
+	void flush()
+	{
+		std::lock_guard<std::mutex> lock(flushMutex_);
+		std::vector<Ring*> rings;
+		{
+			std::lock_guard<std::mutex> registry(mutex_);
+			for (auto& ring : rings_)
+				rings.push_back(ring.get());
+		}
+		for (Ring* ring : rings)
+			ring->drain(buffer_);
+		if (!buffer_.empty())
+		{
+			std::fwrite(buffer_.data(), sizeof(uint64_t), buffer_.size(), file_);
+			written_ += buffer_.size();
+			buffer_.clear();
+		}
+		std::fflush(file_);
+	}
+
+	// 已写入文件的记录数（不含仍在缓冲中的）
+	uint64_t written() const
+	{
+		std::lock_guard<std::mutex> lock(flushMutex_);
+		return written_;
+	}
+
+	// 因缓冲满被丢弃的记录数
+	uint64_t dropped() const
+	{
+		uint64_t total = 0;
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (const auto& ring : rings_)
+			total += ring->dropped.load(std::memory_order_relaxed);
+		return total;
+	}
+
+private:
+	// 单生产者单消费者环形缓冲，head只由记录线程写，tail只由刷盘线程写，分别独占缓存行
+	struct Ring
+	{
+		explicit Ring(size_t capacity)
+			: data(new uint64_t[capacity])
+			, mask(capacity - 1)
+		{}
+
+		void push(uint64_t value)
+		{
+			size_t h = head.load(std::memory_order_relaxed);
+			if (h - tail.load(std::memory_order_acquire) > mask)
+			{
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			data[h & mask] = value;
+			head.store(h + 1, std::memory_order_release);
+		}
+
+		void drain(std::vector<uint64_t>& out)
+		{
+			size_t t = tail.load(std::memory_order_relaxed);
+			size_t h = head.load(std::memory_order_acquire);
+			for (; t != h; ++t)
+				out.push_back(data[t & mask]);
+			tail.store(t, std::memory_order_release);
+		}
+
+		std::unique_ptr<uint64_t[]>                 data;
+		size_t                                      mask;
+		alignas(kCacheLineSize) std::atomic<size_t> head{0};
+		alignas(kCacheLineSize) std::atomic<size_t> tail{0};
+		std::atomic<uint64_t>                       dropped{0};
+	};
+
+	static std::atomic<uint64_t>& nextId()
+	{
+		static std::atomic<uint64_t> id{0};
+		return id;
+	}
+
+	// 线程局部的(记录器id, 缓冲)表，通常只有一项；id全局唯一，已析构的记录器不会被再次匹配
+	Ring& localRing()
+	{
+		struct Local
+		{
+			uint64_t owner;
+			Ring*    ring;
+		};
+		static thread_local std::vector<Local> locals;
+		for (const Local& local : locals)
+			if (local.owner == id_)
+				return *local.ring;
+
+		auto ring = std::make_unique<Ring>(ringCapacity_);
+		Ring* raw = ring.get();
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			rings_.push_back(std::move(ring));
+		}
+		if (locals.size() >= 8)
+			locals.erase(locals.begin());
+		locals.push_back(Local{id_, raw});
+		return *raw;
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!cv_.wait_for(lock, flushInterval_, [this] { return stop_; }))
+		{
+			lock.unlock();
+			flush();
+			lock.lock();
+		}
+	}
+
+private:
+	uint64_t                           id_;
+	uint64_t                           threshold_;
+	size_t                             ringCapacity_;
+	std::chrono::milliseconds          flushInterval_;
+	std::FILE*                         file_ = nullptr;
+	mutable std::mutex                 mutex_;      // 保护rings_和stop_
+	std::condition_variable            cv_;
+	std::vector<std::unique_ptr<Ring>> rings_;      // 线程退出后缓冲仍保留到记录器析构，剩余记录不会丢失
+	bool                               stop_ = false;
+	mutable std::mutex                 flushMutex_; // 保证写文件的只有一个线程
+	std::vector<uint64_t>              buffer_;
+	uint64_t                           written_ = 0;
+	std::thread                        flusher_;    // 在构造函数体中启动，此时其他成员已经就绪
+};
+
+// 读取LLZXTraceRecorder写出的trace文件
+class LLZXTraceReader
+{
+public:
+	explicit LLZXTraceReader(const std::string& path)
+	{
+		file_ = std::fopen(path.c_str(), "rb");
+		if (file_ == nullptr)
+			throw std::runtime_error("cannot open trace file: " + path);
+		char magic[sizeof(detail::kTraceMagic)];
+		if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic)
+			|| std::memcmp(magic, detail::kTraceMagic, sizeof(magic)) != 0
+			|| std::fread(&threshold_, sizeof(threshold_), 1, file_) != 1)
+		{
+			std::fclose(file_);
+			throw std::runtime_error("not a binary trace file: " + path);
+		}
+	}
+
+	~LLZXTraceReader() { std::fclose(file_); }
+
+	LLZXTraceReader(const LLZXTraceReader&) = delete;
+	LLZXTraceReader& operator=(const LLZXTraceReader&) = delete;
+
+	// 文件是否是二进制trace格式（检查魔数）
+	static bool isBinaryTrace(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return false;
+		char magic[sizeof(detail::kTraceMagic)];
+		bool matched = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+			&& std::memcmp(magic, detail::kTraceMagic, sizeof(magic)) == 0;
+		std::fclose(file);
+		return matched;
+	}
+
+	// 记录时使用的采样率
+	double sampleRate() const
+	{
+		return threshold_ == UINT64_MAX ? 1.0 : static_cast<double>(threshold_) / 18446744073709551616.0;
+	}
+
+	// 读取最多maxCount条记录，返回实际读到的条数，0表示读完
+	size_t read(uint64_t* records, size_t maxCount)
+	{
+		return std::fread(records, sizeof(uint64_t), maxCount, file_);
+	}
+
+private:
+	std::FILE* file_ = nullptr;
+	uint64_t   threshold_ = UINT64_MAX;
+};
+
+// 记录访问trace的缓存包装：转发到被包装的缓存，同时把每次访问交给记录器
+// 不持有被包装的缓存和记录器，二者需要比包装对象活得更久
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class LLZXTracedCache : public LLZXCachePolicy<Key, Value>
+{
+public:
+	using typename LLZXCachePolicy<Key, Value>::Visitor;
+
+	LLZXTracedCache(LLZXCachePolicy<Key, Value>& cache, LLZXTraceRecorder& recorder)
+		: cache_(cache)
+		, recorder_(recorder)
+	{}
+
+	void put(const Key& key, const Value& value) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Put);
+		cache_.put(key, value);
+	}
+
+	void put(Key&& key, Value&& value) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Put);
+		cache_.put(std::move(key), std::move(value));
+	}
+
+	void put(const Key& key, const Value& value, std::chrono::steady_clock::duration ttl) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Put);
+		cache_.put(key, value, ttl);
+	}
+
+	using LLZXCachePolicy<Key, Value>::get;
+
+	bool get(const Key& key, Value& value) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Get);
+		return cache_.get(key, value);
+	}
+
+	Value get(const Key& key) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Get);
+		return cache_.get(key);
+	}
+
+	bool visit(const Key& key, const Visitor& visitor) override
+	{
+		recorder_.recordKey<Key, Hash>(key, LLZXTraceOp::Get);
+		return cache_.visit(key, visitor);
+	}
+
+	size_t getMany(const Key* keys, size_t count, Value* values, bool* hits) override
+	{
+		for (size_t i = 0; i < count; ++i)
+			recorder_.recordKey<Key, Hash>(keys[i], LLZXTraceOp::Get);
+		return cache_.getMany(keys, count, values, hits);
+	}
+
+	void putMany(const Key* keys, const Value* values, size_t count) override
+	{
+		for (size_t i = 0; i < count; ++i)
+			recorder_.recordKey<Key, Hash>(keys[i], LLZXTraceOp::Put);
+		cache_.putMany(keys, values, count);
+	}
+
+private:
+	LLZXCachePolicy<Key, Value>& cache_;
+	LLZXTraceRecorder&           recorder_;
+};
+
+} // namespace LLZXCache
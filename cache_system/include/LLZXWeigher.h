@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "LLZXNodeIndex.h"
+#include "LLZXNodeSlab.h"
+
+namespace LLZXCache
+{
+
+namespace detail
+{
+
+// 对象在自身sizeof之外占用的堆内存，默认认为没有
+template<typename T>
+size_t heapBytesOf(const T&)
+{
+	return 0;
+}
+
+// 短字符串存放在对象内部（SSO），只有超过内部缓冲时才占用堆内存
+template<typename CharT, typename Traits, typename Alloc>
+size_t heapBytesOf(const std::basic_string<CharT, Traits, Alloc>& str)
+{
+	static const size_t kInlineCapacity = std::basic_string<CharT, Traits, Alloc>().capacity();
+	return str.capacity() > kInlineCapacity ? (str.capacity() + 1) * sizeof(CharT) : 0;
+}
+
+template<typename T, typename Alloc>
+size_t heapBytesOf(const std::vector<T, Alloc>& vec)
+{
+	size_t bytes = vec.capacity() * sizeof(T);
+	for (const auto& item : vec)
+		bytes += heapBytesOf(item);
+	return bytes;
+}
+
+// 索引提供kEntryBytes时计入索引表项的大小，自定义索引没有提供时按0计
+template<typename Index, typename = void>
+struct IndexEntryBytes : std::integral_constant<size_t, 0> {};
+
+template<typename Index>
+struct IndexEntryBytes<Index, std::void_t<decltype(Index::kEntryBytes)>>
+	: std::integral_constant<size_t, Index::kEntryBytes> {};
+
+} // namespace detail
+
+template<typename Key, typename Value>
+class LruNode;
+
+// 默认的按字节计重函数：key、value本身的大小，加上它们在堆上的内存，
+// 再加上每个元素在节点和索引中的固定开销；固定开销由LruNode和索引的实际布局算出，节点字段变化时随之更新
+// 其他类型如需统计堆内存，可以在LLZXCache::detail中为其重载heapBytesOf
+template<typename Key, typename Value, typename Index = LLZXDefaultNodeIndex<Key>>
+struct LLZXDefaultWeigher
+{
+	// 节点中key、value以外的部分（链表下标、访问计数、权重和对齐填充）加上索引表项；
+	// 写成函数，使用时LruNode已经是完整类型
+	static constexpr size_t perEntryOverhead()
+	{
+		return sizeof(LruNode<Key, Value>) - sizeof(Key) - sizeof(Value) + detail::IndexEntryBytes<Index>::value;
+	}
+
+	size_t operator()(const Key& key, const Value& value) const
+	{
+		return sizeof(Key) + sizeof(Value) + detail::heapBytesOf(key) + detail::heapBytesOf(value) + perEntryOverhead();
+	}
+};
+
+} // namespace LLZXCache
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LLZXCommon
+{
+
+// 基于epoch的内存回收（EBR）
+//   读者进入临界区时记下当前的全局epoch，退出时清零；写者把对象从共享结构上摘下后retire，
+//   对象记上retire时的epoch，等全局epoch前进两次后再释放
+//   全局epoch只有在所有处于临界区的线程都已经观察到当前epoch时才能前进一步，
+//   所以前进两次之后，摘下对象之前进入临界区的读者一定都已经退出
+//   读者的代价是一次thread_local访问、一次store和一次fence，不修改任何共享计数
+// 所有线程共用一个全局epoch，线程第一次使用时自动注册，退出时未释放的对象交给其他线程继续回收
+
+namespace detail
+{
+
+struct LLZXRetired
+{
+	void*  ptr;
+	void   (*deleter)(void*);
+	uint64_t epoch;
+};
+
+struct alignas(64) LLZXEpochRecord
+{
+	std::atomic<uint64_t>     epoch{0};     // 0表示不在临界区，否则为进入时的全局epoch
+	std::atomic<bool>         inUse{false}; // 线程退出后记录留在链表中，由新线程复用
+	LLZXEpochRecord*          next = nullptr;
+	uint32_t                  depth = 0;    // 临界区嵌套深度，只由所属线程访问
+	bool                      exited = false;
+	std::vector<LLZXRetired>  retired;      // 本线程retire、尚未释放的对象，按epoch递增
+};
+
+inline std::atomic<uint64_t> globalEpoch{1};
+inline thread_local LLZXEpochRecord* localRecord = nullptr;
+
+LLZXEpochRecord* registerThread();
+
+} // namespace detail
+
+class LLZXEpoch
+{
+public:
+	using Deleter = void (*)(void*);
+
+	// 每retire这么多个对象尝试推进一次epoch并批量释放
+	static constexpr size_t kCollectBatch = 64;
+
+	// 进入临界区，可以嵌套；临界区内读到的对象在退出之前不会被释放
+	static void enter()
+	{
+		detail::LLZXEpochRecord* record = detail::localRecord;
+		if (!record)
+			record = detail::registerThread();
+		if (record->depth++ == 0)
+		{
+			record->epoch.store(detail::globalEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			// 先公开自己的epoch，再读共享结构
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	static void exit()
+	{
+		detail::LLZXEpochRecord* record = detail::localRecord;
+		if (--record->depth == 0)
+			record->epoch.store(0, std::memory_order_release);
+	}
+
+	// 对象已经从所有共享结构上摘下之后调用，之后由deleter(ptr)释放
+	static void retire(void* ptr, Deleter deleter);
+
+	template<typename T>
+	static void retire(T* ptr)
+	{
+		retire(ptr, [](void* object) { delete static_cast<T*>(object); });
+	}
+
+	// 尝试推进epoch，释放当前线程（以及已退出线程遗留的）可以释放的对象，返回释放个数
+	static size_t collect();
+
+	// 当前线程retire但尚未释放的对象个数
+	static size_t pending();
+
+	static uint64_t current() { return detail::globalEpoch.load(std::memory_order_acquire); }
+};
+
+// 临界区的RAII包装
+class LLZXEpochGuard
+{
+public:
+	LLZXEpochGuard() { LLZXEpoch::enter(); }
+	~LLZXEpochGuard() { LLZXEpoch::exit(); }
+
+	LLZXEpochGuard(const LLZXEpochGuard&) = delete;
+	LLZXEpochGuard& operator=(const LLZXEpochGuard&) = delete;
+};
+
+} // namespace LLZXCommon
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace LLZXCommon
+{
+
+// 有界的多生产者单消费者无锁队列（环形数组，每个格子带一个序号）
+//   生产者用CAS抢占tail_上的位置，写入元素后把格子的序号推进到pos + 1，消费者看到序号就绪才读取
+//   消费者只有一个，head_不需要原子操作；读走元素后把序号推进一圈，格子重新对生产者开放
+//   队列满时tryPush返回false，由调用方决定重试还是放弃
+// T需要可平凡拷贝（通常是指向请求的指针）
+template<typename T>
+class LLZXMpscQueue
+{
+	static_assert(std::is_trivially_copyable<T>::value, "LLZXMpscQueue stores trivially copyable elements");
+
+public:
+	// 容量向上取整到2的幂
+	explicit LLZXMpscQueue(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+		mask_ = size - 1;
+		cells_.reset(new Cell[size]);
+		for (size_t i = 0; i < size; ++i)
+			cells_[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	LLZXMpscQueue(const LLZXMpscQueue&) = delete;
+	LLZXMpscQueue& operator=(const LLZXMpscQueue&) = delete;
+
+	// 任意线程调用
+	bool tryPush(const T& value)
+	{
+		size_t pos = tail_.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = cells_[pos & mask_];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+			if (diff == 0)
+			{
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.value = value;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+				return false; // 这个格子上一圈的元素还没被读走，队列已满
+			else
+				pos = tail_.load(std::memory_order_relaxed);
+		}
+	}
+
+	// 以下只由消费者线程调用
+
+	bool tryPop(T& value)
+	{
+		Cell& cell = cells_[head_ & mask_];
+		if (cell.sequence.load(std::memory_order_acquire) != head_ + 1)
+			return false;
+		value = cell.value;
+		cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+		++head_;
+		return true;
+	}
+
+	// 一次取出至多max个元素，返回取出的个数
+	size_t popMany(T* values, size_t max)
+	{
+		size_t count = 0;
+		while (count < max && tryPop(values[count]))
+			++count;
+		return count;
+	}
+
+	// 没有任何元素；生产者已经抢占位置、还没写完元素时视为非空，消费者应当稍后再取
+	bool empty() const
+	{
+		return cells_[head_ & mask_].sequence.load(std::memory_order_acquire) != head_ + 1
+			&& tail_.load(std::memory_order_acquire) == head_;
+	}
+
+	size_t capacity() const { return mask_ + 1; }
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T                   value;
+	};
+
+	// 生产者争用tail_，消费者独占head_，分开放在不同的缓存行上
+	alignas(64) std::atomic<size_t> tail_{0};
+	alignas(64) size_t              head_ = 0;
+	size_t                          mask_;
+	std::unique_ptr<Cell[]>         cells_;
+};
+
+} // namespace LLZXCommon
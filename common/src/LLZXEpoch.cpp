@@ -0,0 +1,189 @@
+#include "LLZXEpoch.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace LLZXCommon
+{
+
+namespace detail
+{
+
+namespace
+{
+
+// 全局状态不析构：其他线程和静态对象析构时仍可能访问
+struct EpochDomain
+{
+	std::atomic<LLZXEpochRecord*> records{nullptr}; // 只增不删的线程记录链表
+	std::mutex                    orphanMutex;
+	std::vector<LLZXRetired>      orphans;          // 已退出线程遗留的对象
+};
+
+EpochDomain& domain()
+{
+	static EpochDomain* instance = new EpochDomain();
+	return *instance;
+}
+
+// 平凡类型，线程退出的任何阶段都可以安全访问
+thread_local bool releaserDestroyed = false;
+
+// 线程退出时把未释放的对象交给全局的遗留列表，记录留给之后的线程复用
+struct RecordReleaser
+{
+	~RecordReleaser()
+	{
+		releaserDestroyed = true;
+		LLZXEpochRecord* record = localRecord;
+		if (!record)
+			return;
+		LLZXEpoch::collect();
+		if (!record->retired.empty())
+		{
+			EpochDomain& epochDomain = domain();
+			std::lock_guard<std::mutex> lock(epochDomain.orphanMutex);
+			epochDomain.orphans.insert(epochDomain.orphans.end(), record->retired.begin(), record->retired.end());
+		}
+		record->retired.clear();
+		record->retired.shrink_to_fit();
+		// 之后同一线程上其他thread_local析构时仍可以进入临界区，retire的对象直接进遗留列表
+		record->exited = true;
+		if (record->depth == 0)
+		{
+			localRecord = nullptr;
+			record->inUse.store(false, std::memory_order_release);
+		}
+	}
+};
+
+// 所有在临界区中的线程都已经观察到当前epoch时，推进一步
+bool tryAdvance()
+{
+	uint64_t current = globalEpoch.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	for (LLZXEpochRecord* record = domain().records.load(std::memory_order_acquire); record; record = record->next)
+	{
+		if (!record->inUse.load(std::memory_order_acquire))
+			continue;
+		uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+		if (epoch != 0 && epoch != current)
+			return false;
+	}
+	return globalEpoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+}
+
+bool reclaimable(const LLZXRetired& retired, uint64_t current)
+{
+	return retired.epoch + 2 <= current;
+}
+
+} // namespace
+
+LLZXEpochRecord* registerThread()
+{
+	EpochDomain& epochDomain = domain();
+	LLZXEpochRecord* record = nullptr;
+	for (LLZXEpochRecord* candidate = epochDomain.records.load(std::memory_order_acquire); candidate; candidate = candidate->next)
+	{
+		bool expected = false;
+		if (!candidate->inUse.load(std::memory_order_relaxed)
+			&& candidate->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+		{
+			record = candidate;
+			break;
+		}
+	}
+
+	if (!record)
+	{
+		record = new LLZXEpochRecord();
+		record->inUse.store(true, std::memory_order_relaxed);
+		LLZXEpochRecord* head = epochDomain.records.load(std::memory_order_relaxed);
+		do
+		{
+			record->next = head;
+		} while (!epochDomain.records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	record->depth = 0;
+	record->exited = releaserDestroyed;
+	localRecord = record;
+	if (!releaserDestroyed)
+	{
+		static thread_local RecordReleaser releaser;
+		(void)releaser;
+	}
+	return record;
+}
+
+} // namespace detail
+
+void LLZXEpoch::retire(void* ptr, Deleter deleter)
+{
+	detail::LLZXEpochRecord* record = detail::localRecord;
+	if (!record)
+		record = detail::registerThread();
+
+	// 对象摘下的写入必须先于读取epoch
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	detail::LLZXRetired retired{ptr, deleter, detail::globalEpoch.load(std::memory_order_relaxed)};
+	if (record->exited)
+	{
+		auto& epochDomain = detail::domain();
+		std::lock_guard<std::mutex> lock(epochDomain.orphanMutex);
+		epochDomain.orphans.push_back(retired);
+		return;
+	}
+
+	record->retired.push_back(retired);
+	if (record->retired.size() % kCollectBatch == 0)
+		collect();
+}
+
+size_t LLZXEpoch::collect()
+{
+	detail::tryAdvance();
+	uint64_t current = detail::globalEpoch.load(std::memory_order_acquire);
+	size_t freed = 0;
+
+	if (detail::LLZXEpochRecord* record = detail::localRecord)
+	{
+		auto& retired = record->retired;
+		auto end = std::find_if(retired.begin(), retired.end(),
+			[current](const detail::LLZXRetired& item) { return !detail::reclaimable(item, current); });
+		// 先摘下再释放，deleter中再次retire不会破坏正在遍历的列表
+		std::vector<detail::LLZXRetired> ready(retired.begin(), end);
+		retired.erase(retired.begin(), end);
+		for (const auto& item : ready)
+			item.deleter(item.ptr);
+		freed += ready.size();
+	}
+
+	// 遗留列表由拿到锁的线程顺手回收，拿不到就下次再说
+	auto& epochDomain = detail::domain();
+	std::vector<detail::LLZXRetired> ready;
+	{
+		std::unique_lock<std::mutex> lock(epochDomain.orphanMutex, std::try_to_lock);
+		if (lock.owns_lock() && !epochDomain.orphans.empty())
+		{
+			auto& orphans = epochDomain.orphans;
+			auto split = std::stable_partition(orphans.begin(), orphans.end(),
+				[current](const detail::LLZXRetired& item) { return !detail::reclaimable(item, current); });
+			ready.assign(split, orphans.end());
+			orphans.erase(split, orphans.end());
+		}
+	}
+	for (const auto& item : ready)
+		item.deleter(item.ptr);
+	freed += ready.size();
+	return freed;
+}
+
+size_t LLZXEpoch::pending()
+{
+	detail::LLZXEpochRecord* record = detail::localRecord;
+	return record ? record->retired.size() : 0;
+}
+
+} // namespace LLZXCommon
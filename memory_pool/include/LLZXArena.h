@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "LLZXSizeClass.h"
+
+namespace LLZXMemoryPool
+{
+
+// 请求级别的单调分配器：allocate只向后移动指针，单个对象不释放，请求结束时rewind/reset一次性回收
+// 内存块从内存池分配并在回收后保留复用，稳态下每个请求的分配既不加锁也不访问全局堆
+// 不是线程安全的，每个线程使用自己的arena（见local()）
+class LLZXArena
+{
+public:
+	// arena中的一个位置，rewind回到这里时之后的分配全部作废
+	struct Mark
+	{
+		void* block = nullptr;
+		char* ptr = nullptr;
+	};
+
+	// 第一个块的大小，之后每个新块翻倍，最大kMaxBytes；超过的请求单独分配一个刚好够用的块
+	explicit LLZXArena(size_t blockSize = 4096);
+	~LLZXArena();
+
+	LLZXArena(const LLZXArena&) = delete;
+	LLZXArena& operator=(const LLZXArena&) = delete;
+
+	// 当前线程的arena
+	static LLZXArena& local();
+
+	// align需要是2的幂
+	void* allocate(size_t bytes, size_t align = alignof(std::max_align_t))
+	{
+		uintptr_t aligned = LLZXSizeClass::alignUp(reinterpret_cast<uintptr_t>(ptr_), align);
+		if (ptr_ && aligned + bytes <= reinterpret_cast<uintptr_t>(end_))
+		{
+			ptr_ = reinterpret_cast<char*>(aligned + bytes);
+			return reinterpret_cast<void*>(aligned);
+		}
+		return allocateSlow(bytes, align);
+	}
+
+	Mark mark() const { return Mark{current_, ptr_}; }
+	void rewind(const Mark& mark);
+
+	// 回收全部分配，块保留给之后的请求复用
+	void reset() { rewind(Mark{}); }
+
+	// 持有的块的总字节数
+	size_t capacity() const { return capacity_; }
+
+private:
+	struct Block
+	{
+		Block* next;
+		size_t size; // 含块头
+	};
+
+	void* allocateSlow(size_t bytes, size_t align);
+	static char* dataOf(Block* block) { return reinterpret_cast<char*>(block) + sizeof(Block); }
+	static char* endOf(Block* block) { return reinterpret_cast<char*>(block) + block->size; }
+
+private:
+	size_t blockSize_;
+	Block* first_ = nullptr;   // 所有块按使用顺序串成链表
+	Block* current_ = nullptr; // 正在分配的块，nullptr表示还没有开始用第一个块
+	char*  ptr_ = nullptr;
+	char*  end_ = nullptr;
+	size_t capacity_ = 0;
+};
+
+// 作用域结束时把arena退回到进入作用域时的位置，可以嵌套
+class LLZXArenaScope
+{
+public:
+	explicit LLZXArenaScope(LLZXArena& arena = LLZXArena::local())
+		: arena_(arena)
+		, mark_(arena.mark())
+	{}
+
+	~LLZXArenaScope() { arena_.rewind(mark_); }
+
+	LLZXArenaScope(const LLZXArenaScope&) = delete;
+	LLZXArenaScope& operator=(const LLZXArenaScope&) = delete;
+
+	LLZXArena& arena() const { return arena_; }
+
+private:
+	LLZXArena&      arena_;
+	LLZXArena::Mark mark_;
+};
+
+// 从arena分配的STL分配器，deallocate不做任何事；容器的生命周期不能超过arena的回收点
+template<typename T>
+class LLZXArenaAllocator
+{
+public:
+	using value_type = T;
+
+	LLZXArenaAllocator(LLZXArena& arena) noexcept
+		: arena_(&arena)
+	{}
+
+	template<typename U>
+	LLZXArenaAllocator(const LLZXArenaAllocator<U>& other) noexcept
+		: arena_(other.arena())
+	{}
+
+	T* allocate(size_t count)
+	{
+		if (count > SIZE_MAX / sizeof(T))
+			throw std::bad_array_new_length();
+		return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) noexcept {}
+
+	LLZXArena* arena() const noexcept { return arena_; }
+
+	template<typename U>
+	bool operator==(const LLZXArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+
+	template<typename U>
+	bool operator!=(const LLZXArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+	LLZXArena* arena_;
+};
+
+// 内容放在arena中的字符串
+using LLZXArenaString = std::basic_string<char, std::char_traits<char>, LLZXArenaAllocator<char>>;
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+#include "LLZXPageHeap.h"
+#include "LLZXSizeClass.h"
+
+namespace LLZXMemoryPool
+{
+
+// 中心缓存：每个大小类一个桶，桶里是切分好的span，线程缓存成批地从这里取对象、还对象
+// 每个桶各自一把锁，不同大小类之间互不竞争；span的对象全部还回来后整个span交还页堆
+class LLZXCentralCache
+{
+public:
+	static LLZXCentralCache& instance();
+
+	// 取最多count个size大小的对象，串成以nullptr结尾的链表[start, end]，返回实际个数（至少1个）
+	size_t fetchRange(void*& start, void*& end, size_t count, size_t size);
+
+	// 归还一个以nullptr结尾的对象链表，链表里的对象大小都是size
+	void releaseList(void* start, size_t size);
+
+private:
+	LLZXCentralCache() = default;
+
+	// 找一个还有空闲对象的span，调用方持有桶锁；需要新span时临时释放桶锁去页堆申请
+	LLZXSpan* spanWithFreeObjects(std::unique_lock<std::mutex>& lock, LLZXSpanList& spans, size_t size);
+
+private:
+	struct alignas(64) Bucket
+	{
+		std::mutex   mutex;
+		LLZXSpanList spans;
+	};
+
+	Bucket buckets_[kNumClasses];
+};
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace LLZXMemoryPool
+{
+
+// 小对象分配器（线程缓存 -> 中心缓存 -> 页堆）
+//   不超过256KB的请求按大小类从当前线程的空闲链表分配，大多数分配和释放不加任何锁；
+//   更大的请求直接按页从页堆分配
+// 内存不足时抛出std::bad_alloc
+
+// 分配size字节，至少按8字节对齐，size是16的倍数时按16字节对齐
+// （alignof(T)总能整除sizeof(T)，所以按类型分配时总能满足不超过16的对齐要求）
+void* allocate(size_t size);
+
+// 释放allocate分配的内存，size必须与分配时相同，省去一次按地址查span
+void deallocate(void* ptr, size_t size);
+
+// 不知道大小时按地址查出所在span再释放
+void deallocate(void* ptr);
+
+// 池向系统申请（mmap/VirtualAlloc）且尚未归还的字节数，包括已映射但空闲的页；这部分不经过malloc
+size_t systemBytes();
+
+// 把分配器接到标准容器上的适配器：无状态，所有实例都从同一个全局池分配，彼此相等
+template<typename T>
+class LLZXPoolAllocator
+{
+public:
+	using value_type = T;
+	using propagate_on_container_move_assignment = std::true_type;
+	using is_always_equal = std::true_type;
+
+	LLZXPoolAllocator() noexcept = default;
+
+	template<typename U>
+	LLZXPoolAllocator(const LLZXPoolAllocator<U>&) noexcept {}
+
+	T* allocate(size_t count)
+	{
+		static_assert(alignof(T) <= 16, "LLZXPoolAllocator only guarantees 16-byte alignment");
+		if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+			throw std::bad_array_new_length();
+		return static_cast<T*>(LLZXMemoryPool::allocate(count * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t count) noexcept
+	{
+		LLZXMemoryPool::deallocate(ptr, count * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const LLZXPoolAllocator<U>&) const noexcept { return true; }
+
+	template<typename U>
+	bool operator!=(const LLZXPoolAllocator<U>&) const noexcept { return false; }
+};
+
+} // namespace LLZXMemoryPool
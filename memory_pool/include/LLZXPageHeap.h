@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include "LLZXSizeClass.h"
+
+namespace LLZXMemoryPool
+{
+
+// 一段连续的页。被中心缓存持有时切成同样大小的对象，freeList串起其中的空闲对象
+struct LLZXSpan
+{
+	PageId    pageId = 0;     // 起始页号
+	size_t    pages = 0;      // 页数
+	LLZXSpan* prev = nullptr;
+	LLZXSpan* next = nullptr;
+	void*     freeList = nullptr;
+	size_t    useCount = 0;   // 已分配给线程缓存的对象个数
+	size_t    objectSize = 0; // 切分的对象大小，直接按页分配的大对象为请求大小
+	bool      inUse = false;  // false表示在页堆的空闲桶里
+
+	void* address() const { return reinterpret_cast<void*>(pageId << kPageShift); }
+};
+
+// 带哨兵的span双向链表，调用方负责加锁
+class LLZXSpanList
+{
+public:
+	LLZXSpanList()
+	{
+		head_.prev = head_.next = &head_;
+	}
+
+	LLZXSpanList(const LLZXSpanList&) = delete;
+	LLZXSpanList& operator=(const LLZXSpanList&) = delete;
+
+	LLZXSpan* begin() { return head_.next; }
+	LLZXSpan* end() { return &head_; }
+	bool empty() const { return head_.next == &head_; }
+
+	void pushFront(LLZXSpan* span)
+	{
+		span->next = head_.next;
+		span->prev = &head_;
+		head_.next->prev = span;
+		head_.next = span;
+	}
+
+	void pushBack(LLZXSpan* span)
+	{
+		span->prev = head_.prev;
+		span->next = &head_;
+		head_.prev->next = span;
+		head_.prev = span;
+	}
+
+	LLZXSpan* popFront()
+	{
+		LLZXSpan* span = head_.next;
+		erase(span);
+		return span;
+	}
+
+	static void erase(LLZXSpan* span)
+	{
+		span->prev->next = span->next;
+		span->next->prev = span->prev;
+		span->prev = span->next = nullptr;
+	}
+
+private:
+	LLZXSpan head_;
+};
+
+// 页号 -> span 的三层基数树，覆盖48位地址空间（35位页号 = 12 + 12 + 11）
+// 只有页堆在持锁时写入，读者（按指针释放时查span）不加锁，各层指针用原子变量发布
+class LLZXPageMap
+{
+public:
+	LLZXSpan* get(PageId page) const
+	{
+		if ((page >> kBits) != 0) return nullptr;
+		Node* mid = root_[page >> (kLeafBits + kMidBits)].load(std::memory_order_acquire);
+		if (!mid) return nullptr;
+		Leaf* leaf = mid->children[(page >> kLeafBits) & (kMidSize - 1)].load(std::memory_order_acquire);
+		if (!leaf) return nullptr;
+		return leaf->spans[page & (kLeafSize - 1)].load(std::memory_order_acquire);
+	}
+
+	// 调用方持有页堆的锁
+	void set(PageId page, LLZXSpan* span);
+
+private:
+	static constexpr size_t kRootBits = 12;
+	static constexpr size_t kMidBits = 12;
+	static constexpr size_t kLeafBits = 11;
+	static constexpr size_t kBits = kRootBits + kMidBits + kLeafBits;
+	static constexpr size_t kRootSize = size_t(1) << kRootBits;
+	static constexpr size_t kMidSize = size_t(1) << kMidBits;
+	static constexpr size_t kLeafSize = size_t(1) << kLeafBits;
+
+	struct Leaf
+	{
+		std::atomic<LLZXSpan*> spans[kLeafSize];
+	};
+
+	struct Node
+	{
+		std::atomic<Leaf*> children[kMidSize];
+	};
+
+	std::atomic<Node*> root_[kRootSize] = {};
+};
+
+// 页堆：全局唯一，管理从系统申请来的页
+//   空闲span按页数放进kMaxPages个桶，申请时从不小于所需页数的桶里取一个并切开，
+//   释放时与前后相邻的空闲span合并，都没有合适的span时一次向系统申请kMaxPages-1页
+//   超过kMaxPages-1页的请求直接向系统申请，释放时直接归还系统
+class LLZXPageHeap
+{
+public:
+	// 进程生命周期内不析构：线程退出和静态对象析构时仍可能归还内存
+	static LLZXPageHeap& instance();
+
+	// 申请pages页，返回的span的每一页都登记在页号映射中（直接向系统申请的大span只登记首尾页）
+	LLZXSpan* allocateSpan(size_t pages);
+	void releaseSpan(LLZXSpan* span);
+
+	// 已分配地址所在的span，不加锁
+	LLZXSpan* spanOf(const void* ptr) const
+	{
+		return pageMap_.get(reinterpret_cast<PageId>(ptr) >> kPageShift);
+	}
+
+private:
+	LLZXPageHeap() = default;
+
+	LLZXSpan* allocateLocked(size_t pages);
+	void insertFree(LLZXSpan* span);
+	LLZXSpan* newSpanObject();
+	void deleteSpanObject(LLZXSpan* span);
+
+private:
+	std::mutex   mutex_;
+	LLZXSpanList free_[kMaxPages];
+	LLZXPageMap  pageMap_;
+	LLZXSpan*    spanPool_ = nullptr; // span对象自身的空闲链表，span对象从系统页上切出，不走malloc
+};
+
+// 向系统申请/归还按页对齐的内存
+void* systemAllocate(size_t pages);
+void systemRelease(void* ptr, size_t pages);
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace LLZXMemoryPool
+{
+
+// 页大小8KB，页号 = 地址 >> kPageShift
+constexpr size_t kPageShift = 13;
+constexpr size_t kPageSize = size_t(1) << kPageShift;
+// 线程缓存/中心缓存负责的最大对象，更大的请求直接向页堆按页申请
+constexpr size_t kMaxBytes = 256 * 1024;
+// 页堆按页数分桶管理空闲span，1..kMaxPages-1页各一个桶，更大的span直接向系统申请
+constexpr size_t kMaxPages = 129;
+// 大小类个数，见LLZXSizeClass的分段
+constexpr size_t kNumClasses = 208;
+
+using PageId = uintptr_t;
+
+// 空闲对象的前8字节保存下一个空闲对象的地址，对象最小8字节
+inline void*& nextOf(void* object)
+{
+	return *static_cast<void**>(object);
+}
+
+// 大小类：按对象大小分段对齐，每段内部碎片不超过约12.5%
+//   [1, 128]          8字节对齐    16个类
+//   (128, 1024]       16字节对齐   56个类
+//   (1K, 8K]          128字节对齐  56个类
+//   (8K, 64K]         1K对齐       56个类
+//   (64K, 256K]       8K对齐       24个类
+class LLZXSizeClass
+{
+public:
+	// 向上取整到所在大小类的对象大小，size不超过kMaxBytes
+	static constexpr size_t roundUp(size_t size)
+	{
+		if (size <= 128) return alignUp(size, 8);
+		if (size <= 1024) return alignUp(size, 16);
+		if (size <= 8 * 1024) return alignUp(size, 128);
+		if (size <= 64 * 1024) return alignUp(size, 1024);
+		return alignUp(size, 8 * 1024);
+	}
+
+	// 大小类下标
+	static constexpr size_t index(size_t size)
+	{
+		if (size <= 128) return bucket(size, 0, 3);
+		if (size <= 1024) return bucket(size, 128, 4) + 16;
+		if (size <= 8 * 1024) return bucket(size, 1024, 7) + 16 + 56;
+		if (size <= 64 * 1024) return bucket(size, 8 * 1024, 10) + 16 + 56 + 56;
+		return bucket(size, 64 * 1024, 13) + 16 + 56 + 56 + 56;
+	}
+
+	// 大小类下标对应的对象大小，index()的逆映射
+	static constexpr size_t classSize(size_t index)
+	{
+		if (index < 16) return (index + 1) << 3;
+		index -= 16;
+		if (index < 56) return 128 + ((index + 1) << 4);
+		index -= 56;
+		if (index < 56) return 1024 + ((index + 1) << 7);
+		index -= 56;
+		if (index < 56) return 8 * 1024 + ((index + 1) << 10);
+		index -= 56;
+		return 64 * 1024 + ((index + 1) << 13);
+	}
+
+	// 线程缓存与中心缓存之间一次搬运的对象个数上限：小对象多搬，大对象少搬
+	static constexpr size_t batchSize(size_t size)
+	{
+		size_t count = kMaxBytes / size;
+		if (count < 2) count = 2;
+		if (count > 512) count = 512;
+		return count;
+	}
+
+	// 中心缓存为该大小类向页堆申请的span页数，至少能切出一批对象
+	static constexpr size_t spanPages(size_t size)
+	{
+		size_t pages = (batchSize(size) * size) >> kPageShift;
+		return pages == 0 ? 1 : pages;
+	}
+
+	static constexpr size_t alignUp(size_t size, size_t align)
+	{
+		return (size + align - 1) & ~(align - 1);
+	}
+
+private:
+	// (size - base)按2^shift向上取整后的段内下标
+	static constexpr size_t bucket(size_t size, size_t base, size_t shift)
+	{
+		return ((size - base + (size_t(1) << shift) - 1) >> shift) - 1;
+	}
+};
+
+static_assert(LLZXSizeClass::index(kMaxBytes) + 1 == kNumClasses, "size class table out of sync");
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include "LLZXSizeClass.h"
+
+namespace LLZXMemoryPool
+{
+
+// 线程缓存：每个线程每个大小类一条空闲链表，命中时分配和释放都不加锁
+// 链表为空时从中心缓存批量取，链表过长时批量还给中心缓存；
+// 每次取空后批量上限加一（慢启动），只偶尔分配某个大小的线程不会囤积大量对象
+class LLZXThreadCache
+{
+public:
+	LLZXThreadCache() = default;
+	~LLZXThreadCache();
+
+	LLZXThreadCache(const LLZXThreadCache&) = delete;
+	LLZXThreadCache& operator=(const LLZXThreadCache&) = delete;
+
+	// 当前线程的缓存；线程退出、缓存已销毁之后返回nullptr，调用方改为直接访问中心缓存
+	static LLZXThreadCache* local();
+
+	// size不超过kMaxBytes
+	void* allocate(size_t size);
+	void deallocate(void* ptr, size_t size);
+
+private:
+	struct FreeList
+	{
+		void*  head = nullptr;
+		size_t length = 0;
+		size_t maxLength = 1; // 从中心缓存一次取的个数，也是链表长度的上限
+	};
+
+	void* fetchFromCentral(FreeList& list, size_t size);
+	void releaseToCentral(FreeList& list, size_t size, size_t count);
+
+private:
+	FreeList lists_[kNumClasses];
+};
+
+} // namespace LLZXMemoryPool
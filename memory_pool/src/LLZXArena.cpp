@@ -0,0 +1,78 @@
+#include "LLZXArena.h"
+
+#include "LLZXMemoryPool.h"
+
+namespace LLZXMemoryPool
+{
+
+LLZXArena::LLZXArena(size_t blockSize)
+	: blockSize_(blockSize > sizeof(Block) ? blockSize : sizeof(Block) * 2)
+{}
+
+LLZXArena::~LLZXArena()
+{
+	Block* block = first_;
+	while (block)
+	{
+		Block* next = block->next;
+		deallocate(block, block->size);
+		block = next;
+	}
+}
+
+LLZXArena& LLZXArena::local()
+{
+	thread_local LLZXArena arena;
+	return arena;
+}
+
+void LLZXArena::rewind(const Mark& mark)
+{
+	current_ = static_cast<Block*>(mark.block);
+	ptr_ = mark.ptr;
+	end_ = current_ ? endOf(current_) : nullptr;
+}
+
+void* LLZXArena::allocateSlow(size_t bytes, size_t align)
+{
+	// 先依次复用当前块之后保留下来的块
+	Block* candidate = current_ ? current_->next : first_;
+	while (candidate)
+	{
+		uintptr_t aligned = LLZXSizeClass::alignUp(reinterpret_cast<uintptr_t>(dataOf(candidate)), align);
+		if (aligned + bytes <= reinterpret_cast<uintptr_t>(endOf(candidate)))
+			break;
+		candidate = candidate->next;
+	}
+
+	if (!candidate)
+	{
+		// 保留的块都放不下时分配新块：大小按当前块翻倍，挂在当前块之后
+		size_t size = current_ ? current_->size * 2 : blockSize_;
+		if (size > kMaxBytes)
+			size = kMaxBytes;
+		if (size < sizeof(Block) + bytes + align)
+			size = sizeof(Block) + bytes + align;
+
+		candidate = static_cast<Block*>(LLZXMemoryPool::allocate(size));
+		candidate->size = size;
+		capacity_ += size;
+		if (current_)
+		{
+			candidate->next = current_->next;
+			current_->next = candidate;
+		}
+		else
+		{
+			candidate->next = first_;
+			first_ = candidate;
+		}
+	}
+
+	current_ = candidate;
+	ptr_ = dataOf(candidate);
+	end_ = endOf(candidate);
+	return allocate(bytes, align);
+}
+
+} // namespace LLZXMemoryPool
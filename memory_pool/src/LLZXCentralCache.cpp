@@ -0,0 +1,96 @@
+#include "LLZXCentralCache.h"
+
+namespace LLZXMemoryPool
+{
+
+LLZXCentralCache& LLZXCentralCache::instance()
+{
+	static LLZXCentralCache* cache = new LLZXCentralCache();
+	return *cache;
+}
+
+size_t LLZXCentralCache::fetchRange(void*& start, void*& end, size_t count, size_t size)
+{
+	Bucket& bucket = buckets_[LLZXSizeClass::index(size)];
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+	LLZXSpan* span = spanWithFreeObjects(lock, bucket.spans, size);
+
+	start = end = span->freeList;
+	size_t fetched = 1;
+	while (fetched < count && nextOf(end))
+	{
+		end = nextOf(end);
+		++fetched;
+	}
+	span->freeList = nextOf(end);
+	nextOf(end) = nullptr;
+	span->useCount += fetched;
+
+	// 取空的span移到链表尾部，有空闲对象的span总是排在前面
+	if (!span->freeList)
+	{
+		LLZXSpanList::erase(span);
+		bucket.spans.pushBack(span);
+	}
+	return fetched;
+}
+
+void LLZXCentralCache::releaseList(void* start, size_t size)
+{
+	Bucket& bucket = buckets_[LLZXSizeClass::index(size)];
+	LLZXPageHeap& heap = LLZXPageHeap::instance();
+	std::unique_lock<std::mutex> lock(bucket.mutex);
+
+	while (start)
+	{
+		void* next = nextOf(start);
+		LLZXSpan* span = heap.spanOf(start);
+		bool wasFull = !span->freeList;
+		nextOf(start) = span->freeList;
+		span->freeList = start;
+
+		if (--span->useCount == 0)
+		{
+			// 对象全部还回来了，整个span交还页堆，交还时不持有桶锁
+			LLZXSpanList::erase(span);
+			lock.unlock();
+			heap.releaseSpan(span);
+			lock.lock();
+		}
+		else if (wasFull)
+		{
+			LLZXSpanList::erase(span);
+			bucket.spans.pushFront(span);
+		}
+		start = next;
+	}
+}
+
+LLZXSpan* LLZXCentralCache::spanWithFreeObjects(std::unique_lock<std::mutex>& lock, LLZXSpanList& spans, size_t size)
+{
+	LLZXSpan* span = spans.begin();
+	if (span != spans.end() && span->freeList)
+		return span;
+
+	// 申请和切分新span时不持有桶锁，其他线程可以继续向这个桶还对象
+	lock.unlock();
+	span = LLZXPageHeap::instance().allocateSpan(LLZXSizeClass::spanPages(size));
+	span->objectSize = size;
+
+	char* begin = static_cast<char*>(span->address());
+	char* limit = begin + (span->pages << kPageShift);
+	void* tail = begin;
+	for (char* object = begin + size; object + size <= limit; object += size)
+	{
+		nextOf(tail) = object;
+		tail = object;
+	}
+	nextOf(tail) = nullptr;
+	span->freeList = begin;
+
+	lock.lock();
+	spans.pushFront(span);
+	return span;
+}
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,65 @@
+#include "LLZXMemoryPool.h"
+
+#include "LLZXCentralCache.h"
+#include "LLZXPageHeap.h"
+#include "LLZXThreadCache.h"
+
+namespace LLZXMemoryPool
+{
+
+void* allocate(size_t size)
+{
+	if (size == 0)
+		size = 1;
+
+	if (size > kMaxBytes)
+	{
+		size_t pages = LLZXSizeClass::alignUp(size, kPageSize) >> kPageShift;
+		LLZXSpan* span = LLZXPageHeap::instance().allocateSpan(pages);
+		span->objectSize = size;
+		return span->address();
+	}
+
+	if (LLZXThreadCache* cache = LLZXThreadCache::local())
+		return cache->allocate(size);
+
+	// 线程缓存已经销毁（线程退出阶段），直接从中心缓存取一个
+	void* start = nullptr;
+	void* end = nullptr;
+	LLZXCentralCache::instance().fetchRange(start, end, 1, LLZXSizeClass::classSize(LLZXSizeClass::index(size)));
+	return start;
+}
+
+void deallocate(void* ptr, size_t size)
+{
+	if (!ptr)
+		return;
+	if (size == 0)
+		size = 1;
+
+	if (size > kMaxBytes)
+	{
+		LLZXPageHeap& heap = LLZXPageHeap::instance();
+		heap.releaseSpan(heap.spanOf(ptr));
+		return;
+	}
+
+	if (LLZXThreadCache* cache = LLZXThreadCache::local())
+	{
+		cache->deallocate(ptr, size);
+		return;
+	}
+
+	nextOf(ptr) = nullptr;
+	LLZXCentralCache::instance().releaseList(ptr, LLZXSizeClass::classSize(LLZXSizeClass::index(size)));
+}
+
+void deallocate(void* ptr)
+{
+	if (!ptr)
+		return;
+	LLZXSpan* span = LLZXPageHeap::instance().spanOf(ptr);
+	deallocate(ptr, span->objectSize);
+}
+
+} // namespace LLZXMemoryPool
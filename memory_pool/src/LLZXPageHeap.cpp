@@ -0,0 +1,217 @@
+#include "LLZXPageHeap.h"
+
+#include <atomic>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace LLZXMemoryPool
+{
+
+namespace
+{
+
+// 页堆向系统申请、尚未归还的字节数，包括页表用的页，不经过malloc，mallinfo统计不到
+std::atomic<size_t> mappedBytes{0};
+
+} // namespace
+
+size_t systemBytes()
+{
+	return mappedBytes.load(std::memory_order_relaxed);
+}
+
+void* systemAllocate(size_t pages)
+{
+	size_t bytes = pages << kPageShift;
+#ifdef _WIN32
+	// VirtualAlloc按64KB对齐，满足页对齐
+	void* ptr = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	if (!ptr)
+		throw std::bad_alloc();
+	mappedBytes.fetch_add(bytes, std::memory_order_relaxed);
+	return ptr;
+#else
+	// mmap只保证系统页（通常4KB）对齐，多申请一页再把首尾多余的部分还回去
+	void* ptr = mmap(nullptr, bytes + kPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED)
+		throw std::bad_alloc();
+	uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+	uintptr_t aligned = LLZXSizeClass::alignUp(begin, kPageSize);
+	if (aligned > begin)
+		munmap(ptr, aligned - begin);
+	uintptr_t tail = begin + bytes + kPageSize - (aligned + bytes);
+	if (tail > 0)
+		munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+	mappedBytes.fetch_add(bytes, std::memory_order_relaxed);
+	return reinterpret_cast<void*>(aligned);
+#endif
+}
+
+void systemRelease(void* ptr, size_t pages)
+{
+	mappedBytes.fetch_sub(pages << kPageShift, std::memory_order_relaxed);
+#ifdef _WIN32
+	VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+	munmap(ptr, pages << kPageShift);
+#endif
+}
+
+void LLZXPageMap::set(PageId page, LLZXSpan* span)
+{
+	// 中间节点和叶子直接向系统申请，新映射的页保证是全零的
+	std::atomic<Node*>& rootSlot = root_[page >> (kLeafBits + kMidBits)];
+	Node* mid = rootSlot.load(std::memory_order_relaxed);
+	if (!mid)
+	{
+		mid = new (systemAllocate(sizeof(Node) >> kPageShift)) Node();
+		rootSlot.store(mid, std::memory_order_release);
+	}
+
+	std::atomic<Leaf*>& midSlot = mid->children[(page >> kLeafBits) & (kMidSize - 1)];
+	Leaf* leaf = midSlot.load(std::memory_order_relaxed);
+	if (!leaf)
+	{
+		leaf = new (systemAllocate(sizeof(Leaf) >> kPageShift)) Leaf();
+		midSlot.store(leaf, std::memory_order_release);
+	}
+
+	leaf->spans[page & (kLeafSize - 1)].store(span, std::memory_order_release);
+}
+
+LLZXPageHeap& LLZXPageHeap::instance()
+{
+	static LLZXPageHeap* heap = new LLZXPageHeap();
+	return *heap;
+}
+
+LLZXSpan* LLZXPageHeap::allocateSpan(size_t pages)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return allocateLocked(pages);
+}
+
+LLZXSpan* LLZXPageHeap::allocateLocked(size_t pages)
+{
+	if (pages >= kMaxPages)
+	{
+		void* ptr = systemAllocate(pages);
+		LLZXSpan* span = newSpanObject();
+		span->pageId = reinterpret_cast<PageId>(ptr) >> kPageShift;
+		span->pages = pages;
+		span->inUse = true;
+		pageMap_.set(span->pageId, span);
+		pageMap_.set(span->pageId + pages - 1, span);
+		return span;
+	}
+
+	for (size_t n = pages; n < kMaxPages; ++n)
+	{
+		if (free_[n].empty())
+			continue;
+
+		LLZXSpan* span = free_[n].popFront();
+		if (n > pages)
+		{
+			// 切下前pages页，剩下的放回对应的桶
+			LLZXSpan* rest = newSpanObject();
+			rest->pageId = span->pageId + pages;
+			rest->pages = n - pages;
+			span->pages = pages;
+			insertFree(rest);
+		}
+		span->inUse = true;
+		// 对象可能位于span的任意一页上，每一页都要能查回span
+		for (size_t i = 0; i < pages; ++i)
+			pageMap_.set(span->pageId + i, span);
+		return span;
+	}
+
+	// 没有足够大的空闲span，向系统申请一整块最大的span再切
+	void* ptr = systemAllocate(kMaxPages - 1);
+	LLZXSpan* span = newSpanObject();
+	span->pageId = reinterpret_cast<PageId>(ptr) >> kPageShift;
+	span->pages = kMaxPages - 1;
+	insertFree(span);
+	return allocateLocked(pages);
+}
+
+void LLZXPageHeap::releaseSpan(LLZXSpan* span)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (span->pages >= kMaxPages)
+	{
+		pageMap_.set(span->pageId, nullptr);
+		pageMap_.set(span->pageId + span->pages - 1, nullptr);
+		systemRelease(span->address(), span->pages);
+		deleteSpanObject(span);
+		return;
+	}
+
+	span->freeList = nullptr;
+	span->useCount = 0;
+	span->objectSize = 0;
+
+	// 与前后相邻的空闲span合并，空闲span的首尾页总是登记着自己，合并后超过最大桶的不合并
+	while (true)
+	{
+		LLZXSpan* left = pageMap_.get(span->pageId - 1);
+		if (!left || left->inUse || left->pages + span->pages >= kMaxPages)
+			break;
+		LLZXSpanList::erase(left);
+		left->pages += span->pages;
+		deleteSpanObject(span);
+		span = left;
+	}
+	while (true)
+	{
+		LLZXSpan* right = pageMap_.get(span->pageId + span->pages);
+		if (!right || right->inUse || right->pages + span->pages >= kMaxPages)
+			break;
+		LLZXSpanList::erase(right);
+		span->pages += right->pages;
+		deleteSpanObject(right);
+	}
+	insertFree(span);
+}
+
+void LLZXPageHeap::insertFree(LLZXSpan* span)
+{
+	span->inUse = false;
+	free_[span->pages].pushFront(span);
+	// 空闲span只需要登记首尾页，供相邻span释放时合并
+	pageMap_.set(span->pageId, span);
+	pageMap_.set(span->pageId + span->pages - 1, span);
+}
+
+LLZXSpan* LLZXPageHeap::newSpanObject()
+{
+	if (!spanPool_)
+	{
+		char* page = static_cast<char*>(systemAllocate(1));
+		for (size_t offset = 0; offset + sizeof(LLZXSpan) <= kPageSize; offset += sizeof(LLZXSpan))
+		{
+			LLZXSpan* span = reinterpret_cast<LLZXSpan*>(page + offset);
+			span->next = spanPool_;
+			spanPool_ = span;
+		}
+	}
+
+	LLZXSpan* span = spanPool_;
+	spanPool_ = span->next;
+	return new (span) LLZXSpan();
+}
+
+void LLZXPageHeap::deleteSpanObject(LLZXSpan* span)
+{
+	span->next = spanPool_;
+	spanPool_ = span;
+}
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,115 @@
+#include "LLZXThreadCache.h"
+
+#include <algorithm>
+
+#include "LLZXCentralCache.h"
+
+namespace LLZXMemoryPool
+{
+
+namespace
+{
+
+// 两个thread_local都是平凡类型，线程退出的任何阶段都可以安全访问
+thread_local LLZXThreadCache* tlsCache = nullptr;
+thread_local bool             tlsDestroyed = false;
+
+// 线程退出时把线程缓存里的对象还给中心缓存；之后同一线程上其他thread_local对象析构时
+// 释放的内存由local()返回nullptr转为直接访问中心缓存
+struct ThreadCacheReclaimer
+{
+	~ThreadCacheReclaimer()
+	{
+		LLZXThreadCache* cache = tlsCache;
+		tlsCache = nullptr;
+		tlsDestroyed = true;
+		delete cache;
+	}
+};
+
+} // namespace
+
+LLZXThreadCache* LLZXThreadCache::local()
+{
+	if (tlsCache)
+		return tlsCache;
+	if (tlsDestroyed)
+		return nullptr;
+
+	static thread_local ThreadCacheReclaimer reclaimer;
+	(void)reclaimer;
+	tlsCache = new LLZXThreadCache();
+	return tlsCache;
+}
+
+LLZXThreadCache::~LLZXThreadCache()
+{
+	LLZXCentralCache& central = LLZXCentralCache::instance();
+	for (size_t i = 0; i < kNumClasses; ++i)
+	{
+		if (lists_[i].head)
+			central.releaseList(lists_[i].head, LLZXSizeClass::classSize(i));
+	}
+}
+
+void* LLZXThreadCache::allocate(size_t size)
+{
+	size_t index = LLZXSizeClass::index(size);
+	FreeList& list = lists_[index];
+	if (list.head)
+	{
+		void* object = list.head;
+		list.head = nextOf(object);
+		--list.length;
+		return object;
+	}
+	return fetchFromCentral(list, LLZXSizeClass::classSize(index));
+}
+
+void LLZXThreadCache::deallocate(void* ptr, size_t size)
+{
+	size_t index = LLZXSizeClass::index(size);
+	FreeList& list = lists_[index];
+	nextOf(ptr) = list.head;
+	list.head = ptr;
+	++list.length;
+
+	if (list.length > list.maxLength)
+	{
+		size_t classSize = LLZXSizeClass::classSize(index);
+		size_t batch = LLZXSizeClass::batchSize(classSize);
+		releaseToCentral(list, classSize, std::min(list.length, batch));
+		if (list.maxLength < batch)
+			++list.maxLength;
+	}
+}
+
+void* LLZXThreadCache::fetchFromCentral(FreeList& list, size_t size)
+{
+	size_t batch = LLZXSizeClass::batchSize(size);
+	size_t count = std::min(list.maxLength, batch);
+	if (list.maxLength < batch)
+		++list.maxLength;
+
+	void* start = nullptr;
+	void* end = nullptr;
+	size_t fetched = LLZXCentralCache::instance().fetchRange(start, end, count, size);
+	// 第一个对象直接返回，其余的留在线程链表里
+	list.head = nextOf(start);
+	list.length = fetched - 1;
+	return start;
+}
+
+void LLZXThreadCache::releaseToCentral(FreeList& list, size_t size, size_t count)
+{
+	void* start = list.head;
+	void* end = start;
+	for (size_t i = 1; i < count; ++i)
+		end = nextOf(end);
+	list.head = nextOf(end);
+	list.length -= count;
+	nextOf(end) = nullptr;
+	LLZXCentralCache::instance().releaseList(start, size);
+}
+
+} // namespace LLZXMemoryPool
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// 测试用的最小工具：检查失败时打印位置并abort（sanitizer和ctest都能据此报告失败），不依赖外部测试框架
+#define LLZX_CHECK(condition)                                                                        \
+	do                                                                                               \
+	{                                                                                                \
+		if (!(condition))                                                                            \
+			LLZXTest::fail(#condition, __FILE__, __LINE__);                                          \
+	} while (0)
+
+namespace LLZXTest
+{
+
+[[noreturn]] inline void fail(const char* condition, const char* file, int line)
+{
+	std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+	std::fflush(stderr);
+	std::abort();
+}
+
+// 启动threadNum个线程执行fn(i)并等待全部结束
+template<typename Fn>
+void runThreads(size_t threadNum, Fn&& fn)
+{
+	std::vector<std::thread> threads;
+	threads.reserve(threadNum);
+	for (size_t i = 0; i < threadNum; ++i)
+		threads.emplace_back([&fn, i] { fn(i); });
+	for (auto& thread : threads)
+		thread.join();
+}
+
+// 固定种子的xorshift，测试结果可复现
+class Random
+{
+public:
+	explicit Random(uint64_t seed) : state_(seed * 0x9e3779b97f4a7c15ull + 1) {}
+
+	uint64_t next()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return state_;
+	}
+
+	uint64_t below(uint64_t bound) { return next() % bound; }
+
+private:
+	uint64_t state_;
+};
+
+} // namespace LLZXTest
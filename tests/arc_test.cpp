@@ -0,0 +1,114 @@
+// ARC的行为测试：
+//   访问过两次的元素在T2中，一轮超过容量的一次性扫描只冲刷T1；
+//   插入的key命中B1幽灵记录时T1的目标大小增大，命中B2时减小，命中幽灵的key直接进入T2；
+//   remove、过期回收释放槽位里的key和值
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "LLZXArcCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+bool contains(LLZXArcCache<int, int>& cache, int key)
+{
+	int value = 0;
+	bool hit = cache.get(key, value);
+	LLZX_CHECK(!hit || value == key);
+	return hit;
+}
+
+void testGhostAdaptation()
+{
+	LLZXArcCache<int, int> cache(4);
+	// T2: 1 2，T1: 3 4
+	cache.put(1, 1);
+	cache.put(2, 2);
+	LLZX_CHECK(contains(cache, 1) && contains(cache, 2));
+	cache.put(3, 3);
+	cache.put(4, 4);
+	LLZX_CHECK(cache.recencyTarget() == 0);
+
+	// T1超过目标大小，从T1驱逐3，3记入B1
+	cache.put(5, 5);
+	LLZX_CHECK(cache.size() == 4);
+
+	// 3命中B1：目标大小增大，3进入T2，这次仍从T1驱逐4
+	cache.put(3, 3);
+	LLZX_CHECK(cache.recencyTarget() == 1);
+	LLZX_CHECK(cache.size() == 4);
+	LLZX_CHECK(contains(cache, 3) && contains(cache, 1) && contains(cache, 2));
+	LLZX_CHECK(!contains(cache, 4));
+
+	// T1: 5，T2: 3 1 2；T1没有超过目标大小，从T2驱逐3，3记入B2
+	cache.put(6, 6);
+	LLZX_CHECK(cache.size() == 4);
+	LLZX_CHECK(!contains(cache, 3));
+
+	// 3命中B2：目标大小减小
+	cache.put(3, 3);
+	LLZX_CHECK(cache.recencyTarget() == 0);
+	LLZX_CHECK(contains(cache, 3));
+	LLZX_CHECK(cache.size() == 4);
+}
+
+void testScanResistance()
+{
+	constexpr int kCapacity = 100;
+	constexpr int kHotKeys = 50;
+	LLZXArcCache<int, int> cache(kCapacity);
+	for (int key = 0; key < kHotKeys; ++key)
+	{
+		cache.put(key, key);
+		LLZX_CHECK(contains(cache, key));
+	}
+
+	for (int key = kHotKeys; key < kHotKeys + 10 * kCapacity; ++key)
+		cache.put(key, key);
+	LLZX_CHECK(cache.size() == static_cast<size_t>(kCapacity));
+	// 扫描的key都不重复，没有命中幽灵记录，目标大小保持不变
+	LLZX_CHECK(cache.recencyTarget() == 0);
+
+	for (int key = 0; key < kHotKeys; ++key)
+		LLZX_CHECK(contains(cache, key));
+	// T1剩下的是扫描中最后插入的那些key
+	LLZX_CHECK(contains(cache, kHotKeys + 10 * kCapacity - 1));
+	LLZX_CHECK(!contains(cache, kHotKeys));
+}
+
+// shared_ptr的引用计数回到1说明缓存里的key和值已经释放
+void testSlotRelease()
+{
+	LLZXArcCache<std::shared_ptr<int>, std::shared_ptr<std::string>> cache(16);
+	auto key = std::make_shared<int>(1);
+	auto value = std::make_shared<std::string>("one");
+
+	cache.put(key, value);
+	LLZX_CHECK(key.use_count() > 1 && value.use_count() == 2);
+	cache.remove(key);
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+
+	cache.put(key, value, std::chrono::milliseconds(10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	LLZX_CHECK(cache.purgeExpired() == 1);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+}
+
+} // namespace
+
+int main()
+{
+	testGhostAdaptation();
+	testScanResistance();
+	testSlotRelease();
+	std::printf("arc_test: passed\n");
+	return 0;
+}
@@ -0,0 +1,118 @@
+// CLOCK的行为测试：
+//   新元素引用位为0，命中或更新时置1；时钟指针清零置位的元素（第二次机会），驱逐遇到的第一个引用位为0的元素；
+//   每圈之内都被访问过的热点不会被持续插入的新key挤掉；remove腾出的槽位优先复用，并释放槽位里的key和值
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "LLZXClockCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+bool contains(LLZXClockCache<int, int>& cache, int key)
+{
+	int value = 0;
+	bool hit = cache.get(key, value);
+	LLZX_CHECK(!hit || value == key);
+	return hit;
+}
+
+void testSecondChance()
+{
+	LLZXClockCache<int, int> cache(4);
+	for (int key = 1; key <= 4; ++key)
+		cache.put(key, key);
+	LLZX_CHECK(contains(cache, 1) && contains(cache, 3));
+
+	// 指针从1开始：1被清零后跳过，驱逐未被访问的2
+	cache.put(5, 5);
+	LLZX_CHECK(cache.size() == 4);
+	LLZX_CHECK(!contains(cache, 2));
+
+	// 指针在3：同样清零后跳过，驱逐4
+	cache.put(6, 6);
+	LLZX_CHECK(!contains(cache, 4));
+
+	// 1的第二次机会已经用掉，这一圈没有再被访问，轮到它被驱逐
+	cache.put(7, 7);
+	LLZX_CHECK(!contains(cache, 1));
+	LLZX_CHECK(contains(cache, 3) && contains(cache, 5) && contains(cache, 6) && contains(cache, 7));
+	LLZX_CHECK(cache.size() == 4);
+}
+
+void testUpdateMarksReferenced()
+{
+	LLZXClockCache<int, int> cache(2);
+	cache.put(1, 1);
+	cache.put(2, 2);
+	cache.put(1, 1);
+	cache.put(3, 3);
+	LLZX_CHECK(!contains(cache, 2));
+	LLZX_CHECK(contains(cache, 1) && contains(cache, 3));
+}
+
+void testHotKeysSurvive()
+{
+	constexpr int kCapacity = 100;
+	constexpr int kHotKeys = 20;
+	LLZXClockCache<int, int> cache(kCapacity);
+	for (int key = 0; key < kHotKeys; ++key)
+		cache.put(key, key);
+
+	// 指针转一圈至少要插入kCapacity - kHotKeys个新key，期间热点都被访问过
+	int next = kHotKeys;
+	for (int round = 0; round < 50; ++round)
+	{
+		for (int key = 0; key < kHotKeys; ++key)
+			LLZX_CHECK(contains(cache, key));
+		for (int i = 0; i < 40; ++i, ++next)
+			cache.put(next, next);
+		LLZX_CHECK(cache.size() <= static_cast<size_t>(kCapacity));
+	}
+	LLZX_CHECK(!contains(cache, kHotKeys));
+}
+
+// remove腾出的槽位先被复用，不驱逐其他元素；shared_ptr的引用计数回到1说明key和值已经释放
+void testSlotRelease()
+{
+	LLZXClockCache<int, int> small(2);
+	small.put(1, 1);
+	small.put(2, 2);
+	small.remove(1);
+	small.put(3, 3);
+	LLZX_CHECK(contains(small, 2) && contains(small, 3));
+
+	LLZXClockCache<std::shared_ptr<int>, std::shared_ptr<std::string>> cache(16);
+	auto key = std::make_shared<int>(1);
+	auto value = std::make_shared<std::string>("one");
+
+	cache.put(key, value);
+	LLZX_CHECK(key.use_count() > 1 && value.use_count() == 2);
+	cache.remove(key);
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+
+	cache.put(key, value, std::chrono::milliseconds(10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	LLZX_CHECK(cache.purgeExpired() == 1);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+}
+
+} // namespace
+
+int main()
+{
+	testSecondChance();
+	testUpdateMarksReferenced();
+	testHotKeysSurvive();
+	testSlotRelease();
+	std::printf("clock_test: passed\n");
+	return 0;
+}
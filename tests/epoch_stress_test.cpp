@@ -0,0 +1,197 @@
+// LLZXEpoch和LockFree读模式的压力测试：
+//   直接使用LLZXEpoch：写者不断替换共享指针并retire旧对象，读者在临界区内检查对象未被释放；
+//   LockFree模式的LLZXLruCache/LLZXHashLruCache：读者无锁get的同时写者put/remove并反复缩小、扩大容量，
+//   值由key推出，读到的值必须与key一致（读到已释放或被复用的表项时值会对不上，ASan/TSan也会报告）
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "LLZXEpoch.h"
+#include "LLZXLruCache.h"
+#include "LLZXTestUtil.h"
+
+using LLZXCommon::LLZXEpoch;
+using LLZXCommon::LLZXEpochGuard;
+
+namespace
+{
+
+constexpr uint64_t kAlive = 0x600dcafe600dcafeull;
+constexpr uint64_t kDead = 0xdeaddeaddeaddeadull;
+
+struct Node
+{
+	uint64_t canary = kAlive;
+	uint64_t value = 0;
+	uint64_t check = 0;
+
+	~Node() { canary = kDead; }
+};
+
+std::atomic<size_t> liveNodes{0};
+
+Node* makeNode(uint64_t value)
+{
+	Node* node = new Node;
+	node->value = value;
+	node->check = ~value;
+	liveNodes.fetch_add(1, std::memory_order_relaxed);
+	return node;
+}
+
+void freeNode(void* object)
+{
+	delete static_cast<Node*>(object);
+	liveNodes.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// 读者在临界区内多次访问同一个对象，期间写者可能已经把它摘下并retire
+void testRawEpoch(size_t readerNum, size_t writerNum, uint64_t swaps)
+{
+	constexpr size_t kSlots = 8;
+	std::atomic<Node*> slots[kSlots];
+	for (auto& slot : slots)
+		slot.store(makeNode(0));
+	std::atomic<size_t> writersDone{0};
+
+	std::thread readers([&] {
+		LLZXTest::runThreads(readerNum, [&](size_t id) {
+			LLZXTest::Random random(id + 1);
+			while (writersDone.load(std::memory_order_acquire) < writerNum)
+			{
+				LLZXEpochGuard guard;
+				Node* node = slots[random.below(kSlots)].load(std::memory_order_acquire);
+				for (int i = 0; i < 4; ++i)
+				{
+					LLZX_CHECK(node->canary == kAlive);
+					LLZX_CHECK(node->check == ~node->value);
+					std::this_thread::yield();
+				}
+				// 嵌套的临界区
+				LLZXEpochGuard inner;
+				LLZX_CHECK(slots[random.below(kSlots)].load(std::memory_order_acquire)->canary == kAlive);
+			}
+		});
+	});
+
+	LLZXTest::runThreads(writerNum, [&](size_t id) {
+		LLZXTest::Random random(id + 100);
+		for (uint64_t i = 1; i <= swaps; ++i)
+		{
+			Node* old = slots[random.below(kSlots)].exchange(makeNode(i), std::memory_order_acq_rel);
+			LLZXEpoch::retire(old, freeNode);
+		}
+		// 没有读者之后反复collect，本线程retire的对象最终全部释放
+		writersDone.fetch_add(1, std::memory_order_release);
+		while (writersDone.load(std::memory_order_acquire) < writerNum)
+			std::this_thread::yield();
+		for (int round = 0; round < 1000 && LLZXEpoch::pending() > 0; ++round)
+		{
+			LLZXEpoch::collect();
+			std::this_thread::yield();
+		}
+		LLZX_CHECK(LLZXEpoch::pending() == 0);
+	});
+	readers.join();
+
+	for (auto& slot : slots)
+		freeNode(slot.load());
+	// 已退出线程遗留的对象由之后的collect接手
+	for (int round = 0; round < 1000 && liveNodes.load() > 0; ++round)
+		LLZXEpoch::collect();
+	LLZX_CHECK(liveNodes.load() == 0);
+}
+
+uint64_t valueOf(uint64_t key)
+{
+	return key * 0x9e3779b97f4a7c15ull ^ 0x5555;
+}
+
+// 写者线程随机put/remove，另一个线程反复缩小、恢复容量，读者无锁查询
+template<typename Cache>
+void testLockFreeCache(Cache& cache, size_t readerNum, uint64_t keySpace, uint64_t writes, size_t capacity)
+{
+	std::atomic<bool> done{false};
+	std::atomic<uint64_t> hits{0};
+
+	std::thread readers([&] {
+		LLZXTest::runThreads(readerNum, [&](size_t id) {
+			LLZXTest::Random random(id + 1);
+			uint64_t localHits = 0;
+			while (!done.load(std::memory_order_acquire))
+			{
+				uint64_t key = random.below(keySpace);
+				uint64_t value = 0;
+				if (cache.get(key, value))
+				{
+					LLZX_CHECK(value == valueOf(key));
+					++localHits;
+				}
+			}
+			hits.fetch_add(localHits);
+		});
+	});
+
+	std::thread resizer([&] {
+		LLZXTest::Random random(7);
+		while (!done.load(std::memory_order_acquire))
+		{
+			cache.setCapacity(capacity / 8 + random.below(capacity / 4));
+			std::this_thread::yield();
+			cache.setCapacity(capacity);
+			std::this_thread::yield();
+		}
+	});
+
+	LLZXTest::runThreads(2, [&](size_t id) {
+		LLZXTest::Random random(id + 50);
+		for (uint64_t i = 0; i < writes; ++i)
+		{
+			uint64_t key = random.below(keySpace);
+			if (random.below(8) == 0)
+				cache.remove(key);
+			else if (random.below(8) == 0)
+				cache.put(key, valueOf(key), std::chrono::milliseconds(1 + random.below(5)));
+			else
+				cache.put(key, valueOf(key));
+		}
+	});
+	done.store(true, std::memory_order_release);
+	resizer.join();
+	readers.join();
+
+	cache.setCapacity(capacity);
+	size_t present = 0;
+	for (uint64_t key = 0; key < keySpace; ++key)
+	{
+		uint64_t value = 0;
+		if (cache.get(key, value))
+		{
+			LLZX_CHECK(value == valueOf(key));
+			++present;
+		}
+	}
+	LLZX_CHECK(present <= capacity);
+	LLZX_CHECK(hits.load() > 0);
+}
+
+} // namespace
+
+int main()
+{
+	testRawEpoch(3, 2, 20000);
+
+	{
+		LLZXCache::LLZXLruCache<uint64_t, uint64_t> cache(2048, LLZXCache::LLZXReadMode::LockFree);
+		testLockFreeCache(cache, 3, 8192, 100000, 2048);
+	}
+	{
+		LLZXCache::LLZXHashLruCache<uint64_t, uint64_t> cache(4096, 4, LLZXCache::LLZXReadMode::LockFree);
+		testLockFreeCache(cache, 3, 16384, 100000, 4096);
+	}
+	std::printf("epoch_stress_test: passed\n");
+	return 0;
+}
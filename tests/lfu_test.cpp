@@ -0,0 +1,137 @@
+// LFU的行为测试：
+//   满时驱逐频率最小的元素，频率相同时驱逐其中最久未访问的；新元素频率为1，更新也算一次访问；
+//   平均频率超过maxAverageNum时整体降温，曾经的热点不再访问后会被新的热点取代；
+//   Buffered读模式下命中先记录到读缓冲，频率在回放后一致；remove、过期回收释放槽位里的key和值
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "LLZXLfuCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+void access(LLZXLfuCache<int, int>& cache, int key, int times)
+{
+	int value = 0;
+	for (int i = 0; i < times; ++i)
+		LLZX_CHECK(cache.get(key, value) && value == key);
+}
+
+void testEvictLeastFrequent()
+{
+	LLZXLfuCache<int, int> cache(3);
+	cache.put(1, 1);
+	cache.put(2, 2);
+	cache.put(3, 3);
+	access(cache, 1, 2);
+	access(cache, 2, 1);
+	LLZX_CHECK(cache.frequency(1) == 3);
+	LLZX_CHECK(cache.frequency(2) == 2);
+	LLZX_CHECK(cache.frequency(3) == 1);
+
+	cache.put(4, 4);
+	LLZX_CHECK(cache.frequency(3) == 0);
+	LLZX_CHECK(cache.frequency(4) == 1);
+
+	// 新元素频率最低，下一次驱逐的就是它
+	cache.put(5, 5);
+	LLZX_CHECK(cache.frequency(4) == 0);
+	LLZX_CHECK(cache.frequency(1) == 3 && cache.frequency(2) == 2 && cache.frequency(5) == 1);
+	LLZX_CHECK(cache.size() == 3);
+
+	// 更新已有的key计入一次访问
+	cache.put(5, 50);
+	LLZX_CHECK(cache.frequency(5) == 2);
+	LLZX_CHECK(cache.get(5) == 50);
+}
+
+void testTieBreakByRecency()
+{
+	LLZXLfuCache<int, int> cache(3);
+	cache.put(1, 1);
+	cache.put(2, 2);
+	cache.put(3, 3);
+	cache.put(4, 4);
+	LLZX_CHECK(cache.frequency(1) == 0);
+
+	// 2升到频率2之后，频率1的桶里3比4更久未访问
+	access(cache, 2, 1);
+	cache.put(5, 5);
+	LLZX_CHECK(cache.frequency(3) == 0);
+	LLZX_CHECK(cache.frequency(2) == 2 && cache.frequency(4) == 1 && cache.frequency(5) == 1);
+}
+
+void testAging()
+{
+	constexpr size_t kMaxAverage = 10;
+	LLZXLfuCache<int, int> cache(2, kMaxAverage);
+	cache.put(1, 1);
+	cache.put(2, 2);
+
+	// 平均频率不会明显超过上限
+	access(cache, 1, 100);
+	LLZX_CHECK(cache.frequency(1) + cache.frequency(2) <= 2 * kMaxAverage + 1);
+	LLZX_CHECK(cache.frequency(2) >= 1);
+
+	// 1不再访问，之后的热点2逐渐超过它，满时驱逐的是降温后的1
+	access(cache, 2, 100);
+	LLZX_CHECK(cache.frequency(2) > cache.frequency(1));
+	cache.put(3, 3);
+	LLZX_CHECK(cache.frequency(1) == 0);
+	LLZX_CHECK(cache.frequency(2) > 0 && cache.frequency(3) == 1);
+}
+
+void testBufferedReads()
+{
+	LLZXLfuCache<int, int> cache(3, LLZXLfuCache<int, int>::kDefaultMaxAverageNum, LLZXReadMode::Buffered);
+	cache.put(1, 1);
+	cache.put(2, 2);
+	access(cache, 1, 5);
+	LLZX_CHECK(cache.frequency(1) == 6);
+	LLZX_CHECK(cache.frequency(2) == 1);
+
+	cache.put(3, 3);
+	access(cache, 3, 2);
+	cache.put(4, 4);
+	LLZX_CHECK(cache.frequency(2) == 0);
+	LLZX_CHECK(cache.frequency(1) == 6 && cache.frequency(3) == 3 && cache.frequency(4) == 1);
+}
+
+// shared_ptr的引用计数回到1说明缓存里的key和值已经释放
+void testSlotRelease()
+{
+	LLZXLfuCache<std::shared_ptr<int>, std::shared_ptr<std::string>> cache(16);
+	auto key = std::make_shared<int>(1);
+	auto value = std::make_shared<std::string>("one");
+
+	cache.put(key, value);
+	LLZX_CHECK(key.use_count() > 1 && value.use_count() == 2);
+	cache.remove(key);
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+
+	cache.put(key, value, std::chrono::milliseconds(10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	LLZX_CHECK(cache.purgeExpired() == 1);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+}
+
+} // namespace
+
+int main()
+{
+	testEvictLeastFrequent();
+	testTieBreakByRecency();
+	testAging();
+	testBufferedReads();
+	testSlotRelease();
+	std::printf("lfu_test: passed\n");
+	return 0;
+}
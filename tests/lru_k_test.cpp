@@ -0,0 +1,236 @@
+// LRU-K的行为测试：
+//   Exact模式下第k次访问才进入主缓存，之前put的值暂存在访问历史里，由达到k次的get提升，提升后保留剩余的存活时间；
+//   暂存的值过期后不再提升，访问历史被淘汰后重新计数；Sketch模式不暂存值，由达到k次之后的put写入；
+//   putIfAbsent、tryGet/tryPut、visit和arena版本的get同样经过访问历史；分片版本行为一致
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "LLZXLruCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+using KCache = LLZXLruKCache<int, std::string>;
+
+// 最简单的arena：分配出去的内存在析构时一起释放
+class TestArena
+{
+public:
+	void* allocate(size_t bytes, size_t)
+	{
+		blocks_.emplace_back(new char[bytes > 0 ? bytes : 1]);
+		return blocks_.back().get();
+	}
+
+private:
+	std::vector<std::unique_ptr<char[]>> blocks_;
+};
+
+// k=3：put和前一次get都只记录历史，第三次访问时暂存的值进入主缓存
+void testAdmissionAtK()
+{
+	KCache cache(4, 16, 3);
+	std::string value;
+
+	cache.put(1, "one");
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(!cache.get(1, value));
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(cache.get(1, value) && value == "one");
+	LLZX_CHECK(cache.size() == 1);
+	LLZX_CHECK(cache.get(1, value) && value == "one");
+
+	// 没有暂存值的key只累计次数，达到k次之后的put直接写入主缓存
+	for (int i = 0; i < 3; ++i)
+		LLZX_CHECK(!cache.get(2, value));
+	cache.put(2, "two");
+	LLZX_CHECK(cache.size() == 2);
+	LLZX_CHECK(cache.get(2, value) && value == "two");
+
+	// 已在主缓存中的key直接更新
+	cache.put(2, "deux");
+	LLZX_CHECK(cache.get(2, value) && value == "deux");
+}
+
+// 提升时带上暂存值剩余的存活时间，到期后从主缓存中消失
+void testPromotionKeepsTtl()
+{
+	KCache cache(4, 16, 2);
+	std::string value;
+
+	cache.put(1, "one", std::chrono::milliseconds(200));
+	LLZX_CHECK(cache.get(1, value) && value == "one");
+	LLZX_CHECK(cache.size() == 1);
+	std::this_thread::sleep_for(std::chrono::milliseconds(400));
+	LLZX_CHECK(!cache.get(1, value));
+}
+
+void testPendingExpiry()
+{
+	KCache cache(4, 16, 2);
+	std::string value;
+
+	// 暂存的值过期后，达到k次的get也不会提升它
+	cache.put(1, "one", std::chrono::milliseconds(20));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	LLZX_CHECK(!cache.get(1, value));
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(!cache.get(1, value));
+
+	// 次数已经达到k，之后的put直接进入主缓存
+	cache.put(1, "uno");
+	LLZX_CHECK(cache.get(1, value) && value == "uno");
+
+	// 不带ttl的put覆盖暂存值时清除原来的到期时刻
+	KCache other(4, 16, 3);
+	other.put(2, "two", std::chrono::milliseconds(20));
+	other.put(2, "deux");
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	LLZX_CHECK(other.get(2, value) && value == "deux");
+}
+
+// 访问历史按LRU淘汰，被淘汰的key连同暂存的值一起丢弃，重新从1开始计数
+void testHistoryEviction()
+{
+	KCache cache(4, 2, 2);
+	std::string value;
+
+	cache.put(1, "one");
+	cache.put(2, "two");
+	cache.put(3, "three");
+	LLZX_CHECK(!cache.get(1, value));
+	LLZX_CHECK(cache.get(3, value) && value == "three");
+}
+
+void testSketchMode()
+{
+	KCache cache(4, 64, 2, LLZXHistoryMode::Sketch);
+	std::string value;
+
+	// 不暂存值：第二次访问的get仍然未命中，之后的put写入主缓存
+	cache.put(1, "one");
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(!cache.get(1, value));
+	cache.put(1, "uno");
+	LLZX_CHECK(cache.size() == 1);
+	LLZX_CHECK(cache.get(1, value) && value == "uno");
+
+	cache.put(2, "two");
+	LLZX_CHECK(cache.size() == 1);
+
+	// k超过计数器上限时按上限处理，仍然可以进入主缓存
+	KCache capped(4, 64, 100, LLZXHistoryMode::Sketch);
+	for (uint32_t i = 0; i < LLZXCountMinSketch::kMaxCount; ++i)
+		capped.put(3, "three");
+	LLZX_CHECK(capped.get(3, value) && value == "three");
+}
+
+// 不存在（包括只有暂存值）时才写入，写入同样只是暂存，不绕过k次门槛
+void testPutIfAbsent()
+{
+	KCache cache(4, 16, 2);
+	std::string value;
+
+	LLZX_CHECK(cache.putIfAbsent(1, "one"));
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(!cache.putIfAbsent(1, "uno"));
+	LLZX_CHECK(cache.get(1, value) && value == "one");
+	LLZX_CHECK(!cache.putIfAbsent(1, "uno"));
+	LLZX_CHECK(cache.get(1, value) && value == "one");
+
+	// 暂存值过期后视为不存在
+	LLZX_CHECK(cache.putIfAbsent(2, "two", std::chrono::milliseconds(20)));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	LLZX_CHECK(cache.putIfAbsent(2, "deux"));
+	LLZX_CHECK(cache.size() == 2);
+	LLZX_CHECK(cache.get(2, value) && value == "deux");
+}
+
+void testTryGetTryPut()
+{
+	KCache cache(4, 16, 2);
+	std::string value;
+
+	LLZX_CHECK(cache.tryPut(1, "one"));
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(cache.tryGet(1, value) == LLZXTryResult::Hit && value == "one");
+	LLZX_CHECK(cache.size() == 1);
+	LLZX_CHECK(cache.tryGet(2, value) == LLZXTryResult::Miss);
+}
+
+// 模板visit、基类接口的visit和arena版本的get都计入访问次数并提升暂存值
+void testVisit()
+{
+	KCache cache(4, 16, 2);
+	std::string seen;
+
+	cache.put(1, "one");
+	LLZX_CHECK(cache.visit(1, [&seen](const std::string& found) { seen = found; }));
+	LLZX_CHECK(seen == "one");
+	LLZX_CHECK(cache.size() == 1);
+
+	LLZXCachePolicy<int, std::string>& policy = cache;
+	cache.put(2, "two");
+	LLZX_CHECK(policy.visit(2, [&seen](const std::string& found) { seen = found; }));
+	LLZX_CHECK(seen == "two");
+	LLZX_CHECK(cache.size() == 2);
+
+	TestArena arena;
+	std::string_view view;
+	cache.put(3, "three");
+	LLZX_CHECK(cache.get(3, arena, view) && view == "three");
+	LLZX_CHECK(cache.size() == 3);
+	LLZX_CHECK(!cache.get(4, arena, view));
+}
+
+void testSharded()
+{
+	LLZXHashLruKCache<int, std::string> cache(64, 256, 2, 4);
+	std::string value;
+
+	auto occupied = [&cache] {
+		std::vector<size_t> occupancy = cache.sliceOccupancy();
+		return std::accumulate(occupancy.begin(), occupancy.end(), size_t(0));
+	};
+
+	for (int i = 0; i < 32; ++i)
+		cache.put(i, std::to_string(i));
+	LLZX_CHECK(occupied() == 0);
+	for (int i = 0; i < 32; ++i)
+		LLZX_CHECK(cache.get(i, value) && value == std::to_string(i));
+	LLZX_CHECK(occupied() == 32);
+
+	LLZX_CHECK(cache.putIfAbsent(100, "hundred"));
+	LLZX_CHECK(!cache.putIfAbsent(100, "cent"));
+	LLZX_CHECK(occupied() == 32);
+	LLZX_CHECK(cache.tryGet(100, value) == LLZXTryResult::Hit && value == "hundred");
+	LLZX_CHECK(occupied() == 33);
+}
+
+} // namespace
+
+int main()
+{
+	testAdmissionAtK();
+	testPromotionKeepsTtl();
+	testPendingExpiry();
+	testHistoryEviction();
+	testSketchMode();
+	testPutIfAbsent();
+	testTryGetTryPut();
+	testVisit();
+	testSharded();
+	std::printf("lru_k_test: passed\n");
+	return 0;
+}
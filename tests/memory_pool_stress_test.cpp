@@ -0,0 +1,190 @@
+// memory_pool的多线程压力测试：
+//   各线程按随机大小（覆盖所有大小类和超过256KB的大块）分配、写入特征字节、稍后检查并释放，
+//   一部分内存交给其他线程释放（跨线程归还到中心缓存），块的特征字节被改写说明内存重叠或被提前回收；
+//   另外让标准容器通过LLZXPoolAllocator并发使用池，以及每个线程的arena在LLZXArenaScope结束时回收
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LLZXArena.h"
+#include "LLZXMemoryPool.h"
+#include "LLZXTestUtil.h"
+
+namespace
+{
+
+struct Block
+{
+	unsigned char* ptr;
+	size_t         size;
+	unsigned char  tag;
+};
+
+size_t randomSize(LLZXTest::Random& random)
+{
+	uint64_t kind = random.below(100);
+	if (kind < 70)
+		return 1 + random.below(256);
+	if (kind < 95)
+		return 1 + random.below(32 * 1024);
+	if (kind < 99)
+		return 1 + random.below(256 * 1024);
+	return 256 * 1024 + 1 + random.below(768 * 1024);
+}
+
+Block allocateBlock(LLZXTest::Random& random)
+{
+	Block block;
+	block.size = randomSize(random);
+	block.ptr = static_cast<unsigned char*>(LLZXMemoryPool::allocate(block.size));
+	LLZX_CHECK(block.ptr != nullptr);
+	LLZX_CHECK(reinterpret_cast<uintptr_t>(block.ptr) % 8 == 0);
+	if (block.size % 16 == 0)
+		LLZX_CHECK(reinterpret_cast<uintptr_t>(block.ptr) % 16 == 0);
+	block.tag = static_cast<unsigned char>(random.next() | 1);
+	// 首尾和中间各写一段，整块写入在大块上太慢
+	size_t span = std::min<size_t>(block.size, 64);
+	std::memset(block.ptr, block.tag, span);
+	std::memset(block.ptr + block.size - span, block.tag, span);
+	block.ptr[block.size / 2] = block.tag;
+	return block;
+}
+
+void checkAndFree(const Block& block, bool withSize)
+{
+	size_t span = std::min<size_t>(block.size, 64);
+	for (size_t i = 0; i < span; ++i)
+	{
+		LLZX_CHECK(block.ptr[i] == block.tag);
+		LLZX_CHECK(block.ptr[block.size - 1 - i] == block.tag);
+	}
+	LLZX_CHECK(block.ptr[block.size / 2] == block.tag);
+	if (withSize)
+		LLZXMemoryPool::deallocate(block.ptr, block.size);
+	else
+		LLZXMemoryPool::deallocate(block.ptr);
+}
+
+// 每个线程保留一批存活的块，随机替换；一部分块放进共享的交接区，由下一个线程释放
+void testAllocateFree(size_t threadNum, size_t rounds)
+{
+	std::mutex handoffMutex;
+	std::vector<std::vector<Block>> handoff(threadNum);
+
+	LLZXTest::runThreads(threadNum, [&](size_t id) {
+		LLZXTest::Random random(id + 1);
+		std::vector<Block> live;
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			if (live.size() < 256 || random.below(2) == 0)
+				live.push_back(allocateBlock(random));
+			else
+			{
+				size_t victim = random.below(live.size());
+				Block block = live[victim];
+				live[victim] = live.back();
+				live.pop_back();
+				if (random.below(4) == 0)
+				{
+					std::lock_guard<std::mutex> lock(handoffMutex);
+					handoff[(id + 1) % threadNum].push_back(block);
+				}
+				else
+					checkAndFree(block, random.below(2) == 0);
+			}
+
+			if (round % 1024 == 0)
+			{
+				std::vector<Block> mine;
+				{
+					std::lock_guard<std::mutex> lock(handoffMutex);
+					mine.swap(handoff[id]);
+				}
+				for (const Block& block : mine)
+					checkAndFree(block, true);
+			}
+		}
+		for (const Block& block : live)
+			checkAndFree(block, true);
+	});
+
+	for (const auto& blocks : handoff)
+	{
+		for (const Block& block : blocks)
+			checkAndFree(block, false);
+	}
+}
+
+using PoolString = std::basic_string<char, std::char_traits<char>, LLZXMemoryPool::LLZXPoolAllocator<char>>;
+using PoolMap = std::map<uint64_t, PoolString, std::less<uint64_t>,
+	LLZXMemoryPool::LLZXPoolAllocator<std::pair<const uint64_t, PoolString>>>;
+
+// 容器节点和字符串都来自池，其他线程同时在分配释放
+void testContainers(size_t threadNum, size_t ops)
+{
+	LLZXTest::runThreads(threadNum, [&](size_t id) {
+		LLZXTest::Random random(id + 100);
+		PoolMap map;
+		std::vector<uint64_t, LLZXMemoryPool::LLZXPoolAllocator<uint64_t>> keys;
+		for (size_t i = 0; i < ops; ++i)
+		{
+			uint64_t key = random.below(4096);
+			if (random.below(3) == 0)
+				map.erase(key);
+			else
+				map[key] = PoolString(static_cast<size_t>(1 + key % 300), static_cast<char>('a' + key % 26));
+			keys.push_back(key);
+		}
+		for (const auto& [key, value] : map)
+		{
+			LLZX_CHECK(value.size() == 1 + key % 300);
+			LLZX_CHECK(value.front() == static_cast<char>('a' + key % 26));
+			LLZX_CHECK(value.back() == value.front());
+		}
+		LLZX_CHECK(keys.size() == ops);
+	});
+}
+
+// 每个线程自己的arena：分配、写入、rewind后重新分配，回收的块被复用
+void testArena(size_t threadNum, size_t requests)
+{
+	LLZXTest::runThreads(threadNum, [&](size_t id) {
+		LLZXTest::Random random(id + 200);
+		LLZXMemoryPool::LLZXArena& arena = LLZXMemoryPool::LLZXArena::local();
+		for (size_t request = 0; request < requests; ++request)
+		{
+			LLZXMemoryPool::LLZXArenaScope scope(arena);
+			std::vector<std::pair<unsigned char*, size_t>> allocations;
+			for (size_t i = 0, count = 1 + random.below(64); i < count; ++i)
+			{
+				size_t size = 1 + random.below(random.below(16) == 0 ? 100000 : 512);
+				auto* ptr = static_cast<unsigned char*>(arena.allocate(size, 16));
+				LLZX_CHECK(reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+				std::memset(ptr, static_cast<int>(i & 0xff), size);
+				allocations.emplace_back(ptr, size);
+			}
+			for (size_t i = 0; i < allocations.size(); ++i)
+			{
+				LLZX_CHECK(allocations[i].first[0] == static_cast<unsigned char>(i & 0xff));
+				LLZX_CHECK(allocations[i].first[allocations[i].second - 1] == static_cast<unsigned char>(i & 0xff));
+			}
+		}
+	});
+}
+
+} // namespace
+
+int main()
+{
+	testAllocateFree(4, 40000);
+	testContainers(4, 20000);
+	testArena(4, 2000);
+	std::printf("memory_pool_stress_test: passed\n");
+	return 0;
+}
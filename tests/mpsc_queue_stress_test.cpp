@@ -0,0 +1,114 @@
+// LLZXMpscQueue的压力测试：多个生产者向一个很小的队列并发推入，单个消费者取出，
+// 检查每个元素恰好被取出一次、同一个生产者的元素保持推入的顺序，以及队列满/空时的行为
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "LLZXMpscQueue.h"
+#include "LLZXTestUtil.h"
+
+using LLZXCommon::LLZXMpscQueue;
+
+namespace
+{
+
+// 单线程下的容量、满和空
+void testBounds()
+{
+	LLZXMpscQueue<uint64_t> queue(5);
+	LLZX_CHECK(queue.capacity() == 8);
+	LLZX_CHECK(queue.empty());
+	for (uint64_t i = 0; i < queue.capacity(); ++i)
+		LLZX_CHECK(queue.tryPush(i));
+	LLZX_CHECK(!queue.tryPush(100));
+	LLZX_CHECK(!queue.empty());
+
+	// 绕过一圈之后格子重新可用，顺序不变
+	uint64_t values[8];
+	LLZX_CHECK(queue.popMany(values, 3) == 3);
+	LLZX_CHECK(values[0] == 0 && values[1] == 1 && values[2] == 2);
+	for (uint64_t i = 8; i < 11; ++i)
+		LLZX_CHECK(queue.tryPush(i));
+	LLZX_CHECK(!queue.tryPush(100));
+	for (uint64_t expected = 3; expected < 11; ++expected)
+	{
+		uint64_t value = 0;
+		LLZX_CHECK(queue.tryPop(value));
+		LLZX_CHECK(value == expected);
+	}
+	uint64_t value = 0;
+	LLZX_CHECK(!queue.tryPop(value));
+	LLZX_CHECK(queue.empty());
+}
+
+// 元素为(生产者编号 << 32) | 序号；队列容量远小于元素总数，生产者频繁遇到队列满
+void testConcurrent(size_t producerNum, uint64_t perProducer, size_t capacity)
+{
+	LLZXMpscQueue<uint64_t> queue(capacity);
+	std::atomic<size_t> started{0};
+	std::vector<uint64_t> nextSeq(producerNum, 0);
+	uint64_t total = producerNum * perProducer;
+
+	std::thread consumer([&] {
+		uint64_t values[32];
+		uint64_t received = 0;
+		while (received < total)
+		{
+			size_t count = queue.popMany(values, 32);
+			if (count == 0)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				size_t producer = static_cast<size_t>(values[i] >> 32);
+				uint64_t seq = values[i] & 0xffffffffu;
+				LLZX_CHECK(producer < producerNum);
+				LLZX_CHECK(seq == nextSeq[producer]);
+				++nextSeq[producer];
+			}
+			received += count;
+		}
+		LLZX_CHECK(queue.empty());
+	});
+
+	LLZXTest::runThreads(producerNum, [&](size_t producer) {
+		started.fetch_add(1);
+		while (started.load() < producerNum)
+			std::this_thread::yield();
+		for (uint64_t seq = 0; seq < perProducer; ++seq)
+		{
+			uint64_t value = static_cast<uint64_t>(producer) << 32 | seq;
+			while (!queue.tryPush(value))
+				std::this_thread::yield();
+		}
+	});
+	consumer.join();
+
+	for (size_t producer = 0; producer < producerNum; ++producer)
+		LLZX_CHECK(nextSeq[producer] == perProducer);
+}
+
+} // namespace
+
+int main()
+{
+	testBounds();
+	testConcurrent(4, 50000, 16);
+	testConcurrent(8, 10000, 2);
+	// 指针元素，与LLZXSharedNothingCache的用法一致
+	{
+		LLZXMpscQueue<int*> queue(4);
+		int value = 42;
+		LLZX_CHECK(queue.tryPush(&value));
+		int* popped = nullptr;
+		LLZX_CHECK(queue.tryPop(popped));
+		LLZX_CHECK(popped == &value && *popped == 42);
+	}
+	std::printf("mpsc_queue_stress_test: passed\n");
+	return 0;
+}
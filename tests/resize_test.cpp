@@ -0,0 +1,228 @@
+// 在线调整容量的行为测试：
+//   LLZXLruCache缩小时按最久未访问的顺序驱逐，保留最近访问的元素；大幅缩小后整理slab，之后扩大仍然可以写满；
+//   缩小与并发读写同时进行时不超出容量；
+//   分片缓存的setCapacity按当前份额等比例缩放，rebalance把容量移向未命中多的分片，总容量保持不变；
+//   LLZXSliceRebalancer在后台定期执行rebalance
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXLruCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+using Sharded = LLZXHashLruCache<int, int>;
+
+size_t sum(const std::vector<size_t>& values)
+{
+	return std::accumulate(values.begin(), values.end(), size_t(0));
+}
+
+void testShrinkKeepsRecent()
+{
+	LLZXLruCache<int, int> cache(100);
+	int value = 0;
+	for (int key = 0; key < 100; ++key)
+		cache.put(key, key);
+	// 0..9重新访问，变成最近访问的元素
+	for (int key = 0; key < 10; ++key)
+		LLZX_CHECK(cache.get(key, value));
+
+	cache.setCapacity(30);
+	LLZX_CHECK(cache.capacity() == 30 && cache.size() == 30);
+	for (int key = 0; key < 10; ++key)
+		LLZX_CHECK(cache.get(key, value) && value == key);
+	for (int key = 80; key < 100; ++key)
+		LLZX_CHECK(cache.get(key, value) && value == key);
+	for (int key = 10; key < 80; ++key)
+		LLZX_CHECK(!cache.get(key, value));
+
+	// 扩大立即生效
+	cache.setCapacity(200);
+	for (int key = 100; key < 270; ++key)
+		cache.put(key, key);
+	LLZX_CHECK(cache.size() == 200);
+
+	// 扩大到比当前元素更多、再缩小到不低于当前元素个数时不驱逐
+	cache.setCapacity(500);
+	cache.setCapacity(200);
+	LLZX_CHECK(cache.size() == 200);
+}
+
+void testCompaction()
+{
+	constexpr int kLarge = 5000;
+	constexpr int kSmall = 100;
+	LLZXLruCache<int, std::string> cache(kLarge);
+	std::string value;
+	for (int key = 0; key < kLarge; ++key)
+		cache.put(key, std::to_string(key));
+
+	// 存活元素远少于槽位数，缩小之后整理slab和索引，剩下的元素和顺序不变
+	cache.setCapacity(kSmall);
+	LLZX_CHECK(cache.size() == static_cast<size_t>(kSmall));
+	for (int key = kLarge - kSmall; key < kLarge; ++key)
+		LLZX_CHECK(cache.get(key, value) && value == std::to_string(key));
+	cache.put(-1, "new");
+	LLZX_CHECK(!cache.get(kLarge - kSmall, value));
+	LLZX_CHECK(cache.get(-1, value) && value == "new");
+
+	cache.setCapacity(kLarge);
+	for (int key = kLarge; key < 3 * kLarge; ++key)
+		cache.put(key, std::to_string(key));
+	LLZX_CHECK(cache.size() == static_cast<size_t>(kLarge));
+	for (int key = 2 * kLarge; key < 3 * kLarge; ++key)
+		LLZX_CHECK(cache.get(key, value) && value == std::to_string(key));
+}
+
+// 一个线程反复缩小、扩大，其他线程并发读写；结束后容量等于最后一次设置的值
+void testConcurrentResize()
+{
+	LLZXLruCache<int, int> cache(4096);
+	std::atomic<bool> done{false};
+	LLZXTest::runThreads(4, [&](size_t id) {
+		if (id == 0)
+		{
+			for (int round = 0; round < 50; ++round)
+			{
+				cache.setCapacity(round % 2 == 0 ? 64 : 4096);
+				LLZX_CHECK(cache.size() <= 4096);
+			}
+			cache.setCapacity(128);
+			done = true;
+			return;
+		}
+
+		LLZXTest::Random random(id);
+		int value = 0;
+		while (!done)
+		{
+			int key = static_cast<int>(random.below(8192));
+			if (cache.get(key, value))
+				LLZX_CHECK(value == key);
+			else
+				cache.put(key, key);
+		}
+	});
+	LLZX_CHECK(cache.capacity() == 128);
+	LLZX_CHECK(cache.size() <= 128);
+}
+
+// 在空缓存（分片没有满）中插入再删除，从各分片的元素个数找出key所在的分片；删除不计入未命中
+template<typename Cache>
+size_t sliceOf(Cache& cache, int key)
+{
+	cache.put(key, key);
+	std::vector<size_t> occupancy = cache.sliceOccupancy();
+	cache.remove(key);
+	for (size_t i = 0; i < occupancy.size(); ++i)
+		if (occupancy[i] == 1)
+			return i;
+	LLZX_CHECK(false);
+	return 0;
+}
+
+// 返回count个落在slice分片上的key，从first开始找
+template<typename Cache>
+std::vector<int> keysOfSlice(Cache& cache, size_t slice, int first, size_t count)
+{
+	std::vector<int> keys;
+	for (int key = first; keys.size() < count; ++key)
+		if (sliceOf(cache, key) == slice)
+			keys.push_back(key);
+	return keys;
+}
+
+void testShardedSetCapacity()
+{
+	Sharded cache(400, 4);
+	LLZX_CHECK(cache.capacity() == 400);
+	LLZX_CHECK(cache.sliceCapacities() == std::vector<size_t>(4, 100));
+	for (int key = 0; key < 1000; ++key)
+		cache.put(key, key);
+
+	cache.setCapacity(200);
+	LLZX_CHECK(cache.capacity() == 200);
+	LLZX_CHECK(cache.sliceCapacities() == std::vector<size_t>(4, 50));
+	LLZX_CHECK(sum(cache.sliceOccupancy()) == 200);
+
+	cache.setCapacity(403);
+	LLZX_CHECK(sum(cache.sliceCapacities()) == 403);
+}
+
+void testRebalance()
+{
+	Sharded cache(400, 4);
+	std::vector<int> hotKeys = keysOfSlice(cache, 0, 0, 300);
+	std::vector<int> coldKeys = keysOfSlice(cache, 1, 100000, 100);
+
+	// 没有未命中时不调整
+	cache.rebalance(1.0, 0.25);
+	LLZX_CHECK(cache.sliceCapacities() == std::vector<size_t>(4, 100));
+
+	// 未命中全部落在分片0：保底份额25，其余300全部给分片0
+	int value = 0;
+	for (int key : hotKeys)
+		LLZX_CHECK(!cache.get(key, value));
+	cache.rebalance(1.0, 0.25);
+	LLZX_CHECK((cache.sliceCapacities() == std::vector<size_t>{325, 25, 25, 25}));
+	LLZX_CHECK(cache.capacity() == 400);
+	for (int key : hotKeys)
+		cache.put(key, key);
+	for (int key : hotKeys)
+		LLZX_CHECK(cache.get(key, value) && value == key);
+
+	// 之后的setCapacity保留rebalance得到的份额
+	cache.setCapacity(800);
+	LLZX_CHECK((cache.sliceCapacities() == std::vector<size_t>{650, 50, 50, 50}));
+
+	// step只向目标移动一部分：分片1的未命中最多，容量从50开始增长，总量不变
+	for (int key : coldKeys)
+		LLZX_CHECK(!cache.get(key, value));
+	cache.rebalance(0.5, 0.25);
+	std::vector<size_t> capacities = cache.sliceCapacities();
+	LLZX_CHECK(sum(capacities) == 800);
+	LLZX_CHECK(capacities[1] > 50 && capacities[1] < 650);
+	LLZX_CHECK(capacities[0] < 650);
+	for (size_t i = 0; i < capacities.size(); ++i)
+		LLZX_CHECK(cache.sliceOccupancy()[i] <= capacities[i]);
+}
+
+void testRebalancer()
+{
+	Sharded cache(400, 4);
+	std::vector<int> keys = keysOfSlice(cache, 2, 0, 200);
+	{
+		LLZXSliceRebalancer rebalancer(cache, std::chrono::milliseconds(10));
+		int value = 0;
+		for (int key : keys)
+			LLZX_CHECK(!cache.get(key, value));
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	std::vector<size_t> capacities = cache.sliceCapacities();
+	LLZX_CHECK(sum(capacities) == 400);
+	LLZX_CHECK(capacities[2] > 100);
+}
+
+} // namespace
+
+int main()
+{
+	testShrinkKeepsRecent();
+	testCompaction();
+	testConcurrentResize();
+	testShardedSetCapacity();
+	testRebalance();
+	testRebalancer();
+	std::printf("resize_test: passed\n");
+	return 0;
+}
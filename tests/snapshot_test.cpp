@@ -0,0 +1,186 @@
+// 快照的往返测试：
+//   LLZXLruCache/LLZXHashLruCache保存快照（保存期间其他线程并发读写）后恢复到新的缓存，内容和剩余存活时间保持一致；
+//   恢复到容量更小的缓存时只恢复一部分；截断、损坏或不存在的文件抛出std::runtime_error
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "LLZXLruCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+std::string tempPath(const std::string& name)
+{
+	return (std::filesystem::temp_directory_path() /
+		("llzx_" + name + "_" + std::to_string(::getpid()) + ".snapshot")).string();
+}
+
+std::string keyOf(uint64_t i) { return "key:" + std::to_string(i); }
+std::string valueOf(uint64_t i) { return std::string(static_cast<size_t>(i % 97), 'v') + std::to_string(i); }
+
+template<typename Fn>
+bool throwsRuntimeError(Fn&& fn)
+{
+	try
+	{
+		fn();
+	}
+	catch (const std::runtime_error&)
+	{
+		return true;
+	}
+	return false;
+}
+
+// count个永久元素，另有一批很快过期的元素和一批长TTL的元素；之后并发读写的线程只操作另一段key
+template<typename Cache>
+void fill(Cache& cache, uint64_t count)
+{
+	for (uint64_t i = 0; i < count; ++i)
+		cache.put(keyOf(i), valueOf(i));
+	for (uint64_t i = count; i < count + 100; ++i)
+		cache.put(keyOf(i), valueOf(i), std::chrono::milliseconds(1));
+	for (uint64_t i = count + 100; i < count + 200; ++i)
+		cache.put(keyOf(i), valueOf(i), std::chrono::hours(1));
+}
+
+template<typename Cache>
+void checkRestored(Cache& cache, uint64_t count)
+{
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		std::string value;
+		LLZX_CHECK(cache.get(keyOf(i), value));
+		LLZX_CHECK(value == valueOf(i));
+	}
+	for (uint64_t i = count; i < count + 100; ++i)
+	{
+		std::string value;
+		LLZX_CHECK(!cache.get(keyOf(i), value));
+	}
+	for (uint64_t i = count + 100; i < count + 200; ++i)
+	{
+		std::string value;
+		LLZX_CHECK(cache.get(keyOf(i), value));
+		LLZX_CHECK(value == valueOf(i));
+	}
+}
+
+template<typename Cache, typename MakeCache>
+void testRoundTrip(const std::string& name, MakeCache&& makeCache, uint64_t count)
+{
+	std::string path = tempPath(name);
+	Cache source = makeCache(count * 2 + 1000);
+	fill(source, count);
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+	// 保存期间另外两个线程读写不在快照检查范围内的key，快照在每个分片的锁内编码
+	std::atomic<bool> done{false};
+	std::thread background([&] {
+		LLZXTest::runThreads(2, [&](size_t id) {
+			LLZXTest::Random random(id + 1);
+			while (!done.load())
+			{
+				uint64_t key = count * 10 + random.below(200);
+				std::string value;
+				if (random.below(2) == 0)
+					source.put(keyOf(key), valueOf(key));
+				else if (source.get(keyOf(key), value))
+					LLZX_CHECK(value == valueOf(key));
+				// 同时读取快照中的元素，刷新它们的访问顺序
+				if (source.get(keyOf(random.below(count)), value))
+					LLZX_CHECK(!value.empty());
+			}
+		});
+	});
+	for (int round = 0; round < 3; ++round)
+		source.saveSnapshot(path);
+	done.store(true);
+	background.join();
+
+	for (size_t threadNum : {size_t{1}, size_t{4}})
+	{
+		Cache restored = makeCache(count * 2 + 1000);
+		size_t loaded = restored.loadSnapshot(path, threadNum);
+		LLZX_CHECK(loaded >= count + 100);
+		checkRestored(restored, count);
+	}
+
+	// 容量不足时只恢复一部分（各分片按比例保留最近访问的一段），总数不超过容量，恢复的值仍然正确
+	{
+		Cache small = makeCache(count / 2);
+		size_t loaded = small.loadSnapshot(path, 2);
+		// 每个分片保留的个数向上取整，恢复个数最多比容量多出分片数，多出的在插入时被驱逐
+		LLZX_CHECK(loaded > 0 && loaded <= count / 2 + 64);
+		size_t present = 0;
+		for (uint64_t i = 0; i < count + 200; ++i)
+		{
+			std::string value;
+			if (small.get(keyOf(i), value))
+			{
+				LLZX_CHECK(value == valueOf(i));
+				++present;
+			}
+		}
+		LLZX_CHECK(present <= count / 2);
+	}
+
+	auto size = std::filesystem::file_size(path);
+	// 截断：元数据之后的数据不完整
+	{
+		std::filesystem::resize_file(path, size / 2);
+		Cache restored = makeCache(count * 2);
+		LLZX_CHECK(throwsRuntimeError([&] { restored.loadSnapshot(path, 2); }));
+		std::filesystem::resize_file(path, 8);
+		LLZX_CHECK(throwsRuntimeError([&] { restored.loadSnapshot(path, 2); }));
+	}
+	// 损坏：改写数据区的一个字节，校验和不符
+	{
+		source.saveSnapshot(path);
+		{
+			std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekg(-16, std::ios::end);
+			char byte = 0;
+			file.get(byte);
+			file.seekp(-16, std::ios::end);
+			file.put(static_cast<char>(byte ^ 0x5a));
+		}
+		Cache restored = makeCache(count * 2);
+		LLZX_CHECK(throwsRuntimeError([&] { restored.loadSnapshot(path, 4); }));
+	}
+	std::filesystem::remove(path);
+	{
+		Cache restored = makeCache(count);
+		LLZX_CHECK(throwsRuntimeError([&] { restored.loadSnapshot(path); }));
+	}
+}
+
+} // namespace
+
+int main()
+{
+	using Lru = LLZXLruCache<std::string, std::string>;
+	using HashLru = LLZXHashLruCache<std::string, std::string>;
+
+	testRoundTrip<Lru>("lru", [](uint64_t capacity) {
+		return Lru(static_cast<int>(capacity));
+	}, 5000);
+	testRoundTrip<HashLru>("hash_lru", [](uint64_t capacity) {
+		return HashLru(static_cast<size_t>(capacity), 8);
+	}, 20000);
+	std::printf("snapshot_test: passed\n");
+	return 0;
+}
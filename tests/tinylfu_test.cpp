@@ -0,0 +1,123 @@
+// W-TinyLFU的行为测试：
+//   频繁访问的key进入保护区，之后一轮超过容量的一次性扫描不会把它们冲掉（同样的访问序列下普通LRU会全部丢失）；
+//   元素个数始终不超过容量；remove、过期回收释放槽位里的key和值；分片版本同样抗扫描
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "LLZXLruCache.h"
+#include "LLZXTinyLfuCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+constexpr int kCapacity = 1000;
+constexpr int kHotKeys = 100;
+constexpr int kScanKeys = 2000;
+
+// 热点key各访问多次，随后是kScanKeys个只出现一次的key，返回扫描之后仍然命中的热点key个数
+// 扫描之前的总访问次数小于Sketch的老化周期（容量的10倍），热点的频率不会在扫描中途减半
+template<typename Cache>
+int hotKeysAfterScan(Cache& cache)
+{
+	int value = 0;
+	for (int key = 0; key < kHotKeys; ++key)
+		cache.put(key, key);
+	for (int round = 0; round < 14; ++round)
+	{
+		for (int key = 0; key < kHotKeys; ++key)
+			LLZX_CHECK(cache.get(key, value) && value == key);
+	}
+
+	for (int key = kHotKeys; key < kHotKeys + kScanKeys; ++key)
+		cache.put(key, key);
+
+	int survived = 0;
+	for (int key = 0; key < kHotKeys; ++key)
+	{
+		if (cache.get(key, value))
+		{
+			LLZX_CHECK(value == key);
+			++survived;
+		}
+	}
+	return survived;
+}
+
+void testScanResistance()
+{
+	LLZXTinyLfuCache<int, int> cache(kCapacity);
+	LLZX_CHECK(hotKeysAfterScan(cache) == kHotKeys);
+	LLZX_CHECK(cache.size() == static_cast<size_t>(kCapacity));
+
+	// 扫描中的新key频率都只有1，准入判断时比不过试用区里同样频率的受害者，大部分没有留下
+	int value = 0;
+	int scanned = 0;
+	for (int key = kHotKeys; key < kHotKeys + kScanKeys; ++key)
+		scanned += cache.get(key, value) ? 1 : 0;
+	LLZX_CHECK(scanned <= kCapacity - kHotKeys);
+
+	LLZXLruCache<int, int> lru(kCapacity);
+	LLZX_CHECK(hotKeysAfterScan(lru) == 0);
+}
+
+void testSharded()
+{
+	LLZXHashTinyLfuCache<int, int> cache(kCapacity, 4);
+	// 各分片按key的hash分到的扫描元素不完全均匀，只要求绝大多数热点留下
+	LLZX_CHECK(hotKeysAfterScan(cache) >= kHotKeys * 9 / 10);
+}
+
+// 槽位被remove或过期回收后不再持有key和值；shared_ptr的引用计数回到1说明缓存里的副本已经释放
+void testSlotRelease()
+{
+	LLZXTinyLfuCache<std::shared_ptr<int>, std::shared_ptr<std::string>> cache(16);
+	auto key = std::make_shared<int>(1);
+	auto value = std::make_shared<std::string>("one");
+
+	cache.put(key, value);
+	LLZX_CHECK(cache.size() == 1);
+	LLZX_CHECK(key.use_count() > 1 && value.use_count() == 2); // 默认索引里还有一份key
+	cache.remove(key);
+	LLZX_CHECK(cache.size() == 0);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+
+	cache.put(key, value, std::chrono::milliseconds(10));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	LLZX_CHECK(cache.purgeExpired() == 1);
+	LLZX_CHECK(key.use_count() == 1 && value.use_count() == 1);
+}
+
+void testCapacityBound()
+{
+	LLZXTinyLfuCache<int, int> cache(100);
+	LLZXTest::Random random(11);
+	int value = 0;
+	for (int i = 0; i < 20000; ++i)
+	{
+		int key = static_cast<int>(random.below(1000));
+		if (!cache.get(key, value))
+			cache.put(key, key);
+		else
+			LLZX_CHECK(value == key);
+		LLZX_CHECK(cache.size() <= 100);
+	}
+}
+
+} // namespace
+
+int main()
+{
+	testScanResistance();
+	testSharded();
+	testSlotRelease();
+	testCapacityBound();
+	std::printf("tinylfu_test: passed\n");
+	return 0;
+}
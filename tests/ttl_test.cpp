@@ -0,0 +1,200 @@
+// 逐元素TTL的行为测试：
+//   LLZXTimingWheel按手动推进的tick检查：每个槽位恰好在推进越过deadline的那一次到期（包括跨层重新分配的远期deadline），
+//   取消和重新调度后按新的deadline处理；
+//   各个缓存策略中带ttl的元素到期后不再命中，不带ttl的put清除原有的过期时间，purgeExpired返回回收个数；
+//   LLZXExpiryReaper在没有读写的情况下在后台回收过期元素
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LLZXArcCache.h"
+#include "LLZXClockCache.h"
+#include "LLZXLfuCache.h"
+#include "LLZXLruCache.h"
+#include "LLZXTimingWheel.h"
+#include "LLZXTinyLfuCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+constexpr auto kShortTtl = std::chrono::milliseconds(50);
+constexpr auto kWait = std::chrono::milliseconds(150);
+
+void testTimingWheel()
+{
+	constexpr SlotIndex kSlots = 2000;
+	LLZXTimingWheel wheel(0);
+	LLZXTest::Random random(7);
+	std::vector<uint64_t> deadline(kSlots, 0);
+	std::vector<bool> pending(kSlots, false);
+
+	// deadline分布在多层上，第0层只覆盖64个tick
+	for (SlotIndex slot = 0; slot < kSlots; ++slot)
+	{
+		uint64_t range = uint64_t(1) << (6 + random.below(15));
+		deadline[slot] = 1 + random.below(range);
+		wheel.schedule(slot, deadline[slot]);
+		pending[slot] = true;
+	}
+	LLZX_CHECK(wheel.size() == kSlots);
+
+	// 取消一部分，另一部分重新调度到更晚的时刻
+	for (SlotIndex slot = 0; slot < kSlots; slot += 7)
+	{
+		wheel.cancel(slot);
+		pending[slot] = false;
+	}
+	for (SlotIndex slot = 3; slot < kSlots; slot += 11)
+	{
+		if (!pending[slot]) continue;
+		deadline[slot] += 1 + random.below(5000);
+		wheel.schedule(slot, deadline[slot]);
+	}
+
+	uint64_t now = 0;
+	size_t remaining = wheel.size();
+	while (remaining > 0)
+	{
+		uint64_t next = now + 1 + random.below(3000);
+		size_t expired = wheel.advance(next, [&](SlotIndex slot) {
+			LLZX_CHECK(pending[slot]);
+			LLZX_CHECK(deadline[slot] > now && deadline[slot] <= next);
+			pending[slot] = false;
+		});
+		now = next;
+		LLZX_CHECK(wheel.now() == now);
+		LLZX_CHECK(expired <= remaining);
+		remaining -= expired;
+		LLZX_CHECK(wheel.size() == remaining);
+		for (SlotIndex slot = 0; slot < kSlots; ++slot)
+			LLZX_CHECK(!pending[slot] || deadline[slot] > now);
+	}
+
+	// 不晚于当前tick的deadline在下一个tick到期
+	wheel.schedule(0, now / 2);
+	LLZX_CHECK(wheel.advance(now, [](SlotIndex) {}) == 0);
+	LLZX_CHECK(wheel.advance(now + 1, [](SlotIndex slot) { LLZX_CHECK(slot == 0); }) == 1);
+}
+
+template<typename Cache>
+void checkExpiry(Cache& cache)
+{
+	int value = 0;
+	cache.put(1, 1, kShortTtl);
+	cache.put(2, 2, kShortTtl);
+	cache.put(2, 20);
+	cache.put(3, 3, std::chrono::hours(1));
+	cache.put(4, 4);
+	for (int key = 10; key < 20; ++key)
+		cache.put(key, key, kShortTtl);
+	LLZX_CHECK(cache.get(1, value) && value == 1);
+
+	std::this_thread::sleep_for(kWait);
+	LLZX_CHECK(cache.purgeExpired() == 11);
+	LLZX_CHECK(cache.purgeExpired() == 0);
+	LLZX_CHECK(!cache.get(1, value));
+	LLZX_CHECK(cache.get(2, value) && value == 20);
+	LLZX_CHECK(cache.get(3, value) && value == 3);
+	LLZX_CHECK(cache.get(4, value) && value == 4);
+	for (int key = 10; key < 20; ++key)
+		LLZX_CHECK(!cache.get(key, value));
+
+	// 还没有回收的过期元素同样不命中
+	cache.put(5, 5, kShortTtl);
+	std::this_thread::sleep_for(kWait);
+	LLZX_CHECK(!cache.get(5, value));
+	cache.purgeExpired();
+
+	// 过期后重新put的元素按新的ttl存活
+	cache.put(1, 100, std::chrono::hours(1));
+	LLZX_CHECK(cache.get(1, value) && value == 100);
+}
+
+template<typename Cache>
+void checkExpiryWithSize(Cache& cache)
+{
+	checkExpiry(cache);
+	LLZX_CHECK(cache.size() == 4);
+}
+
+void testPolicies()
+{
+	LLZXLruCache<int, int> lru(64);
+	checkExpiryWithSize(lru);
+
+	LLZXLruCache<int, int> buffered(64, LLZXReadMode::Buffered);
+	checkExpiryWithSize(buffered);
+
+	LLZXLfuCache<int, int> lfu(64);
+	checkExpiryWithSize(lfu);
+
+	LLZXArcCache<int, int> arc(64);
+	checkExpiryWithSize(arc);
+
+	LLZXClockCache<int, int> clock(64);
+	checkExpiryWithSize(clock);
+
+	LLZXTinyLfuCache<int, int> tinyLfu(64);
+	checkExpiryWithSize(tinyLfu);
+
+	LLZXHashLruCache<int, int> sharded(256, 4);
+	checkExpiry(sharded);
+}
+
+// 满时先回收已过期的元素，不驱逐仍然有效的元素
+void testExpiredMakeRoom()
+{
+	LLZXLruCache<int, int> cache(4);
+	int value = 0;
+	cache.put(1, 1);
+	cache.put(2, 2, kShortTtl);
+	cache.put(3, 3, kShortTtl);
+	cache.put(4, 4);
+	std::this_thread::sleep_for(kWait);
+	cache.put(5, 5);
+	cache.put(6, 6);
+	LLZX_CHECK(cache.size() == 4);
+	LLZX_CHECK(cache.get(1, value) && cache.get(4, value) && cache.get(5, value) && cache.get(6, value));
+}
+
+void testReaper()
+{
+	LLZXLruCache<int, int> cache(64);
+	LLZXHashLruCache<int, int> sharded(256, 4);
+	for (int key = 0; key < 32; ++key)
+	{
+		cache.put(key, key, kShortTtl);
+		sharded.put(key, key, kShortTtl);
+	}
+	cache.put(100, 100);
+	LLZX_CHECK(cache.size() == 33);
+
+	{
+		LLZXExpiryReaper reaper(cache, std::chrono::milliseconds(10));
+		LLZXExpiryReaper shardedReaper(sharded, std::chrono::milliseconds(10));
+		std::this_thread::sleep_for(kWait * 2);
+	}
+	LLZX_CHECK(cache.size() == 1);
+	std::vector<size_t> occupancy = sharded.sliceOccupancy();
+	LLZX_CHECK(std::accumulate(occupancy.begin(), occupancy.end(), size_t(0)) == 0);
+}
+
+} // namespace
+
+int main()
+{
+	testTimingWheel();
+	testPolicies();
+	testExpiredMakeRoom();
+	testReaper();
+	std::printf("ttl_test: passed\n");
+	return 0;
+}
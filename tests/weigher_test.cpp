@@ -0,0 +1,166 @@
+// 按权重限制容量的行为测试：
+//   自定义weigher下已用容量始终不超过maxWeight，并且等于仍在缓存中的元素权重之和；按最久未访问的顺序驱逐；
+//   单个元素超过预算时不缓存，更新得更大时驱逐其他元素，更新到超过预算时删除这个key；
+//   默认weigher计入key、value本身、它们的堆内存和由节点、索引布局算出的固定开销
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "LLZXLruCache.h"
+#include "LLZXTestUtil.h"
+
+using namespace LLZXCache;
+
+namespace
+{
+
+using StringCache = LLZXLruCache<int, std::string>;
+
+size_t valueLength(const int&, const std::string& value)
+{
+	return value.size();
+}
+
+bool contains(StringCache& cache, int key)
+{
+	std::string value;
+	return cache.get(key, value);
+}
+
+void testEvictionByWeight()
+{
+	StringCache cache(100, valueLength);
+	LLZX_CHECK(cache.capacity() == 100);
+
+	cache.put(1, std::string(40, 'a'));
+	cache.put(2, std::string(40, 'b'));
+	LLZX_CHECK(cache.weight() == 80);
+
+	// 放不下时驱逐最久未访问的1
+	cache.put(3, std::string(40, 'c'));
+	LLZX_CHECK(cache.weight() == 80);
+	LLZX_CHECK(!contains(cache, 1));
+
+	// 访问过的2变成最近访问的；插入5要腾出两个元素的空间，依次驱逐3和2，最近插入的4放得下
+	LLZX_CHECK(contains(cache, 2));
+	cache.put(4, std::string(10, 'd'));
+	LLZX_CHECK(cache.weight() == 90);
+	cache.put(5, std::string(85, 'e'));
+	LLZX_CHECK(cache.weight() == 95);
+	LLZX_CHECK(!contains(cache, 2) && !contains(cache, 3));
+	LLZX_CHECK(contains(cache, 4) && contains(cache, 5));
+	LLZX_CHECK(cache.size() == 2);
+}
+
+void testOversizedEntries()
+{
+	StringCache cache(100, valueLength);
+	cache.put(1, std::string(30, 'a'));
+	cache.put(2, std::string(30, 'b'));
+
+	// 单个元素超过预算：不缓存，也不驱逐其他元素
+	cache.put(3, std::string(101, 'c'));
+	LLZX_CHECK(!contains(cache, 3));
+	LLZX_CHECK(cache.weight() == 60 && contains(cache, 1) && contains(cache, 2));
+
+	// 更新得更大：驱逐其他元素，更新的key保留
+	cache.put(1, std::string(80, 'A'));
+	LLZX_CHECK(cache.weight() == 80);
+	LLZX_CHECK(contains(cache, 1) && !contains(cache, 2));
+
+	// 更新到超过预算：这个key被删除
+	cache.put(1, std::string(200, 'A'));
+	LLZX_CHECK(!contains(cache, 1));
+	LLZX_CHECK(cache.weight() == 0 && cache.size() == 0);
+}
+
+void testRandomWorkload()
+{
+	constexpr size_t kMaxWeight = 4096;
+	StringCache cache(kMaxWeight, valueLength);
+	LLZXTest::Random random(5);
+	for (int i = 0; i < 20000; ++i)
+	{
+		int key = static_cast<int>(random.below(500));
+		if (random.below(4) == 0)
+			cache.remove(key);
+		else
+			cache.put(key, std::string(random.below(200), 'x'));
+		LLZX_CHECK(cache.weight() <= kMaxWeight);
+	}
+
+	size_t total = 0;
+	std::string value;
+	for (int key = 0; key < 500; ++key)
+	{
+		if (cache.get(key, value))
+			total += value.size();
+	}
+	LLZX_CHECK(total == cache.weight());
+}
+
+// 没有提供kEntryBytes的自定义索引，计重时只用到它的类型
+struct NoEntryBytesIndex
+{
+};
+
+void testDefaultWeigher()
+{
+	using IntWeigher = LLZXDefaultWeigher<int, int>;
+	static_assert(IntWeigher::perEntryOverhead() > sizeof(LruNode<int, int>) - 2 * sizeof(int),
+		"the default index contributes its entry size");
+	static_assert(LLZXDefaultWeigher<int, int, NoEntryBytesIndex>::perEntryOverhead() ==
+		sizeof(LruNode<int, int>) - 2 * sizeof(int), "an index without kEntryBytes only counts the node");
+
+	// nullptr使用默认weigher，已用容量就是它给出的字节数
+	LLZXLruCache<int, int> ints(1 << 20, nullptr);
+	ints.put(1, 1);
+	ints.put(2, 2);
+	LLZX_CHECK(ints.weight() == 2 * IntWeigher()(1, 1));
+	LLZX_CHECK(IntWeigher()(1, 1) == 2 * sizeof(int) + IntWeigher::perEntryOverhead());
+
+	// 短字符串在对象内部，长字符串计入堆上的容量
+	using StringWeigher = LLZXDefaultWeigher<std::string, std::string>;
+	size_t inlineWeight = StringWeigher()("k", "v");
+	LLZX_CHECK(inlineWeight == 2 * sizeof(std::string) + StringWeigher::perEntryOverhead());
+	std::string large(1000, 'v');
+	LLZX_CHECK(StringWeigher()("k", large) >= inlineWeight + large.size());
+
+	using VectorWeigher = LLZXDefaultWeigher<int, std::vector<std::string>>;
+	std::vector<std::string> nested(4, large);
+	LLZX_CHECK(VectorWeigher()(1, nested) >= nested.capacity() * sizeof(std::string) + 4 * large.size());
+
+	// 预算按字节算：放不下第二个长字符串时驱逐第一个
+	LLZXLruCache<std::string, std::string> strings(StringWeigher()("a", large) + inlineWeight, nullptr);
+	strings.put("a", large);
+	strings.put("b", "v");
+	LLZX_CHECK(strings.size() == 2);
+	strings.put("c", large);
+	std::string value;
+	LLZX_CHECK(!strings.get("a", value) && strings.get("c", value) && value == large);
+	LLZX_CHECK(strings.weight() <= strings.capacity());
+}
+
+void testSharded()
+{
+	LLZXHashLruCache<int, std::string> cache(400, valueLength, 4);
+	std::string value;
+	cache.put(1, std::string(101, 'a'));
+	LLZX_CHECK(!cache.get(1, value));
+	cache.put(2, std::string(50, 'b'));
+	LLZX_CHECK(cache.get(2, value) && value.size() == 50);
+}
+
+} // namespace
+
+int main()
+{
+	testEvictionByWeight();
+	testOversizedEntries();
+	testRandomWorkload();
+	testDefaultWeigher();
+	testSharded();
+	std::printf("weigher_test: passed\n");
+	return 0;
+}